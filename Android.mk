@@ -22,7 +22,20 @@ LOCAL_SHARED_LIBRARIES := libcutils libutils libdl libc
 LOCAL_SRC_FILES := \
     src/mraa.c \
     src/gpio/gpio.c \
+    src/gpio/gpio_chardev.c \
+    src/gpio/gpio_dispatch.c \
+    src/gpio/gpio_events.c \
+    src/gpio/gpio_mmap.c \
+    src/gpio/gpio_seq.c \
+    src/gpio/gpio_counter.c \
+    src/mock/mock_board.c \
+    src/stats/stats.c \
+    src/trace/trace.c \
     src/i2c/i2c.c \
+    src/i2c/i2c_regmap.c \
+    src/i2c/i2c_async.c \
+    src/i2c/i2c_scan.c \
+    src/sampler/sampler.c \
     src/pwm/pwm.c \
     src/spi/spi.c \
     src/aio/aio.c \
@@ -37,7 +50,8 @@ LOCAL_SRC_FILES := \
     src/x86/intel_sofia_3gr.c \
     src/x86/intel_minnow_byt_compatible.c \
     src/x86/intel_cherryhills.c \
-    src/x86/up.c
+    src/x86/up.c \
+    src/x86/intel_pad_mmap.c
 
 # glob.c pulled in from NetBSD project (BSD 3-clause License)
 LOCAL_SRC_FILES += \
@@ -34,6 +34,8 @@ extern "C" {
 #include "mraa/i2c.h"
 #include "mraa/uart.h"
 #include "mraa/uart_ow.h"
+#include "mraa/stats.h"
+#include "mraa/sampler.h"
 
 #ifdef __cplusplus
 }
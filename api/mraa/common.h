@@ -133,6 +133,27 @@ unsigned int mraa_get_platform_adc_supported_bits(int platform_offset);
  */
 mraa_result_t mraa_set_log_level(int level);
 
+/**
+ * Errors on the gpio, i2c, spi, aio and pwm data paths are recorded in a per
+ * thread ring and forwarded by a background thread instead of being logged
+ * by the failing call. They go to syslog by default, this sends them to a
+ * file instead. The log level filters them like any other message.
+ *
+ * @param path File to append the records to, NULL to go back to syslog
+ * @return Result of operation
+ */
+mraa_result_t mraa_set_trace_output(const char* path);
+
+/**
+ * Write the most recent trace records of every thread, forwarded or not, to
+ * a file descriptor, oldest first. Meant for post-mortems, the rings keep the
+ * last 256 records of each thread.
+ *
+ * @param fd File descriptor to write to
+ * @return Result of operation
+ */
+mraa_result_t mraa_trace_dump(int fd);
+
 /**
  * Return the Platform's Name, If no platform detected return NULL
  *
@@ -161,6 +182,58 @@ const char* mraa_get_platform_version(int platform_offset);
  */
 int mraa_set_priority(const int priority);
 
+/**
+ * Scheduling policy of the threads mraa creates
+ */
+typedef enum {
+    MRAA_THREAD_SCHED_INHERIT = 0, /**< Default. Keep the policy and priority of the creating thread */
+    MRAA_THREAD_SCHED_OTHER = 1,   /**< Normal time sharing */
+    MRAA_THREAD_SCHED_FIFO = 2,    /**< Realtime, first in first out */
+    MRAA_THREAD_SCHED_RR = 3       /**< Realtime, round robin */
+} mraa_thread_sched_t;
+
+/**
+ * Attributes applied to the threads mraa creates: gpio interrupt threads
+ * and dispatcher, iio trigger and event threads, i2c bus workers, sampler
+ * threads, the Firmata pull thread and the FT4222 gpio monitor
+ */
+typedef struct {
+    uint64_t cpu_mask; /**< cpus the thread may run on, bit n is cpu n, 0 to inherit */
+    mraa_thread_sched_t policy; /**< scheduling policy */
+    int priority; /**< priority for the realtime policies, clamped to the range of the policy */
+    unsigned int stack_size; /**< stack size in bytes, 0 for the default */
+} mraa_thread_attr_t;
+
+/**
+ * Set the attributes of every thread mraa creates from now on, unless the
+ * context the thread belongs to has attributes of its own. When the
+ * process lacks the privileges for a realtime policy the thread is created
+ * with the rest of the attributes and a warning is logged.
+ *
+ * @param attr Thread attributes, NULL to go back to the defaults
+ * @return Result of operation
+ */
+mraa_result_t mraa_set_thread_attr(const mraa_thread_attr_t* attr);
+
+/**
+ * Look up every sysfs, devfs and procfs path mraa uses under root, so
+ * "/tmp/fake" turns /sys/class/gpio into /tmp/fake/sys/class/gpio. The
+ * MRAA_FS_ROOT environment variable sets it before the platform is
+ * detected. Platform detection already happened when this is called, use
+ * mraa_deinit() and mraa_init() around it to detect again under the new root.
+ *
+ * @param root Directory to prefix paths with, NULL or "" for the real root
+ * @return Result of operation
+ */
+mraa_result_t mraa_set_fs_root(const char* root);
+
+/**
+ * Get the directory paths are looked up under, see mraa_set_fs_root()
+ *
+ * @return The prefix, "" for the real root
+ */
+const char* mraa_get_fs_root();
+
 /** Get the version string of mraa autogenerated from git tag
  *
  * The version returned may not be what is expected however it is a reliable
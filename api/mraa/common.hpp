@@ -83,6 +83,43 @@ setPriority(const int priority)
     return mraa_set_priority(priority);
 }
 
+/**
+ * Set the cpu affinity, scheduling and stack size of the threads mraa
+ * creates from now on, see mraa_set_thread_attr()
+ *
+ * @param attr Thread attributes
+ * @return Result of operation
+ */
+inline Result
+setThreadAttr(const mraa_thread_attr_t& attr)
+{
+    return (Result) mraa_set_thread_attr(&attr);
+}
+
+/**
+ * Look up every sysfs, devfs and procfs path under root, see
+ * mraa_set_fs_root()
+ *
+ * @param root Directory to prefix paths with, "" for the real root
+ * @return Result of operation
+ */
+inline Result
+setFsRoot(const std::string& root)
+{
+    return (Result) mraa_set_fs_root(root.c_str());
+}
+
+/**
+ * Get the directory paths are looked up under
+ *
+ * @return The prefix, empty for the real root
+ */
+inline std::string
+getFsRoot()
+{
+    return std::string(mraa_get_fs_root());
+}
+
 /**
  * Get platform type, board must be initialised.
  *
@@ -227,6 +264,30 @@ setLogLevel(int level)
     return (Result) mraa_set_log_level(level);
 }
 
+/**
+ * Send the records of the trace ring to a file instead of syslog
+ *
+ * @param path File to append the records to, empty to go back to syslog
+ * @return Result of operation
+ */
+inline Result
+setTraceOutput(const std::string& path)
+{
+    return (Result) mraa_set_trace_output(path.empty() ? NULL : path.c_str());
+}
+
+/**
+ * Write the most recent trace records of every thread to a file descriptor
+ *
+ * @param fd File descriptor to write to
+ * @return Result of operation
+ */
+inline Result
+traceDump(int fd)
+{
+    return (Result) mraa_trace_dump(fd);
+}
+
 /**
  * Detect presence of sub platform.
  *
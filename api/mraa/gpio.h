@@ -56,6 +56,11 @@ extern "C" {
  */
 typedef struct _gpio* mraa_gpio_context;
 
+/**
+ * Opaque pointer definition to the internal struct _gpio_group
+ */
+typedef struct _gpio_group* mraa_gpio_group_context;
+
 /**
  * Gpio Output modes
  */
@@ -86,6 +91,58 @@ typedef enum {
     MRAA_GPIO_EDGE_FALLING = 3 /**< Interrupt on falling only */
 } mraa_gpio_edge_t;
 
+/**
+ * A single edge recorded by mraa_gpio_events_enable()
+ */
+typedef struct {
+    uint64_t timestamp_ns; /**< CLOCK_MONOTONIC time of the edge, taken by the kernel when available */
+    mraa_gpio_edge_t edge; /**< MRAA_GPIO_EDGE_RISING or FALLING, MRAA_GPIO_EDGE_BOTH when unknown */
+    unsigned int seqno; /**< per pin sequence number, a gap means events were dropped */
+} mraa_gpio_event_t;
+
+/**
+ * Snapshot of the edge counter of a Gpio, see mraa_gpio_counter_read()
+ */
+typedef struct {
+    uint64_t count; /**< counted edges since the counter was enabled or last reset */
+    uint64_t timestamp_ns; /**< CLOCK_MONOTONIC time of the last counted edge, 0 if none */
+    uint64_t period_ns; /**< time between the last two counted edges, 0 until known */
+    uint64_t mean_period_ns; /**< mean time between counted edges since enable or reset, 0 until known */
+    uint64_t high_ns; /**< length of the last high pulse, 0 until known */
+    uint64_t low_ns; /**< length of the last low pulse, 0 until known */
+} mraa_gpio_counter_t;
+
+/**
+ * Filtering applied to a Gpio interrupt before its callback is called
+ */
+typedef struct {
+    unsigned int debounce_us; /**< the line must stay quiet this long after an edge before the callback fires, 0 to disable */
+    unsigned int min_interval_us; /**< callbacks closer than this to the previous one are dropped, 0 to disable */
+} mraa_gpio_isr_options_t;
+
+/**
+ * One step of a waveform played by mraa_gpio_sequence()
+ */
+typedef struct {
+    uint32_t mask; /**< group members driven by this step, bit n is member n */
+    uint32_t value; /**< levels of the members in mask, same bit order */
+    uint32_t delay_ns; /**< time from this step to the next one */
+} mraa_gpio_seq_step_t;
+
+/**
+ * Timing achieved by mraa_gpio_sequence(). Errors are the time a step was
+ * written minus the time it was due, negative means early.
+ */
+typedef struct {
+    unsigned int steps; /**< steps written, repeats included */
+    uint64_t requested_ns; /**< time from the first to the last step asked for */
+    uint64_t duration_ns; /**< time from the first to the last step achieved */
+    int64_t min_error_ns; /**< most early step */
+    int64_t max_error_ns; /**< most late step */
+    uint64_t mean_abs_error_ns; /**< mean of the absolute errors */
+    mraa_boolean_t realtime; /**< the thread got a realtime priority and locked memory */
+} mraa_gpio_seq_stats_t;
+
 /**
  * Initialise gpio_context, based on board number
  *
@@ -123,6 +180,155 @@ mraa_result_t mraa_gpio_edge_mode(mraa_gpio_context dev, mraa_gpio_edge_t mode);
  */
 mraa_result_t mraa_gpio_isr(mraa_gpio_context dev, mraa_gpio_edge_t edge, void (*fptr)(void*), void* args);
 
+/**
+ * Set the cpu affinity, scheduling and stack size of the interrupt thread
+ * of this Gpio, overriding mraa_set_thread_attr(). Applies to the next
+ * mraa_gpio_isr(), Gpios serviced by the shared dispatcher use the
+ * dispatcher threads instead.
+ *
+ * @param dev The Gpio context
+ * @param attr Thread attributes, NULL to use the library defaults
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_thread_attr(mraa_gpio_context dev, const mraa_thread_attr_t* attr);
+
+/**
+ * Filter the interrupts of a Gpio before they reach the callback. With a
+ * debounce time a burst of edges, like a bouncing contact, results in a
+ * single callback once the line has settled. With a minimum interval
+ * callbacks arriving faster are dropped. Filtering happens in the interrupt
+ * thread or dispatcher, so suppressed edges never wake a language binding.
+ * May be called before or after mraa_gpio_isr(), the event ring of
+ * mraa_gpio_events_enable() is not filtered. Platforms that replace the
+ * interrupt wait have no way to see bounces, there debounce is a hold off.
+ *
+ * @param dev The Gpio context
+ * @param options Filter settings, NULL to remove filtering
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_isr_options(mraa_gpio_context dev, const mraa_gpio_isr_options_t* options);
+
+/**
+ * Record edges on the Gpio into a ring buffer instead of calling back. Where
+ * the Gpio is driven through a gpiochip the timestamps and edge direction come
+ * from the kernel, otherwise they are taken when the interrupt is serviced.
+ * Cannot be combined with mraa_gpio_isr() on the same context.
+ *
+ * @param dev The Gpio context
+ * @param edge The edge mode to set the gpio into
+ * @param queue_size Number of events the ring holds, rounded up to a power
+ * of two, 0 for the default
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_events_enable(mraa_gpio_context dev, mraa_gpio_edge_t edge, unsigned int queue_size);
+
+/**
+ * Drain recorded edges, oldest first. Only one thread may read the events of
+ * a given context.
+ *
+ * @param dev The Gpio context
+ * @param events Array receiving the events
+ * @param max_events Size of the events array
+ * @param timeout_ms How long to wait when no event is queued, 0 to return
+ * immediately, -1 to wait forever
+ * @return Number of events stored in events, -1 on error
+ */
+int mraa_gpio_events_read(mraa_gpio_context dev, mraa_gpio_event_t* events, unsigned int max_events, int timeout_ms);
+
+/**
+ * Get the number of edges lost because the ring was full
+ *
+ * @param dev The Gpio context
+ * @return Dropped event count
+ */
+unsigned int mraa_gpio_events_dropped(mraa_gpio_context dev);
+
+/**
+ * Stop recording edges, set the Gpio edge mode to MRAA_GPIO_EDGE_NONE and
+ * free the ring
+ *
+ * @param dev The Gpio context
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_events_disable(mraa_gpio_context dev);
+
+/**
+ * Count edges of the Gpio in the interrupt path, without any callback. The
+ * time between edges and the length of high and low pulses are tracked as
+ * well, which is enough to measure a tachometer or flow meter. Where the
+ * Gpio is driven through a gpiochip the kernel timestamps are used. Pulse
+ * widths need MRAA_GPIO_EDGE_BOTH and a backend that reports the direction
+ * of an edge. Cannot be combined with mraa_gpio_isr() or
+ * mraa_gpio_events_enable() on the same context.
+ *
+ * @param dev The Gpio context
+ * @param edge Edges to count, periods are measured between edges of the
+ * same direction, rising ones for MRAA_GPIO_EDGE_BOTH
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_counter_enable(mraa_gpio_context dev, mraa_gpio_edge_t edge);
+
+/**
+ * Take a consistent snapshot of the edge counter. May be called from any
+ * thread while edges keep being counted.
+ *
+ * @param dev The Gpio context
+ * @param counter Filled with the snapshot
+ * @param reset 1 to start counting, and averaging the period, from zero
+ * after this snapshot
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_counter_read(mraa_gpio_context dev, mraa_gpio_counter_t* counter, mraa_boolean_t reset);
+
+/**
+ * Mean time between counted edges since the counter was enabled or reset
+ *
+ * @param dev The Gpio context, with the counter enabled
+ * @param period_ns Filled with the period in nanoseconds
+ * @return Result of operation, MRAA_ERROR_UNSPECIFIED until two edges were counted
+ */
+mraa_result_t mraa_gpio_measure_period(mraa_gpio_context dev, uint64_t* period_ns);
+
+/**
+ * Length of the last complete high and low pulses
+ *
+ * @param dev The Gpio context, with the counter enabled on both edges
+ * @param high_ns Filled with the high time in nanoseconds, may be NULL
+ * @param low_ns Filled with the low time in nanoseconds, may be NULL
+ * @return Result of operation, MRAA_ERROR_UNSPECIFIED until a full pulse was seen
+ */
+mraa_result_t mraa_gpio_measure_pulsewidth(mraa_gpio_context dev, uint64_t* high_ns, uint64_t* low_ns);
+
+/**
+ * Stop counting edges, set the Gpio edge mode to MRAA_GPIO_EDGE_NONE and
+ * free the counter
+ *
+ * @param dev The Gpio context
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_counter_disable(mraa_gpio_context dev);
+
+/**
+ * Start the shared interrupt dispatcher. Once started mraa_gpio_isr() no
+ * longer spawns a thread per Gpio, one epoll thread watches every registered
+ * Gpio and hands callbacks to a small pool of worker threads. Callbacks for a
+ * single Gpio never run concurrently, callbacks for different Gpios may.
+ * Gpios whose platform cannot be polled without blocking keep their own
+ * thread.
+ *
+ * @param num_workers Number of callback threads, 0 for the default
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_isr_dispatcher_start(unsigned int num_workers);
+
+/**
+ * Stop the shared interrupt dispatcher. All isrs registered through it must
+ * have been removed with mraa_gpio_isr_exit() first.
+ *
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_isr_dispatcher_stop();
+
 /**
  * Stop the current interrupt watcher on this Gpio, and set the Gpio edge mode
  * to MRAA_GPIO_EDGE_NONE
@@ -220,6 +426,86 @@ int mraa_gpio_get_pin(mraa_gpio_context dev);
  */
 int mraa_gpio_get_pin_raw(mraa_gpio_context dev);
 
+/**
+ * Initialise a group of gpios that are read and written together. Where the
+ * platform allows it all pins on the same gpiochip are handled by a single
+ * line request so a group write or read is one syscall per chip.
+ *
+ * @param pins Pin numbers read from the board, i.e IO3 is 3
+ * @param num_pins Number of pins in the pins array
+ * @return gpio group context or NULL
+ */
+mraa_gpio_group_context mraa_gpio_init_multi(int pins[], int num_pins);
+
+/**
+ * Set the direction of every gpio in the group
+ *
+ * @param group The Gpio group context
+ * @param dir The direction of the Gpios
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_dir_multi(mraa_gpio_group_context group, mraa_gpio_dir_t dir);
+
+/**
+ * Read all gpios of the group
+ *
+ * @param group The Gpio group context
+ * @param output_values Filled with one value per pin, in init order
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_read_multi(mraa_gpio_group_context group, int output_values[]);
+
+/**
+ * Write all gpios of the group
+ *
+ * @param group The Gpio group context
+ * @param input_values One value per pin, in init order
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_write_multi(mraa_gpio_group_context group, int input_values[]);
+
+/**
+ * Enable using memory mapped io for the whole group. Only available when the
+ * platform can access all pins of the group through its register map.
+ *
+ * @param group The Gpio group context
+ * @param mmap Use mmap instead of gpiochip/sysfs
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_use_mmaped_multi(mraa_gpio_group_context group, mraa_boolean_t mmap);
+
+/**
+ * Play a waveform on the group. The steps are written from a dedicated
+ * thread with a realtime priority and locked memory, busy waiting between
+ * steps against CLOCK_MONOTONIC so the timing does not depend on syscalls.
+ * Every member must already be memory mapped, see
+ * mraa_gpio_use_mmaped_multi(), and set as an output. Blocks until the
+ * waveform has been played. Without the privileges for a realtime priority
+ * the waveform is still played, stats tell how well it went.
+ *
+ * @param group The Gpio group context, at most 32 members
+ * @param steps Steps to write, in order
+ * @param num_steps Number of steps
+ * @param repeat Number of times the steps are played, 0 counts as 1
+ * @param cpu Cpu the thread is pinned to, -1 to leave it to the scheduler
+ * @param stats Filled with the achieved timing, may be NULL
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_sequence(mraa_gpio_group_context group,
+                                 const mraa_gpio_seq_step_t* steps,
+                                 unsigned int num_steps,
+                                 unsigned int repeat,
+                                 int cpu,
+                                 mraa_gpio_seq_stats_t* stats);
+
+/**
+ * Close the Gpio group context and every gpio it holds
+ *
+ * @param group The Gpio group context
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_close_multi(mraa_gpio_group_context group);
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,6 +27,7 @@
 #include "gpio.h"
 #include "types.hpp"
 #include <stdexcept>
+#include <vector>
 
 #if defined(SWIGJAVASCRIPT)
 #if NODE_MODULE_VERSION >= 0x000D
@@ -209,6 +210,94 @@ class Gpio
     {
         return (Result) mraa_gpio_isr(m_gpio, (mraa_gpio_edge_t) mode, fptr, args);
     }
+    /**
+     * Sets a callback to be called when pin value changes, with the edges
+     * filtered first, see mraa_gpio_isr_options()
+     *
+     * @param mode The edge mode to set
+     * @param fptr Function pointer to function to be called when interrupt is
+     * triggered
+     * @param args Arguments passed to the interrupt handler (fptr)
+     * @param debounceUs Quiet time required after an edge, 0 for none
+     * @param minIntervalUs Minimum time between two callbacks, 0 for none
+     * @return Result of operation
+     */
+    Result
+    isr(Edge mode, void (*fptr)(void*), void* args, unsigned int debounceUs, unsigned int minIntervalUs = 0)
+    {
+        Result ret = isrOptions(debounceUs, minIntervalUs);
+        if (ret != SUCCESS) {
+            return ret;
+        }
+        return (Result) mraa_gpio_isr(m_gpio, (mraa_gpio_edge_t) mode, fptr, args);
+    }
+    /**
+     * Set the cpu affinity, scheduling and stack size of the interrupt
+     * thread, see mraa_gpio_thread_attr()
+     *
+     * @param attr Thread attributes
+     * @return Result of operation
+     */
+    Result
+    threadAttr(const mraa_thread_attr_t& attr)
+    {
+        return (Result) mraa_gpio_thread_attr(m_gpio, &attr);
+    }
+    /**
+     * Filter interrupts before they reach the callback, applies to every
+     * isr() variant. Takes effect on the next edge.
+     *
+     * @param debounceUs Quiet time required after an edge, 0 for none
+     * @param minIntervalUs Minimum time between two callbacks, 0 for none
+     * @return Result of operation
+     */
+    Result
+    isrOptions(unsigned int debounceUs, unsigned int minIntervalUs = 0)
+    {
+        mraa_gpio_isr_options_t options;
+        options.debounce_us = debounceUs;
+        options.min_interval_us = minIntervalUs;
+        return (Result) mraa_gpio_isr_options(m_gpio, &options);
+    }
+
+    /**
+     * Count edges in the interrupt path without calling back, see
+     * mraa_gpio_counter_enable()
+     *
+     * @param mode Edges to count
+     * @return Result of operation
+     */
+    Result
+    counterEnable(Edge mode)
+    {
+        return (Result) mraa_gpio_counter_enable(m_gpio, (mraa_gpio_edge_t) mode);
+    }
+    /**
+     * Snapshot of the edge counter
+     *
+     * @param reset true to restart counting after the snapshot
+     * @throw std::runtime_error in case of failure
+     * @return Count, periods and pulse widths
+     */
+    mraa_gpio_counter_t
+    counter(bool reset = false)
+    {
+        mraa_gpio_counter_t snapshot;
+        if (mraa_gpio_counter_read(m_gpio, &snapshot, (mraa_boolean_t) reset) != MRAA_SUCCESS) {
+            throw std::runtime_error("Failed to read GPIO counter");
+        }
+        return snapshot;
+    }
+    /**
+     * Stop counting edges
+     *
+     * @return Result of operation
+     */
+    Result
+    counterDisable()
+    {
+        return (Result) mraa_gpio_counter_disable(m_gpio);
+    }
 
     /**
      * Exits callback - this call will not kill the isr thread immediately
@@ -322,4 +411,113 @@ class Gpio
     v8::Persistent<v8::Function> m_v8isr;
 #endif
 };
+
+/**
+ * @brief API to a group of General Purpose IOs driven together
+ *
+ * Useful for parallel buses where every pin changes at once. Pins sharing a
+ * gpiochip or a register bank are read and written in a single operation.
+ */
+class GpioGroup
+{
+  public:
+    /**
+     * Instantiates a GpioGroup object
+     *
+     * @param pins pin numbers to use, values are ordered the same way
+     */
+    GpioGroup(std::vector<int> pins)
+    {
+        if (pins.empty()) {
+            throw std::invalid_argument("No GPIO pins specified");
+        }
+        m_group = mraa_gpio_init_multi(&pins[0], (int) pins.size());
+        if (m_group == NULL) {
+            throw std::invalid_argument("Invalid GPIO pins specified");
+        }
+        m_size = pins.size();
+    }
+    /**
+     * GpioGroup object destructor, closes every gpio of the group
+     */
+    ~GpioGroup()
+    {
+        mraa_gpio_close_multi(m_group);
+    }
+    /**
+     * Change direction of every gpio in the group
+     *
+     * @param dir The direction to change the gpios into
+     * @return Result of operation
+     */
+    Result
+    dir(Dir dir)
+    {
+        return (Result) mraa_gpio_dir_multi(m_group, (mraa_gpio_dir_t) dir);
+    }
+    /**
+     * Read values of the group
+     *
+     * @throw std::runtime_error in case of failure
+     * @return One value per pin, in the order given to the constructor
+     */
+    std::vector<int>
+    read()
+    {
+        std::vector<int> values(m_size);
+        if (mraa_gpio_read_multi(m_group, &values[0]) != MRAA_SUCCESS) {
+            throw std::runtime_error("Failed to read GPIO group");
+        }
+        return values;
+    }
+    /**
+     * Write values to the group
+     *
+     * @param values One value per pin, in the order given to the constructor
+     * @return Result of operation
+     */
+    Result
+    write(std::vector<int> values)
+    {
+        if (values.size() != m_size) {
+            return ERROR_INVALID_PARAMETER;
+        }
+        return (Result) mraa_gpio_write_multi(m_group, &values[0]);
+    }
+    /**
+     * Enable use of mmap i/o for the whole group if available.
+     *
+     * @param enable true to use mmap
+     * @return Result of operation
+     */
+    Result
+    useMmap(bool enable)
+    {
+        return (Result) mraa_gpio_use_mmaped_multi(m_group, (mraa_boolean_t) enable);
+    }
+    /**
+     * Play a waveform on the group from a realtime thread, see
+     * mraa_gpio_sequence(). The group must be memory mapped.
+     *
+     * @param steps Steps to write, bit n of mask and value is pin n
+     * @param repeat Number of times the steps are played
+     * @param cpu Cpu the thread is pinned to, -1 for any
+     * @throw std::runtime_error in case of failure
+     * @return Achieved timing
+     */
+    mraa_gpio_seq_stats_t
+    sequence(const std::vector<mraa_gpio_seq_step_t>& steps, unsigned int repeat = 1, int cpu = -1)
+    {
+        mraa_gpio_seq_stats_t stats;
+        if (steps.empty() ||
+            mraa_gpio_sequence(m_group, &steps[0], (unsigned int) steps.size(), repeat, cpu, &stats) != MRAA_SUCCESS) {
+            throw std::runtime_error("Failed to play GPIO sequence");
+        }
+        return stats;
+    }
+
+  private:
+    mraa_gpio_group_context m_group;
+    size_t m_size;
+};
 }
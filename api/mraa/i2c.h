@@ -30,6 +30,9 @@
  *
  * An i2c context represents a master on an i2c bus and that context can
  * communicate to multiple i2c slaves by configuring the address.
+ * Contexts on the same bus share one /dev/i2c-* handle but each keeps its
+ * own slave address, so threads may use separate contexts on one bus
+ * without locking around them.
  * @htmlinclude i2c.txt
  *
  * @snippet i2c_HMC5883L.c Interesting
@@ -52,6 +55,84 @@ extern "C" {
  */
 typedef struct _i2c* mraa_i2c_context;
 
+/**
+ * Opaque pointer definition to the internal struct _i2c_transaction
+ */
+typedef struct _i2c_transaction* mraa_i2c_transaction;
+
+/**
+ * Opaque pointer definition to the internal struct _i2c_regmap
+ */
+typedef struct _i2c_regmap* mraa_i2c_regmap;
+
+/**
+ * Completion callback of a queued i2c job. Callbacks run on the worker
+ * thread of the bus, one at a time, and hold up every other job of the
+ * bus while they run. A callback may queue more jobs and may stop its
+ * context, which drops the jobs still queued for it without calling their
+ * callbacks. mraa_i2c_async_wait() called from a callback fails rather than
+ * wait for jobs that cannot run before it returns.
+ *
+ * @param dev The i2c context the job was queued on
+ * @param result Result of the job
+ * @param args The args given when queueing
+ */
+typedef void (*mraa_i2c_async_cb)(mraa_i2c_context dev, mraa_result_t result, void* args);
+
+/**
+ * Most messages a transaction can hold, the limit of one I2C_RDWR ioctl
+ */
+#define MRAA_I2C_TRANSACTION_MAX_MSGS 42
+
+/**
+ * Longest message a transaction accepts, in bytes
+ */
+#define MRAA_I2C_TRANSACTION_MAX_LENGTH 8192
+
+/**
+ * Addresses mraa_i2c_scan() probes, 0x08 to 0x77
+ */
+#define MRAA_I2C_SCAN_MAX_ADDRESSES 112
+
+/**
+ * Errors a retry policy may retry, as reported by the adapter
+ */
+typedef enum {
+    MRAA_I2C_RETRY_EAGAIN = 0x01,    /**< arbitration lost or adapter busy */
+    MRAA_I2C_RETRY_EREMOTEIO = 0x02, /**< no acknowledge from the slave */
+    MRAA_I2C_RETRY_ENXIO = 0x04,     /**< no acknowledge of the address, on some adapters */
+    MRAA_I2C_RETRY_ETIMEDOUT = 0x08, /**< transfer timed out, often a slave holding SDA low */
+    MRAA_I2C_RETRY_EIO = 0x10        /**< unspecified bus error */
+} mraa_i2c_retry_errors_t;
+
+/**
+ * How a context retries failed calls. A call is tried up to 1 + retries
+ * times, sleeping backoff_us before the first retry and twice as long
+ * before each following one. Only errors in retry_on are retried, others
+ * fail at once, and so do calls rejected before reaching the bus. Writes are retried whole, a slave that took part of a
+ * failed write sees the start of it twice.
+ */
+typedef struct {
+    /*@{*/
+    unsigned int retries; /**< attempts after the first one, 0 disables retrying */
+    unsigned int backoff_us; /**< delay before the first retry in microseconds */
+    unsigned int max_backoff_us; /**< longest delay between attempts, 0 for no limit */
+    int retry_on; /**< mraa_i2c_retry_errors_t to retry, ORed together */
+    int recover_on; /**< mraa_i2c_retry_errors_t after which the bus is recovered before retrying */
+    /*@}*/
+} mraa_i2c_retry_policy_t;
+
+/**
+ * Retry counters of a context
+ */
+typedef struct {
+    /*@{*/
+    uint64_t retries; /**< attempts made after a failure */
+    uint64_t recoveries; /**< bus recoveries run before a retry */
+    uint64_t exhausted; /**< calls that still failed after every retry */
+    /*@}*/
+} mraa_i2c_retry_stats_t;
+
 /**
  * Initialise i2c context, using board defintions
  *
@@ -126,7 +207,9 @@ int mraa_i2c_read_bytes_data(mraa_i2c_context dev, uint8_t command, uint8_t* dat
 
 /**
  * Write length bytes to the bus, the first byte in the array is the
- * command/register to write
+ * command/register to write. The buffer goes out in a single write of any
+ * length, up to MRAA_I2C_TRANSACTION_MAX_LENGTH bytes if the adapter cannot
+ * continue a message. On SMBus only adapters at most 33 bytes are sent.
  *
  * @param dev The i2c context
  * @param data pointer to the byte array to be written
@@ -165,7 +248,8 @@ mraa_result_t mraa_i2c_write_byte_data(mraa_i2c_context dev, const uint8_t data,
 mraa_result_t mraa_i2c_write_word_data(mraa_i2c_context dev, const uint16_t data, const uint8_t command);
 
 /**
- * Sets the i2c slave address.
+ * Sets the i2c slave address. It only applies to this context, other
+ * contexts on the bus keep theirs.
  *
  * @param dev The i2c context
  * @param address The address to set for the slave (7-bit address)
@@ -181,6 +265,312 @@ mraa_result_t mraa_i2c_address(mraa_i2c_context dev, uint8_t address);
  */
 mraa_result_t mraa_i2c_stop(mraa_i2c_context dev);
 
+/**
+ * Create an empty transaction on the bus of an i2c context. Messages queued
+ * on it go out in a single transfer: each starts with a repeated start,
+ * only the last one is followed by a stop and the bus is not released in
+ * between. The transaction must be stopped before its i2c context.
+ *
+ * @param dev The i2c context
+ * @return transaction or NULL
+ */
+mraa_i2c_transaction mraa_i2c_transaction_init(mraa_i2c_context dev);
+
+/**
+ * Queue a write message. The data is copied, the buffer can be reused as
+ * soon as the call returns.
+ *
+ * @param trans The transaction
+ * @param address The slave to write to (7-bit address)
+ * @param data The bytes to write
+ * @param length The number of bytes to write, at most MRAA_I2C_TRANSACTION_MAX_LENGTH
+ * @return Result of operation
+ */
+mraa_result_t mraa_i2c_transaction_write(mraa_i2c_transaction trans, uint8_t address, const uint8_t* data, int length);
+
+/**
+ * Queue a read message. The data is stored when the transaction is
+ * submitted, the buffer must stay valid until then.
+ *
+ * @param trans The transaction
+ * @param address The slave to read from (7-bit address)
+ * @param data pointer to the byte array to read data in to
+ * @param length The number of bytes to read, at most MRAA_I2C_TRANSACTION_MAX_LENGTH
+ * @return Result of operation
+ */
+mraa_result_t mraa_i2c_transaction_read(mraa_i2c_transaction trans, uint8_t address, uint8_t* data, int length);
+
+/**
+ * Send the queued messages in one transfer. The messages stay queued so the
+ * same transaction can be submitted again.
+ *
+ * @param trans The transaction
+ * @return Result of operation, MRAA_ERROR_FEATURE_NOT_SUPPORTED when the bus
+ * only speaks SMBus
+ */
+mraa_result_t mraa_i2c_transaction_submit(mraa_i2c_transaction trans);
+
+/**
+ * Number of messages queued on a transaction
+ *
+ * @param trans The transaction
+ * @return number of messages or -1 if trans is invalid
+ */
+int mraa_i2c_transaction_count(mraa_i2c_transaction trans);
+
+/**
+ * Drop every queued message
+ *
+ * @param trans The transaction
+ * @return Result of operation
+ */
+mraa_result_t mraa_i2c_transaction_clear(mraa_i2c_transaction trans);
+
+/**
+ * Free a transaction
+ *
+ * @param trans The transaction
+ * @return Result of operation
+ */
+mraa_result_t mraa_i2c_transaction_stop(mraa_i2c_transaction trans);
+
+/**
+ * Create a register cache for the byte wide registers of a slave. Reads of
+ * a register go to the device once and are then served from the cache,
+ * writes go to both. Registers the device changes by itself, such as status
+ * or data registers, must be marked volatile. The map selects its address
+ * before every transfer so the i2c context can be shared, but neither may
+ * be used from several threads at once. It must be stopped before its i2c
+ * context.
+ *
+ * @param dev The i2c context
+ * @param address The slave (7-bit address)
+ * @return register map or NULL
+ */
+mraa_i2c_regmap mraa_i2c_regmap_init(mraa_i2c_context dev, uint8_t address);
+
+/**
+ * Mark a register volatile, so it is always read from the device, or
+ * cacheable again. A write held for the register is sent first.
+ *
+ * @param map The register map
+ * @param reg The register
+ * @param is_volatile 1 for volatile, 0 for cacheable
+ * @return Result of operation
+ */
+mraa_result_t mraa_i2c_regmap_set_volatile(mraa_i2c_regmap map, uint8_t reg, mraa_boolean_t is_volatile);
+
+/**
+ * Hold writes to cacheable registers in the cache until
+ * mraa_i2c_regmap_sync(), several writes to one register then cost a single
+ * transfer. Turning it off syncs.
+ *
+ * @param map The register map
+ * @param enable 1 to hold writes, 0 to write through
+ * @return Result of operation
+ */
+mraa_result_t mraa_i2c_regmap_set_writeback(mraa_i2c_regmap map, mraa_boolean_t enable);
+
+/**
+ * Read a register, from the cache when it holds the value
+ *
+ * @param map The register map
+ * @param reg The register
+ * @return The value of the register or -1 if failed
+ */
+int mraa_i2c_regmap_read(mraa_i2c_regmap map, uint8_t reg);
+
+/**
+ * Write a register
+ *
+ * @param map The register map
+ * @param reg The register
+ * @param value The byte to write
+ * @return Result of operation
+ */
+mraa_result_t mraa_i2c_regmap_write(mraa_i2c_regmap map, uint8_t reg, uint8_t value);
+
+/**
+ * Read-modify-write of the bits of a register set in mask. The old value
+ * comes from the cache when it holds it and nothing is written when the
+ * bits already have the requested value.
+ *
+ * @param map The register map
+ * @param reg The register
+ * @param mask The bits to change
+ * @param value The new value of those bits
+ * @return Result of operation
+ */
+mraa_result_t mraa_i2c_regmap_update_bits(mraa_i2c_regmap map, uint8_t reg, uint8_t mask, uint8_t value);
+
+/**
+ * Send every write held in the cache, in register order
+ *
+ * @param map The register map
+ * @return Result of operation, registers that failed stay held
+ */
+mraa_result_t mraa_i2c_regmap_sync(mraa_i2c_regmap map);
+
+/**
+ * Forget every cached value, for instance after the slave was reset. Held
+ * writes are dropped.
+ *
+ * @param map The register map
+ * @return Result of operation
+ */
+mraa_result_t mraa_i2c_regmap_invalidate(mraa_i2c_regmap map);
+
+/**
+ * Sync held writes and free a register map
+ *
+ * @param map The register map
+ * @return Result of the sync
+ */
+mraa_result_t mraa_i2c_regmap_stop(mraa_i2c_regmap map);
+
+/**
+ * Queue a read of length bytes starting from a register on the worker of
+ * the bus and return at once. Each bus has one worker, running jobs by
+ * priority and in queueing order within a priority, so separate buses
+ * proceed in parallel. The address of the context must not change while it
+ * has jobs queued.
+ *
+ * @param dev The i2c context
+ * @param command The register
+ * @param data Buffer to read into, must stay valid until the callback
+ * @param length The number of bytes to read
+ * @param priority Priority class of the job
+ * @param cb Called once the read is done, may be NULL
+ * @param args Passed to cb
+ * @return Result of queueing
+ */
+mraa_result_t mraa_i2c_async_read_bytes_data(mraa_i2c_context dev,
+                                             uint8_t command,
+                                             uint8_t* data,
+                                             int length,
+                                             mraa_i2c_priority_t priority,
+                                             mraa_i2c_async_cb cb,
+                                             void* args);
+
+/**
+ * Queue a mraa_i2c_write() on the worker of the bus, the data is copied
+ *
+ * @param dev The i2c context
+ * @param data The bytes to write, the first one is the register
+ * @param length The number of bytes to write
+ * @param priority Priority class of the job
+ * @param cb Called once the write is done, may be NULL
+ * @param args Passed to cb
+ * @return Result of queueing
+ */
+mraa_result_t mraa_i2c_async_write(mraa_i2c_context dev,
+                                   const uint8_t* data,
+                                   int length,
+                                   mraa_i2c_priority_t priority,
+                                   mraa_i2c_async_cb cb,
+                                   void* args);
+
+/**
+ * Queue the submission of a transaction on the worker of its bus. The
+ * transaction must not be changed or stopped until the callback.
+ *
+ * @param trans The transaction
+ * @param priority Priority class of the job
+ * @param cb Called once the transaction is done, may be NULL
+ * @param args Passed to cb
+ * @return Result of queueing
+ */
+mraa_result_t
+mraa_i2c_async_transaction(mraa_i2c_transaction trans, mraa_i2c_priority_t priority, mraa_i2c_async_cb cb, void* args);
+
+/**
+ * Wait until every job queued on an i2c context ran and its callback
+ * returned. mraa_i2c_stop() does this too. From a callback on the worker
+ * of the bus it returns MRAA_ERROR_INVALID_RESOURCE if other jobs of the
+ * context are still queued.
+ *
+ * @param dev The i2c context
+ * @return Result of operation
+ */
+mraa_result_t mraa_i2c_async_wait(mraa_i2c_context dev);
+
+/**
+ * Check whether a slave answers on the bus of a context without changing
+ * the address of the context. The probe follows i2cdetect: a read of one
+ * byte at 0x30-0x37 and 0x50-0x5f, where a quick write could change the
+ * state of eeproms, and a quick write elsewhere. Either falls back to the
+ * other when the adapter lacks it. Slaves claimed by a kernel driver are
+ * reported present without a transfer, i2cdetect shows them as "UU".
+ *
+ * @param dev An i2c context on the bus to probe
+ * @param address The slave (7-bit address)
+ * @return 1 if the slave acknowledged, 0 otherwise
+ */
+mraa_boolean_t mraa_i2c_probe(mraa_i2c_context dev, uint8_t address);
+
+/**
+ * List the slaves answering on a bus, probing every address from 0x08 to
+ * 0x77 with mraa_i2c_probe(). The result is cached per bus, later scans
+ * return it without touching the bus until mraa_i2c_scan_invalidate().
+ *
+ * @param bus The bus, as passed to mraa_i2c_init()
+ * @param addresses Receives the addresses found in ascending order
+ * @param max_addresses Room in addresses, MRAA_I2C_SCAN_MAX_ADDRESSES is always enough
+ * @return number of addresses stored or -1 if the bus could not be opened
+ */
+int mraa_i2c_scan(int bus, uint8_t* addresses, int max_addresses);
+
+/**
+ * Scan several buses at once, one thread per bus, filling the cache read
+ * by mraa_i2c_scan(). Buses already cached are not scanned again.
+ *
+ * @param buses The buses, as passed to mraa_i2c_init()
+ * @param nbuses Number of buses
+ * @return Result of operation, the first error if a bus could not be opened
+ */
+mraa_result_t mraa_i2c_scan_buses(const int* buses, int nbuses);
+
+/**
+ * Drop the cached scan of a bus, for instance after a slave was powered or
+ * plugged in
+ *
+ * @param bus The bus, as passed to mraa_i2c_init(), or -1 for every bus
+ */
+void mraa_i2c_scan_invalidate(int bus);
+
+/**
+ * Set how a context retries failed reads, writes and transactions. A new
+ * context does not retry.
+ *
+ * @param dev The i2c context
+ * @param policy The policy, copied, or NULL to stop retrying
+ * @return Result of operation
+ */
+mraa_result_t mraa_i2c_set_retry_policy(mraa_i2c_context dev, const mraa_i2c_retry_policy_t* policy);
+
+/**
+ * Snapshot the retry counters of a context
+ *
+ * @param dev The i2c context
+ * @param stats Filled with the counters
+ * @param reset Also zero the counters of the context
+ * @return Result of operation
+ */
+mraa_result_t mraa_i2c_retry_stats(mraa_i2c_context dev, mraa_i2c_retry_stats_t* stats, mraa_boolean_t reset);
+
+/**
+ * Free a bus a slave holds by keeping SDA low: SCL is driven as a gpio
+ * through the pin mux and clocked up to 9 times until SDA is released,
+ * then a STOP condition is sent and the pins are muxed back to i2c. Other
+ * contexts on the bus fail their transfers while this runs. Only contexts
+ * from mraa_i2c_init() on a board exposing its SCL and SDA pins as gpios
+ * can be recovered.
+ *
+ * @param dev The i2c context
+ * @return Result of operation, MRAA_ERROR_UNSPECIFIED if SDA stays low
+ */
+mraa_result_t mraa_i2c_recover(mraa_i2c_context dev);
+
 #ifdef __cplusplus
 }
 #endif
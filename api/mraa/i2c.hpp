@@ -27,6 +27,10 @@
 #include "i2c.h"
 #include "types.hpp"
 #include <stdexcept>
+#include <vector>
+#if !defined(SWIG) && __cplusplus >= 201103L
+#include <future>
+#endif
 
 namespace mraa
 {
@@ -112,6 +116,87 @@ class I2c
         return (Result) mraa_i2c_address(m_i2c, address);
     }
 
+    /**
+     * Check whether a slave answers, the address of the object is kept
+     *
+     * @param address The slave (7-bit address)
+     * @return true if the slave acknowledged
+     */
+    bool
+    probe(uint8_t address)
+    {
+        return mraa_i2c_probe(m_i2c, address) == 1;
+    }
+
+    /**
+     * List the slaves answering on a bus, the result is cached until
+     * scanInvalidate()
+     *
+     * @param bus The bus, as passed to the constructor
+     * @throws std::invalid_argument if the bus cannot be opened
+     * @return addresses found in ascending order
+     */
+    static std::vector<uint8_t>
+    scan(int bus)
+    {
+        std::vector<uint8_t> found(MRAA_I2C_SCAN_MAX_ADDRESSES);
+        int n = mraa_i2c_scan(bus, &found[0], MRAA_I2C_SCAN_MAX_ADDRESSES);
+        if (n < 0) {
+            throw std::invalid_argument("Invalid i2c bus");
+        }
+        found.resize(n);
+        return found;
+    }
+
+    /**
+     * Drop the cached scan of a bus
+     *
+     * @param bus The bus, or -1 for every bus
+     */
+    static void
+    scanInvalidate(int bus = -1)
+    {
+        mraa_i2c_scan_invalidate(bus);
+    }
+
+    /**
+     * Retry failed calls, sleeping backoffUs before the first retry and
+     * twice as long before each following one
+     *
+     * @param retries Attempts after the first one, 0 stops retrying
+     * @param backoffUs Delay before the first retry in microseconds
+     * @param maxBackoffUs Longest delay between attempts, 0 for no limit
+     * @param retryOn mraa_i2c_retry_errors_t to retry, ORed together
+     * @param recoverOn mraa_i2c_retry_errors_t after which the bus is recovered first
+     * @return Result of operation
+     */
+    Result
+    setRetryPolicy(unsigned int retries,
+                   unsigned int backoffUs,
+                   unsigned int maxBackoffUs = 0,
+                   int retryOn = MRAA_I2C_RETRY_EAGAIN | MRAA_I2C_RETRY_EREMOTEIO | MRAA_I2C_RETRY_ETIMEDOUT,
+                   int recoverOn = 0)
+    {
+        mraa_i2c_retry_policy_t policy;
+        policy.retries = retries;
+        policy.backoff_us = backoffUs;
+        policy.max_backoff_us = maxBackoffUs;
+        policy.retry_on = retryOn;
+        policy.recover_on = recoverOn;
+        return (Result) mraa_i2c_set_retry_policy(m_i2c, &policy);
+    }
+
+    /**
+     * Free a bus held low by a slave, see mraa_i2c_recover()
+     *
+     * @return Result of operation
+     */
+    Result
+    recover()
+    {
+        return (Result) mraa_i2c_recover(m_i2c);
+    }
+
     /**
      * Read exactly one byte from the bus
      *
@@ -244,7 +329,369 @@ class I2c
         return (Result) mraa_i2c_write_word_data(m_i2c, data, reg);
     }
 
+#if !defined(SWIG) && __cplusplus >= 201103L
+    /**
+     * Queue a read of length bytes starting from an i2c register on the
+     * worker of the bus
+     *
+     * @param reg Register to read from
+     * @param data Buffer to read into, must stay valid until the future is ready
+     * @param length Size of read in bytes to make
+     * @param priority Priority class of the read
+     * @return future of the Result of the read
+     */
+    std::future<Result>
+    readBytesRegAsync(uint8_t reg, uint8_t* data, int length, I2cPriority priority = I2C_PRIORITY_NORMAL)
+    {
+        std::promise<Result>* done = new std::promise<Result>();
+        std::future<Result> result = done->get_future();
+        mraa_result_t ret = mraa_i2c_async_read_bytes_data(m_i2c, reg, data, length,
+                                                           (mraa_i2c_priority_t) priority, &I2c::asyncDone, done);
+        if (ret != MRAA_SUCCESS) {
+            asyncDone(m_i2c, ret, done);
+        }
+        return result;
+    }
+
+    /**
+     * Queue a write on the worker of the bus, the data is copied
+     *
+     * @param data Buffer to send on the bus, first byte is i2c command
+     * @param length Size of buffer to send
+     * @param priority Priority class of the write
+     * @return future of the Result of the write
+     */
+    std::future<Result>
+    writeAsync(const uint8_t* data, int length, I2cPriority priority = I2C_PRIORITY_NORMAL)
+    {
+        std::promise<Result>* done = new std::promise<Result>();
+        std::future<Result> result = done->get_future();
+        mraa_result_t ret =
+        mraa_i2c_async_write(m_i2c, data, length, (mraa_i2c_priority_t) priority, &I2c::asyncDone, done);
+        if (ret != MRAA_SUCCESS) {
+            asyncDone(m_i2c, ret, done);
+        }
+        return result;
+    }
+#endif
+
+    /**
+     * Wait for every job queued on this object
+     *
+     * @return Result of operation
+     */
+    Result
+    asyncWait()
+    {
+        return (Result) mraa_i2c_async_wait(m_i2c);
+    }
+
   private:
     mraa_i2c_context m_i2c;
+#if !defined(SWIG) && __cplusplus >= 201103L
+    static void
+    asyncDone(mraa_i2c_context dev, mraa_result_t result, void* args)
+    {
+        std::promise<Result>* done = static_cast<std::promise<Result>*>(args);
+        done->set_value((Result) result);
+        delete done;
+    }
+#endif
+    friend class I2cTransaction;
+    friend class I2cRegmap;
+};
+
+/**
+ * @brief Builder for batched i2c transfers
+ *
+ * Queues reads and writes, to any slave on the bus of an I2c object, and
+ * sends them in a single transfer joined by repeated starts. Calls chain:
+ *
+ * @code
+ * mraa::I2cTransaction t(i2c);
+ * t.readBytesReg(0x1e, 0x03, mag, 6).readBytesReg(0x53, 0x32, acc, 6).submit();
+ * @endcode
+ */
+class I2cTransaction
+{
+  public:
+    /**
+     * Creates an empty transaction, it must not outlive the I2c object
+     *
+     * @param i2c The bus to send the messages on
+     */
+    I2cTransaction(I2c& i2c)
+    {
+        m_trans = mraa_i2c_transaction_init(i2c.m_i2c);
+        if (m_trans == NULL) {
+            throw std::invalid_argument("Invalid i2c transaction");
+        }
+    }
+
+    /**
+     * Frees the transaction, the messages not submitted are lost
+     */
+    ~I2cTransaction()
+    {
+        mraa_i2c_transaction_stop(m_trans);
+    }
+
+    /**
+     * Queue a write, the data is copied
+     *
+     * @param address The slave to write to
+     * @param data Buffer to send
+     * @param length Size of buffer to send
+     * @throws std::invalid_argument if the message does not fit
+     * @return this transaction
+     */
+    I2cTransaction&
+    write(uint8_t address, const uint8_t* data, int length)
+    {
+        if (mraa_i2c_transaction_write(m_trans, address, data, length) != MRAA_SUCCESS) {
+            throw std::invalid_argument("Failed to queue write in I2cTransaction::write()");
+        }
+        return *this;
+    }
+
+    /**
+     * Queue a write of a byte to a register
+     *
+     * @param address The slave to write to
+     * @param reg Register to write to
+     * @param data Value to write to register
+     * @throws std::invalid_argument if the message does not fit
+     * @return this transaction
+     */
+    I2cTransaction&
+    writeReg(uint8_t address, uint8_t reg, uint8_t data)
+    {
+        uint8_t buf[2] = { reg, data };
+        return write(address, buf, 2);
+    }
+
+    /**
+     * Queue a read, data is filled in by submit()
+     *
+     * @param address The slave to read from
+     * @param data Buffer to read into, must stay valid until submit()
+     * @param length Size of read in bytes to make
+     * @throws std::invalid_argument if the message does not fit
+     * @return this transaction
+     */
+    I2cTransaction&
+    read(uint8_t address, uint8_t* data, int length)
+    {
+        if (mraa_i2c_transaction_read(m_trans, address, data, length) != MRAA_SUCCESS) {
+            throw std::invalid_argument("Failed to queue read in I2cTransaction::read()");
+        }
+        return *this;
+    }
+
+    /**
+     * Queue a read starting from a register, the register is written and
+     * read back after a repeated start
+     *
+     * @param address The slave to read from
+     * @param reg Register to read from
+     * @param data Buffer to read into, must stay valid until submit()
+     * @param length Size of read in bytes to make
+     * @throws std::invalid_argument if the messages do not fit
+     * @return this transaction
+     */
+    I2cTransaction&
+    readBytesReg(uint8_t address, uint8_t reg, uint8_t* data, int length)
+    {
+        return write(address, &reg, 1).read(address, data, length);
+    }
+
+    /**
+     * Send the queued messages in one transfer, they stay queued
+     *
+     * @return Result of operation
+     */
+    Result
+    submit()
+    {
+        return (Result) mraa_i2c_transaction_submit(m_trans);
+    }
+
+#if !defined(SWIG) && __cplusplus >= 201103L
+    /**
+     * Queue the transaction on the worker of the bus, it must not be
+     * changed or destroyed until the future is ready
+     *
+     * @param priority Priority class of the transfer
+     * @return future of the Result of the transfer
+     */
+    std::future<Result>
+    submitAsync(I2cPriority priority = I2C_PRIORITY_NORMAL)
+    {
+        std::promise<Result>* done = new std::promise<Result>();
+        std::future<Result> result = done->get_future();
+        mraa_result_t ret = mraa_i2c_async_transaction(m_trans, (mraa_i2c_priority_t) priority, &I2c::asyncDone, done);
+        if (ret != MRAA_SUCCESS) {
+            I2c::asyncDone(NULL, ret, done);
+        }
+        return result;
+    }
+#endif
+
+    /**
+     * Number of messages queued
+     *
+     * @return number of messages
+     */
+    int
+    count()
+    {
+        return mraa_i2c_transaction_count(m_trans);
+    }
+
+    /**
+     * Drop every queued message
+     *
+     * @return this transaction
+     */
+    I2cTransaction&
+    clear()
+    {
+        mraa_i2c_transaction_clear(m_trans);
+        return *this;
+    }
+
+  private:
+    mraa_i2c_transaction m_trans;
+    I2cTransaction(const I2cTransaction&);
+    I2cTransaction& operator=(const I2cTransaction&);
+};
+
+/**
+ * @brief Register cache of an i2c slave
+ *
+ * Serves reads of byte wide registers from a cache and can hold writes
+ * until sync(). Registers the slave changes by itself must be marked
+ * volatile.
+ */
+class I2cRegmap
+{
+  public:
+    /**
+     * Creates an empty cache, it must not outlive the I2c object
+     *
+     * @param i2c The bus the slave is on
+     * @param address The slave
+     */
+    I2cRegmap(I2c& i2c, uint8_t address)
+    {
+        m_map = mraa_i2c_regmap_init(i2c.m_i2c, address);
+        if (m_map == NULL) {
+            throw std::invalid_argument("Invalid i2c register map");
+        }
+    }
+
+    /**
+     * Sends held writes and frees the cache
+     */
+    ~I2cRegmap()
+    {
+        mraa_i2c_regmap_stop(m_map);
+    }
+
+    /**
+     * Mark a register volatile or cacheable
+     *
+     * @param reg The register
+     * @param isVolatile true to always read it from the slave
+     * @return Result of operation
+     */
+    Result
+    setVolatile(uint8_t reg, bool isVolatile = true)
+    {
+        return (Result) mraa_i2c_regmap_set_volatile(m_map, reg, isVolatile);
+    }
+
+    /**
+     * Hold writes until sync() or write through
+     *
+     * @param enable true to hold writes
+     * @return Result of operation
+     */
+    Result
+    setWriteback(bool enable)
+    {
+        return (Result) mraa_i2c_regmap_set_writeback(m_map, enable);
+    }
+
+    /**
+     * Read a register
+     *
+     * @param reg The register
+     * @throws std::invalid_argument in case of error
+     * @return value of the register
+     */
+    uint8_t
+    readReg(uint8_t reg)
+    {
+        int x = mraa_i2c_regmap_read(m_map, reg);
+        if (x == -1) {
+            throw std::invalid_argument("Unknown error in I2cRegmap::readReg()");
+        }
+        return (uint8_t) x;
+    }
+
+    /**
+     * Write a register
+     *
+     * @param reg The register
+     * @param data Value to write
+     * @return Result of operation
+     */
+    Result
+    writeReg(uint8_t reg, uint8_t data)
+    {
+        return (Result) mraa_i2c_regmap_write(m_map, reg, data);
+    }
+
+    /**
+     * Change the bits of a register set in mask
+     *
+     * @param reg The register
+     * @param mask The bits to change
+     * @param data The new value of those bits
+     * @return Result of operation
+     */
+    Result
+    updateBits(uint8_t reg, uint8_t mask, uint8_t data)
+    {
+        return (Result) mraa_i2c_regmap_update_bits(m_map, reg, mask, data);
+    }
+
+    /**
+     * Send held writes
+     *
+     * @return Result of operation
+     */
+    Result
+    sync()
+    {
+        return (Result) mraa_i2c_regmap_sync(m_map);
+    }
+
+    /**
+     * Forget cached values and held writes
+     *
+     * @return Result of operation
+     */
+    Result
+    invalidate()
+    {
+        return (Result) mraa_i2c_regmap_invalidate(m_map);
+    }
+
+  private:
+    mraa_i2c_regmap m_map;
+    I2cRegmap(const I2cRegmap&);
+    I2cRegmap& operator=(const I2cRegmap&);
 };
 }
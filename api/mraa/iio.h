@@ -81,6 +81,17 @@ mraa_iio_context mraa_iio_init(int device);
 
 mraa_result_t mraa_iio_trigger_buffer(mraa_iio_context dev, void (*fptr)(char* data), void* args);
 
+/**
+ * Set the cpu affinity, scheduling and stack size of the trigger and event
+ * threads of this context, overriding mraa_set_thread_attr(). Applies to
+ * threads started afterwards.
+ *
+ * @param dev The iio context
+ * @param attr Thread attributes, NULL to use the library defaults
+ * @return Result of operation
+ */
+mraa_result_t mraa_iio_thread_attr(mraa_iio_context dev, const mraa_thread_attr_t* attr);
+
 const char* mraa_iio_get_device_name(mraa_iio_context dev);
 
 int mraa_iio_get_device_num_by_name(const char* name);
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+/**
+ * @file
+ * @brief Periodic sampling
+ *
+ * A sampler job reads a block of registers from an i2c slave, or makes a
+ * spi transfer, at a fixed period and keeps the results with their
+ * timestamps in a ring the application drains at its own pace. Jobs on one
+ * bus are run by a single thread woken by a timerfd at absolute deadlines,
+ * so the period does not drift, and i2c jobs due at the same time are sent
+ * in one transfer. Deadlines are aligned to multiples of the period, jobs
+ * whose periods are multiples of each other therefore share ticks. The
+ * threads honour mraa_set_thread_attr(), a realtime policy bounds the
+ * jitter under load.
+ *
+ * Jobs must be removed before the context they sample is stopped.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "common.h"
+#include "i2c.h"
+#include "spi.h"
+
+/**
+ * Opaque pointer definition to the internal struct _sampler_job
+ */
+typedef struct _sampler_job* mraa_sampler_job;
+
+/**
+ * Counters of a sampler job
+ */
+typedef struct {
+    /*@{*/
+    uint64_t samples; /**< samples taken */
+    uint64_t errors; /**< transfers that failed, no sample is stored for them */
+    uint64_t overruns; /**< samples overwritten before they were read */
+    uint64_t missed; /**< periods skipped because the thread ran late */
+    uint64_t max_late_ns; /**< longest delay between a deadline and its transfer */
+    /*@}*/
+} mraa_sampler_status_t;
+
+/**
+ * Sample length bytes starting at register reg of an i2c slave every
+ * period_us microseconds
+ *
+ * @param dev An i2c context on the bus of the slave, its own address is not used
+ * @param address The slave (7-bit address)
+ * @param reg The first register
+ * @param length Bytes to read, at most MRAA_I2C_TRANSACTION_MAX_LENGTH
+ * @param period_us Sampling period in microseconds
+ * @param depth Samples kept until read, the oldest ones are overwritten
+ * @return sampler job or NULL
+ */
+mraa_sampler_job mraa_sampler_add_i2c(mraa_i2c_context dev,
+                                      uint8_t address,
+                                      uint8_t reg,
+                                      int length,
+                                      unsigned int period_us,
+                                      unsigned int depth);
+
+/**
+ * Make a spi transfer every period_us microseconds and sample what comes
+ * back
+ *
+ * @param dev The spi context
+ * @param tx Bytes to send, copied
+ * @param length Bytes to transfer
+ * @param period_us Sampling period in microseconds
+ * @param depth Samples kept until read, the oldest ones are overwritten
+ * @return sampler job or NULL
+ */
+mraa_sampler_job mraa_sampler_add_spi(mraa_spi_context dev,
+                                      const uint8_t* tx,
+                                      int length,
+                                      unsigned int period_us,
+                                      unsigned int depth);
+
+/**
+ * Take the oldest samples out of the ring of a job
+ *
+ * @param job The sampler job
+ * @param data Receives the samples back to back, length bytes each
+ * @param timestamps Receives the CLOCK_MONOTONIC time of each transfer in nanoseconds, may be NULL
+ * @param max_samples Room in data and timestamps, in samples
+ * @return samples taken out or -1 if job is invalid
+ */
+int mraa_sampler_read(mraa_sampler_job job, uint8_t* data, uint64_t* timestamps, int max_samples);
+
+/**
+ * Snapshot the counters of a job
+ *
+ * @param job The sampler job
+ * @param status Filled with the counters
+ * @return Result of operation
+ */
+mraa_result_t mraa_sampler_status(mraa_sampler_job job, mraa_sampler_status_t* status);
+
+/**
+ * Stop sampling and free the job, samples not read are lost
+ *
+ * @param job The sampler job
+ * @return Result of operation
+ */
+mraa_result_t mraa_sampler_remove(mraa_sampler_job job);
+
+#ifdef __cplusplus
+}
+#endif
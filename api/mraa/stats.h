@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+/**
+ * @file
+ * @brief Operation statistics
+ *
+ * When libmraa is built with -DSTATS=ON every gpio, i2c, spi, uart, aio and
+ * pwm context counts its operations, the bytes they moved, failures and
+ * files reopened on the way, and keeps a histogram of call latencies. The
+ * counters are updated without locks so a snapshot taken while another
+ * thread uses the context may be off by the calls in flight. In the default
+ * build the counters do not exist and every call here returns
+ * MRAA_ERROR_FEATURE_NOT_IMPLEMENTED.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include "common.h"
+#include "gpio.h"
+#include "i2c.h"
+#include "spi.h"
+#include "uart.h"
+#include "aio.h"
+#include "pwm.h"
+
+/**
+ * Number of latency buckets. Bucket n counts calls that took from 2^n up to
+ * 2^(n+1) nanoseconds, bucket 0 also counts faster ones and the last bucket
+ * every call slower than about 2 seconds.
+ */
+#define MRAA_STATS_BUCKETS 32
+
+/**
+ * Counters of one context
+ */
+typedef struct {
+    /*@{*/
+    uint64_t ops; /**< calls made on the context */
+    uint64_t bytes; /**< bytes moved by those calls */
+    uint64_t errors; /**< calls that failed */
+    uint64_t reopens; /**< device or sysfs files opened while serving a call */
+    uint64_t total_ns; /**< time spent in the calls */
+    uint64_t max_ns; /**< slowest call */
+    uint64_t histogram[MRAA_STATS_BUCKETS]; /**< calls by latency */
+    /*@}*/
+} mraa_stats_t;
+
+/**
+ * Check whether this build of libmraa keeps statistics
+ *
+ * @return 1 when the counters are compiled in, 0 otherwise
+ */
+mraa_boolean_t mraa_stats_enabled();
+
+/**
+ * Snapshot the statistics of a gpio context
+ *
+ * @param dev The GPIO context
+ * @param stats Filled with the counters
+ * @param reset Also zero the counters of the context
+ * @return Result of operation
+ */
+mraa_result_t mraa_stats_gpio(mraa_gpio_context dev, mraa_stats_t* stats, mraa_boolean_t reset);
+
+/**
+ * Snapshot the statistics of an i2c context
+ *
+ * @param dev The I2C context
+ * @param stats Filled with the counters
+ * @param reset Also zero the counters of the context
+ * @return Result of operation
+ */
+mraa_result_t mraa_stats_i2c(mraa_i2c_context dev, mraa_stats_t* stats, mraa_boolean_t reset);
+
+/**
+ * Snapshot the statistics of a spi context
+ *
+ * @param dev The SPI context
+ * @param stats Filled with the counters
+ * @param reset Also zero the counters of the context
+ * @return Result of operation
+ */
+mraa_result_t mraa_stats_spi(mraa_spi_context dev, mraa_stats_t* stats, mraa_boolean_t reset);
+
+/**
+ * Snapshot the statistics of a uart context
+ *
+ * @param dev The UART context
+ * @param stats Filled with the counters
+ * @param reset Also zero the counters of the context
+ * @return Result of operation
+ */
+mraa_result_t mraa_stats_uart(mraa_uart_context dev, mraa_stats_t* stats, mraa_boolean_t reset);
+
+/**
+ * Snapshot the statistics of an aio context
+ *
+ * @param dev The AIO context
+ * @param stats Filled with the counters
+ * @param reset Also zero the counters of the context
+ * @return Result of operation
+ */
+mraa_result_t mraa_stats_aio(mraa_aio_context dev, mraa_stats_t* stats, mraa_boolean_t reset);
+
+/**
+ * Snapshot the statistics of a pwm context
+ *
+ * @param dev The PWM context
+ * @param stats Filled with the counters
+ * @param reset Also zero the counters of the context
+ * @return Result of operation
+ */
+mraa_result_t mraa_stats_pwm(mraa_pwm_context dev, mraa_stats_t* stats, mraa_boolean_t reset);
+
+/**
+ * Estimate a latency percentile from the histogram of a snapshot, as the
+ * upper bound of the bucket the percentile falls in
+ *
+ * @param stats A snapshot
+ * @param percentile Between 0 and 100
+ * @return Latency in nanoseconds, 0 when no call was counted
+ */
+uint64_t mraa_stats_percentile(const mraa_stats_t* stats, double percentile);
+
+#ifdef __cplusplus
+}
+#endif
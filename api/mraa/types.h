@@ -57,6 +57,7 @@ typedef enum {
     // contains bit 9 so is subplatform
     MRAA_GENERIC_FIRMATA = 1280,    /**< Firmata uart platform/bridge */
 
+    MRAA_MOCK_PLATFORM = 96,        /**< Mock platform on a fake filesystem, requires no hardware */
     MRAA_NULL_PLATFORM = 98,        /**< Platform with no capabilities that hosts a sub platform  */
     MRAA_UNKNOWN_PLATFORM =
     99 /**< An unknown platform type, typically will load INTEL_GALILEO_GEN1 */
@@ -236,6 +237,15 @@ typedef enum {
     MRAA_I2C_HIGH = 2  /**< up to 3.4Mhz */
 } mraa_i2c_mode_t;
 
+/**
+ * Enum representing the priority classes of queued i2c jobs
+ */
+typedef enum {
+    MRAA_I2C_PRIORITY_HIGH = 0,   /**< time critical, runs before anything else queued */
+    MRAA_I2C_PRIORITY_NORMAL = 1, /**< regular polling */
+    MRAA_I2C_PRIORITY_LOW = 2     /**< background work, runs when nothing else is queued */
+} mraa_i2c_priority_t;
+
 typedef enum {
 	MRAA_UART_PARITY_NONE = 0,
 	MRAA_UART_PARITY_EVEN = 1,
@@ -55,6 +55,7 @@ typedef enum {
 
     GENERIC_FIRMATA = 1280,    /**< Firmata uart platform/bridge */
 
+    MOCK_PLATFORM = 96,        /**< Mock platform on a fake filesystem, requires no hardware */
     NULL_PLATFORM = 98,
     UNKNOWN_PLATFORM =
     99 /**< An unknown platform type, typically will load INTEL_GALILEO_GEN1 */
@@ -234,6 +235,15 @@ typedef enum {
     I2C_HIGH = 2  /**< up to 3.4Mhz */
 } I2cMode;
 
+/**
+ * Enum representing the priority classes of queued i2c jobs
+ */
+typedef enum {
+    I2C_PRIORITY_HIGH = 0,   /**< time critical, runs before anything else queued */
+    I2C_PRIORITY_NORMAL = 1, /**< regular polling */
+    I2C_PRIORITY_LOW = 2     /**< background work, runs when nothing else is queued */
+} I2cPriority;
+
 typedef enum {
     UART_PARITY_NONE = 0,
     UART_PARITY_EVEN = 1,
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "stdio.h"
+#include "unistd.h"
+
+#include "mraa.h"
+
+#define BUS_WIDTH 4
+
+int
+main(int argc, char** argv)
+{
+    mraa_init();
+    fprintf(stdout, "MRAA Version: %s\nCounting on IO2-IO5\n", mraa_get_version());
+
+    //! [Interesting]
+    int pins[BUS_WIDTH] = { 2, 3, 4, 5 };
+    int values[BUS_WIDTH];
+    int count, i;
+
+    mraa_gpio_group_context bus = mraa_gpio_init_multi(pins, BUS_WIDTH);
+    if (bus == NULL) {
+        fprintf(stderr, "Failed to initialise IO2-IO5\n");
+        return 1;
+    }
+
+    mraa_gpio_dir_multi(bus, MRAA_GPIO_OUT_LOW);
+
+    for (count = 0; count < (1 << BUS_WIDTH); count++) {
+        for (i = 0; i < BUS_WIDTH; i++) {
+            values[i] = (count >> i) & 1;
+        }
+        mraa_gpio_write_multi(bus, values);
+        sleep(1);
+    }
+
+    mraa_gpio_close_multi(bus);
+    //! [Interesting]
+
+    return 0;
+}
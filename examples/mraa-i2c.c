@@ -155,18 +155,19 @@ i2c_set_exit:
 void
 i2c_detect_devices(int bus)
 {
-    mraa_result_t status = MRAA_SUCCESS;
-    mraa_i2c_context i2c = mraa_i2c_init(bus);
-    if (i2c == NULL) {
+    uint8_t found[MRAA_I2C_SCAN_MAX_ADDRESSES];
+    int n = mraa_i2c_scan(bus, found, MRAA_I2C_SCAN_MAX_ADDRESSES);
+    if (n < 0) {
         return;
     }
-    int addr;
+    int addr, i = 0;
     for (addr = 0x0; addr < 0x80; ++addr) {
-        uint8_t value;
         if ((addr) % 16 == 0)
             printf("%02x: ", addr);
-        if (i2c_get(bus, addr, 0, &value) == MRAA_SUCCESS)
-            printf("%02x ", addr);
+        if (i < n && found[i] == addr)
+            printf("%02x ", found[i++]);
+        else if (addr < 0x08 || addr > 0x77)
+            printf("   ");
         else
             printf("-- ");
         if ((addr + 1) % 16 == 0)
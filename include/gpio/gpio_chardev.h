@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "mraa_internal.h"
+
+/**
+ * Generic gpio_chardev_lookup hook. Finds the gpiochip owning a sysfs gpio
+ * number by walking /sys/class/gpio/gpiochip* and converts the number to a
+ * line offset on that chip. Platforms opt into the character device backend
+ * by setting this (or their own lookup) as adv_func->gpio_chardev_lookup.
+ *
+ * @param pin gpio number as used within sysfs
+ * @param chip filled with the /dev/gpiochip* number
+ * @param line filled with the line offset on that chip
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_chardev_lookup_sysfs(int pin, unsigned int* chip, unsigned int* line);
+
+/**
+ * Request a line from /dev/gpiochip<chip> for the context. The line is
+ * requested 'as-is' so its current direction and value are preserved.
+ *
+ * @param dev The Gpio context
+ * @param chip gpiochip number
+ * @param line line offset on the gpiochip
+ * @return Result of operation, dev->line_fd is valid on MRAA_SUCCESS
+ */
+mraa_result_t mraa_gpio_chardev_request(mraa_gpio_context dev, unsigned int chip, unsigned int line);
+
+/**
+ * Release the line request held by the context, if any
+ *
+ * @param dev The Gpio context
+ */
+void mraa_gpio_chardev_release(mraa_gpio_context dev);
+
+int mraa_gpio_chardev_read(mraa_gpio_context dev);
+mraa_result_t mraa_gpio_chardev_write(mraa_gpio_context dev, int value);
+mraa_result_t mraa_gpio_chardev_dir(mraa_gpio_context dev, mraa_gpio_dir_t dir);
+mraa_result_t mraa_gpio_chardev_read_dir(mraa_gpio_context dev, mraa_gpio_dir_t* dir);
+mraa_result_t mraa_gpio_chardev_edge_mode(mraa_gpio_context dev, mraa_gpio_edge_t mode);
+mraa_result_t mraa_gpio_chardev_mode(mraa_gpio_context dev, mraa_gpio_mode_t mode);
+
+/**
+ * Block until an edge event is queued on fd (a line request fd or a dup of
+ * one) and consume the pending events.
+ *
+ * @param dev The Gpio context the events are recorded for
+ * @param fd line request fd
+ * @param control_fd fd whose hangup aborts the wait, -1 for none
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_chardev_wait_interrupt(mraa_gpio_context dev, int fd, int control_fd);
+
+/**
+ * Consume the edge events queued on fd without waiting for more, recording
+ * them on the event ring of dev if it has one
+ *
+ * @param dev The Gpio context the events are recorded for
+ * @param fd line request fd
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_chardev_read_events(mraa_gpio_context dev, int fd);
+
+/**
+ * Request several lines of one gpiochip with a single line request. Like
+ * mraa_gpio_chardev_request the lines are requested 'as-is'.
+ *
+ * @param lines filled in on success
+ * @param chip gpiochip number
+ * @param offsets line offsets on the gpiochip, bit n of values maps to offsets[n]
+ * @param num number of offsets, at most 64
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_chardev_request_lines(struct _gpio_lines* lines, unsigned int chip, const unsigned int* offsets, unsigned int num);
+
+void mraa_gpio_chardev_release_lines(struct _gpio_lines* lines);
+mraa_result_t mraa_gpio_chardev_get_lines(struct _gpio_lines* lines);
+mraa_result_t mraa_gpio_chardev_set_lines(struct _gpio_lines* lines);
+mraa_result_t mraa_gpio_chardev_dir_lines(struct _gpio_lines* lines, mraa_gpio_dir_t dir);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "mraa_internal.h"
+
+/**
+ * Check whether the shared isr dispatcher has been started
+ *
+ * @return 1 if mraa_gpio_isr() should register with the dispatcher
+ */
+mraa_boolean_t mraa_gpio_dispatch_active();
+
+/**
+ * Register a gpio context, with isr and isr_args already set, with the
+ * dispatcher. Platforms replacing the interrupt wait are only accepted when
+ * they also provide gpio_interrupt_pending_replace, anything else must be
+ * serviced by its own thread.
+ *
+ * @param dev The Gpio context
+ * @return Result of operation, MRAA_ERROR_FEATURE_NOT_SUPPORTED if the
+ * context has to fall back to a dedicated thread
+ */
+mraa_result_t mraa_gpio_dispatch_add(mraa_gpio_context dev);
+
+/**
+ * Deregister a gpio context. Returns once no callback for dev is queued or
+ * running, so the caller may free dev afterwards.
+ *
+ * @param dev The Gpio context
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_dispatch_remove(mraa_gpio_context dev);
+
+/**
+ * Current CLOCK_MONOTONIC time, as used by the isr filters
+ *
+ * @return time in nanoseconds
+ */
+uint64_t mraa_gpio_isr_now();
+
+/**
+ * Apply the minimum interval of mraa_gpio_isr_options() to a callback about
+ * to be made, and account for it when it goes ahead. Only the thread calling
+ * the isr of dev may use this.
+ *
+ * @param dev The Gpio context
+ * @return 1 if the isr should be called
+ */
+mraa_boolean_t mraa_gpio_isr_rate_ok(mraa_gpio_context dev);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "mraa_internal.h"
+
+/**
+ * Whether the interrupt path of dev has to report edges, to the event ring
+ * or to the edge counter
+ */
+#define MRAA_GPIO_EVENTS_WANTED(dev) ((dev)->events != NULL || (dev)->counter != NULL)
+
+/**
+ * Queue an edge event on the ring of dev, and account for it in the edge
+ * counter when one is enabled. Only the thread servicing the
+ * interrupts of dev may call this, the ring is single producer.
+ *
+ * @param dev The Gpio context, must have events or the counter enabled
+ * @param timestamp_ns CLOCK_MONOTONIC timestamp of the edge
+ * @param edge MRAA_GPIO_EDGE_RISING, MRAA_GPIO_EDGE_FALLING or MRAA_GPIO_EDGE_BOTH if unknown
+ * @param seqno sequence number from the kernel, 0 to let the ring number events itself
+ */
+void mraa_gpio_event_push(mraa_gpio_context dev, uint64_t timestamp_ns, mraa_gpio_edge_t edge, unsigned int seqno);
+
+/**
+ * Queue an edge event stamped with the current time, for interrupt sources
+ * that carry no timestamp of their own
+ *
+ * @param dev The Gpio context, must have events or the counter enabled
+ * @param edge MRAA_GPIO_EDGE_RISING, MRAA_GPIO_EDGE_FALLING or MRAA_GPIO_EDGE_BOTH if unknown
+ */
+void mraa_gpio_event_push_now(mraa_gpio_context dev, mraa_gpio_edge_t edge);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+
+#include "mraa_internal.h"
+
+#define MRAA_GPIO_MMAP_MAX_WINDOWS 8
+#define MRAA_GPIO_MMAP_NONE -1
+
+/**
+ * Register layout of a memory mapped gpio controller. Platforms fill in the
+ * layout part, usually as a static table, and leave the engine state zeroed.
+ * Register offsets are in bytes from the start of a bank, unused registers
+ * are MRAA_GPIO_MMAP_NONE.
+ */
+typedef struct _gpio_mmap_desc {
+    /*@{*/
+    const char* name; /**< prefix of log messages */
+    const char* path; /**< file mapped, /dev/mem, a uio node or a pci resource */
+    const char* iomem_name; /**< /proc/iomem resource giving base and size, NULL to use base */
+    off_t base; /**< offset in path of the first bank */
+    size_t size; /**< bytes to map, 0 for the size of path */
+    const off_t* bank_base; /**< per bank offsets in path when banks are separate blocks, NULL otherwise */
+    unsigned int num_banks; /**< banks of the controller, 0 to bound lines by the mapping only */
+    unsigned int pins_per_bank; /**< lines sharing a register, 1 when every line has its own */
+    size_t bank_stride; /**< distance between the registers of consecutive banks in one window */
+    int data_in; /**< level register */
+    int data_out; /**< output latch, written read-modify-write when set and clear are missing */
+    int set; /**< write one to set register */
+    int clear; /**< write one to clear register */
+    int dir; /**< first direction register, MRAA_GPIO_MMAP_NONE leaves direction to the kernel */
+    unsigned int dir_bits; /**< width of the direction field of a line */
+    uint32_t dir_in; /**< direction field value of an input */
+    uint32_t dir_out; /**< direction field value of an output */
+    mraa_boolean_t dir_global; /**< direction fields number lines across banks rather than per bank */
+    uint32_t in_mask; /**< level bit in data_in when pins_per_bank is 1 */
+    uint32_t out_mask; /**< level bit in data_out when pins_per_bank is 1 */
+    /* engine state */
+    uint8_t* map[MRAA_GPIO_MMAP_MAX_WINDOWS]; /**< page aligned mappings */
+    uint8_t* window[MRAA_GPIO_MMAP_MAX_WINDOWS]; /**< first bank of each mapping */
+    size_t map_size; /**< length of each mapping */
+    size_t window_size; /**< usable bytes from window */
+    int fd; /**< descriptor of path while mapped */
+    unsigned int users; /**< gpio contexts and groups holding the mapping */
+    /*@}*/
+} mraa_gpio_mmap_desc_t;
+
+/**
+ * Enable or disable the memory mapped path of dev. The mapping is created
+ * for the first user of desc and dropped with the last one. Platforms call
+ * this from their gpio_mmap_setup after their own checks and muxing.
+ *
+ * @param desc Register layout of the controller owning dev
+ * @param dev The Gpio context
+ * @param line Line of dev on the controller, bank is line / pins_per_bank
+ * @param en 1 to enable, 0 to disable
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_mmap_setup(mraa_gpio_mmap_desc_t* desc, mraa_gpio_context dev, unsigned int line, mraa_boolean_t en);
+
+/**
+ * gpio_mmap_setup_multi implementation for platforms whose gpio_mmap_setup
+ * goes through mraa_gpio_mmap_setup. Each member is enabled through the
+ * platform hook, then reads and writes are batched per bank register.
+ *
+ * @param group The group context
+ * @param en 1 to enable, 0 to disable
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_mmap_setup_multi(mraa_gpio_group_context group, mraa_boolean_t en);
+
+/**
+ * Read the level register of a bank
+ *
+ * @param desc Register layout, mapped by at least one user
+ * @param bank Bank to read
+ * @return levels of the bank, bit n is line bank * pins_per_bank + n
+ */
+uint32_t mraa_gpio_mmap_bank_read(mraa_gpio_mmap_desc_t* desc, unsigned int bank);
+
+/**
+ * Drive the lines of a bank. Atomic with respect to other writers when the
+ * controller has set and clear registers, otherwise serialised against the
+ * other read-modify-write users of the engine in this process.
+ *
+ * @param desc Register layout, mapped by at least one user
+ * @param bank Bank to update
+ * @param set Lines to drive high
+ * @param clear Lines to drive low
+ * @return Result of operation
+ */
+mraa_result_t mraa_gpio_mmap_bank_update(mraa_gpio_mmap_desc_t* desc, unsigned int bank, uint32_t set, uint32_t clear);
+
+#ifdef __cplusplus
+}
+#endif
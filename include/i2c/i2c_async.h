@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "mraa_internal.h"
+
+/**
+ * The i2c context a transaction was created on
+ *
+ * @param trans The transaction
+ * @return i2c context or NULL if trans is invalid
+ */
+mraa_i2c_context mraa_i2c_transaction_context(mraa_i2c_transaction trans);
+
+/**
+ * Wait for the jobs of a context before it is freed, called from
+ * mraa_i2c_stop(). From a callback on the worker of its bus the jobs still
+ * queued for the context are dropped instead, without their callbacks.
+ *
+ * @param dev The i2c context
+ */
+void mraa_i2c_async_release(mraa_i2c_context dev);
+
+/**
+ * Let the bus workers run every queued job and join them, called from
+ * mraa_deinit()
+ */
+void mraa_i2c_async_shutdown();
+
+#ifdef __cplusplus
+}
+#endif
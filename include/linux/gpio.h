@@ -0,0 +1,111 @@
+/****************************************************************************
+ ****************************************************************************
+ ***
+ ***   This header was automatically generated from a Linux kernel header
+ ***   of the same name, to make information necessary for userspace to
+ ***   call into the kernel available to libc.  It contains only constants,
+ ***   structures, and macros generated from the original header, and thus,
+ ***   contains no copyrightable information.
+ ***
+ ***   Only the chip info and v2 line request ABI used by mraa is kept.
+ ***
+ ****************************************************************************
+ ****************************************************************************/
+#ifndef _UAPI_GPIO_H_
+#define _UAPI_GPIO_H_
+#include <linux/ioctl.h>
+#include <linux/types.h>
+
+#define GPIO_MAX_NAME_SIZE 32
+struct gpiochip_info {
+ char name[GPIO_MAX_NAME_SIZE];
+ char label[GPIO_MAX_NAME_SIZE];
+ __u32 lines;
+};
+
+#define GPIO_V2_LINES_MAX 64
+#define GPIO_V2_LINE_NUM_ATTRS_MAX 10
+
+#define GPIO_V2_LINE_FLAG_USED (1ULL << 0)
+#define GPIO_V2_LINE_FLAG_ACTIVE_LOW (1ULL << 1)
+#define GPIO_V2_LINE_FLAG_INPUT (1ULL << 2)
+#define GPIO_V2_LINE_FLAG_OUTPUT (1ULL << 3)
+#define GPIO_V2_LINE_FLAG_EDGE_RISING (1ULL << 4)
+#define GPIO_V2_LINE_FLAG_EDGE_FALLING (1ULL << 5)
+#define GPIO_V2_LINE_FLAG_OPEN_DRAIN (1ULL << 6)
+#define GPIO_V2_LINE_FLAG_OPEN_SOURCE (1ULL << 7)
+#define GPIO_V2_LINE_FLAG_BIAS_PULL_UP (1ULL << 8)
+#define GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN (1ULL << 9)
+#define GPIO_V2_LINE_FLAG_BIAS_DISABLED (1ULL << 10)
+#define GPIO_V2_LINE_FLAG_EVENT_CLOCK_REALTIME (1ULL << 11)
+
+struct gpio_v2_line_values {
+ __aligned_u64 bits;
+ __aligned_u64 mask;
+};
+
+#define GPIO_V2_LINE_ATTR_ID_FLAGS 1
+#define GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES 2
+#define GPIO_V2_LINE_ATTR_ID_DEBOUNCE 3
+
+struct gpio_v2_line_attribute {
+ __u32 id;
+ __u32 padding;
+ union {
+  __aligned_u64 flags;
+  __aligned_u64 values;
+  __u32 debounce_period_us;
+ };
+};
+
+struct gpio_v2_line_config_attribute {
+ struct gpio_v2_line_attribute attr;
+ __aligned_u64 mask;
+};
+
+struct gpio_v2_line_config {
+ __aligned_u64 flags;
+ __u32 num_attrs;
+ __u32 padding[5];
+ struct gpio_v2_line_config_attribute attrs[GPIO_V2_LINE_NUM_ATTRS_MAX];
+};
+
+struct gpio_v2_line_request {
+ __u32 offsets[GPIO_V2_LINES_MAX];
+ char consumer[GPIO_MAX_NAME_SIZE];
+ struct gpio_v2_line_config config;
+ __u32 num_lines;
+ __u32 event_buffer_size;
+ __u32 padding[5];
+ __s32 fd;
+};
+
+struct gpio_v2_line_info {
+ char name[GPIO_MAX_NAME_SIZE];
+ char consumer[GPIO_MAX_NAME_SIZE];
+ __u32 offset;
+ __u32 num_attrs;
+ __aligned_u64 flags;
+ struct gpio_v2_line_attribute attrs[GPIO_V2_LINE_NUM_ATTRS_MAX];
+ __u32 padding[4];
+};
+
+#define GPIO_V2_LINE_EVENT_RISING_EDGE 1
+#define GPIO_V2_LINE_EVENT_FALLING_EDGE 2
+
+struct gpio_v2_line_event {
+ __aligned_u64 timestamp_ns;
+ __u32 id;
+ __u32 offset;
+ __u32 seqno;
+ __u32 line_seqno;
+ __u32 padding[6];
+};
+
+#define GPIO_GET_CHIPINFO_IOCTL _IOR(0xB4, 0x01, struct gpiochip_info)
+#define GPIO_V2_GET_LINEINFO_IOCTL _IOWR(0xB4, 0x05, struct gpio_v2_line_info)
+#define GPIO_V2_GET_LINE_IOCTL _IOWR(0xB4, 0x07, struct gpio_v2_line_request)
+#define GPIO_V2_LINE_SET_CONFIG_IOCTL _IOWR(0xB4, 0x0D, struct gpio_v2_line_config)
+#define GPIO_V2_LINE_GET_VALUES_IOCTL _IOWR(0xB4, 0x0E, struct gpio_v2_line_values)
+#define GPIO_V2_LINE_SET_VALUES_IOCTL _IOWR(0xB4, 0x0F, struct gpio_v2_line_values)
+#endif
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "mraa_internal.h"
+
+#define MRAA_MOCK_PINCOUNT 20
+// pins 0 to 9, sysfs gpio 0 to 9
+#define MRAA_MOCK_GPIOCOUNT 10
+// pins 10 and 11, channels of iio:device0
+#define MRAA_MOCK_AIOCOUNT 2
+// pins 3 and 5, pwm0 and pwm1 of pwmchip0
+#define MRAA_MOCK_PWMCOUNT 2
+// register file answering on i2c bus 0
+#define MRAA_MOCK_I2C_ADDR 0x33
+#define MRAA_MOCK_I2C_REGS 256
+// value of a fresh aio channel, half of MRAA_MOCK_ADC_BITS
+#define MRAA_MOCK_ADC_BITS 10
+#define MRAA_MOCK_ADC_VALUE 512
+
+mraa_board_t*
+mraa_mock_board();
+
+#ifdef __cplusplus
+}
+#endif
@@ -28,6 +28,8 @@
 #include "mraa.h"
 #include "types.h"
 
+struct i2c_msg;
+
 // FIXME: Nasty macro to test for presence of function in context structure function table
 #define IS_FUNC_DEFINED(dev, func)   (dev != NULL && dev->advance_func != NULL && dev->advance_func->func != NULL)
 
@@ -56,6 +58,10 @@ typedef struct {
     mraa_result_t (*gpio_mmap_setup) (mraa_gpio_context dev, mraa_boolean_t en);
     mraa_result_t (*gpio_interrupt_handler_init_replace) (mraa_gpio_context dev);
     mraa_result_t (*gpio_wait_interrupt_replace) (mraa_gpio_context dev);
+    mraa_boolean_t (*gpio_interrupt_pending_replace) (mraa_gpio_context dev);
+    mraa_result_t (*gpio_interrupt_handler_exit_replace) (mraa_gpio_context dev);
+    mraa_result_t (*gpio_chardev_lookup) (int pin, unsigned int* chip, unsigned int* line);
+    mraa_result_t (*gpio_mmap_setup_multi) (mraa_gpio_group_context group, mraa_boolean_t en);
 
     mraa_result_t (*i2c_init_pre) (unsigned int bus);
     mraa_result_t (*i2c_init_bus_replace) (mraa_i2c_context dev);
@@ -72,6 +78,7 @@ typedef struct {
     mraa_result_t (*i2c_write_byte_replace) (mraa_i2c_context dev, uint8_t data);
     mraa_result_t (*i2c_write_byte_data_replace) (mraa_i2c_context dev, const uint8_t data, const uint8_t command);
     mraa_result_t (*i2c_write_word_data_replace) (mraa_i2c_context dev, const uint16_t data, const uint8_t command);
+    mraa_result_t (*i2c_transfer_replace) (mraa_i2c_context dev, struct i2c_msg* msgs, int nmsgs);
     mraa_result_t (*i2c_stop_replace) (mraa_i2c_context dev);
 
     mraa_result_t (*aio_init_internal_replace) (mraa_aio_context dev, int pin);
@@ -93,7 +100,14 @@ typedef struct {
 
     mraa_result_t (*spi_init_pre) (int bus);
     mraa_result_t (*spi_init_post) (mraa_spi_context spi);
+    mraa_result_t (*spi_init_raw_replace) (mraa_spi_context dev, unsigned int bus, unsigned int cs);
+    mraa_result_t (*spi_mode_replace) (mraa_spi_context dev, mraa_spi_mode_t mode);
+    mraa_result_t (*spi_frequency_replace) (mraa_spi_context dev, int hz);
     mraa_result_t (*spi_lsbmode_replace) (mraa_spi_context dev, mraa_boolean_t lsb);
+    mraa_result_t (*spi_bit_per_word_replace) (mraa_spi_context dev, unsigned int bits);
+    mraa_result_t (*spi_transfer_buf_replace) (mraa_spi_context dev, uint8_t* data, uint8_t* rxbuf, int length);
+    mraa_result_t (*spi_transfer_buf_word_replace) (mraa_spi_context dev, uint16_t* data, uint16_t* rxbuf, int length);
+    mraa_result_t (*spi_stop_replace) (mraa_spi_context dev);
 
     mraa_result_t (*uart_init_pre) (int index);
     mraa_result_t (*uart_init_post) (mraa_uart_context uart);
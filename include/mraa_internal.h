@@ -28,6 +28,7 @@
 extern "C" {
 #endif
 
+#include <stdio.h>
 #include <syslog.h>
 #include <fnmatch.h>
 
@@ -132,6 +133,84 @@ mraa_boolean_t mraa_link_targets(const char* filename, const char* targetname);
  */
 int mraa_find_i2c_bus(const char* devname, int startfrom);
 
+/**
+ * helper function to find the sysfs gpiochip registered with a given label
+ *
+ * @param label of the gpiochip, usually the device name of the controller
+ * @param ngpio if not NULL receives the number of lines of the gpiochip
+ * @return the sysfs number of the first line of the gpiochip or -1
+ */
+int mraa_find_gpiochip_base(const char* label, int* ngpio);
+
+/**
+ * Create a library thread with the given attributes, or the ones set with
+ * mraa_set_thread_attr() when attr is NULL
+ *
+ * @param thread receives the thread id
+ * @param attr attributes of the context the thread serves, NULL for the defaults
+ * @param start thread function
+ * @param arg argument of start
+ * @return 0 or the error of pthread_create
+ */
+int mraa_thread_create(pthread_t* thread, const mraa_thread_attr_t* attr, void* (*start)(void*), void* arg);
+
+/**
+ * Stop the sampler threads, jobs can still be read and removed afterwards
+ */
+void mraa_sampler_shutdown();
+
+/**
+ * helper function to find the physical address range of a device in
+ * /proc/iomem
+ *
+ * @param name of the resource, matched anywhere on the line
+ * @param start receives the first physical address
+ * @param size receives the length of the range
+ * @return MRAA_SUCCESS or MRAA_ERROR_NO_RESOURCES when the range is missing or hidden
+ */
+mraa_result_t mraa_find_iomem_resource(const char* name, uint64_t* start, uint64_t* size);
+
+/**
+ * Build a sysfs, devfs or procfs path under the root set with
+ * mraa_set_fs_root(), printf style
+ *
+ * @param buf receives the path
+ * @param size of buf
+ * @param fmt absolute path format
+ * @return length of the path or -1 when it does not fit in buf
+ */
+int mraa_fs_path(char* buf, size_t size, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+
+/**
+ * Open a path under the filesystem root
+ *
+ * @param path absolute path as on the target
+ * @param flags of open(2)
+ * @return the fd or -1
+ */
+int mraa_fs_open(const char* path, int flags);
+
+/**
+ * fopen a path under the filesystem root
+ *
+ * @param path absolute path as on the target
+ * @param mode of fopen(3)
+ * @return the stream or NULL
+ */
+FILE* mraa_fs_fopen(const char* path, const char* mode);
+
+/**
+ * Detect the mock platform and create its fake sysfs tree
+ *
+ * @return mraa_platform_t of the mock platform
+ */
+mraa_platform_t mraa_mock_platform();
+
+/**
+ * Tear down what mraa_mock_platform() set up
+ */
+void mraa_mock_platform_deinit();
+
 #if defined(IMRAA)
 /**
  * read Imraa subplatform lock file, caller is responsible to free return
@@ -29,6 +29,7 @@
 #include "mraa.h"
 #include "mraa_adv_func.h"
 #include "iio.h"
+#include "stats.h"
 
 // Bionic does not implement pthread cancellation API
 #ifndef __BIONIC__
@@ -40,6 +41,10 @@
 #define MRAA_IO_SETUP_FAILURE -2
 #define MRAA_NO_SUCH_IO -1
 
+// longest root mraa_set_fs_root() takes, path buffers leave room for it
+#define MRAA_FS_ROOT_MAX 128
+#define MRAA_FS_PATH_MAX 256
+
 #ifdef FIRMATA
 struct _firmata {
     /*@*/
@@ -59,17 +64,72 @@ struct _gpio {
     int pin; /**< the pin number, as known to the os. */
     int phy_pin; /**< pin passed to clean init. -1 none and raw*/
     int value_fp; /**< the file pointer to the value of the gpio */
+    int dir_fp; /**< cached fd of the sysfs direction attribute, -1 until first use */
+    int edge_fp; /**< cached fd of the sysfs edge attribute, -1 until first use */
+    int drive_fp; /**< cached fd of the sysfs drive attribute, -1 until first use */
     void (* isr)(void *); /**< the interrupt service request */
     void *isr_args; /**< args return when interrupt service request triggered */
     pthread_t thread_id; /**< the isr handler thread id */
+    mraa_thread_attr_t* thread_attr; /**< attributes of the isr thread, NULL for the library defaults */
     int isr_value_fp; /**< the isr file pointer on the value */
 #ifndef HAVE_PTHREAD_CANCEL
     int isr_control_pipe[2]; /**< a pipe used to interrupt the isr from polling the value fd*/
 #endif
     mraa_boolean_t isr_thread_terminating; /**< is the isr thread being terminated? */
+    uint64_t isr_debounce_ns; /**< quiet time after an edge before the isr is called, 0 for none */
+    uint64_t isr_min_interval_ns; /**< minimum time between two isr calls, 0 for none */
+    uint64_t isr_last_edge_ns; /**< CLOCK_MONOTONIC time of the last edge seen by the dispatcher */
+    uint64_t isr_last_call_ns; /**< CLOCK_MONOTONIC time of the last isr call */
+    struct _gpio_isr_entry* isr_entry; /**< shared dispatcher registration, NULL when a thread services the isr */
+    struct _gpio_event_ring* events; /**< edge event ring, NULL unless events are enabled */
+    struct _gpio_counter* counter; /**< edge counter, NULL unless the counter is enabled */
     mraa_boolean_t owner; /**< If this context originally exported the pin */
+    int line_fd; /**< gpiochip line request fd, -1 when the pin is driven through sysfs */
+    unsigned int line_chip; /**< the /dev/gpiochip* number the line belongs to */
+    unsigned int line_offset; /**< the line offset on its gpiochip */
+    uint64_t line_flags; /**< gpio_v2 flags currently applied to the line request */
+    struct _gpio_mmap_desc* mmap_desc; /**< register layout behind the mmap path, NULL when not mapped */
+    volatile uint32_t* mmap_reg; /**< first register of the bank, or of the pad, of the pin */
+    uint32_t mmap_mask; /**< bit of the pin in its bank registers */
+    unsigned int mmap_line; /**< line of the pin on the mapped controller */
     mraa_result_t (*mmap_write) (mraa_gpio_context dev, int value);
     int (*mmap_read) (mraa_gpio_context dev);
+    mraa_result_t (*mmap_dir) (mraa_gpio_context dev, mraa_gpio_dir_t dir);
+    mraa_result_t (*mmap_read_dir) (mraa_gpio_context dev, mraa_gpio_dir_t* dir);
+#ifdef MRAA_STATS
+    mraa_stats_t stats; /**< operation counters */
+#endif
+    mraa_adv_func_t* advance_func; /**< override function table */
+    /*@}*/
+};
+
+/**
+ * A set of lines on one gpiochip held by a single line request
+ */
+struct _gpio_lines {
+    /*@{*/
+    int fd; /**< the line request fd */
+    unsigned int chip; /**< the /dev/gpiochip* number */
+    unsigned int num_lines; /**< lines in the request, bit n of a value is the nth line */
+    uint64_t flags; /**< gpio_v2 flags currently applied to every line */
+    uint64_t values; /**< scratch for the last value snapshot read or to be written */
+    /*@}*/
+};
+
+/**
+ * A structure representing a group of gpio pins driven together
+ */
+struct _gpio_group {
+    /*@{*/
+    mraa_gpio_context* gpio; /**< member contexts, in the order the pins were passed */
+    int num_pins; /**< number of members */
+    struct _gpio_lines* lines; /**< gpiochip requests shared by members, one per chip */
+    int num_lines; /**< number of gpiochip requests */
+    int* line_req; /**< per member index into lines, -1 when driven through its own context */
+    unsigned int* line_bit; /**< per member bit within its gpiochip request */
+    mraa_result_t (*mmap_write_multi) (mraa_gpio_group_context group, int* values);
+    mraa_result_t (*mmap_read_multi) (mraa_gpio_group_context group, int* values);
+    mraa_boolean_t* mmap_taken; /**< per member, set when the group mapped it, NULL while the group is not mapped */
     mraa_adv_func_t* advance_func; /**< override function table */
     /*@}*/
 };
@@ -84,6 +144,15 @@ struct _i2c {
     int addr; /**< the address of the i2c slave */
     unsigned long funcs; /**< /dev/i2c-* device capabilities as per https://www.kernel.org/doc/Documentation/i2c/functionality */
     void *handle; /**< generic handle for non-standard drivers that don't use file descriptors  */
+    struct _i2c_bus* bus; /**< /dev/i2c-* device shared with other contexts on the bus, NULL when the platform drives the bus */
+    int async_pending; /**< jobs queued on or running in the bus worker, under the async lock */
+    int scl_pin; /**< board pin of SCL for bus recovery, -1 when unknown */
+    int sda_pin; /**< board pin of SDA for bus recovery, -1 when unknown */
+    mraa_i2c_retry_policy_t retry; /**< how failed calls are retried */
+    mraa_i2c_retry_stats_t retry_stats; /**< retry counters, updated atomically */
+#ifdef MRAA_STATS
+    mraa_stats_t stats; /**< operation counters */
+#endif
     mraa_adv_func_t* advance_func; /**< override function table */
     /*@}*/
 };
@@ -98,6 +167,9 @@ struct _spi {
     int clock;          /**< clock to run transactions at */
     mraa_boolean_t lsb; /**< least significant bit mode */
     unsigned int bpw;   /**< Bits per word */
+#ifdef MRAA_STATS
+    mraa_stats_t stats; /**< operation counters */
+#endif
     mraa_adv_func_t* advance_func; /**< override function table */
     /*@}*/
 };
@@ -112,6 +184,9 @@ struct _pwm {
     int duty_fp; /**< File pointer to duty file */
     int period;  /**< Cache the period to speed up setting duty */
     mraa_boolean_t owner; /**< Owner of pwm context*/
+#ifdef MRAA_STATS
+    mraa_stats_t stats; /**< operation counters */
+#endif
     mraa_adv_func_t* advance_func; /**< override function table */
     /*@}*/
 };
@@ -124,6 +199,9 @@ struct _aio {
     unsigned int channel; /**< the channel as on board and ADC module */
     int adc_in_fp; /**< File Pointer to raw sysfs */
     int value_bit; /**< 10 bits by default. Can be increased if board */
+#ifdef MRAA_STATS
+    mraa_stats_t stats; /**< operation counters */
+#endif
     mraa_adv_func_t* advance_func; /**< override function table */
     /*@}*/
 };
@@ -136,6 +214,9 @@ struct _uart {
     int index; /**< the uart index, as known to the os. */
     const char* path; /**< the uart device path. */
     int fd; /**< file descriptor for device. */
+#ifdef MRAA_STATS
+    mraa_stats_t stats; /**< operation counters */
+#endif
     mraa_adv_func_t* advance_func; /**< override function table */
     /*@}*/
 };
@@ -153,6 +234,7 @@ struct _iio {
     void (* isr_event)(struct iio_event_data* data, void* args); /**< the event interrupt service request */
     int chan_num;
     pthread_t thread_id; /**< the isr handler thread id */
+    mraa_thread_attr_t* thread_attr; /**< attributes of the trigger and event threads, NULL for the library defaults */
     mraa_iio_channel* channels;
     int event_num;
     mraa_iio_event* events;
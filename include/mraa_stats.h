@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "mraa/stats.h"
+
+/*
+ * Instrumentation of the context operations. Without MRAA_STATS the macros
+ * expand to nothing and contexts carry no counters. Arguments other than
+ * start are not evaluated then, so they must not have side effects.
+ */
+#ifdef MRAA_STATS
+
+#include <time.h>
+
+static inline uint64_t
+mraa_stats_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline void
+mraa_stats_record(mraa_stats_t* stats, uint64_t start_ns, uint64_t bytes, mraa_boolean_t failed)
+{
+    uint64_t elapsed = mraa_stats_now() - start_ns;
+    uint64_t max = __atomic_load_n(&stats->max_ns, __ATOMIC_RELAXED);
+    int bucket = elapsed < 2 ? 0 : 63 - __builtin_clzll(elapsed);
+
+    if (bucket >= MRAA_STATS_BUCKETS) {
+        bucket = MRAA_STATS_BUCKETS - 1;
+    }
+    __atomic_fetch_add(&stats->ops, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->total_ns, elapsed, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->histogram[bucket], 1, __ATOMIC_RELAXED);
+    if (failed) {
+        __atomic_fetch_add(&stats->errors, 1, __ATOMIC_RELAXED);
+    } else if (bytes > 0) {
+        __atomic_fetch_add(&stats->bytes, bytes, __ATOMIC_RELAXED);
+    }
+    while (elapsed > max &&
+           !__atomic_compare_exchange_n(&stats->max_ns, &max, elapsed, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+#define MRAA_STATS_START(start) uint64_t start = mraa_stats_now()
+#define MRAA_STATS_RECORD(dev, start, bytes, failed)                                                      \
+    do {                                                                                                  \
+        if ((dev) != NULL)                                                                                \
+            mraa_stats_record(&(dev)->stats, (start), (bytes), (failed));                                 \
+    } while (0)
+#define MRAA_STATS_REOPEN(dev) __atomic_fetch_add(&(dev)->stats.reopens, 1, __ATOMIC_RELAXED)
+
+#else
+
+#define MRAA_STATS_START(start)
+#define MRAA_STATS_RECORD(dev, start, bytes, failed) do { } while (0)
+#define MRAA_STATS_REOPEN(dev) do { } while (0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Events the data paths report through the trace ring instead of calling
+ * syslog themselves. Each one maps to the message it used to log, see the
+ * table in trace.c, keep both in the same order.
+ */
+typedef enum {
+    MRAA_TRACE_GPIO_OPEN_VALUE,
+    MRAA_TRACE_GPIO_READ,
+    MRAA_TRACE_GPIO_WRITE,
+    MRAA_TRACE_I2C_READ_BYTE,
+    MRAA_TRACE_I2C_READ_BYTE_DATA,
+    MRAA_TRACE_I2C_READ_WORD_DATA,
+    MRAA_TRACE_I2C_READ_BYTES_DATA,
+    MRAA_TRACE_I2C_WRITE,
+    MRAA_TRACE_I2C_WRITE_BYTE,
+    MRAA_TRACE_I2C_WRITE_BYTE_DATA,
+    MRAA_TRACE_I2C_WRITE_WORD_DATA,
+    MRAA_TRACE_I2C_TRANSFER,
+    MRAA_TRACE_SPI_TRANSFER,
+    MRAA_TRACE_AIO_OPEN,
+    MRAA_TRACE_AIO_READ,
+    MRAA_TRACE_AIO_PARSE,
+    MRAA_TRACE_PWM_OPEN_DUTY,
+    MRAA_TRACE_PWM_WRITE_DUTY,
+    MRAA_TRACE_PWM_READ_DUTY,
+    MRAA_TRACE_PWM_PARSE_DUTY,
+    MRAA_TRACE_OP_COUNT
+} mraa_trace_op_t;
+
+/**
+ * Record an event in the trace ring of the calling thread. Never blocks and
+ * makes no syscall, the record is forwarded to syslog or the trace file by a
+ * background thread. Events above the log level are dropped here.
+ *
+ * @param priority syslog priority of the event
+ * @param op what happened
+ * @param id pin, bus or channel of the context, -1 for none
+ * @param err errno of the failure, 0 for none
+ */
+void mraa_trace(int priority, mraa_trace_op_t op, int id, int err);
+
+/**
+ * Filter applied by mraa_trace(), kept in step with setlogmask()
+ *
+ * @param mask syslog priority mask as built by LOG_UPTO()
+ */
+void mraa_trace_set_mask(int mask);
+
+/**
+ * Forward every pending record and stop the background thread, it is
+ * started again by the next record
+ */
+void mraa_trace_stop();
+
+#ifdef __cplusplus
+}
+#endif
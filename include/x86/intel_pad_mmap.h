@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "mraa_internal.h"
+
+/**
+ * Intel SoC families whose gpio controllers expose one register per pad
+ */
+typedef enum {
+    MRAA_INTEL_PAD_BAYTRAIL = 0,   /**< INT33FC, MinnowBoard MAX/Turbot, DE3815 */
+    MRAA_INTEL_PAD_CHERRYVIEW = 1  /**< INT33FF, Braswell and Cherry Trail, Cherry Hill, UP */
+} mraa_intel_pad_soc_t;
+
+/**
+ * Resolve the pad register of every gpio capable pin of board and install
+ * gpio_mmap_setup. Resolution only reads sysfs (and debugfs on Cherryview),
+ * the registers themselves are mapped through /dev/mem on first use so an
+ * unprivileged process keeps working on the sysfs path.
+ *
+ * @param board The board being initialised, adv_func must be allocated
+ * @param soc The gpio controller family of the board
+ * @return Result of operation
+ */
+mraa_result_t mraa_intel_pad_mmap_init(mraa_board_t* board, mraa_intel_pad_soc_t soc);
+
+#ifdef __cplusplus
+}
+#endif
@@ -29,6 +29,8 @@
 
 #include "aio.h"
 #include "mraa_internal.h"
+#include "mraa_stats.h"
+#include "mraa_trace.h"
 
 #define DEFAULT_BITS 10
 
@@ -41,10 +43,10 @@ aio_get_valid_fp(mraa_aio_context dev)
         return dev->advance_func->aio_get_valid_fp(dev);
     }
 
-    char file_path[64] = "";
+    char file_path[MRAA_FS_PATH_MAX] = "";
 
     // Open file Analog device input channel raw voltage file for reading.
-    snprintf(file_path, 64, "/sys/bus/iio/devices/iio:device0/in_voltage%d_raw", dev->channel);
+    mraa_fs_path(file_path, sizeof(file_path), "/sys/bus/iio/devices/iio:device0/in_voltage%d_raw", dev->channel);
 
     dev->adc_in_fp = open(file_path, O_RDONLY);
     if (dev->adc_in_fp == -1) {
@@ -153,8 +155,8 @@ mraa_aio_init(unsigned int aio)
     return dev;
 }
 
-int
-mraa_aio_read(mraa_aio_context dev)
+static int
+mraa_aio_read_internal(mraa_aio_context dev)
 {
     if (IS_FUNC_DEFINED(dev, aio_read_replace)) {
         return dev->advance_func->aio_read_replace(dev);
@@ -164,15 +166,16 @@ mraa_aio_read(mraa_aio_context dev)
     unsigned int shifter_value = 0;
 
     if (dev->adc_in_fp == -1) {
+        MRAA_STATS_REOPEN(dev);
         if (aio_get_valid_fp(dev) != MRAA_SUCCESS) {
-            syslog(LOG_ERR, "aio: Failed to get to the device");
+            mraa_trace(LOG_ERR, MRAA_TRACE_AIO_OPEN, dev->channel, errno);
             return -1;
         }
     }
 
     lseek(dev->adc_in_fp, 0, SEEK_SET);
     if (read(dev->adc_in_fp, buffer, sizeof(buffer)) < 1) {
-        syslog(LOG_ERR, "aio: Failed to read a sensible value");
+        mraa_trace(LOG_ERR, MRAA_TRACE_AIO_READ, dev->channel, errno);
     }
     // force NULL termination of string
     buffer[16] = '\0';
@@ -182,10 +185,10 @@ mraa_aio_read(mraa_aio_context dev)
     char* end;
     unsigned int analog_value = (unsigned int) strtoul(buffer, &end, 10);
     if (end == &buffer[0]) {
-        syslog(LOG_ERR, "aio: Value is not a decimal number");
+        mraa_trace(LOG_ERR, MRAA_TRACE_AIO_PARSE, dev->channel, 0);
         return -1;
     } else if (errno != 0) {
-        syslog(LOG_ERR, "aio: Errno was set");
+        mraa_trace(LOG_ERR, MRAA_TRACE_AIO_PARSE, dev->channel, errno);
         return -1;
     }
 
@@ -203,6 +206,15 @@ mraa_aio_read(mraa_aio_context dev)
     return analog_value;
 }
 
+int
+mraa_aio_read(mraa_aio_context dev)
+{
+    MRAA_STATS_START(start);
+    int ret = mraa_aio_read_internal(dev);
+    MRAA_STATS_RECORD(dev, start, 0, ret == -1);
+    return ret;
+}
+
 float
 mraa_aio_read_float(mraa_aio_context dev)
 {
@@ -28,17 +28,26 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
-#include <sys/mman.h>
 #include <mraa/common.h>
 
 #include "common.h"
 #include "arm/96boards.h"
+#include "gpio/gpio_chardev.h"
+#include "gpio/gpio_mmap.h"
 
 #define DT_BASE "/sys/firmware/devicetree/base"
 
 #define PLATFORM_NAME_DB410C "DB410C"
 #define PLATFORM_NAME_HIKEY "HIKEY"
 
+#define MMAP_PATH "/dev/mem"
+// Qualcomm TLMM, one 4k block per gpio, level bits in the IN_OUT register
+#define DB410C_TLMM_NAME "1000000.pinctrl"
+#define TLMM_GPIO_STRIDE 0x1000
+#define TLMM_GPIO_IN_OUT 0x4
+#define TLMM_GPIO_IN 0x1
+#define TLMM_GPIO_OUT 0x2
+
 int db410c_ls_gpio_pins[MRAA_96BOARDS_LS_GPIO_COUNT] = {
   36, 12, 13, 69, 115, 4, 24, 25, 35, 34, 28, 33,
 };
@@ -51,6 +60,41 @@ int hikey_ls_gpio_pins[MRAA_96BOARDS_LS_GPIO_COUNT] = {
 
 const char* hikey_serialdev[MRAA_96BOARDS_LS_UART_COUNT] = { "/dev/ttyAMA2", "/dev/ttyAMA3"};
 
+static int tlmm_gpio_base = -1;
+static int tlmm_ngpio = 0;
+static mraa_gpio_mmap_desc_t tlmm_desc = {
+   .name = "db410c",
+   .path = MMAP_PATH,
+   .iomem_name = DB410C_TLMM_NAME,
+   .pins_per_bank = 1,
+   .bank_stride = TLMM_GPIO_STRIDE,
+   .data_in = TLMM_GPIO_IN_OUT,
+   .data_out = TLMM_GPIO_IN_OUT,
+   .set = MRAA_GPIO_MMAP_NONE,
+   .clear = MRAA_GPIO_MMAP_NONE,
+   .dir = MRAA_GPIO_MMAP_NONE,
+   .in_mask = TLMM_GPIO_IN,
+   .out_mask = TLMM_GPIO_OUT,
+};
+
+mraa_result_t
+mraa_db410c_mmap_setup(mraa_gpio_context dev, mraa_boolean_t en)
+{
+   if (dev == NULL) {
+      syslog(LOG_ERR, "db410c mmap: context not valid");
+      return MRAA_ERROR_INVALID_HANDLE;
+   }
+
+   int line = dev->pin - tlmm_gpio_base;
+   if (tlmm_gpio_base < 0 || line < 0 || line >= tlmm_ngpio) {
+      syslog(LOG_WARNING, "db410c mmap: gpio%i is not a tlmm line, mmap not available", dev->pin);
+      return MRAA_ERROR_FEATURE_NOT_SUPPORTED;
+   }
+
+   // IN_OUT also holds the input level, the engine writes it read-modify-write
+   return mraa_gpio_mmap_setup(&tlmm_desc, dev, (unsigned int) line, en);
+}
+
 void mraa_96boards_pininfo(mraa_board_t* board, int index, int sysfs_pin,
                            char *fmt, ...)
 {
@@ -120,6 +164,13 @@ mraa_board_t* mraa_96boards()
       free(b);
       return NULL;
    }
+   b->adv_func->gpio_chardev_lookup = &mraa_gpio_chardev_lookup_sysfs;
+   if (ls_gpio_pins == db410c_ls_gpio_pins) {
+      // line numbers are fixed by the gpiochip base, resolve it once here
+      tlmm_gpio_base = mraa_find_gpiochip_base(DB410C_TLMM_NAME, &tlmm_ngpio);
+      b->adv_func->gpio_mmap_setup = &mraa_db410c_mmap_setup;
+      b->adv_func->gpio_mmap_setup_multi = &mraa_gpio_mmap_setup_multi;
+   }
 
    b->pins = (mraa_pininfo_t*) malloc(sizeof(mraa_pininfo_t) * b->phy_pin_count);
    if (b->pins == NULL) {
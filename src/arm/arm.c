@@ -39,7 +39,7 @@ mraa_arm_platform()
     mraa_platform_t platform_type = MRAA_UNKNOWN_PLATFORM;
     size_t len = 100;
     char* line = malloc(len);
-    FILE* fh = fopen("/proc/cpuinfo", "r");
+    FILE* fh = mraa_fs_fopen("/proc/cpuinfo", "r");
 
     if (fh != NULL) {
         while (getline(&line, &len, fh) != -1) {
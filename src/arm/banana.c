@@ -31,6 +31,7 @@
 
 #include "common.h"
 #include "arm/banana.h"
+#include "gpio/gpio_mmap.h"
 
 #define PLATFORM_NAME_BANANA_PI "Banana Pi"
 #define PLATFORM_BANANA_PI 1
@@ -41,15 +42,30 @@
 
 #define SUNXI_BASE (0x01C20000)
 #define SUNXI_BLOCK_SIZE (4 * 1024)
+#define SUNXI_GPIO_CFG 0x0800
 #define SUNXI_GPIO_DAT 0x0810
 #define SUNXI_GPIO_PORT_OFFSET 0x0024
+#define SUNXI_GPIO_PORTS 9
 #define MAX_SIZE 64
 
-// MMAP
-static uint8_t* mmap_reg = NULL;
-static int mmap_fd = 0;
-static int mmap_size;
-static unsigned int mmap_count = 0;
+// MMAP, ports A to I, 4 bit function fields where 0 is input and 1 output
+static mraa_gpio_mmap_desc_t mmap_desc = {
+    .name = "banana",
+    .path = MMAP_PATH,
+    .base = SUNXI_BASE,
+    .size = SUNXI_BLOCK_SIZE,
+    .num_banks = SUNXI_GPIO_PORTS,
+    .pins_per_bank = 32,
+    .bank_stride = SUNXI_GPIO_PORT_OFFSET,
+    .data_in = SUNXI_GPIO_DAT,
+    .data_out = SUNXI_GPIO_DAT,
+    .set = MRAA_GPIO_MMAP_NONE,
+    .clear = MRAA_GPIO_MMAP_NONE,
+    .dir = SUNXI_GPIO_CFG,
+    .dir_bits = 4,
+    .dir_in = 0,
+    .dir_out = 1,
+};
 static int platform_detected = 0;
 
 const char* serialdev[] = { "/dev/ttyS0", "/dev/ttyS1", "/dev/ttyS2", "/dev/ttyS3",
@@ -102,48 +118,6 @@ mraa_banana_i2c_init_pre(unsigned int bus)
     return MRAA_SUCCESS;
 }
 
-mraa_result_t
-mraa_banana_mmap_write(mraa_gpio_context dev, int value)
-{
-    uint32_t readvalue =
-    *(volatile uint32_t*) (mmap_reg + SUNXI_GPIO_DAT + (dev->pin / 32) * SUNXI_GPIO_PORT_OFFSET);
-    volatile uint32_t* addr;
-    if (value) {
-        *(volatile uint32_t*) (mmap_reg + SUNXI_GPIO_DAT + (dev->pin / 32) * SUNXI_GPIO_PORT_OFFSET) =
-        (uint32_t)((1 << (dev->pin % 32)) | readvalue);
-    } else {
-        *(volatile uint32_t*) (mmap_reg + SUNXI_GPIO_DAT + (dev->pin / 32) * SUNXI_GPIO_PORT_OFFSET) =
-        (uint32_t)(~(1 << (dev->pin % 32)) & readvalue);
-    }
-    return MRAA_SUCCESS;
-}
-
-int
-mraa_banana_mmap_read(mraa_gpio_context dev)
-{
-    uint32_t value =
-    *(volatile uint32_t*) (mmap_reg + SUNXI_GPIO_DAT + (dev->pin / 32) * SUNXI_GPIO_PORT_OFFSET);
-    if (value & (uint32_t)(1 << (dev->pin % 32))) {
-        return 1;
-    }
-    return 0;
-}
-
-static mraa_result_t
-mraa_banana_mmap_unsetup()
-{
-    if (mmap_reg == NULL) {
-        syslog(LOG_ERR, "banana mmap: cannot unsetup NULLed mmap");
-        return MRAA_ERROR_INVALID_RESOURCE;
-    }
-    munmap(mmap_reg, mmap_size);
-    mmap_reg = NULL;
-    if (close(mmap_fd) != 0) {
-        return MRAA_ERROR_INVALID_RESOURCE;
-    }
-    return MRAA_SUCCESS;
-}
-
 mraa_result_t
 mraa_banana_mmap_setup(mraa_gpio_context dev, mraa_boolean_t en)
 {
@@ -151,49 +125,7 @@ mraa_banana_mmap_setup(mraa_gpio_context dev, mraa_boolean_t en)
         syslog(LOG_ERR, "Banana mmap: context not valid");
         return MRAA_ERROR_INVALID_HANDLE;
     }
-
-    if (en == 0) {
-        if (dev->mmap_write == NULL && dev->mmap_read == NULL) {
-            syslog(LOG_ERR, "Banana mmap: can't disable disabled mmap gpio");
-            return MRAA_ERROR_INVALID_PARAMETER;
-        }
-        dev->mmap_write = NULL;
-        dev->mmap_read = NULL;
-        mmap_count--;
-        if (mmap_count == 0) {
-            return mraa_banana_mmap_unsetup();
-        }
-        return MRAA_SUCCESS;
-    }
-
-    if (dev->mmap_write != NULL && dev->mmap_read != NULL) {
-        syslog(LOG_ERR, "Banana mmap: can't enable enabled mmap gpio");
-        return MRAA_ERROR_INVALID_PARAMETER;
-    }
-
-    // Might need to make some elements of this thread safe.
-    // For example only allow one thread to enter the following block
-    // to prevent mmap'ing twice.
-    if (mmap_reg == NULL) {
-        if ((mmap_fd = open(MMAP_PATH, O_RDWR)) < 0) {
-            syslog(LOG_ERR, "Banana mmap: unable to open /dev/mem file");
-            return MRAA_ERROR_INVALID_HANDLE;
-        }
-
-        mmap_reg = (uint8_t*) mmap(NULL, SUNXI_BLOCK_SIZE, PROT_READ | PROT_WRITE,
-                                   MAP_FILE | MAP_SHARED, mmap_fd, SUNXI_BASE);
-        if (mmap_reg == MAP_FAILED) {
-            syslog(LOG_ERR, "Banana mmap: failed to mmap");
-            mmap_reg = NULL;
-            close(mmap_fd);
-            return MRAA_ERROR_NO_RESOURCES;
-        }
-    }
-    dev->mmap_write = &mraa_banana_mmap_write;
-    dev->mmap_read = &mraa_banana_mmap_read;
-    mmap_count++;
-
-    return MRAA_SUCCESS;
+    return mraa_gpio_mmap_setup(&mmap_desc, dev, dev->pin, en);
 }
 
 mraa_board_t*
@@ -303,6 +235,7 @@ mraa_banana()
     b->adv_func->spi_init_pre = &mraa_banana_spi_init_pre;
     b->adv_func->i2c_init_pre = &mraa_banana_i2c_init_pre;
     b->adv_func->gpio_mmap_setup = &mraa_banana_mmap_setup;
+    b->adv_func->gpio_mmap_setup_multi = &mraa_gpio_mmap_setup_multi;
 
     strncpy(b->pins[0].name, "INVALID", MRAA_PIN_NAME_SIZE);
     b->pins[0].capabilites = (mraa_pincapabilities_t){ 0, 0, 0, 0, 0, 0, 0, 0 };
@@ -30,6 +30,7 @@
 
 #include "common.h"
 #include "arm/beaglebone.h"
+#include "gpio/gpio_mmap.h"
 
 #define NUM2STR(x) #x
 
@@ -52,56 +53,31 @@
 #define AM335X_GPIO2_BASE 0x481AC000
 #define AM335X_GPIO3_BASE 0x481AE000
 #define AM335X_GPIO_SIZE (4 * 1024)
+#define AM335X_OE 0x134
 #define AM335X_IN 0x138
+#define AM335X_OUT 0x13c
 #define AM335X_CLR 0x190
 #define AM335X_SET 0x194
 
-// MMAP
-static uint8_t* mmap_gpio[4] = { NULL, NULL, NULL, NULL };
-static int mmap_fd = 0;
-static unsigned int mmap_count = 0;
-
-mraa_result_t
-mraa_beaglebone_mmap_write(mraa_gpio_context dev, int value)
-{
-    if (value) {
-        *(volatile uint32_t*) (mmap_gpio[dev->pin / 32] + AM335X_SET) = (uint32_t)(1 << (dev->pin % 32));
-    } else {
-        *(volatile uint32_t*) (mmap_gpio[dev->pin / 32] + AM335X_CLR) = (uint32_t)(1 << (dev->pin % 32));
-    }
-    return MRAA_SUCCESS;
-}
-
-static mraa_result_t
-mraa_beaglebone_mmap_unsetup()
-{
-    if (mmap_gpio[0] == NULL) {
-        syslog(LOG_ERR, "beaglebone mmap: null register cant unsetup");
-        return MRAA_ERROR_INVALID_RESOURCE;
-    }
-    munmap(mmap_gpio[0], AM335X_GPIO_SIZE);
-    mmap_gpio[0] = NULL;
-    munmap(mmap_gpio[1], AM335X_GPIO_SIZE);
-    mmap_gpio[1] = NULL;
-    munmap(mmap_gpio[2], AM335X_GPIO_SIZE);
-    mmap_gpio[2] = NULL;
-    munmap(mmap_gpio[3], AM335X_GPIO_SIZE);
-    mmap_gpio[3] = NULL;
-    if (close(mmap_fd) != 0) {
-        return MRAA_ERROR_INVALID_RESOURCE;
-    }
-    return MRAA_SUCCESS;
-}
-
-int
-mraa_beaglebone_mmap_read(mraa_gpio_context dev)
-{
-    uint32_t value = *(volatile uint32_t*) (mmap_gpio[dev->pin / 32] + AM335X_IN);
-    if (value & (uint32_t)(1 << (dev->pin % 32))) {
-        return 1;
-    }
-    return 0;
-}
+// MMAP, the four gpio modules are separate blocks. OE is set for inputs
+static const off_t mmap_bank_base[] = { AM335X_GPIO0_BASE, AM335X_GPIO1_BASE, AM335X_GPIO2_BASE,
+                                        AM335X_GPIO3_BASE };
+static mraa_gpio_mmap_desc_t mmap_desc = {
+    .name = "beaglebone",
+    .path = MMAP_PATH,
+    .size = AM335X_GPIO_SIZE,
+    .bank_base = mmap_bank_base,
+    .num_banks = 4,
+    .pins_per_bank = 32,
+    .data_in = AM335X_IN,
+    .data_out = AM335X_OUT,
+    .set = AM335X_SET,
+    .clear = AM335X_CLR,
+    .dir = AM335X_OE,
+    .dir_bits = 1,
+    .dir_in = 1,
+    .dir_out = 0,
+};
 
 mraa_result_t
 mraa_beaglebone_mmap_setup(mraa_gpio_context dev, mraa_boolean_t en)
@@ -110,73 +86,7 @@ mraa_beaglebone_mmap_setup(mraa_gpio_context dev, mraa_boolean_t en)
         syslog(LOG_ERR, "beaglebone mmap: context not valid");
         return MRAA_ERROR_INVALID_HANDLE;
     }
-
-    if (en == 0) {
-        if (dev->mmap_write == NULL && dev->mmap_read == NULL) {
-            syslog(LOG_ERR, "beaglebone mmap: can't disable disabled mmap gpio");
-            return MRAA_ERROR_INVALID_PARAMETER;
-        }
-        dev->mmap_write = NULL;
-        dev->mmap_read = NULL;
-        mmap_count--;
-        if (mmap_count == 0) {
-            return mraa_beaglebone_mmap_unsetup();
-        }
-        return MRAA_SUCCESS;
-    }
-
-    if (dev->mmap_write != NULL && dev->mmap_read != NULL) {
-        syslog(LOG_ERR, "beaglebone mmap: can't enable enabled mmap gpio");
-        return MRAA_ERROR_INVALID_PARAMETER;
-    }
-
-    // Might need to make some elements of this thread safe.
-    // For example only allow one thread to enter the following block
-    // to prevent mmap'ing twice.
-    if (mmap_gpio[0] == NULL) {
-        if ((mmap_fd = open(MMAP_PATH, O_RDWR)) < 0) {
-            syslog(LOG_ERR, "beaglebone map: unable to open resource0 file");
-            return MRAA_ERROR_INVALID_HANDLE;
-        }
-
-        mmap_gpio[0] = (uint8_t*) mmap(NULL, AM335X_GPIO_SIZE, PROT_READ | PROT_WRITE,
-                                       MAP_FILE | MAP_SHARED, mmap_fd, AM335X_GPIO0_BASE);
-        if (mmap_gpio[0] == MAP_FAILED) {
-            syslog(LOG_ERR, "beaglebone mmap: failed to mmap");
-            mmap_gpio[0] = NULL;
-            close(mmap_fd);
-            return MRAA_ERROR_NO_RESOURCES;
-        }
-        mmap_gpio[1] = (uint8_t*) mmap(NULL, AM335X_GPIO_SIZE, PROT_READ | PROT_WRITE,
-                                       MAP_FILE | MAP_SHARED, mmap_fd, AM335X_GPIO1_BASE);
-        if (mmap_gpio[1] == MAP_FAILED) {
-            syslog(LOG_ERR, "beaglebone mmap: failed to mmap");
-            mmap_gpio[1] = NULL;
-            close(mmap_fd);
-            return MRAA_ERROR_NO_RESOURCES;
-        }
-        mmap_gpio[2] = (uint8_t*) mmap(NULL, AM335X_GPIO_SIZE, PROT_READ | PROT_WRITE,
-                                       MAP_FILE | MAP_SHARED, mmap_fd, AM335X_GPIO2_BASE);
-        if (mmap_gpio[2] == MAP_FAILED) {
-            syslog(LOG_ERR, "beaglebone mmap: failed to mmap");
-            mmap_gpio[2] = NULL;
-            close(mmap_fd);
-            return MRAA_ERROR_NO_RESOURCES;
-        }
-        mmap_gpio[3] = (uint8_t*) mmap(NULL, AM335X_GPIO_SIZE, PROT_READ | PROT_WRITE,
-                                       MAP_FILE | MAP_SHARED, mmap_fd, AM335X_GPIO3_BASE);
-        if (mmap_gpio[3] == MAP_FAILED) {
-            syslog(LOG_ERR, "beaglebone mmap: failed to mmap");
-            mmap_gpio[3] = NULL;
-            close(mmap_fd);
-            return MRAA_ERROR_NO_RESOURCES;
-        }
-    }
-    dev->mmap_write = &mraa_beaglebone_mmap_write;
-    dev->mmap_read = &mraa_beaglebone_mmap_read;
-    mmap_count++;
-
-    return MRAA_SUCCESS;
+    return mraa_gpio_mmap_setup(&mmap_desc, dev, dev->pin, en);
 }
 
 mraa_result_t
@@ -523,6 +433,8 @@ mraa_beaglebone()
     b->adv_func->spi_init_pre = &mraa_beaglebone_spi_init_pre;
     b->adv_func->i2c_init_pre = &mraa_beaglebone_i2c_init_pre;
     b->adv_func->pwm_init_replace = &mraa_beaglebone_pwm_init_replace;
+    b->adv_func->gpio_mmap_setup = &mraa_beaglebone_mmap_setup;
+    b->adv_func->gpio_mmap_setup_multi = &mraa_gpio_mmap_setup_multi;
 
     strncpy(b->pins[0].name, "INVALID", MRAA_PIN_NAME_SIZE);
     b->pins[0].capabilites = (mraa_pincapabilities_t){ 0, 0, 0, 0, 0, 0, 0, 0 };
@@ -30,6 +30,8 @@
 
 #include "common.h"
 #include "arm/raspberry_pi.h"
+#include "gpio/gpio_chardev.h"
+#include "gpio/gpio_mmap.h"
 
 #define PLATFORM_NAME_RASPBERRY_PI_B_REV_1 "Raspberry Pi Model B Rev 1"
 #define PLATFORM_NAME_RASPBERRY_PI_A_REV_2 "Raspberry Pi Model A Rev 2"
@@ -52,16 +54,30 @@
 #define BCM2836_GPIO_BASE (BCM2836_PERI_BASE + 0x200000)
 #define BCM2835_BLOCK_SIZE (4 * 1024)
 #define BCM2836_BLOCK_SIZE (4 * 1024)
+#define BCM283X_GPFSEL0 0x0000
 #define BCM283X_GPSET0 0x001c
 #define BCM283X_GPCLR0 0x0028
 #define BCM2835_GPLEV0 0x0034
 #define MAX_SIZE 64
 
-// MMAP
-static uint8_t* mmap_reg = NULL;
-static int mmap_fd = 0;
-static int mmap_size;
-static unsigned int mmap_count = 0;
+// MMAP, base is filled in once the SoC is known
+static mraa_gpio_mmap_desc_t mmap_desc = {
+    .name = "raspberry",
+    .path = MMAP_PATH,
+    .size = BCM2835_BLOCK_SIZE,
+    .num_banks = 2,
+    .pins_per_bank = 32,
+    .bank_stride = sizeof(uint32_t),
+    .data_in = BCM2835_GPLEV0,
+    .data_out = MRAA_GPIO_MMAP_NONE,
+    .set = BCM283X_GPSET0,
+    .clear = BCM283X_GPCLR0,
+    .dir = BCM283X_GPFSEL0,
+    .dir_bits = 3,
+    .dir_in = 0,
+    .dir_out = 1,
+    .dir_global = 1,
+};
 static int platform_detected = 0;
 
 mraa_result_t
@@ -109,45 +125,6 @@ mraa_raspberry_pi_i2c_init_pre(unsigned int bus)
     return MRAA_SUCCESS;
 }
 
-mraa_result_t
-mraa_raspberry_pi_mmap_write(mraa_gpio_context dev, int value)
-{
-    volatile uint32_t* addr;
-    if (value) {
-        *(volatile uint32_t*) (mmap_reg + BCM283X_GPSET0 + (dev->pin / 32) * 4) =
-        (uint32_t)(1 << (dev->pin % 32));
-    } else {
-        *(volatile uint32_t*) (mmap_reg + BCM283X_GPCLR0 + (dev->pin / 32) * 4) =
-        (uint32_t)(1 << (dev->pin % 32));
-    }
-    return MRAA_SUCCESS;
-}
-
-static mraa_result_t
-mraa_raspberry_pi_mmap_unsetup()
-{
-    if (mmap_reg == NULL) {
-        syslog(LOG_ERR, "raspberry mmap: null register cant unsetup");
-        return MRAA_ERROR_INVALID_RESOURCE;
-    }
-    munmap(mmap_reg, mmap_size);
-    mmap_reg = NULL;
-    if (close(mmap_fd) != 0) {
-        return MRAA_ERROR_INVALID_RESOURCE;
-    }
-    return MRAA_SUCCESS;
-}
-
-int
-mraa_raspberry_pi_mmap_read(mraa_gpio_context dev)
-{
-    uint32_t value = *(volatile uint32_t*) (mmap_reg + BCM2835_GPLEV0 + (dev->pin / 32) * 4);
-    if (value & (uint32_t)(1 << (dev->pin % 32))) {
-        return 1;
-    }
-    return 0;
-}
-
 mraa_result_t
 mraa_raspberry_pi_mmap_setup(mraa_gpio_context dev, mraa_boolean_t en)
 {
@@ -155,54 +132,7 @@ mraa_raspberry_pi_mmap_setup(mraa_gpio_context dev, mraa_boolean_t en)
         syslog(LOG_ERR, "raspberry mmap: context not valid");
         return MRAA_ERROR_INVALID_HANDLE;
     }
-
-    if (en == 0) {
-        if (dev->mmap_write == NULL && dev->mmap_read == NULL) {
-            syslog(LOG_ERR, "raspberry mmap: can't disable disabled mmap gpio");
-            return MRAA_ERROR_INVALID_PARAMETER;
-        }
-        dev->mmap_write = NULL;
-        dev->mmap_read = NULL;
-        mmap_count--;
-        if (mmap_count == 0) {
-            return mraa_raspberry_pi_mmap_unsetup();
-        }
-        return MRAA_SUCCESS;
-    }
-
-    if (dev->mmap_write != NULL && dev->mmap_read != NULL) {
-        syslog(LOG_ERR, "raspberry mmap: can't enable enabled mmap gpio");
-        return MRAA_ERROR_INVALID_PARAMETER;
-    }
-
-    // Might need to make some elements of this thread safe.
-    // For example only allow one thread to enter the following block
-    // to prevent mmap'ing twice.
-    if (mmap_reg == NULL) {
-        if ((mmap_fd = open(MMAP_PATH, O_RDWR)) < 0) {
-            syslog(LOG_ERR, "raspberry map: unable to open resource0 file");
-            return MRAA_ERROR_INVALID_HANDLE;
-        }
-
-        if (platform_detected == PLATFORM_RASPBERRY_PI2_B_REV_1) {
-            mmap_reg = (uint8_t*) mmap(NULL, BCM2836_BLOCK_SIZE, PROT_READ | PROT_WRITE,
-                                       MAP_FILE | MAP_SHARED, mmap_fd, BCM2836_GPIO_BASE);
-        } else {
-            mmap_reg = (uint8_t*) mmap(NULL, BCM2835_BLOCK_SIZE, PROT_READ | PROT_WRITE,
-                                       MAP_FILE | MAP_SHARED, mmap_fd, BCM2835_GPIO_BASE);
-        }
-        if (mmap_reg == MAP_FAILED) {
-            syslog(LOG_ERR, "raspberry mmap: failed to mmap");
-            mmap_reg = NULL;
-            close(mmap_fd);
-            return MRAA_ERROR_NO_RESOURCES;
-        }
-    }
-    dev->mmap_write = &mraa_raspberry_pi_mmap_write;
-    dev->mmap_read = &mraa_raspberry_pi_mmap_read;
-    mmap_count++;
-
-    return MRAA_SUCCESS;
+    return mraa_gpio_mmap_setup(&mmap_desc, dev, dev->pin, en);
 }
 
 mraa_board_t*
@@ -273,6 +203,7 @@ mraa_raspberry_pi()
         syslog(LOG_ERR, "raspberrypi: Failed to detect platform revision");
         return NULL;
     }
+    mmap_desc.base = platform_detected == PLATFORM_RASPBERRY_PI2_B_REV_1 ? BCM2836_GPIO_BASE : BCM2835_GPIO_BASE;
 
     b->adv_func = (mraa_adv_func_t*) calloc(1, sizeof(mraa_adv_func_t));
     if (b->adv_func == NULL) {
@@ -290,6 +221,8 @@ mraa_raspberry_pi()
     b->adv_func->spi_init_pre = &mraa_raspberry_pi_spi_init_pre;
     b->adv_func->i2c_init_pre = &mraa_raspberry_pi_i2c_init_pre;
     b->adv_func->gpio_mmap_setup = &mraa_raspberry_pi_mmap_setup;
+    b->adv_func->gpio_mmap_setup_multi = &mraa_gpio_mmap_setup_multi;
+    b->adv_func->gpio_chardev_lookup = &mraa_gpio_chardev_lookup_sysfs;
 
     strncpy(b->pins[0].name, "INVALID", MRAA_PIN_NAME_SIZE);
     b->pins[0].capabilites = (mraa_pincapabilities_t){ 0, 0, 0, 0, 0, 0, 0, 0 };
@@ -444,6 +444,16 @@ mraa_firmata_gpio_wait_interrupt_replace(mraa_gpio_context dev)
     return MRAA_SUCCESS;
 }
 
+static mraa_boolean_t
+mraa_firmata_gpio_interrupt_pending_replace(mraa_gpio_context dev)
+{
+    if (!((isr_detected >> dev->pin) & 1)) {
+        return 0;
+    }
+    isr_detected &= ~(1 << dev->pin);
+    return 1;
+}
+
 static mraa_result_t
 mraa_firmata_gpio_close_replace(mraa_gpio_context dev)
 {
@@ -545,7 +555,7 @@ mraa_firmata_plat_init(const char* uart_dev)
 	return NULL;
     }
 
-    pthread_create(&thread_id, NULL, mraa_firmata_pull_handler, NULL);
+    mraa_thread_create(&thread_id, NULL, mraa_firmata_pull_handler, NULL);
 
     b->platform_name = "firmata";
     // do we support 2.5? Or are we more 2.3?
@@ -647,6 +657,7 @@ mraa_firmata_plat_init(const char* uart_dev)
     b->adv_func->gpio_edge_mode_replace = &mraa_firmata_gpio_edge_mode_replace;
     b->adv_func->gpio_interrupt_handler_init_replace = &mraa_firmata_gpio_interrupt_handler_init_replace;
     b->adv_func->gpio_wait_interrupt_replace = &mraa_firmata_gpio_wait_interrupt_replace;
+    b->adv_func->gpio_interrupt_pending_replace = &mraa_firmata_gpio_interrupt_pending_replace;
     b->adv_func->gpio_read_replace = &mraa_firmata_gpio_read_replace;
     b->adv_func->gpio_write_replace = &mraa_firmata_gpio_write_replace;
     b->adv_func->gpio_close_replace = &mraa_firmata_gpio_close_replace;
@@ -24,6 +24,11 @@
  */
 #include "gpio.h"
 #include "mraa_internal.h"
+#include "gpio/gpio_chardev.h"
+#include "gpio/gpio_dispatch.h"
+#include "gpio/gpio_events.h"
+#include "mraa_stats.h"
+#include "mraa_trace.h"
 
 #include <stdlib.h>
 #include <fcntl.h>
@@ -35,25 +40,57 @@
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <errno.h>
+#include <time.h>
 
 #define SYSFS_CLASS_GPIO "/sys/class/gpio"
 #define MAX_SIZE 64
 #define POLL_TIMEOUT
 
+// what a write of 0 or non zero puts in the sysfs value file
+static const char gpio_levels[2] = { '0', '1' };
+
 static mraa_result_t
 mraa_gpio_get_valfp(mraa_gpio_context dev)
 {
-    char bu[MAX_SIZE];
-    sprintf(bu, SYSFS_CLASS_GPIO "/gpio%d/value", dev->pin);
+    char bu[MRAA_FS_PATH_MAX];
+    mraa_fs_path(bu, sizeof(bu), SYSFS_CLASS_GPIO "/gpio%d/value", dev->pin);
     dev->value_fp = open(bu, O_RDWR);
+    MRAA_STATS_REOPEN(dev);
     if (dev->value_fp == -1) {
-        syslog(LOG_ERR, "gpio%i: Failed to open 'value': %s", dev->pin, strerror(errno));
+        mraa_trace(LOG_ERR, MRAA_TRACE_GPIO_OPEN_VALUE, dev->pin, errno);
         return MRAA_ERROR_INVALID_RESOURCE;
     }
 
     return MRAA_SUCCESS;
 }
 
+/**
+ * Lazily open a sysfs attribute of dev and keep it open for the lifetime of
+ * the context, saves a path build, an open and a close per access.
+ */
+static int
+mraa_gpio_get_attr_fp(mraa_gpio_context dev, int* fp, const char* attr, int flags)
+{
+    if (*fp == -1) {
+        char bu[MRAA_FS_PATH_MAX];
+        mraa_fs_path(bu, sizeof(bu), SYSFS_CLASS_GPIO "/gpio%d/%s", dev->pin, attr);
+        *fp = open(bu, flags | O_CLOEXEC);
+        MRAA_STATS_REOPEN(dev);
+    }
+    return *fp;
+}
+
+static void
+mraa_gpio_close_attr_fp(int* fp)
+{
+    if (*fp != -1) {
+        close(*fp);
+        *fp = -1;
+    }
+}
+
+static void mraa_gpio_release(mraa_gpio_context dev);
+
 static mraa_gpio_context
 mraa_gpio_init_internal(mraa_adv_func_t* func_table, int pin)
 {
@@ -72,6 +109,10 @@ mraa_gpio_init_internal(mraa_adv_func_t* func_table, int pin)
 
     dev->advance_func = func_table;
     dev->pin = pin;
+    dev->line_fd = -1;
+    dev->dir_fp = -1;
+    dev->edge_fp = -1;
+    dev->drive_fp = -1;
 
     if (IS_FUNC_DEFINED(dev, gpio_init_internal_replace)) {
         status = dev->advance_func->gpio_init_internal_replace(dev, pin);
@@ -95,14 +136,25 @@ mraa_gpio_init_internal(mraa_adv_func_t* func_table, int pin)
     dev->isr_thread_terminating = 0;
     dev->phy_pin = -1;
 
+    // platforms that know their gpiochip layout skip sysfs entirely
+    if (IS_FUNC_DEFINED(dev, gpio_chardev_lookup)) {
+        unsigned int chip, line;
+        if (dev->advance_func->gpio_chardev_lookup(pin, &chip, &line) == MRAA_SUCCESS &&
+            mraa_gpio_chardev_request(dev, chip, line) == MRAA_SUCCESS) {
+            dev->owner = 1;
+            return dev;
+        }
+        syslog(LOG_NOTICE, "gpio%i: init: gpiochip unavailable, falling back to sysfs", pin);
+    }
+
     // then check to make sure the pin is exported.
-    char directory[MAX_SIZE];
-    snprintf(directory, MAX_SIZE, SYSFS_CLASS_GPIO "/gpio%d/", dev->pin);
+    char directory[MRAA_FS_PATH_MAX];
+    mraa_fs_path(directory, sizeof(directory), SYSFS_CLASS_GPIO "/gpio%d/", dev->pin);
     struct stat dir;
     if (stat(directory, &dir) == 0 && S_ISDIR(dir.st_mode)) {
         dev->owner = 0; // Not Owner
     } else {
-        int export = open(SYSFS_CLASS_GPIO "/export", O_WRONLY);
+        int export = mraa_fs_open(SYSFS_CLASS_GPIO "/export", O_WRONLY);
         if (export == -1) {
             syslog(LOG_ERR, "gpio%i: init: Failed to open 'export' for writing: %s", pin, strerror(errno));
             status = MRAA_ERROR_INVALID_RESOURCE;
@@ -172,7 +224,11 @@ mraa_gpio_init(int pin)
     if (IS_FUNC_DEFINED(r, gpio_init_post)) {
         mraa_result_t ret = r->advance_func->gpio_init_post(r);
         if (ret != MRAA_SUCCESS) {
-            free(r);
+            if (IS_FUNC_DEFINED(r, gpio_close_replace)) {
+                r->advance_func->gpio_close_replace(r);
+            } else {
+                mraa_gpio_release(r);
+            }
             return NULL;
         }
     }
@@ -187,7 +243,7 @@ mraa_gpio_init_raw(int pin)
 
 
 static mraa_result_t
-mraa_gpio_wait_interrupt(int fd
+mraa_gpio_wait_interrupt(mraa_gpio_context dev, int fd
 #ifndef HAVE_PTHREAD_CANCEL
         , int control_fd
 #endif
@@ -230,11 +286,70 @@ mraa_gpio_wait_interrupt(int fd
 #endif
 
     // do a final read to clear interrupt
-    read(fd, &c, 1);
+    lseek(fd, 0, SEEK_SET);
+    if (read(fd, &c, 1) == 1 && MRAA_GPIO_EVENTS_WANTED(dev)) {
+        mraa_gpio_event_push_now(dev, c == '1' ? MRAA_GPIO_EDGE_RISING : MRAA_GPIO_EDGE_FALLING);
+    }
 
     return MRAA_SUCCESS;
 }
 
+uint64_t
+mraa_gpio_isr_now()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+mraa_boolean_t
+mraa_gpio_isr_rate_ok(mraa_gpio_context dev)
+{
+    if (dev->isr_min_interval_ns != 0) {
+        uint64_t now = mraa_gpio_isr_now();
+        if (dev->isr_last_call_ns != 0 && now - dev->isr_last_call_ns < dev->isr_min_interval_ns) {
+            return 0;
+        }
+        dev->isr_last_call_ns = now;
+    }
+    return 1;
+}
+
+/**
+ * Wait for the line to stay quiet for the debounce time, every bounce is
+ * acknowledged and restarts the wait. Runs in the interrupt thread so a
+ * bouncing contact costs wakeups of that thread only, never callbacks.
+ */
+static void
+mraa_gpio_isr_settle(mraa_gpio_context dev)
+{
+    struct pollfd pfd;
+    unsigned char c;
+    int timeout_ms = (int) ((dev->isr_debounce_ns + 999999) / 1000000);
+
+    if (dev->isr_value_fp == -1) {
+        // the platform waits for us, nothing to watch, hold off instead
+        struct timespec ts;
+        ts.tv_sec = dev->isr_debounce_ns / 1000000000ULL;
+        ts.tv_nsec = dev->isr_debounce_ns % 1000000000ULL;
+        nanosleep(&ts, NULL);
+        return;
+    }
+
+    pfd.fd = dev->isr_value_fp;
+    pfd.events = dev->line_fd != -1 ? POLLIN : POLLPRI;
+    while (!dev->isr_thread_terminating && poll(&pfd, 1, timeout_ms) > 0) {
+        if (dev->line_fd != -1) {
+            if (mraa_gpio_chardev_read_events(dev, dev->isr_value_fp) != MRAA_SUCCESS) {
+                return;
+            }
+        } else if (pread(dev->isr_value_fp, &c, 1, 0) == 1 && MRAA_GPIO_EVENTS_WANTED(dev)) {
+            mraa_gpio_event_push_now(dev, c == '1' ? MRAA_GPIO_EDGE_RISING : MRAA_GPIO_EDGE_FALLING);
+        }
+    }
+}
+
 static void*
 mraa_gpio_interrupt_handler(void* arg)
 {
@@ -245,10 +360,17 @@ mraa_gpio_interrupt_handler(void* arg)
     if (IS_FUNC_DEFINED(dev, gpio_interrupt_handler_init_replace)) {
         if (dev->advance_func->gpio_interrupt_handler_init_replace(dev) != MRAA_SUCCESS)
             return NULL;
+    } else if (dev->line_fd != -1) {
+        // keep our own handle so isr_exit can close it without dropping the line
+        fp = dup(dev->line_fd);
+        if (fp < 0) {
+            syslog(LOG_ERR, "gpio%i: interrupt_handler: failed to dup line fd : %s", dev->pin, strerror(errno));
+            return NULL;
+        }
     } else {
         // open gpio value with open(3)
-        char bu[MAX_SIZE];
-        sprintf(bu, SYSFS_CLASS_GPIO "/gpio%d/value", dev->pin);
+        char bu[MRAA_FS_PATH_MAX];
+        mraa_fs_path(bu, sizeof(bu), SYSFS_CLASS_GPIO "/gpio%d/value", dev->pin);
         fp = open(bu, O_RDONLY);
         if (fp < 0) {
             syslog(LOG_ERR, "gpio%i: interrupt_handler: failed to open 'value' : %s", dev->pin, strerror(errno));
@@ -279,18 +401,32 @@ mraa_gpio_interrupt_handler(void* arg)
     for (;;) {
         if (IS_FUNC_DEFINED(dev, gpio_wait_interrupt_replace)) {
             ret = dev->advance_func->gpio_wait_interrupt_replace(dev);
+            if (ret == MRAA_SUCCESS && !dev->isr_thread_terminating && MRAA_GPIO_EVENTS_WANTED(dev)) {
+                mraa_gpio_event_push_now(dev, MRAA_GPIO_EDGE_BOTH);
+            }
+        } else if (dev->line_fd != -1) {
+#ifdef HAVE_PTHREAD_CANCEL
+            ret = mraa_gpio_chardev_wait_interrupt(dev, dev->isr_value_fp, -1);
+#else
+            ret = mraa_gpio_chardev_wait_interrupt(dev, dev->isr_value_fp, dev->isr_control_pipe[0]);
+#endif
         } else {
-            ret = mraa_gpio_wait_interrupt(dev->isr_value_fp
+            ret = mraa_gpio_wait_interrupt(dev, dev->isr_value_fp
 #ifndef HAVE_PTHREAD_CANCEL
                 , dev->isr_control_pipe[0]
 #endif
                 );
         }
         if (ret == MRAA_SUCCESS && !dev->isr_thread_terminating) {
+            if (dev->isr_debounce_ns != 0 && dev->isr != NULL) {
+                mraa_gpio_isr_settle(dev);
+            }
 #ifdef HAVE_PTHREAD_CANCEL
             pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
 #endif
-            if (lang_func->python_isr != NULL) {
+            if (dev->isr == NULL || !mraa_gpio_isr_rate_ok(dev)) {
+                // event ring only, the wait already recorded the edge, or filtered out
+            } else if (lang_func->python_isr != NULL) {
                 lang_func->python_isr(dev->isr, dev->isr_args);
             } else {
                 dev->isr(dev->isr_args);
@@ -331,15 +467,10 @@ mraa_gpio_edge_mode(mraa_gpio_context dev, mraa_gpio_edge_t mode)
    if (IS_FUNC_DEFINED(dev, gpio_edge_mode_replace))
         return dev->advance_func->gpio_edge_mode_replace(dev, mode);
 
-    if (dev->value_fp != -1) {
-        close(dev->value_fp);
-        dev->value_fp = -1;
-    }
-
-    char filepath[MAX_SIZE];
-    snprintf(filepath, MAX_SIZE, SYSFS_CLASS_GPIO "/gpio%d/edge", dev->pin);
+    if (dev->line_fd != -1)
+        return mraa_gpio_chardev_edge_mode(dev, mode);
 
-    int edge = open(filepath, O_RDWR);
+    int edge = mraa_gpio_get_attr_fp(dev, &dev->edge_fp, "edge", O_RDWR);
     if (edge == -1) {
         syslog(LOG_ERR, "gpio%i: edge_mode: Failed to open 'edge' for writing: %s", dev->pin, strerror(errno));
         return MRAA_ERROR_INVALID_RESOURCE;
@@ -361,16 +492,13 @@ mraa_gpio_edge_mode(mraa_gpio_context dev, mraa_gpio_edge_t mode)
             length = snprintf(bu, sizeof(bu), "falling");
             break;
         default:
-            close(edge);
             return MRAA_ERROR_FEATURE_NOT_IMPLEMENTED;
     }
-    if (write(edge, bu, length * sizeof(char)) == -1) {
+    if (pwrite(edge, bu, length * sizeof(char), 0) == -1) {
         syslog(LOG_ERR, "gpio%i: edge_mode: Failed to write to 'edge': %s", dev->pin, strerror(errno));
-        close(edge);
         return MRAA_ERROR_UNSPECIFIED;
     }
 
-    close(edge);
     return MRAA_SUCCESS;
 }
 
@@ -383,7 +511,7 @@ mraa_gpio_isr(mraa_gpio_context dev, mraa_gpio_edge_t mode, void (*fptr)(void*),
     }
 
     // we only allow one isr per mraa_gpio_context
-    if (dev->thread_id != 0) {
+    if (dev->thread_id != 0 || dev->isr_entry != NULL) {
         return MRAA_ERROR_NO_RESOURCES;
     }
 
@@ -403,8 +531,62 @@ mraa_gpio_isr(mraa_gpio_context dev, mraa_gpio_edge_t mode, void (*fptr)(void*),
     }
 
     dev->isr_args = args;
-    pthread_create(&dev->thread_id, NULL, mraa_gpio_interrupt_handler, (void*) dev);
 
+    if (mraa_gpio_dispatch_active()) {
+        ret = mraa_gpio_dispatch_add(dev);
+        if (ret == MRAA_SUCCESS) {
+            return MRAA_SUCCESS;
+        }
+        syslog(LOG_NOTICE, "gpio%i: isr: not dispatchable, using a dedicated thread", dev->pin);
+    }
+    if (mraa_thread_create(&dev->thread_id, dev->thread_attr, mraa_gpio_interrupt_handler, (void*) dev) != 0) {
+        syslog(LOG_ERR, "gpio%i: isr: failed to create interrupt thread", dev->pin);
+        dev->thread_id = 0;
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_thread_attr(mraa_gpio_context dev, const mraa_thread_attr_t* attr)
+{
+    if (dev == NULL) {
+        syslog(LOG_ERR, "gpio: thread_attr: context is invalid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+
+    if (attr == NULL) {
+        free(dev->thread_attr);
+        dev->thread_attr = NULL;
+        return MRAA_SUCCESS;
+    }
+    if (dev->thread_attr == NULL) {
+        dev->thread_attr = (mraa_thread_attr_t*) malloc(sizeof(mraa_thread_attr_t));
+        if (dev->thread_attr == NULL) {
+            syslog(LOG_CRIT, "gpio%i: thread_attr: Failed to allocate memory for attributes", dev->pin);
+            return MRAA_ERROR_NO_RESOURCES;
+        }
+    }
+    *dev->thread_attr = *attr;
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_isr_options(mraa_gpio_context dev, const mraa_gpio_isr_options_t* options)
+{
+    if (dev == NULL) {
+        syslog(LOG_ERR, "gpio: isr_options: context is invalid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+
+    if (options == NULL) {
+        dev->isr_debounce_ns = 0;
+        dev->isr_min_interval_ns = 0;
+    } else {
+        dev->isr_debounce_ns = (uint64_t) options->debounce_us * 1000;
+        dev->isr_min_interval_ns = (uint64_t) options->min_interval_us * 1000;
+    }
     return MRAA_SUCCESS;
 }
 
@@ -418,12 +600,24 @@ mraa_gpio_isr_exit(mraa_gpio_context dev)
     }
 
     // wasting our time, there is no isr to exit from
-    if (dev->thread_id == 0 && dev->isr_value_fp == -1) {
+    if (dev->thread_id == 0 && dev->isr_value_fp == -1 && dev->isr_entry == NULL) {
         return ret;
     }
     // mark the beginning of the thread termination process for interested parties
     dev->isr_thread_terminating = 1;
 
+    if (dev->isr_entry != NULL) {
+        ret = mraa_gpio_edge_mode(dev, MRAA_GPIO_EDGE_NONE);
+        if (mraa_gpio_dispatch_remove(dev) != MRAA_SUCCESS) {
+            ret = MRAA_ERROR_INVALID_RESOURCE;
+        }
+        if (lang_func->java_delete_global_ref != NULL && dev->isr == lang_func->java_isr_callback) {
+            lang_func->java_delete_global_ref(dev->isr_args);
+        }
+        dev->isr_thread_terminating = 0;
+        return ret;
+    }
+
     // stop isr being useful
     ret = mraa_gpio_edge_mode(dev, MRAA_GPIO_EDGE_NONE);
 
@@ -473,15 +667,14 @@ mraa_gpio_mode(mraa_gpio_context dev, mraa_gpio_mode_t mode)
             return pre_ret;
     }
 
-    if (dev->value_fp != -1) {
-        close(dev->value_fp);
-        dev->value_fp = -1;
+    if (dev->line_fd != -1) {
+        mraa_result_t ret = mraa_gpio_chardev_mode(dev, mode);
+        if (ret == MRAA_SUCCESS && IS_FUNC_DEFINED(dev, gpio_mode_post))
+            return dev->advance_func->gpio_mode_post(dev, mode);
+        return ret;
     }
 
-    char filepath[MAX_SIZE];
-    snprintf(filepath, MAX_SIZE, SYSFS_CLASS_GPIO "/gpio%d/drive", dev->pin);
-
-    int drive = open(filepath, O_WRONLY);
+    int drive = mraa_gpio_get_attr_fp(dev, &dev->drive_fp, "drive", O_WRONLY);
     if (drive == -1) {
         syslog(LOG_ERR, "gpio%i: mode: Failed to open 'drive' for writing: %s", dev->pin, strerror(errno));
         return MRAA_ERROR_INVALID_RESOURCE;
@@ -503,16 +696,13 @@ mraa_gpio_mode(mraa_gpio_context dev, mraa_gpio_mode_t mode)
             length = snprintf(bu, sizeof(bu), "hiz");
             break;
         default:
-            close(drive);
             return MRAA_ERROR_FEATURE_NOT_IMPLEMENTED;
     }
-    if (write(drive, bu, length * sizeof(char)) == -1) {
+    if (pwrite(drive, bu, length * sizeof(char), 0) == -1) {
         syslog(LOG_ERR, "gpio%i: mode: Failed to write to 'drive': %s", dev->pin, strerror(errno));
-       close(drive);
         return MRAA_ERROR_INVALID_RESOURCE;
     }
 
-    close(drive);
     if (IS_FUNC_DEFINED(dev, gpio_mode_post))
         return dev->advance_func->gpio_mode_post(dev, mode);
     return MRAA_SUCCESS;
@@ -537,14 +727,22 @@ mraa_gpio_dir(mraa_gpio_context dev, mraa_gpio_dir_t dir)
         }
     }
 
-    if (dev->value_fp != -1) {
-        close(dev->value_fp);
-        dev->value_fp = -1;
+    if (dev->mmap_dir != NULL) {
+        mraa_result_t ret = dev->mmap_dir(dev, dir);
+        if (ret == MRAA_SUCCESS && IS_FUNC_DEFINED(dev, gpio_dir_post))
+            return dev->advance_func->gpio_dir_post(dev, dir);
+        return ret;
+    }
+
+    if (dev->line_fd != -1) {
+        mraa_result_t ret = mraa_gpio_chardev_dir(dev, dir);
+        if (ret == MRAA_SUCCESS && IS_FUNC_DEFINED(dev, gpio_dir_post))
+            return dev->advance_func->gpio_dir_post(dev, dir);
+        return ret;
     }
-    char filepath[MAX_SIZE];
-    snprintf(filepath, MAX_SIZE, SYSFS_CLASS_GPIO "/gpio%d/direction", dev->pin);
 
-    int direction = open(filepath, O_RDWR);
+    // the value fd stays valid across direction changes, keep it open
+    int direction = mraa_gpio_get_attr_fp(dev, &dev->dir_fp, "direction", O_RDWR);
 
     if (direction == -1) {
         // Direction Failed to Open. If HIGH or LOW was passed will try and set
@@ -576,17 +774,14 @@ mraa_gpio_dir(mraa_gpio_context dev, mraa_gpio_dir_t dir)
             length = snprintf(bu, sizeof(bu), "low");
             break;
         default:
-            close(direction);
             return MRAA_ERROR_FEATURE_NOT_IMPLEMENTED;
     }
 
-    if (write(direction, bu, length * sizeof(char)) == -1) {
-        close(direction);
+    if (pwrite(direction, bu, length * sizeof(char), 0) == -1) {
         syslog(LOG_ERR, "gpio%i: dir: Failed to write to 'direction': %s", dev->pin, strerror(errno));
         return MRAA_ERROR_UNSPECIFIED;
     }
 
-    close(direction);
     if (IS_FUNC_DEFINED(dev, gpio_dir_post))
         return dev->advance_func->gpio_dir_post(dev, dir);
     return MRAA_SUCCESS;
@@ -596,8 +791,8 @@ mraa_result_t
 mraa_gpio_read_dir(mraa_gpio_context dev, mraa_gpio_dir_t *dir)
 {
     char value[5];
-    char filepath[MAX_SIZE];
     int fd, rc;
+    int ro_fd = -1;
     mraa_result_t result = MRAA_SUCCESS;
 
     if (dev == NULL) {
@@ -605,22 +800,30 @@ mraa_gpio_read_dir(mraa_gpio_context dev, mraa_gpio_dir_t *dir)
         return MRAA_ERROR_INVALID_HANDLE;
     }
 
-    snprintf(filepath, MAX_SIZE, SYSFS_CLASS_GPIO "/gpio%d/direction", dev->pin);
-    fd = open(filepath, O_RDONLY);
+    if (dev->mmap_read_dir != NULL && dev->mmap_read_dir(dev, dir) == MRAA_SUCCESS)
+        return MRAA_SUCCESS;
+
+    if (dev->line_fd != -1)
+        return mraa_gpio_chardev_read_dir(dev, dir);
+
+    fd = mraa_gpio_get_attr_fp(dev, &dev->dir_fp, "direction", O_RDWR);
+    if (fd == -1 && errno == EACCES) {
+        // direction may only be readable to us, read it without caching
+        char bu[MRAA_FS_PATH_MAX];
+        mraa_fs_path(bu, sizeof(bu), SYSFS_CLASS_GPIO "/gpio%d/direction", dev->pin);
+        fd = ro_fd = open(bu, O_RDONLY | O_CLOEXEC);
+    }
     if (fd == -1) {
         syslog(LOG_ERR, "gpio%i: read_dir: Failed to open 'direction' for reading: %s", dev->pin, strerror(errno));
         return MRAA_ERROR_INVALID_RESOURCE;
     }
 
     memset(value, '\0', sizeof(value));
-    rc = read(fd, value, sizeof(value));
-    close(fd);
+    rc = pread(fd, value, sizeof(value) - 1, 0);
     if (rc <= 0) {
         syslog(LOG_ERR, "gpio%i: read_dir: Failed to read 'direction': %s", dev->pin, strerror(errno));
-        return MRAA_ERROR_INVALID_RESOURCE;
-    }
-
-    if (strcmp(value, "out\n") == 0) {
+        result = MRAA_ERROR_INVALID_RESOURCE;
+    } else if (strcmp(value, "out\n") == 0) {
         *dir = MRAA_GPIO_OUT;
     } else if (strcmp(value, "in\n") == 0) {
         *dir = MRAA_GPIO_IN;
@@ -629,11 +832,14 @@ mraa_gpio_read_dir(mraa_gpio_context dev, mraa_gpio_dir_t *dir)
         result = MRAA_ERROR_UNSPECIFIED;
     }
 
+    if (ro_fd != -1) {
+        close(ro_fd);
+    }
     return result;
 }
 
-int
-mraa_gpio_read(mraa_gpio_context dev)
+static int
+mraa_gpio_read_internal(mraa_gpio_context dev)
 {
     if (dev == NULL) {
         syslog(LOG_ERR, "gpio: read: context is invalid");
@@ -646,26 +852,35 @@ mraa_gpio_read(mraa_gpio_context dev)
     if (dev->mmap_read != NULL)
         return dev->mmap_read(dev);
 
+    if (dev->line_fd != -1)
+        return mraa_gpio_chardev_read(dev);
+
     if (dev->value_fp == -1) {
         if (mraa_gpio_get_valfp(dev) != MRAA_SUCCESS) {
             return -1;
         }
-    } else {
-        // if value_fp is new this is pointless
-        lseek(dev->value_fp, 0, SEEK_SET);
     }
+    // sysfs reports "0\n" or "1\n", the level is the low bit of the digit
     char bu[2];
-    if (read(dev->value_fp, bu, 2 * sizeof(char)) != 2) {
-        syslog(LOG_ERR, "gpio%i: read: Failed to read a sensible value from sysfs: %s", dev->pin, strerror(errno));
+    if (pread(dev->value_fp, bu, 2 * sizeof(char), 0) != 2 || (bu[0] | 1) != '1') {
+        mraa_trace(LOG_ERR, MRAA_TRACE_GPIO_READ, dev->pin, errno);
         return -1;
     }
-    lseek(dev->value_fp, 0, SEEK_SET);
 
-    return (int) strtol(bu, NULL, 10);
+    return bu[0] & 1;
 }
 
-mraa_result_t
-mraa_gpio_write(mraa_gpio_context dev, int value)
+int
+mraa_gpio_read(mraa_gpio_context dev)
+{
+    MRAA_STATS_START(start);
+    int ret = mraa_gpio_read_internal(dev);
+    MRAA_STATS_RECORD(dev, start, 0, ret == -1);
+    return ret;
+}
+
+static mraa_result_t
+mraa_gpio_write_internal(mraa_gpio_context dev, int value)
 {
     if (dev == NULL) {
         syslog(LOG_ERR, "gpio: write: context is invalid");
@@ -685,21 +900,21 @@ mraa_gpio_write(mraa_gpio_context dev, int value)
         return dev->advance_func->gpio_write_replace(dev, value);
     }
 
+    if (dev->line_fd != -1) {
+        mraa_result_t ret = mraa_gpio_chardev_write(dev, value);
+        if (ret == MRAA_SUCCESS && IS_FUNC_DEFINED(dev, gpio_write_post))
+            return dev->advance_func->gpio_write_post(dev, value);
+        return ret;
+    }
+
     if (dev->value_fp == -1) {
         if (mraa_gpio_get_valfp(dev) != MRAA_SUCCESS) {
             return MRAA_ERROR_INVALID_RESOURCE;
         }
     }
 
-    if (lseek(dev->value_fp, 0, SEEK_SET) == -1) {
-        syslog(LOG_ERR, "gpio%i: write: Failed to lseek 'value': %s", dev->pin, strerror(errno));
-          return MRAA_ERROR_UNSPECIFIED;
-    }
-
-    char bu[MAX_SIZE];
-    int length = snprintf(bu, sizeof(bu), "%d", value);
-    if (write(dev->value_fp, bu, length * sizeof(char)) == -1) {
-        syslog(LOG_ERR, "gpio%i: write: Failed to write to 'value': %s", dev->pin, strerror(errno));
+    if (pwrite(dev->value_fp, &gpio_levels[value != 0], sizeof(char), 0) == -1) {
+        mraa_trace(LOG_ERR, MRAA_TRACE_GPIO_WRITE, dev->pin, errno);
         return MRAA_ERROR_UNSPECIFIED;
     }
 
@@ -708,10 +923,19 @@ mraa_gpio_write(mraa_gpio_context dev, int value)
     return MRAA_SUCCESS;
 }
 
+mraa_result_t
+mraa_gpio_write(mraa_gpio_context dev, int value)
+{
+    MRAA_STATS_START(start);
+    mraa_result_t ret = mraa_gpio_write_internal(dev, value);
+    MRAA_STATS_RECORD(dev, start, 0, ret != MRAA_SUCCESS);
+    return ret;
+}
+
 static mraa_result_t
 mraa_gpio_unexport_force(mraa_gpio_context dev)
 {
-    int unexport = open(SYSFS_CLASS_GPIO "/unexport", O_WRONLY);
+    int unexport = mraa_fs_open(SYSFS_CLASS_GPIO "/unexport", O_WRONLY);
     if (unexport == -1) {
         syslog(LOG_ERR, "gpio%i: Failed to open 'unexport' for writing: %s", dev->pin, strerror(errno));
         return MRAA_ERROR_INVALID_RESOURCE;
@@ -743,6 +967,27 @@ mraa_gpio_unexport(mraa_gpio_context dev)
     return MRAA_ERROR_INVALID_PARAMETER;
 }
 
+/* closes the fds of a context, hands the pin back and frees it */
+static void
+mraa_gpio_release(mraa_gpio_context dev)
+{
+    if (dev->value_fp != -1) {
+        close(dev->value_fp);
+    }
+    mraa_gpio_close_attr_fp(&dev->dir_fp);
+    mraa_gpio_close_attr_fp(&dev->edge_fp);
+    mraa_gpio_close_attr_fp(&dev->drive_fp);
+    free(dev->thread_attr);
+    if (dev->line_fd != -1) {
+        // nothing was exported, dropping the line request hands the pin back
+        mraa_gpio_isr_exit(dev);
+        mraa_gpio_chardev_release(dev);
+    } else {
+        mraa_gpio_unexport(dev);
+    }
+    free(dev);
+}
+
 mraa_result_t
 mraa_gpio_close(mraa_gpio_context dev)
 {
@@ -762,11 +1007,18 @@ mraa_gpio_close(mraa_gpio_context dev)
         result = dev->advance_func->gpio_close_pre(dev);
     }
 
-    if (dev->value_fp != -1) {
-        close(dev->value_fp);
+    if (dev->events != NULL) {
+        mraa_gpio_events_disable(dev);
     }
-    mraa_gpio_unexport(dev);
-    free(dev);
+    if (dev->counter != NULL) {
+        mraa_gpio_counter_disable(dev);
+    }
+    if (dev->mmap_write != NULL || dev->mmap_read != NULL) {
+        // drop this pin's reference on the platform register mapping
+        mraa_gpio_use_mmaped(dev, 0);
+    }
+
+    mraa_gpio_release(dev);
     return result;
 }
 
@@ -817,3 +1069,262 @@ mraa_gpio_get_pin_raw(mraa_gpio_context dev)
     }
     return dev->pin;
 }
+
+static void
+mraa_gpio_group_bundle_chardev(mraa_gpio_group_context group)
+{
+    unsigned int offsets[64];
+    int members[64];
+    int i, j;
+
+    for (i = 0; i < group->num_pins; i++) {
+        mraa_gpio_context first = group->gpio[i];
+        if (first->line_fd == -1 || group->line_req[i] != -1) {
+            continue;
+        }
+
+        // collect every not yet bundled member living on the same chip
+        unsigned int num = 0;
+        for (j = i; j < group->num_pins && num < 64; j++) {
+            mraa_gpio_context dev = group->gpio[j];
+            if (dev->line_fd != -1 && group->line_req[j] == -1 && dev->line_chip == first->line_chip) {
+                members[num] = j;
+                offsets[num] = dev->line_offset;
+                num++;
+            }
+        }
+
+        unsigned int chip = first->line_chip;
+        for (j = 0; j < (int) num; j++) {
+            mraa_gpio_chardev_release(group->gpio[members[j]]);
+        }
+
+        struct _gpio_lines* lines = &group->lines[group->num_lines];
+        if (mraa_gpio_chardev_request_lines(lines, chip, offsets, num) != MRAA_SUCCESS) {
+            // hand the lines back to the members, they get driven one by one
+            syslog(LOG_NOTICE, "gpiochip%u: init_multi: falling back to per pin line requests", chip);
+            for (j = 0; j < (int) num; j++) {
+                mraa_gpio_context dev = group->gpio[members[j]];
+                if (mraa_gpio_chardev_request(dev, chip, offsets[j]) != MRAA_SUCCESS) {
+                    syslog(LOG_ERR, "gpio%i: init_multi: lost gpiochip line", dev->pin);
+                }
+                // never bundle this member again
+                group->line_req[members[j]] = -2;
+            }
+            continue;
+        }
+
+        for (j = 0; j < (int) num; j++) {
+            mraa_gpio_context dev = group->gpio[members[j]];
+            group->line_req[members[j]] = group->num_lines;
+            group->line_bit[members[j]] = j;
+            // the group owns the line now, nothing to unexport on member close
+            dev->owner = 0;
+        }
+        group->num_lines++;
+    }
+
+    for (i = 0; i < group->num_pins; i++) {
+        if (group->line_req[i] < 0) {
+            group->line_req[i] = -1;
+        }
+    }
+}
+
+mraa_gpio_group_context
+mraa_gpio_init_multi(int pins[], int num_pins)
+{
+    int i;
+
+    if (pins == NULL || num_pins <= 0) {
+        syslog(LOG_ERR, "gpio: init_multi: invalid pin list");
+        return NULL;
+    }
+
+    mraa_gpio_group_context group = (mraa_gpio_group_context) calloc(1, sizeof(struct _gpio_group));
+    if (group == NULL) {
+        syslog(LOG_CRIT, "gpio: init_multi: Failed to allocate memory for context");
+        return NULL;
+    }
+
+    group->gpio = (mraa_gpio_context*) calloc(num_pins, sizeof(mraa_gpio_context));
+    group->lines = (struct _gpio_lines*) calloc(num_pins, sizeof(struct _gpio_lines));
+    group->line_req = (int*) malloc(num_pins * sizeof(int));
+    group->line_bit = (unsigned int*) calloc(num_pins, sizeof(unsigned int));
+    if (group->gpio == NULL || group->lines == NULL || group->line_req == NULL || group->line_bit == NULL) {
+        syslog(LOG_CRIT, "gpio: init_multi: Failed to allocate memory for context");
+        mraa_gpio_close_multi(group);
+        return NULL;
+    }
+
+    for (i = 0; i < num_pins; i++) {
+        group->gpio[i] = mraa_gpio_init(pins[i]);
+        if (group->gpio[i] == NULL) {
+            syslog(LOG_ERR, "gpio: init_multi: Failed to initialise pin %i", pins[i]);
+            mraa_gpio_close_multi(group);
+            return NULL;
+        }
+        group->line_req[i] = -1;
+        group->num_pins++;
+    }
+    group->advance_func = group->gpio[0]->advance_func;
+
+    mraa_gpio_group_bundle_chardev(group);
+    return group;
+}
+
+mraa_result_t
+mraa_gpio_dir_multi(mraa_gpio_group_context group, mraa_gpio_dir_t dir)
+{
+    mraa_result_t ret;
+    int i;
+
+    if (group == NULL) {
+        syslog(LOG_ERR, "gpio: dir_multi: context is invalid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+
+    for (i = 0; i < group->num_lines; i++) {
+        ret = mraa_gpio_chardev_dir_lines(&group->lines[i], dir);
+        if (ret != MRAA_SUCCESS) {
+            return ret;
+        }
+    }
+    for (i = 0; i < group->num_pins; i++) {
+        if (group->line_req[i] == -1) {
+            ret = mraa_gpio_dir(group->gpio[i], dir);
+            if (ret != MRAA_SUCCESS) {
+                return ret;
+            }
+        }
+    }
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_read_multi(mraa_gpio_group_context group, int output_values[])
+{
+    mraa_result_t ret;
+    int i;
+
+    if (group == NULL || output_values == NULL) {
+        syslog(LOG_ERR, "gpio: read_multi: context is invalid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+
+    if (group->mmap_read_multi != NULL)
+        return group->mmap_read_multi(group, output_values);
+
+    // take one snapshot per gpiochip before spreading bits out
+    for (i = 0; i < group->num_lines; i++) {
+        ret = mraa_gpio_chardev_get_lines(&group->lines[i]);
+        if (ret != MRAA_SUCCESS) {
+            return ret;
+        }
+    }
+    for (i = 0; i < group->num_pins; i++) {
+        if (group->line_req[i] != -1) {
+            output_values[i] = (int) ((group->lines[group->line_req[i]].values >> group->line_bit[i]) & 1);
+        } else {
+            output_values[i] = mraa_gpio_read(group->gpio[i]);
+            if (output_values[i] == -1) {
+                return MRAA_ERROR_UNSPECIFIED;
+            }
+        }
+    }
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_write_multi(mraa_gpio_group_context group, int input_values[])
+{
+    mraa_result_t ret;
+    int i;
+
+    if (group == NULL || input_values == NULL) {
+        syslog(LOG_ERR, "gpio: write_multi: context is invalid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+
+    if (group->mmap_write_multi != NULL)
+        return group->mmap_write_multi(group, input_values);
+
+    for (i = 0; i < group->num_lines; i++) {
+        group->lines[i].values = 0;
+    }
+    for (i = 0; i < group->num_pins; i++) {
+        if (group->line_req[i] != -1) {
+            if (input_values[i]) {
+                group->lines[group->line_req[i]].values |= (1ULL << group->line_bit[i]);
+            }
+        } else {
+            ret = mraa_gpio_write(group->gpio[i], input_values[i]);
+            if (ret != MRAA_SUCCESS) {
+                return ret;
+            }
+        }
+    }
+    for (i = 0; i < group->num_lines; i++) {
+        ret = mraa_gpio_chardev_set_lines(&group->lines[i]);
+        if (ret != MRAA_SUCCESS) {
+            return ret;
+        }
+    }
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_use_mmaped_multi(mraa_gpio_group_context group, mraa_boolean_t mmap_en)
+{
+    int i;
+
+    if (group == NULL) {
+        syslog(LOG_ERR, "gpio: use_mmaped_multi: context is invalid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+
+    // a single register map can only cover pins of a single platform
+    for (i = 0; i < group->num_pins; i++) {
+        if (group->gpio[i]->advance_func != group->advance_func) {
+            syslog(LOG_ERR, "gpio: use_mmaped_multi: group spans several platforms");
+            return MRAA_ERROR_INVALID_PARAMETER;
+        }
+    }
+
+    if (IS_FUNC_DEFINED(group, gpio_mmap_setup_multi)) {
+        return group->advance_func->gpio_mmap_setup_multi(group, mmap_en);
+    }
+
+    syslog(LOG_ERR, "gpio: use_mmaped_multi: mmap not implemented on this platform");
+    return MRAA_ERROR_FEATURE_NOT_IMPLEMENTED;
+}
+
+mraa_result_t
+mraa_gpio_close_multi(mraa_gpio_group_context group)
+{
+    mraa_result_t result = MRAA_SUCCESS;
+    int i;
+
+    if (group == NULL) {
+        syslog(LOG_ERR, "gpio: close_multi: context is invalid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+
+    if (group->mmap_taken != NULL) {
+        mraa_gpio_use_mmaped_multi(group, 0);
+    }
+    for (i = 0; i < group->num_lines; i++) {
+        mraa_gpio_chardev_release_lines(&group->lines[i]);
+    }
+    for (i = 0; i < group->num_pins; i++) {
+        if (mraa_gpio_close(group->gpio[i]) != MRAA_SUCCESS) {
+            result = MRAA_ERROR_UNSPECIFIED;
+        }
+    }
+    free(group->line_bit);
+    free(group->line_req);
+    free(group->lines);
+    free(group->gpio);
+    free(group);
+    return result;
+}
@@ -0,0 +1,475 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gpio.h"
+#include "gpio/gpio_chardev.h"
+#include "gpio/gpio_events.h"
+
+#include <stdlib.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <glob.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include "linux/gpio.h"
+
+#define SYSFS_CLASS_GPIO "/sys/class/gpio"
+#define DEV_GPIOCHIP "/dev/gpiochip"
+#define MAX_SIZE 64
+#define CONSUMER "mraa"
+#define EVENT_BATCH 16
+
+// flags we are allowed to hand back to the kernel in a line config
+#define LINE_CONFIG_FLAGS                                                                         \
+    (GPIO_V2_LINE_FLAG_ACTIVE_LOW | GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_OUTPUT |          \
+     GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING |                             \
+     GPIO_V2_LINE_FLAG_OPEN_DRAIN | GPIO_V2_LINE_FLAG_OPEN_SOURCE |                               \
+     GPIO_V2_LINE_FLAG_BIAS_PULL_UP | GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN |                          \
+     GPIO_V2_LINE_FLAG_BIAS_DISABLED)
+#define LINE_EDGE_FLAGS (GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING)
+#define LINE_BIAS_FLAGS                                                                           \
+    (GPIO_V2_LINE_FLAG_BIAS_PULL_UP | GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN | GPIO_V2_LINE_FLAG_BIAS_DISABLED)
+
+static int
+mraa_gpio_chardev_read_int(const char* path, int* value)
+{
+    char bu[MAX_SIZE];
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return -1;
+    }
+    memset(bu, 0, sizeof(bu));
+    int length = read(fd, bu, sizeof(bu) - 1);
+    close(fd);
+    if (length <= 0) {
+        return -1;
+    }
+    *value = (int) strtol(bu, NULL, 10);
+    return 0;
+}
+
+mraa_result_t
+mraa_gpio_chardev_lookup_sysfs(int pin, unsigned int* chip, unsigned int* line)
+{
+    glob_t chips;
+    size_t i;
+    char pattern[MRAA_FS_PATH_MAX];
+    mraa_result_t ret = MRAA_ERROR_INVALID_RESOURCE;
+
+    if (pin < 0 || chip == NULL || line == NULL) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+
+    if (mraa_fs_path(pattern, sizeof(pattern), SYSFS_CLASS_GPIO "/gpiochip*") == -1 ||
+        glob(pattern, 0, NULL, &chips) != 0) {
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+
+    for (i = 0; i < chips.gl_pathc; i++) {
+        char path[MRAA_FS_PATH_MAX + MAX_SIZE];
+        int base, ngpio;
+
+        snprintf(path, sizeof(path), "%s/base", chips.gl_pathv[i]);
+        if (mraa_gpio_chardev_read_int(path, &base) != 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/ngpio", chips.gl_pathv[i]);
+        if (mraa_gpio_chardev_read_int(path, &ngpio) != 0) {
+            continue;
+        }
+        if (pin < base || pin >= base + ngpio) {
+            continue;
+        }
+
+        // the parent device of a sysfs gpiochip carries the chardev node name
+        glob_t dev;
+        snprintf(path, sizeof(path), "%s/device/gpiochip*", chips.gl_pathv[i]);
+        if (glob(path, 0, NULL, &dev) == 0) {
+            if (dev.gl_pathc == 1) {
+                const char* name = strrchr(dev.gl_pathv[0], '/');
+                name = (name == NULL) ? dev.gl_pathv[0] : name + 1;
+                *chip = (unsigned int) strtoul(name + strlen("gpiochip"), NULL, 10);
+                *line = (unsigned int) (pin - base);
+                ret = MRAA_SUCCESS;
+            }
+            globfree(&dev);
+        }
+        break;
+    }
+
+    globfree(&chips);
+    return ret;
+}
+
+static mraa_result_t
+mraa_gpio_chardev_set_config(mraa_gpio_context dev, uint64_t flags, int out_value)
+{
+    struct gpio_v2_line_config config;
+
+    memset(&config, 0, sizeof(config));
+    config.flags = flags & LINE_CONFIG_FLAGS;
+    if (out_value >= 0) {
+        config.num_attrs = 1;
+        config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+        config.attrs[0].attr.values = out_value ? 1 : 0;
+        config.attrs[0].mask = 1;
+    }
+
+    if (ioctl(dev->line_fd, GPIO_V2_LINE_SET_CONFIG_IOCTL, &config) == -1) {
+        syslog(LOG_ERR, "gpio%i: chardev: Failed to configure line: %s", dev->pin, strerror(errno));
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    dev->line_flags = config.flags;
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_chardev_request(mraa_gpio_context dev, unsigned int chip, unsigned int line)
+{
+    char path[MRAA_FS_PATH_MAX];
+    struct gpio_v2_line_info info;
+    struct gpio_v2_line_request req;
+
+    mraa_fs_path(path, sizeof(path), DEV_GPIOCHIP "%u", chip);
+    int chip_fd = open(path, O_RDWR | O_CLOEXEC);
+    if (chip_fd == -1) {
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+
+    memset(&info, 0, sizeof(info));
+    info.offset = line;
+    if (ioctl(chip_fd, GPIO_V2_GET_LINEINFO_IOCTL, &info) == -1) {
+        // pre v2 kernels land here, let the caller fall back to sysfs
+        syslog(LOG_DEBUG, "gpio%i: chardev: no v2 line info on %s: %s", dev->pin, path, strerror(errno));
+        close(chip_fd);
+        return MRAA_ERROR_FEATURE_NOT_SUPPORTED;
+    }
+    if (info.flags & GPIO_V2_LINE_FLAG_USED) {
+        syslog(LOG_ERR, "gpio%i: chardev: line %u of %s is used by '%s'", dev->pin, line, path, info.consumer);
+        close(chip_fd);
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+
+    // request as-is, neither direction flag set keeps the pin state untouched
+    memset(&req, 0, sizeof(req));
+    req.offsets[0] = line;
+    req.num_lines = 1;
+    strncpy(req.consumer, CONSUMER, sizeof(req.consumer) - 1);
+    if (ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &req) == -1) {
+        syslog(LOG_ERR, "gpio%i: chardev: Failed to request line %u of %s: %s", dev->pin, line, path, strerror(errno));
+        close(chip_fd);
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    close(chip_fd);
+
+    dev->line_fd = req.fd;
+    dev->line_chip = chip;
+    dev->line_offset = line;
+    dev->line_flags = info.flags & LINE_CONFIG_FLAGS;
+    return MRAA_SUCCESS;
+}
+
+void
+mraa_gpio_chardev_release(mraa_gpio_context dev)
+{
+    if (dev->line_fd != -1) {
+        close(dev->line_fd);
+        dev->line_fd = -1;
+    }
+}
+
+int
+mraa_gpio_chardev_read(mraa_gpio_context dev)
+{
+    struct gpio_v2_line_values values;
+
+    values.bits = 0;
+    values.mask = 1;
+    if (ioctl(dev->line_fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) == -1) {
+        syslog(LOG_ERR, "gpio%i: read: Failed to get line value: %s", dev->pin, strerror(errno));
+        return -1;
+    }
+    return (int) (values.bits & 1);
+}
+
+mraa_result_t
+mraa_gpio_chardev_write(mraa_gpio_context dev, int value)
+{
+    struct gpio_v2_line_values values;
+
+    values.bits = value ? 1 : 0;
+    values.mask = 1;
+    if (ioctl(dev->line_fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) == -1) {
+        syslog(LOG_ERR, "gpio%i: write: Failed to set line value: %s", dev->pin, strerror(errno));
+        return MRAA_ERROR_UNSPECIFIED;
+    }
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_chardev_dir(mraa_gpio_context dev, mraa_gpio_dir_t dir)
+{
+    uint64_t flags = dev->line_flags & ~(GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_OUTPUT);
+
+    switch (dir) {
+        case MRAA_GPIO_IN:
+            return mraa_gpio_chardev_set_config(dev, flags | GPIO_V2_LINE_FLAG_INPUT, -1);
+        case MRAA_GPIO_OUT:
+        case MRAA_GPIO_OUT_LOW:
+            // edge detection is only valid on inputs
+            flags &= ~LINE_EDGE_FLAGS;
+            return mraa_gpio_chardev_set_config(dev, flags | GPIO_V2_LINE_FLAG_OUTPUT, 0);
+        case MRAA_GPIO_OUT_HIGH:
+            flags &= ~LINE_EDGE_FLAGS;
+            return mraa_gpio_chardev_set_config(dev, flags | GPIO_V2_LINE_FLAG_OUTPUT, 1);
+        default:
+            return MRAA_ERROR_FEATURE_NOT_IMPLEMENTED;
+    }
+}
+
+mraa_result_t
+mraa_gpio_chardev_read_dir(mraa_gpio_context dev, mraa_gpio_dir_t* dir)
+{
+    if (dev->line_flags & GPIO_V2_LINE_FLAG_OUTPUT) {
+        *dir = MRAA_GPIO_OUT;
+    } else {
+        *dir = MRAA_GPIO_IN;
+    }
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_chardev_edge_mode(mraa_gpio_context dev, mraa_gpio_edge_t mode)
+{
+    uint64_t flags = dev->line_flags & ~LINE_EDGE_FLAGS;
+
+    switch (mode) {
+        case MRAA_GPIO_EDGE_NONE:
+            break;
+        case MRAA_GPIO_EDGE_BOTH:
+            flags |= LINE_EDGE_FLAGS;
+            break;
+        case MRAA_GPIO_EDGE_RISING:
+            flags |= GPIO_V2_LINE_FLAG_EDGE_RISING;
+            break;
+        case MRAA_GPIO_EDGE_FALLING:
+            flags |= GPIO_V2_LINE_FLAG_EDGE_FALLING;
+            break;
+        default:
+            return MRAA_ERROR_FEATURE_NOT_IMPLEMENTED;
+    }
+    if (flags & LINE_EDGE_FLAGS) {
+        flags = (flags & ~GPIO_V2_LINE_FLAG_OUTPUT) | GPIO_V2_LINE_FLAG_INPUT;
+    }
+    return mraa_gpio_chardev_set_config(dev, flags, -1);
+}
+
+mraa_result_t
+mraa_gpio_chardev_mode(mraa_gpio_context dev, mraa_gpio_mode_t mode)
+{
+    uint64_t flags = dev->line_flags & ~LINE_BIAS_FLAGS;
+
+    switch (mode) {
+        case MRAA_GPIO_STRONG:
+            break;
+        case MRAA_GPIO_PULLUP:
+            flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+            break;
+        case MRAA_GPIO_PULLDOWN:
+            flags |= GPIO_V2_LINE_FLAG_BIAS_PULL_DOWN;
+            break;
+        case MRAA_GPIO_HIZ:
+            flags |= GPIO_V2_LINE_FLAG_BIAS_DISABLED;
+            break;
+        default:
+            return MRAA_ERROR_FEATURE_NOT_IMPLEMENTED;
+    }
+    // the kernel only accepts bias flags together with a direction
+    if (!(flags & (GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_OUTPUT))) {
+        flags |= GPIO_V2_LINE_FLAG_INPUT;
+    }
+    return mraa_gpio_chardev_set_config(dev, flags, -1);
+}
+
+mraa_result_t
+mraa_gpio_chardev_wait_interrupt(mraa_gpio_context dev, int fd, int control_fd)
+{
+    struct pollfd pfd[2];
+
+    if (fd < 0) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+
+    pfd[0].fd = fd;
+    pfd[0].events = POLLIN;
+    pfd[1].fd = control_fd;
+    pfd[1].events = 0;
+
+    if (poll(pfd, control_fd < 0 ? 1 : 2, -1) <= 0) {
+        return MRAA_ERROR_UNSPECIFIED;
+    }
+    if (!(pfd[0].revents & POLLIN)) {
+        // the control fd was closed, we are being asked to stop
+        return MRAA_ERROR_UNSPECIFIED;
+    }
+
+    return mraa_gpio_chardev_read_events(dev, fd);
+}
+
+mraa_result_t
+mraa_gpio_chardev_read_events(mraa_gpio_context dev, int fd)
+{
+    struct gpio_v2_line_event events[EVENT_BATCH];
+    ssize_t length;
+    int i;
+
+    // edges that piled up are delivered as a single interrupt like sysfs does
+    length = read(fd, events, sizeof(events));
+    if (length < (ssize_t) sizeof(events[0])) {
+        return MRAA_ERROR_UNSPECIFIED;
+    }
+    if (MRAA_GPIO_EVENTS_WANTED(dev)) {
+        for (i = 0; i < (int) (length / sizeof(events[0])); i++) {
+            mraa_gpio_edge_t edge = (events[i].id == GPIO_V2_LINE_EVENT_RISING_EDGE) ? MRAA_GPIO_EDGE_RISING : MRAA_GPIO_EDGE_FALLING;
+            mraa_gpio_event_push(dev, events[i].timestamp_ns, edge, events[i].line_seqno);
+        }
+    }
+    return MRAA_SUCCESS;
+}
+
+static uint64_t
+mraa_gpio_chardev_lines_mask(struct _gpio_lines* lines)
+{
+    return lines->num_lines >= 64 ? ~0ULL : (1ULL << lines->num_lines) - 1;
+}
+
+mraa_result_t
+mraa_gpio_chardev_request_lines(struct _gpio_lines* lines, unsigned int chip, const unsigned int* offsets, unsigned int num)
+{
+    char path[MRAA_FS_PATH_MAX];
+    struct gpio_v2_line_request req;
+    unsigned int i;
+
+    if (num == 0 || num > GPIO_V2_LINES_MAX) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+
+    mraa_fs_path(path, sizeof(path), DEV_GPIOCHIP "%u", chip);
+    int chip_fd = open(path, O_RDWR | O_CLOEXEC);
+    if (chip_fd == -1) {
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+
+    memset(&req, 0, sizeof(req));
+    for (i = 0; i < num; i++) {
+        req.offsets[i] = offsets[i];
+    }
+    req.num_lines = num;
+    strncpy(req.consumer, CONSUMER, sizeof(req.consumer) - 1);
+    if (ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &req) == -1) {
+        syslog(LOG_ERR, "gpiochip%u: chardev: Failed to request %u lines: %s", chip, num, strerror(errno));
+        close(chip_fd);
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    close(chip_fd);
+
+    lines->fd = req.fd;
+    lines->chip = chip;
+    lines->num_lines = num;
+    lines->flags = 0;
+    lines->values = 0;
+    return MRAA_SUCCESS;
+}
+
+void
+mraa_gpio_chardev_release_lines(struct _gpio_lines* lines)
+{
+    if (lines->fd != -1) {
+        close(lines->fd);
+        lines->fd = -1;
+    }
+}
+
+mraa_result_t
+mraa_gpio_chardev_get_lines(struct _gpio_lines* lines)
+{
+    struct gpio_v2_line_values values;
+
+    values.bits = 0;
+    values.mask = mraa_gpio_chardev_lines_mask(lines);
+    if (ioctl(lines->fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) == -1) {
+        syslog(LOG_ERR, "gpiochip%u: read_multi: Failed to get line values: %s", lines->chip, strerror(errno));
+        return MRAA_ERROR_UNSPECIFIED;
+    }
+    lines->values = values.bits;
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_chardev_set_lines(struct _gpio_lines* lines)
+{
+    struct gpio_v2_line_values values;
+
+    values.mask = mraa_gpio_chardev_lines_mask(lines);
+    values.bits = lines->values & values.mask;
+    if (ioctl(lines->fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) == -1) {
+        syslog(LOG_ERR, "gpiochip%u: write_multi: Failed to set line values: %s", lines->chip, strerror(errno));
+        return MRAA_ERROR_UNSPECIFIED;
+    }
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_chardev_dir_lines(struct _gpio_lines* lines, mraa_gpio_dir_t dir)
+{
+    struct gpio_v2_line_config config;
+    uint64_t flags = lines->flags & ~(GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_OUTPUT);
+
+    memset(&config, 0, sizeof(config));
+    switch (dir) {
+        case MRAA_GPIO_IN:
+            flags |= GPIO_V2_LINE_FLAG_INPUT;
+            break;
+        case MRAA_GPIO_OUT:
+        case MRAA_GPIO_OUT_LOW:
+        case MRAA_GPIO_OUT_HIGH:
+            flags = (flags & ~LINE_EDGE_FLAGS) | GPIO_V2_LINE_FLAG_OUTPUT;
+            config.num_attrs = 1;
+            config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+            config.attrs[0].attr.values = (dir == MRAA_GPIO_OUT_HIGH) ? ~0ULL : 0;
+            config.attrs[0].mask = mraa_gpio_chardev_lines_mask(lines);
+            break;
+        default:
+            return MRAA_ERROR_FEATURE_NOT_IMPLEMENTED;
+    }
+    config.flags = flags;
+
+    if (ioctl(lines->fd, GPIO_V2_LINE_SET_CONFIG_IOCTL, &config) == -1) {
+        syslog(LOG_ERR, "gpiochip%u: dir_multi: Failed to configure lines: %s", lines->chip, strerror(errno));
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    lines->flags = flags;
+    return MRAA_SUCCESS;
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gpio.h"
+#include "gpio/gpio_counter.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/**
+ * Edge counter of a gpio. The interrupt path is the only writer of the
+ * accumulated fields and publishes them under a sequence lock, readers
+ * retry until they copied a stable set.
+ */
+struct _gpio_counter {
+    /*@{*/
+    unsigned int seq; /**< odd while the writer updates the fields below */
+    mraa_gpio_edge_t edge; /**< edges counted */
+    uint64_t count; /**< counted edges since enable */
+    uint64_t first_ns; /**< time of the first counted edge */
+    uint64_t last_ns; /**< time of the last counted edge */
+    uint64_t period_ns; /**< time between the last two period reference edges */
+    uint64_t rise_ns; /**< time of the last rising edge */
+    uint64_t fall_ns; /**< time of the last falling edge */
+    uint64_t high_ns; /**< last high pulse */
+    uint64_t low_ns; /**< last low pulse */
+    /* reader side, under lock */
+    pthread_mutex_t lock; /**< serialises readers resetting the counter */
+    uint64_t base_count; /**< count at the last reset */
+    uint64_t base_ns; /**< last_ns at the last reset, 0 when counting from enable */
+    /*@}*/
+};
+
+void
+mraa_gpio_counter_push(mraa_gpio_context dev, uint64_t timestamp_ns, mraa_gpio_edge_t edge)
+{
+    struct _gpio_counter* c = __atomic_load_n(&dev->counter, __ATOMIC_ACQUIRE);
+    // the period is taken between edges of one direction, unknown ones all count
+    mraa_gpio_edge_t reference = c->edge == MRAA_GPIO_EDGE_FALLING ? MRAA_GPIO_EDGE_FALLING : MRAA_GPIO_EDGE_RISING;
+
+    __atomic_store_n(&c->seq, c->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    if (edge == MRAA_GPIO_EDGE_RISING) {
+        if (reference == MRAA_GPIO_EDGE_RISING && c->rise_ns != 0) {
+            c->period_ns = timestamp_ns - c->rise_ns;
+        }
+        if (c->fall_ns != 0 && c->fall_ns > c->rise_ns) {
+            c->low_ns = timestamp_ns - c->fall_ns;
+        }
+        c->rise_ns = timestamp_ns;
+    } else if (edge == MRAA_GPIO_EDGE_FALLING) {
+        if (reference == MRAA_GPIO_EDGE_FALLING && c->fall_ns != 0) {
+            c->period_ns = timestamp_ns - c->fall_ns;
+        }
+        if (c->rise_ns != 0 && c->rise_ns > c->fall_ns) {
+            c->high_ns = timestamp_ns - c->rise_ns;
+        }
+        c->fall_ns = timestamp_ns;
+    } else if (c->count != 0) {
+        c->period_ns = timestamp_ns - c->last_ns;
+    }
+
+    if (edge == MRAA_GPIO_EDGE_BOTH || c->edge == MRAA_GPIO_EDGE_BOTH || c->edge == edge) {
+        if (c->count++ == 0) {
+            c->first_ns = timestamp_ns;
+        }
+        c->last_ns = timestamp_ns;
+    }
+
+    __atomic_store_n(&c->seq, c->seq + 1, __ATOMIC_RELEASE);
+}
+
+mraa_result_t
+mraa_gpio_counter_enable(mraa_gpio_context dev, mraa_gpio_edge_t edge)
+{
+    struct _gpio_counter* c;
+
+    if (dev == NULL) {
+        syslog(LOG_ERR, "gpio: counter_enable: context is invalid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (dev->counter != NULL) {
+        syslog(LOG_ERR, "gpio%i: counter_enable: counter already enabled", dev->pin);
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    if (edge == MRAA_GPIO_EDGE_NONE) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    // one isr per context, a callback or event queue already owns it
+    if (dev->thread_id != 0 || dev->isr_entry != NULL) {
+        syslog(LOG_ERR, "gpio%i: counter_enable: an isr is already installed", dev->pin);
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+
+    c = (struct _gpio_counter*) calloc(1, sizeof(struct _gpio_counter));
+    if (c == NULL) {
+        syslog(LOG_CRIT, "gpio%i: counter_enable: Failed to allocate memory for counter", dev->pin);
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    c->edge = edge;
+    pthread_mutex_init(&c->lock, NULL);
+
+    // no callback, the interrupt path only feeds the counter
+    mraa_result_t ret = mraa_gpio_isr(dev, edge, NULL, NULL);
+    if (ret != MRAA_SUCCESS) {
+        pthread_mutex_destroy(&c->lock);
+        free(c);
+        return ret;
+    }
+    // published once nothing can fail, edges before this are not counted
+    __atomic_store_n(&dev->counter, c, __ATOMIC_RELEASE);
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_counter_read(mraa_gpio_context dev, mraa_gpio_counter_t* counter, mraa_boolean_t reset)
+{
+    struct _gpio_counter* c;
+    struct _gpio_counter snap;
+    unsigned int seq;
+
+    if (dev == NULL || dev->counter == NULL || counter == NULL) {
+        syslog(LOG_ERR, "gpio: counter_read: context is invalid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    c = dev->counter;
+
+    pthread_mutex_lock(&c->lock);
+    do {
+        seq = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE);
+        snap.count = c->count;
+        snap.first_ns = c->first_ns;
+        snap.last_ns = c->last_ns;
+        snap.period_ns = c->period_ns;
+        snap.high_ns = c->high_ns;
+        snap.low_ns = c->low_ns;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || seq != __atomic_load_n(&c->seq, __ATOMIC_RELAXED));
+
+    memset(counter, 0, sizeof(mraa_gpio_counter_t));
+    counter->count = snap.count - c->base_count;
+    counter->timestamp_ns = snap.last_ns;
+    counter->period_ns = snap.period_ns;
+    counter->high_ns = snap.high_ns;
+    counter->low_ns = snap.low_ns;
+    // from the reset point every counted edge closes an interval, from enable the first opens one
+    uint64_t intervals = c->base_ns != 0 ? counter->count : (snap.count > 0 ? snap.count - 1 : 0);
+    uint64_t start = c->base_ns != 0 ? c->base_ns : snap.first_ns;
+    if (intervals > 0) {
+        counter->mean_period_ns = (snap.last_ns - start) / intervals;
+    }
+
+    if (reset) {
+        c->base_count = snap.count;
+        c->base_ns = snap.last_ns;
+    }
+    pthread_mutex_unlock(&c->lock);
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_measure_period(mraa_gpio_context dev, uint64_t* period_ns)
+{
+    mraa_gpio_counter_t counter;
+
+    if (period_ns == NULL) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    mraa_result_t ret = mraa_gpio_counter_read(dev, &counter, 0);
+    if (ret != MRAA_SUCCESS) {
+        return ret;
+    }
+    if (counter.mean_period_ns == 0) {
+        return MRAA_ERROR_UNSPECIFIED;
+    }
+    *period_ns = counter.mean_period_ns;
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_measure_pulsewidth(mraa_gpio_context dev, uint64_t* high_ns, uint64_t* low_ns)
+{
+    mraa_gpio_counter_t counter;
+
+    mraa_result_t ret = mraa_gpio_counter_read(dev, &counter, 0);
+    if (ret != MRAA_SUCCESS) {
+        return ret;
+    }
+    if (counter.high_ns == 0 && counter.low_ns == 0) {
+        return MRAA_ERROR_UNSPECIFIED;
+    }
+    if (high_ns != NULL) {
+        *high_ns = counter.high_ns;
+    }
+    if (low_ns != NULL) {
+        *low_ns = counter.low_ns;
+    }
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_counter_disable(mraa_gpio_context dev)
+{
+    struct _gpio_counter* c;
+
+    if (dev == NULL) {
+        syslog(LOG_ERR, "gpio: counter_disable: context is invalid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    c = dev->counter;
+    if (c == NULL) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+
+    // stop the writer before the counter goes away
+    mraa_result_t ret = mraa_gpio_isr_exit(dev);
+    dev->counter = NULL;
+    pthread_mutex_destroy(&c->lock);
+    free(c);
+    return ret;
+}
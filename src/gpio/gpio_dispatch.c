@@ -0,0 +1,555 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gpio.h"
+#include "gpio/gpio_dispatch.h"
+#include "gpio/gpio_chardev.h"
+#include "gpio/gpio_events.h"
+
+#include <stdlib.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#define SYSFS_CLASS_GPIO "/sys/class/gpio"
+#define MAX_SIZE 64
+#define DISPATCH_DEFAULT_WORKERS 2
+#define DISPATCH_MAX_WORKERS 16
+#define DISPATCH_MAX_EVENTS 32
+// how often platforms without a pollable fd are asked for pending interrupts,
+// the same 20ms their own wait loops sleep as every ask may be a bus round trip
+#define DISPATCH_POLL_INTERVAL_NS 20000000
+
+/**
+ * A gpio context registered with the dispatcher
+ */
+struct _gpio_isr_entry {
+    /*@{*/
+    mraa_gpio_context dev; /**< the registered context */
+    int fd; /**< fd watched by epoll, -1 when polled through gpio_interrupt_pending_replace */
+    mraa_boolean_t chardev; /**< fd is a gpiochip line request rather than a sysfs value file */
+    mraa_boolean_t removed; /**< deregistered, events still in flight must be dropped */
+    mraa_boolean_t detached; /**< removed from within its own callback, the worker frees it */
+    mraa_boolean_t queued; /**< sitting in the work queue */
+    mraa_boolean_t running; /**< callback currently executing on a worker */
+    mraa_boolean_t again; /**< fired again while running, rerun once done */
+    mraa_boolean_t pending; /**< last answer of gpio_interrupt_pending_replace */
+    pthread_t worker; /**< worker executing the callback when running */
+    struct _gpio_isr_entry* next; /**< next registered entry */
+    struct _gpio_isr_entry* next_job; /**< next entry in the work queue */
+    struct _gpio_isr_entry* next_polled; /**< next entry asked on the current timer tick */
+    /*@}*/
+};
+
+static pthread_mutex_t dispatch_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t dispatch_work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t dispatch_done_cond = PTHREAD_COND_INITIALIZER;
+
+static struct {
+    mraa_boolean_t running;
+    mraa_boolean_t stopping;
+    int epoll_fd;
+    int wake_fd;
+    int timer_fd;
+    pthread_t thread;
+    pthread_t workers[DISPATCH_MAX_WORKERS];
+    unsigned int num_workers;
+    struct _gpio_isr_entry* entries;
+    int num_polled;
+    struct _gpio_isr_entry* job_head;
+    struct _gpio_isr_entry* job_tail;
+    unsigned long epoch;
+} dispatch = { 0 };
+
+static void
+mraa_gpio_dispatch_wake()
+{
+    uint64_t one = 1;
+    if (write(dispatch.wake_fd, &one, sizeof(one)) != sizeof(one)) {
+        syslog(LOG_ERR, "gpio: dispatch: Failed to wake dispatcher: %s", strerror(errno));
+    }
+}
+
+static void
+mraa_gpio_dispatch_arm_timer(mraa_boolean_t en)
+{
+    struct itimerspec spec;
+
+    memset(&spec, 0, sizeof(spec));
+    if (en) {
+        spec.it_value.tv_nsec = DISPATCH_POLL_INTERVAL_NS;
+        spec.it_interval.tv_nsec = DISPATCH_POLL_INTERVAL_NS;
+    }
+    timerfd_settime(dispatch.timer_fd, 0, &spec, NULL);
+}
+
+// must be called with dispatch_lock held
+static void
+mraa_gpio_dispatch_queue(struct _gpio_isr_entry* entry)
+{
+    if (entry->dev->isr == NULL) {
+        // event ring only, nothing to call back
+        return;
+    }
+    if (entry->running) {
+        // edges collapse into a single rerun, like the sysfs value file does
+        entry->again = 1;
+        return;
+    }
+    if (entry->queued) {
+        return;
+    }
+    entry->queued = 1;
+    entry->next_job = NULL;
+    if (dispatch.job_tail != NULL) {
+        dispatch.job_tail->next_job = entry;
+    } else {
+        dispatch.job_head = entry;
+    }
+    dispatch.job_tail = entry;
+    pthread_cond_signal(&dispatch_work_cond);
+}
+
+static void
+mraa_gpio_dispatch_ack(struct _gpio_isr_entry* entry)
+{
+    unsigned char c;
+
+    // debouncing workers wait for this to stop moving
+    entry->dev->isr_last_edge_ns = mraa_gpio_isr_now();
+
+    if (entry->chardev) {
+        mraa_gpio_chardev_read_events(entry->dev, entry->fd);
+    } else {
+        lseek(entry->fd, 0, SEEK_SET);
+        if (read(entry->fd, &c, 1) != 1) {
+            syslog(LOG_DEBUG, "gpio%i: dispatch: failed to clear interrupt", entry->dev->pin);
+        } else if (MRAA_GPIO_EVENTS_WANTED(entry->dev)) {
+            mraa_gpio_event_push_now(entry->dev, c == '1' ? MRAA_GPIO_EDGE_RISING : MRAA_GPIO_EDGE_FALLING);
+        }
+    }
+}
+
+// must be called with dispatch_lock held, drops it while asking the platform
+// as that may take a bus round trip per pin. The entries asked can not be
+// freed meanwhile, a remover waits for the epoch to move past this batch.
+static void
+mraa_gpio_dispatch_poll()
+{
+    struct _gpio_isr_entry* polled = NULL;
+    struct _gpio_isr_entry* entry;
+
+    for (entry = dispatch.entries; entry != NULL; entry = entry->next) {
+        if (entry->fd == -1 && !entry->dev->isr_thread_terminating) {
+            entry->next_polled = polled;
+            polled = entry;
+        }
+    }
+    if (polled == NULL) {
+        return;
+    }
+
+    pthread_mutex_unlock(&dispatch_lock);
+    for (entry = polled; entry != NULL; entry = entry->next_polled) {
+        entry->pending = entry->dev->advance_func->gpio_interrupt_pending_replace(entry->dev);
+    }
+    pthread_mutex_lock(&dispatch_lock);
+
+    for (entry = polled; entry != NULL; entry = entry->next_polled) {
+        if (entry->pending && !entry->removed) {
+            entry->dev->isr_last_edge_ns = mraa_gpio_isr_now();
+            mraa_gpio_event_push_now(entry->dev, MRAA_GPIO_EDGE_BOTH);
+            mraa_gpio_dispatch_queue(entry);
+        }
+    }
+}
+
+static void*
+mraa_gpio_dispatch_handler(void* arg)
+{
+    struct epoll_event events[DISPATCH_MAX_EVENTS];
+    struct _gpio_isr_entry* entry;
+    uint64_t ticks;
+    int n, i;
+
+    for (;;) {
+        n = epoll_wait(dispatch.epoll_fd, events, DISPATCH_MAX_EVENTS, -1);
+        pthread_mutex_lock(&dispatch_lock);
+        if (dispatch.stopping) {
+            pthread_mutex_unlock(&dispatch_lock);
+            break;
+        }
+        for (i = 0; i < n; i++) {
+            if (events[i].data.ptr == &dispatch.wake_fd) {
+                read(dispatch.wake_fd, &ticks, sizeof(ticks));
+            } else if (events[i].data.ptr == &dispatch.timer_fd) {
+                read(dispatch.timer_fd, &ticks, sizeof(ticks));
+                mraa_gpio_dispatch_poll();
+            } else {
+                entry = (struct _gpio_isr_entry*) events[i].data.ptr;
+                // a remover waits for this batch to finish before freeing
+                if (entry->removed) {
+                    continue;
+                }
+                mraa_gpio_dispatch_ack(entry);
+                mraa_gpio_dispatch_queue(entry);
+            }
+        }
+        dispatch.epoch++;
+        pthread_cond_broadcast(&dispatch_done_cond);
+        pthread_mutex_unlock(&dispatch_lock);
+    }
+    return NULL;
+}
+
+static void*
+mraa_gpio_dispatch_worker(void* arg)
+{
+    struct _gpio_isr_entry* entry;
+    mraa_boolean_t java_attached = 0;
+
+    pthread_mutex_lock(&dispatch_lock);
+    for (;;) {
+        while (!dispatch.stopping && dispatch.job_head == NULL) {
+            pthread_cond_wait(&dispatch_work_cond, &dispatch_lock);
+        }
+        if (dispatch.stopping) {
+            break;
+        }
+
+        entry = dispatch.job_head;
+        dispatch.job_head = entry->next_job;
+        if (dispatch.job_head == NULL) {
+            dispatch.job_tail = NULL;
+        }
+        entry->queued = 0;
+        if (entry->removed) {
+            pthread_cond_broadcast(&dispatch_done_cond);
+            continue;
+        }
+
+        entry->running = 1;
+        entry->worker = pthread_self();
+        do {
+            mraa_gpio_context dev = entry->dev;
+            // bounces land while we sleep, only the settled line calls back
+            while (dev->isr_debounce_ns != 0 && !entry->removed) {
+                uint64_t quiet = mraa_gpio_isr_now() - dev->isr_last_edge_ns;
+                if (quiet >= dev->isr_debounce_ns) {
+                    break;
+                }
+                struct timespec ts;
+                ts.tv_sec = (dev->isr_debounce_ns - quiet) / 1000000000ULL;
+                ts.tv_nsec = (dev->isr_debounce_ns - quiet) % 1000000000ULL;
+                pthread_mutex_unlock(&dispatch_lock);
+                nanosleep(&ts, NULL);
+                pthread_mutex_lock(&dispatch_lock);
+            }
+            entry->again = 0;
+            pthread_mutex_unlock(&dispatch_lock);
+
+            if (!dev->isr_thread_terminating && mraa_gpio_isr_rate_ok(dev)) {
+                if (lang_func->java_attach_thread != NULL && dev->isr == lang_func->java_isr_callback && !java_attached) {
+                    java_attached = (lang_func->java_attach_thread() == MRAA_SUCCESS);
+                }
+                if (lang_func->python_isr != NULL) {
+                    lang_func->python_isr(dev->isr, dev->isr_args);
+                } else if (dev->isr != lang_func->java_isr_callback || java_attached) {
+                    dev->isr(dev->isr_args);
+                }
+            }
+
+            pthread_mutex_lock(&dispatch_lock);
+        } while (entry->again && !entry->removed);
+        entry->running = 0;
+        if (entry->detached) {
+            free(entry);
+        }
+        pthread_cond_broadcast(&dispatch_done_cond);
+    }
+    pthread_mutex_unlock(&dispatch_lock);
+
+    if (java_attached && lang_func->java_detach_thread != NULL) {
+        lang_func->java_detach_thread();
+    }
+    return NULL;
+}
+
+static void
+mraa_gpio_dispatch_close_fds()
+{
+    if (dispatch.timer_fd != -1)
+        close(dispatch.timer_fd);
+    if (dispatch.wake_fd != -1)
+        close(dispatch.wake_fd);
+    if (dispatch.epoll_fd != -1)
+        close(dispatch.epoll_fd);
+    dispatch.epoll_fd = dispatch.wake_fd = dispatch.timer_fd = -1;
+}
+
+static void
+mraa_gpio_dispatch_join()
+{
+    unsigned int i;
+
+    pthread_mutex_lock(&dispatch_lock);
+    dispatch.stopping = 1;
+    mraa_gpio_dispatch_wake();
+    pthread_cond_broadcast(&dispatch_work_cond);
+    pthread_mutex_unlock(&dispatch_lock);
+
+    pthread_join(dispatch.thread, NULL);
+    for (i = 0; i < dispatch.num_workers; i++) {
+        pthread_join(dispatch.workers[i], NULL);
+    }
+    dispatch.num_workers = 0;
+}
+
+mraa_result_t
+mraa_gpio_isr_dispatcher_start(unsigned int num_workers)
+{
+    struct epoll_event ev;
+
+    if (num_workers == 0) {
+        num_workers = DISPATCH_DEFAULT_WORKERS;
+    } else if (num_workers > DISPATCH_MAX_WORKERS) {
+        syslog(LOG_NOTICE, "gpio: dispatch: limiting workers to %d", DISPATCH_MAX_WORKERS);
+        num_workers = DISPATCH_MAX_WORKERS;
+    }
+
+    pthread_mutex_lock(&dispatch_lock);
+    if (dispatch.running) {
+        pthread_mutex_unlock(&dispatch_lock);
+        return MRAA_SUCCESS;
+    }
+
+    dispatch.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    dispatch.wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    dispatch.timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (dispatch.epoll_fd == -1 || dispatch.wake_fd == -1 || dispatch.timer_fd == -1) {
+        syslog(LOG_ERR, "gpio: dispatch: Failed to create dispatcher fds: %s", strerror(errno));
+        mraa_gpio_dispatch_close_fds();
+        pthread_mutex_unlock(&dispatch_lock);
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = &dispatch.wake_fd;
+    epoll_ctl(dispatch.epoll_fd, EPOLL_CTL_ADD, dispatch.wake_fd, &ev);
+    ev.data.ptr = &dispatch.timer_fd;
+    epoll_ctl(dispatch.epoll_fd, EPOLL_CTL_ADD, dispatch.timer_fd, &ev);
+
+    dispatch.stopping = 0;
+    dispatch.num_workers = 0;
+    if (mraa_thread_create(&dispatch.thread, NULL, mraa_gpio_dispatch_handler, NULL) != 0) {
+        syslog(LOG_ERR, "gpio: dispatch: Failed to start dispatcher thread");
+        mraa_gpio_dispatch_close_fds();
+        pthread_mutex_unlock(&dispatch_lock);
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    while (dispatch.num_workers < num_workers) {
+        if (mraa_thread_create(&dispatch.workers[dispatch.num_workers], NULL, mraa_gpio_dispatch_worker, NULL) != 0) {
+            break;
+        }
+        dispatch.num_workers++;
+    }
+    pthread_mutex_unlock(&dispatch_lock);
+
+    if (dispatch.num_workers == 0) {
+        syslog(LOG_ERR, "gpio: dispatch: Failed to start worker threads");
+        mraa_gpio_dispatch_join();
+        mraa_gpio_dispatch_close_fds();
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+
+    pthread_mutex_lock(&dispatch_lock);
+    dispatch.running = 1;
+    pthread_mutex_unlock(&dispatch_lock);
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_isr_dispatcher_stop()
+{
+    pthread_mutex_lock(&dispatch_lock);
+    if (!dispatch.running) {
+        pthread_mutex_unlock(&dispatch_lock);
+        return MRAA_SUCCESS;
+    }
+    if (dispatch.entries != NULL) {
+        pthread_mutex_unlock(&dispatch_lock);
+        syslog(LOG_ERR, "gpio: dispatch: isrs still registered, call mraa_gpio_isr_exit first");
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    dispatch.running = 0;
+    pthread_mutex_unlock(&dispatch_lock);
+
+    mraa_gpio_dispatch_join();
+    mraa_gpio_dispatch_close_fds();
+    return MRAA_SUCCESS;
+}
+
+mraa_boolean_t
+mraa_gpio_dispatch_active()
+{
+    mraa_boolean_t running;
+
+    pthread_mutex_lock(&dispatch_lock);
+    running = dispatch.running;
+    pthread_mutex_unlock(&dispatch_lock);
+    return running;
+}
+
+mraa_result_t
+mraa_gpio_dispatch_add(mraa_gpio_context dev)
+{
+    struct epoll_event ev;
+    struct _gpio_isr_entry* entry;
+
+    entry = (struct _gpio_isr_entry*) calloc(1, sizeof(struct _gpio_isr_entry));
+    if (entry == NULL) {
+        syslog(LOG_CRIT, "gpio%i: dispatch: Failed to allocate memory for entry", dev->pin);
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    entry->dev = dev;
+    entry->fd = -1;
+
+    if (IS_FUNC_DEFINED(dev, gpio_interrupt_handler_init_replace)) {
+        if (!IS_FUNC_DEFINED(dev, gpio_interrupt_pending_replace)) {
+            free(entry);
+            return MRAA_ERROR_FEATURE_NOT_SUPPORTED;
+        }
+        if (dev->advance_func->gpio_interrupt_handler_init_replace(dev) != MRAA_SUCCESS) {
+            free(entry);
+            return MRAA_ERROR_INVALID_RESOURCE;
+        }
+    } else if (dev->line_fd != -1) {
+        entry->fd = dup(dev->line_fd);
+        entry->chardev = 1;
+    } else {
+        char bu[MRAA_FS_PATH_MAX];
+        unsigned char c;
+        mraa_fs_path(bu, sizeof(bu), SYSFS_CLASS_GPIO "/gpio%d/value", dev->pin);
+        entry->fd = open(bu, O_RDONLY | O_CLOEXEC);
+        if (entry->fd != -1) {
+            // clear whatever was pending before the isr got registered
+            read(entry->fd, &c, 1);
+        }
+    }
+    if (entry->fd == -1 && !IS_FUNC_DEFINED(dev, gpio_interrupt_handler_init_replace)) {
+        syslog(LOG_ERR, "gpio%i: dispatch: failed to open interrupt fd: %s", dev->pin, strerror(errno));
+        free(entry);
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+
+    pthread_mutex_lock(&dispatch_lock);
+    if (!dispatch.running) {
+        pthread_mutex_unlock(&dispatch_lock);
+        if (entry->fd != -1)
+            close(entry->fd);
+        free(entry);
+        return MRAA_ERROR_FEATURE_NOT_SUPPORTED;
+    }
+    if (entry->fd != -1) {
+        memset(&ev, 0, sizeof(ev));
+        ev.events = entry->chardev ? EPOLLIN : EPOLLPRI;
+        ev.data.ptr = entry;
+        if (epoll_ctl(dispatch.epoll_fd, EPOLL_CTL_ADD, entry->fd, &ev) == -1) {
+            pthread_mutex_unlock(&dispatch_lock);
+            syslog(LOG_ERR, "gpio%i: dispatch: Failed to watch interrupt fd: %s", dev->pin, strerror(errno));
+            close(entry->fd);
+            free(entry);
+            return MRAA_ERROR_INVALID_RESOURCE;
+        }
+    } else if (dispatch.num_polled++ == 0) {
+        mraa_gpio_dispatch_arm_timer(1);
+    }
+    entry->next = dispatch.entries;
+    dispatch.entries = entry;
+    dev->isr_entry = entry;
+    dev->isr_value_fp = entry->fd;
+    pthread_mutex_unlock(&dispatch_lock);
+
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_dispatch_remove(mraa_gpio_context dev)
+{
+    struct _gpio_isr_entry* entry = dev->isr_entry;
+    struct _gpio_isr_entry** link;
+    mraa_boolean_t detached;
+    unsigned long epoch;
+
+    if (entry == NULL) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&dispatch_lock);
+    if (entry->fd != -1) {
+        epoll_ctl(dispatch.epoll_fd, EPOLL_CTL_DEL, entry->fd, NULL);
+    } else if (--dispatch.num_polled == 0) {
+        mraa_gpio_dispatch_arm_timer(0);
+    }
+    for (link = &dispatch.entries; *link != NULL; link = &(*link)->next) {
+        if (*link == entry) {
+            *link = entry->next;
+            break;
+        }
+    }
+    entry->removed = 1;
+
+    // the dispatcher may hold entry from an epoll_wait that returned before the DEL
+    epoch = dispatch.epoch;
+    mraa_gpio_dispatch_wake();
+    while (dispatch.epoch == epoch) {
+        pthread_cond_wait(&dispatch_done_cond, &dispatch_lock);
+    }
+
+    // isr_exit called from inside the callback, the worker frees the entry
+    detached = entry->running && pthread_equal(entry->worker, pthread_self());
+    entry->detached = detached;
+    while (entry->queued || (entry->running && !detached)) {
+        pthread_cond_wait(&dispatch_done_cond, &dispatch_lock);
+    }
+    pthread_mutex_unlock(&dispatch_lock);
+
+    if (entry->fd != -1) {
+        close(entry->fd);
+    } else if (IS_FUNC_DEFINED(dev, gpio_interrupt_handler_exit_replace)) {
+        dev->advance_func->gpio_interrupt_handler_exit_replace(dev);
+    }
+    dev->isr_entry = NULL;
+    dev->isr_value_fp = -1;
+    if (!detached) {
+        free(entry);
+    }
+    return MRAA_SUCCESS;
+}
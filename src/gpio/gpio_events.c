@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gpio.h"
+#include "gpio/gpio_events.h"
+#include "gpio/gpio_counter.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/eventfd.h>
+
+#define EVENTS_DEFAULT_SIZE 256
+#define EVENTS_MAX_SIZE 65536
+
+/**
+ * Single producer, single consumer ring of edge events
+ */
+struct _gpio_event_ring {
+    /*@{*/
+    mraa_gpio_event_t* buf; /**< storage, size entries */
+    unsigned int mask; /**< size - 1, size is a power of two */
+    unsigned int head; /**< next slot the producer fills, only written by the producer */
+    unsigned int tail; /**< next slot the consumer drains, only written by the consumer */
+    unsigned int seqno; /**< events seen by the producer, dropped ones included */
+    unsigned int dropped; /**< events lost because the ring was full */
+    int notify_fd; /**< eventfd signalled when the ring goes from empty to non empty */
+    /*@}*/
+};
+
+void
+mraa_gpio_event_push(mraa_gpio_context dev, uint64_t timestamp_ns, mraa_gpio_edge_t edge, unsigned int seqno)
+{
+    struct _gpio_event_ring* ring = __atomic_load_n(&dev->events, __ATOMIC_ACQUIRE);
+    unsigned int head, tail;
+
+    if (__atomic_load_n(&dev->counter, __ATOMIC_ACQUIRE) != NULL) {
+        mraa_gpio_counter_push(dev, timestamp_ns, edge);
+    }
+    if (ring == NULL) {
+        return;
+    }
+
+    ring->seqno++;
+    head = ring->head;
+    tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (head - tail > ring->mask) {
+        // never block the interrupt path, the gap in seqno tells the reader
+        __atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    mraa_gpio_event_t* ev = &ring->buf[head & ring->mask];
+    ev->timestamp_ns = timestamp_ns;
+    ev->edge = edge;
+    ev->seqno = seqno ? seqno : ring->seqno;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+    if (head == tail) {
+        uint64_t one = 1;
+        if (write(ring->notify_fd, &one, sizeof(one)) != sizeof(one)) {
+            syslog(LOG_DEBUG, "gpio%i: events: failed to notify reader", dev->pin);
+        }
+    }
+}
+
+void
+mraa_gpio_event_push_now(mraa_gpio_context dev, mraa_gpio_edge_t edge)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    mraa_gpio_event_push(dev, (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec, edge, 0);
+}
+
+mraa_result_t
+mraa_gpio_events_enable(mraa_gpio_context dev, mraa_gpio_edge_t edge, unsigned int queue_size)
+{
+    struct _gpio_event_ring* ring;
+    unsigned int size = 1;
+
+    if (dev == NULL) {
+        syslog(LOG_ERR, "gpio: events_enable: context is invalid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (dev->events != NULL) {
+        syslog(LOG_ERR, "gpio%i: events_enable: events already enabled", dev->pin);
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    // one isr per context, a callback or counter already owns it
+    if (dev->thread_id != 0 || dev->isr_entry != NULL) {
+        syslog(LOG_ERR, "gpio%i: events_enable: an isr is already installed", dev->pin);
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+
+    if (queue_size == 0) {
+        queue_size = EVENTS_DEFAULT_SIZE;
+    } else if (queue_size > EVENTS_MAX_SIZE) {
+        queue_size = EVENTS_MAX_SIZE;
+    }
+    while (size < queue_size) {
+        size <<= 1;
+    }
+
+    ring = (struct _gpio_event_ring*) calloc(1, sizeof(struct _gpio_event_ring));
+    if (ring == NULL) {
+        syslog(LOG_CRIT, "gpio%i: events_enable: Failed to allocate memory for ring", dev->pin);
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    ring->buf = (mraa_gpio_event_t*) calloc(size, sizeof(mraa_gpio_event_t));
+    ring->mask = size - 1;
+    ring->notify_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (ring->buf == NULL || ring->notify_fd == -1) {
+        syslog(LOG_ERR, "gpio%i: events_enable: Failed to set up ring", dev->pin);
+        if (ring->notify_fd != -1)
+            close(ring->notify_fd);
+        free(ring->buf);
+        free(ring);
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+
+    // no callback, the interrupt path only feeds the ring
+    mraa_result_t ret = mraa_gpio_isr(dev, edge, NULL, NULL);
+    if (ret != MRAA_SUCCESS) {
+        close(ring->notify_fd);
+        free(ring->buf);
+        free(ring);
+        return ret;
+    }
+    // published once nothing can fail, edges before this are not queued
+    __atomic_store_n(&dev->events, ring, __ATOMIC_RELEASE);
+    return MRAA_SUCCESS;
+}
+
+int
+mraa_gpio_events_read(mraa_gpio_context dev, mraa_gpio_event_t* events, unsigned int max_events, int timeout_ms)
+{
+    struct _gpio_event_ring* ring;
+    unsigned int head, tail, count = 0;
+    uint64_t ticks;
+
+    if (dev == NULL || dev->events == NULL || events == NULL) {
+        syslog(LOG_ERR, "gpio: events_read: context is invalid");
+        return -1;
+    }
+    ring = dev->events;
+    if (max_events == 0) {
+        return 0;
+    }
+
+    for (;;) {
+        tail = ring->tail;
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        while (tail != head && count < max_events) {
+            events[count++] = ring->buf[tail & ring->mask];
+            tail++;
+        }
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+        if (count > 0 || timeout_ms == 0) {
+            return (int) count;
+        }
+
+        // clear the notification before rechecking so a push in between is not lost
+        read(ring->notify_fd, &ticks, sizeof(ticks));
+        if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) != tail) {
+            continue;
+        }
+
+        struct pollfd pfd;
+        pfd.fd = ring->notify_fd;
+        pfd.events = POLLIN;
+        int rc = poll(&pfd, 1, timeout_ms);
+        if (rc == 0) {
+            return 0;
+        }
+        if (rc < 0 && errno != EINTR) {
+            syslog(LOG_ERR, "gpio%i: events_read: poll failed: %s", dev->pin, strerror(errno));
+            return -1;
+        }
+    }
+}
+
+unsigned int
+mraa_gpio_events_dropped(mraa_gpio_context dev)
+{
+    if (dev == NULL || dev->events == NULL) {
+        return 0;
+    }
+    return __atomic_load_n(&dev->events->dropped, __ATOMIC_RELAXED);
+}
+
+mraa_result_t
+mraa_gpio_events_disable(mraa_gpio_context dev)
+{
+    struct _gpio_event_ring* ring;
+
+    if (dev == NULL) {
+        syslog(LOG_ERR, "gpio: events_disable: context is invalid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    ring = dev->events;
+    if (ring == NULL) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+
+    // stop the producer before the ring goes away
+    mraa_result_t ret = mraa_gpio_isr_exit(dev);
+    dev->events = NULL;
+    close(ring->notify_fd);
+    free(ring->buf);
+    free(ring);
+    return ret;
+}
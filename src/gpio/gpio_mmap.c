@@ -0,0 +1,494 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "gpio.h"
+#include "gpio/gpio_mmap.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define REG(base, off) ((base)[(off) / sizeof(uint32_t)])
+
+// serialises mapping changes and every read-modify-write done by the engine
+static pthread_mutex_t mmap_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned int
+mraa_gpio_mmap_num_windows(mraa_gpio_mmap_desc_t* desc)
+{
+    return desc->bank_base != NULL ? desc->num_banks : 1;
+}
+
+static volatile uint32_t*
+mraa_gpio_mmap_bank(mraa_gpio_mmap_desc_t* desc, unsigned int bank)
+{
+    if (desc->bank_base != NULL) {
+        return (volatile uint32_t*) desc->window[bank];
+    }
+    return (volatile uint32_t*) (desc->window[0] + bank * desc->bank_stride);
+}
+
+static void
+mraa_gpio_mmap_unmap(mraa_gpio_mmap_desc_t* desc)
+{
+    unsigned int i;
+
+    for (i = 0; i < MRAA_GPIO_MMAP_MAX_WINDOWS; i++) {
+        if (desc->map[i] != NULL) {
+            munmap(desc->map[i], desc->map_size);
+            desc->map[i] = NULL;
+            desc->window[i] = NULL;
+        }
+    }
+    if (desc->fd >= 0) {
+        close(desc->fd);
+        desc->fd = -1;
+    }
+}
+
+static mraa_result_t
+mraa_gpio_mmap_map(mraa_gpio_mmap_desc_t* desc)
+{
+    unsigned int i, windows = mraa_gpio_mmap_num_windows(desc);
+    long page = sysconf(_SC_PAGESIZE);
+    size_t size = desc->size;
+    off_t base = desc->base;
+
+    if (windows > MRAA_GPIO_MMAP_MAX_WINDOWS) {
+        syslog(LOG_ERR, "%s mmap: too many register blocks", desc->name);
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    if (desc->iomem_name != NULL) {
+        uint64_t start, len;
+        if (mraa_find_iomem_resource(desc->iomem_name, &start, &len) != MRAA_SUCCESS) {
+            syslog(LOG_ERR, "%s mmap: no memory resource %s", desc->name, desc->iomem_name);
+            return MRAA_ERROR_NO_RESOURCES;
+        }
+        base += (off_t) start;
+        if (size == 0) {
+            size = (size_t) len;
+        }
+    }
+
+    if ((desc->fd = open(desc->path, O_RDWR | O_SYNC | O_CLOEXEC)) < 0) {
+        syslog(LOG_ERR, "%s mmap: unable to open %s", desc->name, desc->path);
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (size == 0) {
+        struct stat fd_stat;
+        if (fstat(desc->fd, &fd_stat) != 0 || fd_stat.st_size <= 0) {
+            syslog(LOG_ERR, "%s mmap: unable to size %s", desc->name, desc->path);
+            close(desc->fd);
+            desc->fd = -1;
+            return MRAA_ERROR_INVALID_HANDLE;
+        }
+        size = (size_t) fd_stat.st_size;
+    }
+
+    for (i = 0; i < windows; i++) {
+        off_t start = desc->bank_base != NULL ? desc->bank_base[i] : base;
+        // mmap wants a page aligned offset, keep the remainder for the window
+        size_t delta = (size_t)(start & (page - 1));
+        desc->map_size = (size + delta + page - 1) & ~((size_t) page - 1);
+        desc->map[i] = (uint8_t*) mmap(NULL, desc->map_size, PROT_READ | PROT_WRITE,
+                                       MAP_FILE | MAP_SHARED, desc->fd, start - (off_t) delta);
+        if (desc->map[i] == MAP_FAILED) {
+            syslog(LOG_ERR, "%s mmap: failed to mmap", desc->name);
+            desc->map[i] = NULL;
+            mraa_gpio_mmap_unmap(desc);
+            return MRAA_ERROR_NO_RESOURCES;
+        }
+        desc->window[i] = desc->map[i] + delta;
+    }
+    desc->window_size = size;
+    return MRAA_SUCCESS;
+}
+
+static int
+mraa_gpio_mmap_read_bank(mraa_gpio_context dev)
+{
+    return (REG(dev->mmap_reg, dev->mmap_desc->data_in) & dev->mmap_mask) ? 1 : 0;
+}
+
+static int
+mraa_gpio_mmap_read_pad(mraa_gpio_context dev)
+{
+    return (REG(dev->mmap_reg, dev->mmap_desc->data_in) & dev->mmap_desc->in_mask) ? 1 : 0;
+}
+
+static mraa_result_t
+mraa_gpio_mmap_write_setclr(mraa_gpio_context dev, int value)
+{
+    if (value) {
+        REG(dev->mmap_reg, dev->mmap_desc->set) = dev->mmap_mask;
+    } else {
+        REG(dev->mmap_reg, dev->mmap_desc->clear) = dev->mmap_mask;
+    }
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mraa_gpio_mmap_write_latch(mraa_gpio_context dev, int value)
+{
+    volatile uint32_t* reg = &REG(dev->mmap_reg, dev->mmap_desc->data_out);
+    uint32_t mask = dev->mmap_desc->pins_per_bank == 1 ? dev->mmap_desc->out_mask : dev->mmap_mask;
+
+    pthread_mutex_lock(&mmap_lock);
+    *reg = value ? (*reg | mask) : (*reg & ~mask);
+    pthread_mutex_unlock(&mmap_lock);
+    return MRAA_SUCCESS;
+}
+
+static volatile uint32_t*
+mraa_gpio_mmap_dir_field(mraa_gpio_context dev, unsigned int* shift)
+{
+    mraa_gpio_mmap_desc_t* desc = dev->mmap_desc;
+    unsigned int per_reg = 32 / desc->dir_bits;
+    unsigned int index;
+    volatile uint32_t* base;
+
+    if (desc->dir_global) {
+        index = dev->mmap_line;
+        base = mraa_gpio_mmap_bank(desc, 0);
+    } else {
+        index = dev->mmap_line % desc->pins_per_bank;
+        base = dev->mmap_reg;
+    }
+    *shift = (index % per_reg) * desc->dir_bits;
+    return &REG(base, desc->dir + (index / per_reg) * sizeof(uint32_t));
+}
+
+static mraa_result_t
+mraa_gpio_mmap_dir(mraa_gpio_context dev, mraa_gpio_dir_t dir)
+{
+    mraa_gpio_mmap_desc_t* desc = dev->mmap_desc;
+    uint32_t field_mask = (desc->dir_bits == 32) ? 0xffffffff : ((1u << desc->dir_bits) - 1);
+    uint32_t field;
+    unsigned int shift;
+
+    switch (dir) {
+        case MRAA_GPIO_OUT_HIGH:
+        case MRAA_GPIO_OUT_LOW:
+            // latch the level first so the line never glitches
+            dev->mmap_write(dev, dir == MRAA_GPIO_OUT_HIGH);
+        // fall through
+        case MRAA_GPIO_OUT:
+            field = desc->dir_out;
+            break;
+        case MRAA_GPIO_IN:
+            field = desc->dir_in;
+            break;
+        default:
+            return MRAA_ERROR_FEATURE_NOT_IMPLEMENTED;
+    }
+
+    volatile uint32_t* reg = mraa_gpio_mmap_dir_field(dev, &shift);
+    pthread_mutex_lock(&mmap_lock);
+    *reg = (*reg & ~(field_mask << shift)) | (field << shift);
+    pthread_mutex_unlock(&mmap_lock);
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mraa_gpio_mmap_read_dir(mraa_gpio_context dev, mraa_gpio_dir_t* dir)
+{
+    mraa_gpio_mmap_desc_t* desc = dev->mmap_desc;
+    uint32_t field_mask = (desc->dir_bits == 32) ? 0xffffffff : ((1u << desc->dir_bits) - 1);
+    unsigned int shift;
+
+    uint32_t field = (*mraa_gpio_mmap_dir_field(dev, &shift) >> shift) & field_mask;
+    if (field == desc->dir_out) {
+        *dir = MRAA_GPIO_OUT;
+    } else if (field == desc->dir_in) {
+        *dir = MRAA_GPIO_IN;
+    } else {
+        // muxed to a peripheral, neither in nor out
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_mmap_setup(mraa_gpio_mmap_desc_t* desc, mraa_gpio_context dev, unsigned int line, mraa_boolean_t en)
+{
+    if (dev == NULL || desc == NULL) {
+        syslog(LOG_ERR, "gpio: mmap: context not valid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+
+    pthread_mutex_lock(&mmap_lock);
+    if (en == 0) {
+        if (dev->mmap_desc != desc) {
+            pthread_mutex_unlock(&mmap_lock);
+            syslog(LOG_ERR, "%s mmap: can't disable disabled mmap gpio", desc->name);
+            return MRAA_ERROR_INVALID_PARAMETER;
+        }
+        dev->mmap_write = NULL;
+        dev->mmap_read = NULL;
+        dev->mmap_dir = NULL;
+        dev->mmap_read_dir = NULL;
+        dev->mmap_reg = NULL;
+        dev->mmap_desc = NULL;
+        if (--desc->users == 0) {
+            mraa_gpio_mmap_unmap(desc);
+        }
+        pthread_mutex_unlock(&mmap_lock);
+        return MRAA_SUCCESS;
+    }
+
+    if (dev->mmap_desc != NULL) {
+        pthread_mutex_unlock(&mmap_lock);
+        syslog(LOG_ERR, "%s mmap: can't enable enabled mmap gpio", desc->name);
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+
+    unsigned int bank = line / desc->pins_per_bank;
+    if (desc->num_banks != 0 && bank >= desc->num_banks) {
+        pthread_mutex_unlock(&mmap_lock);
+        syslog(LOG_ERR, "%s mmap: gpio%i outside of the register map", desc->name, dev->pin);
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+
+    if (desc->users == 0) {
+        mraa_result_t ret = mraa_gpio_mmap_map(desc);
+        if (ret != MRAA_SUCCESS) {
+            pthread_mutex_unlock(&mmap_lock);
+            return ret;
+        }
+    }
+
+    // the highest register the line touches has to lie inside the mapping
+    int last = desc->data_in;
+    last = desc->data_out > last ? desc->data_out : last;
+    last = desc->set > last ? desc->set : last;
+    last = desc->clear > last ? desc->clear : last;
+    if (desc->bank_base == NULL && bank * desc->bank_stride + last + sizeof(uint32_t) > desc->window_size) {
+        if (desc->users == 0) {
+            mraa_gpio_mmap_unmap(desc);
+        }
+        pthread_mutex_unlock(&mmap_lock);
+        syslog(LOG_ERR, "%s mmap: gpio%i outside of the register map", desc->name, dev->pin);
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+
+    desc->users++;
+    dev->mmap_desc = desc;
+    dev->mmap_line = line;
+    dev->mmap_reg = mraa_gpio_mmap_bank(desc, bank);
+    dev->mmap_mask = (uint32_t) 1 << (line % desc->pins_per_bank);
+    if (desc->data_in != MRAA_GPIO_MMAP_NONE) {
+        dev->mmap_read = desc->pins_per_bank == 1 ? &mraa_gpio_mmap_read_pad : &mraa_gpio_mmap_read_bank;
+    }
+    if (desc->set != MRAA_GPIO_MMAP_NONE && desc->clear != MRAA_GPIO_MMAP_NONE) {
+        dev->mmap_write = &mraa_gpio_mmap_write_setclr;
+    } else if (desc->data_out != MRAA_GPIO_MMAP_NONE) {
+        dev->mmap_write = &mraa_gpio_mmap_write_latch;
+    }
+    if (desc->dir != MRAA_GPIO_MMAP_NONE && dev->mmap_write != NULL) {
+        dev->mmap_dir = &mraa_gpio_mmap_dir;
+        dev->mmap_read_dir = &mraa_gpio_mmap_read_dir;
+    }
+    pthread_mutex_unlock(&mmap_lock);
+
+    return MRAA_SUCCESS;
+}
+
+uint32_t
+mraa_gpio_mmap_bank_read(mraa_gpio_mmap_desc_t* desc, unsigned int bank)
+{
+    return REG(mraa_gpio_mmap_bank(desc, bank), desc->data_in);
+}
+
+mraa_result_t
+mraa_gpio_mmap_bank_update(mraa_gpio_mmap_desc_t* desc, unsigned int bank, uint32_t set, uint32_t clear)
+{
+    volatile uint32_t* regs = mraa_gpio_mmap_bank(desc, bank);
+
+    if (desc->set != MRAA_GPIO_MMAP_NONE && desc->clear != MRAA_GPIO_MMAP_NONE) {
+        // set and clear registers ignore zero bits, no need to read back
+        if (set) {
+            REG(regs, desc->set) = set;
+        }
+        if (clear) {
+            REG(regs, desc->clear) = clear;
+        }
+        return MRAA_SUCCESS;
+    }
+    if (desc->data_out == MRAA_GPIO_MMAP_NONE) {
+        return MRAA_ERROR_FEATURE_NOT_SUPPORTED;
+    }
+    pthread_mutex_lock(&mmap_lock);
+    REG(regs, desc->data_out) = (REG(regs, desc->data_out) & ~clear) | set;
+    pthread_mutex_unlock(&mmap_lock);
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mraa_gpio_mmap_write_multi(mraa_gpio_group_context group, int* values)
+{
+    int i, j;
+
+    // members of one bank share mmap_reg, fold them into a single update
+    for (i = 0; i < group->num_pins; i++) {
+        mraa_gpio_context dev = group->gpio[i];
+        mraa_gpio_mmap_desc_t* desc = dev->mmap_desc;
+        uint32_t set = 0, clear = 0;
+
+        if (desc->pins_per_bank == 1) {
+            dev->mmap_write(dev, values[i]);
+            continue;
+        }
+        for (j = 0; j < i; j++) {
+            if (group->gpio[j]->mmap_reg == dev->mmap_reg) {
+                break;
+            }
+        }
+        if (j < i) {
+            continue;
+        }
+        for (j = i; j < group->num_pins; j++) {
+            if (group->gpio[j]->mmap_reg != dev->mmap_reg) {
+                continue;
+            }
+            if (values[j]) {
+                set |= group->gpio[j]->mmap_mask;
+            } else {
+                clear |= group->gpio[j]->mmap_mask;
+            }
+        }
+        mraa_result_t ret = mraa_gpio_mmap_bank_update(desc, dev->mmap_line / desc->pins_per_bank, set, clear);
+        if (ret != MRAA_SUCCESS) {
+            return ret;
+        }
+    }
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mraa_gpio_mmap_read_multi(mraa_gpio_group_context group, int* values)
+{
+    int i, j;
+
+    // one load per bank, members of a bank already read reuse it
+    for (i = 0; i < group->num_pins; i++) {
+        mraa_gpio_context dev = group->gpio[i];
+        uint32_t level;
+
+        for (j = 0; j < i; j++) {
+            if (group->gpio[j]->mmap_reg == dev->mmap_reg && dev->mmap_desc->pins_per_bank > 1) {
+                break;
+            }
+        }
+        if (j < i) {
+            continue;
+        }
+        if (dev->mmap_desc->pins_per_bank == 1) {
+            values[i] = dev->mmap_read(dev);
+            continue;
+        }
+        level = REG(dev->mmap_reg, dev->mmap_desc->data_in);
+        for (j = i; j < group->num_pins; j++) {
+            if (group->gpio[j]->mmap_reg == dev->mmap_reg) {
+                values[j] = (level & group->gpio[j]->mmap_mask) ? 1 : 0;
+            }
+        }
+    }
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_gpio_mmap_setup_multi(mraa_gpio_group_context group, mraa_boolean_t en)
+{
+    int i;
+    mraa_result_t ret = MRAA_SUCCESS;
+
+    if (group == NULL) {
+        syslog(LOG_ERR, "gpio: mmap_multi: context not valid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+
+    if (en == 0) {
+        if (group->mmap_taken == NULL) {
+            syslog(LOG_ERR, "gpio: mmap_multi: can't disable disabled mmap group");
+            return MRAA_ERROR_INVALID_PARAMETER;
+        }
+        group->mmap_write_multi = NULL;
+        group->mmap_read_multi = NULL;
+        // members the caller mapped on their own stay mapped
+        for (i = 0; i < group->num_pins; i++) {
+            if (group->mmap_taken[i] && group->gpio[i]->mmap_desc != NULL) {
+                mraa_result_t r = mraa_gpio_use_mmaped(group->gpio[i], 0);
+                ret = ret == MRAA_SUCCESS ? r : ret;
+            }
+        }
+        free(group->mmap_taken);
+        group->mmap_taken = NULL;
+        return ret;
+    }
+
+    if (group->mmap_taken != NULL) {
+        syslog(LOG_ERR, "gpio: mmap_multi: can't enable enabled mmap group");
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    mraa_boolean_t* taken = (mraa_boolean_t*) calloc(group->num_pins, sizeof(mraa_boolean_t));
+    if (taken == NULL) {
+        syslog(LOG_CRIT, "gpio: mmap_multi: Failed to allocate memory");
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+
+    mraa_boolean_t readable = 1, writable = 1;
+    for (i = 0; i < group->num_pins; i++) {
+        mraa_gpio_context dev = group->gpio[i];
+        if (dev->mmap_desc == NULL) {
+            ret = mraa_gpio_use_mmaped(dev, 1);
+            taken[i] = ret == MRAA_SUCCESS && dev->mmap_desc != NULL;
+        }
+        if (ret == MRAA_SUCCESS && dev->mmap_desc == NULL) {
+            // the platform mapped this pin without the engine
+            ret = MRAA_ERROR_FEATURE_NOT_SUPPORTED;
+        }
+        if (ret != MRAA_SUCCESS) {
+            for (; i >= 0; i--) {
+                if (taken[i]) {
+                    mraa_gpio_use_mmaped(group->gpio[i], 0);
+                }
+            }
+            free(taken);
+            return ret;
+        }
+        readable = readable && dev->mmap_read != NULL;
+        writable = writable && dev->mmap_write != NULL;
+    }
+    if (readable) {
+        group->mmap_read_multi = &mraa_gpio_mmap_read_multi;
+    }
+    if (writable) {
+        group->mmap_write_multi = &mraa_gpio_mmap_write_multi;
+    }
+    group->mmap_taken = taken;
+    return MRAA_SUCCESS;
+}
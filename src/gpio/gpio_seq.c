@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#define _GNU_SOURCE
+#include "gpio.h"
+#include "gpio/gpio_mmap.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#define SEQ_MAX_PINS 32
+// sleep until this close to a deadline, then spin
+#define SEQ_SPIN_NS 100000
+// stack touched and locked by the sequencer thread before it starts
+#define SEQ_STACK_PREFAULT (16 * 1024)
+
+/**
+ * A register write of a step, precomputed so playing a step does no lookups
+ */
+typedef struct {
+    mraa_gpio_context dev; /**< member written, first member of the bank for banked writes */
+    uint32_t set; /**< bank lines driven high, non zero for a high single write */
+    uint32_t clear; /**< bank lines driven low */
+    int bank; /**< bank updated at once, -1 to go through dev->mmap_write */
+} seq_op_t;
+
+typedef struct {
+    const mraa_gpio_seq_step_t* steps; /**< the caller's steps, for the delays */
+    unsigned int num_steps; /**< entries in steps */
+    unsigned int repeat; /**< times the steps are played */
+    seq_op_t* ops; /**< writes of every step, in step order */
+    unsigned int* first_op; /**< index in ops of the first write of each step, num_steps + 1 entries */
+    mraa_gpio_seq_stats_t stats; /**< filled by the thread */
+    mraa_result_t result; /**< first write failure of the thread */
+} seq_program_t;
+
+static inline uint64_t
+mraa_gpio_seq_now()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static inline void
+mraa_gpio_seq_wait(uint64_t deadline)
+{
+    uint64_t now = mraa_gpio_seq_now();
+
+    // long gaps give the cpu back, the last stretch is spun for precision
+    if (deadline > now + SEQ_SPIN_NS) {
+        struct timespec ts;
+        uint64_t wake = deadline - SEQ_SPIN_NS;
+        ts.tv_sec = wake / 1000000000ULL;
+        ts.tv_nsec = wake % 1000000000ULL;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+            ;
+    }
+    while (mraa_gpio_seq_now() < deadline)
+        ;
+}
+
+static mraa_result_t
+mraa_gpio_seq_compile(mraa_gpio_group_context group, seq_program_t* prog)
+{
+    unsigned int s, n = 0;
+    int i, j;
+
+    for (s = 0; s < prog->num_steps; s++) {
+        const mraa_gpio_seq_step_t* step = &prog->steps[s];
+        unsigned int first = n;
+
+        prog->first_op[s] = first;
+        if (group->num_pins < SEQ_MAX_PINS && (step->mask >> group->num_pins) != 0) {
+            syslog(LOG_ERR, "gpio: sequence: step %u drives pins outside of the group", s);
+            return MRAA_ERROR_INVALID_PARAMETER;
+        }
+        for (i = 0; i < group->num_pins; i++) {
+            mraa_gpio_context dev = group->gpio[i];
+            int high = (step->value >> i) & 1;
+
+            if (!((step->mask >> i) & 1)) {
+                continue;
+            }
+            if (dev->mmap_write == NULL) {
+                syslog(LOG_ERR, "gpio%i: sequence: pin is not memory mapped", dev->pin);
+                return MRAA_ERROR_INVALID_RESOURCE;
+            }
+            if (dev->mmap_desc == NULL || dev->mmap_desc->pins_per_bank == 1) {
+                prog->ops[n].dev = dev;
+                prog->ops[n].set = high;
+                prog->ops[n].clear = !high;
+                prog->ops[n].bank = -1;
+                n++;
+                continue;
+            }
+            // members sharing a bank register become one write
+            for (j = first; j < (int) n; j++) {
+                if (prog->ops[j].bank >= 0 && prog->ops[j].dev->mmap_reg == dev->mmap_reg) {
+                    break;
+                }
+            }
+            if (j == (int) n) {
+                prog->ops[n].dev = dev;
+                prog->ops[n].set = 0;
+                prog->ops[n].clear = 0;
+                prog->ops[n].bank = dev->mmap_line / dev->mmap_desc->pins_per_bank;
+                n++;
+            }
+            if (high) {
+                prog->ops[j].set |= dev->mmap_mask;
+            } else {
+                prog->ops[j].clear |= dev->mmap_mask;
+            }
+        }
+    }
+    prog->first_op[prog->num_steps] = n;
+    return MRAA_SUCCESS;
+}
+
+static void*
+mraa_gpio_seq_run(void* arg)
+{
+    seq_program_t* prog = (seq_program_t*) arg;
+    mraa_gpio_seq_stats_t* stats = &prog->stats;
+    size_t ops_size = prog->first_op[prog->num_steps] * sizeof(seq_op_t);
+    size_t first_size = (prog->num_steps + 1) * sizeof(unsigned int);
+    volatile char prefault[SEQ_STACK_PREFAULT];
+    uint64_t start, due, last_due = 0, first_write = 0, last_write = 0, abs_error = 0;
+    unsigned int r, s, k;
+    int locked;
+
+    // fault in everything the loop touches so it never waits on a page
+    memset((char*) prefault, 0, sizeof(prefault));
+    locked = mlock((const void*) prefault, sizeof(prefault)) == 0;
+    locked = (mlock(prog->ops, ops_size) == 0) && locked;
+    locked = (mlock(prog->first_op, first_size) == 0) && locked;
+    locked = (mlock(prog->steps, prog->num_steps * sizeof(mraa_gpio_seq_step_t)) == 0) && locked;
+    if (mraa_set_priority(sched_get_priority_max(SCHED_RR)) == 0 && locked) {
+        stats->realtime = 1;
+    } else {
+        syslog(LOG_WARNING, "gpio: sequence: running without realtime priority or locked memory");
+    }
+
+    start = due = mraa_gpio_seq_now();
+    stats->min_error_ns = INT64_MAX;
+    stats->max_error_ns = INT64_MIN;
+    for (r = 0; r < prog->repeat && prog->result == MRAA_SUCCESS; r++) {
+        for (s = 0; s < prog->num_steps; s++) {
+            mraa_gpio_seq_wait(due);
+            uint64_t written = mraa_gpio_seq_now();
+            for (k = prog->first_op[s]; k < prog->first_op[s + 1]; k++) {
+                seq_op_t* op = &prog->ops[k];
+                mraa_result_t ret;
+                if (op->bank >= 0) {
+                    ret = mraa_gpio_mmap_bank_update(op->dev->mmap_desc, op->bank, op->set, op->clear);
+                } else {
+                    ret = op->dev->mmap_write(op->dev, op->set != 0);
+                }
+                if (ret != MRAA_SUCCESS && prog->result == MRAA_SUCCESS) {
+                    prog->result = ret;
+                }
+            }
+
+            int64_t error = (int64_t)(written - due);
+            if (error < stats->min_error_ns) {
+                stats->min_error_ns = error;
+            }
+            if (error > stats->max_error_ns) {
+                stats->max_error_ns = error;
+            }
+            abs_error += error < 0 ? -error : error;
+            if (stats->steps++ == 0) {
+                first_write = written;
+            }
+            last_write = written;
+            last_due = due;
+            due += prog->steps[s].delay_ns;
+        }
+    }
+
+    stats->requested_ns = last_due - start;
+    stats->duration_ns = last_write - first_write;
+    stats->mean_abs_error_ns = stats->steps ? abs_error / stats->steps : 0;
+
+    munlock(prog->steps, prog->num_steps * sizeof(mraa_gpio_seq_step_t));
+    munlock(prog->first_op, first_size);
+    munlock(prog->ops, ops_size);
+    munlock((const void*) prefault, sizeof(prefault));
+    return NULL;
+}
+
+mraa_result_t
+mraa_gpio_sequence(mraa_gpio_group_context group,
+                   const mraa_gpio_seq_step_t* steps,
+                   unsigned int num_steps,
+                   unsigned int repeat,
+                   int cpu,
+                   mraa_gpio_seq_stats_t* stats)
+{
+    seq_program_t prog;
+    pthread_attr_t attr;
+    pthread_t thread;
+    mraa_result_t ret;
+
+    if (group == NULL || steps == NULL || num_steps == 0) {
+        syslog(LOG_ERR, "gpio: sequence: context is invalid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (group->num_pins > SEQ_MAX_PINS) {
+        syslog(LOG_ERR, "gpio: sequence: group has more than %d pins", SEQ_MAX_PINS);
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+
+    memset(&prog, 0, sizeof(prog));
+    prog.steps = steps;
+    prog.num_steps = num_steps;
+    prog.repeat = repeat ? repeat : 1;
+    prog.ops = (seq_op_t*) calloc((size_t) num_steps * group->num_pins, sizeof(seq_op_t));
+    prog.first_op = (unsigned int*) calloc(num_steps + 1, sizeof(unsigned int));
+    if (prog.ops == NULL || prog.first_op == NULL) {
+        syslog(LOG_CRIT, "gpio: sequence: Failed to allocate memory for program");
+        ret = MRAA_ERROR_NO_RESOURCES;
+        goto out;
+    }
+    ret = mraa_gpio_seq_compile(group, &prog);
+    if (ret != MRAA_SUCCESS) {
+        goto out;
+    }
+
+    pthread_attr_init(&attr);
+    if (cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    }
+    int err = pthread_create(&thread, &attr, mraa_gpio_seq_run, &prog);
+    pthread_attr_destroy(&attr);
+    if (err != 0) {
+        syslog(LOG_ERR, "gpio: sequence: unable to start thread on cpu %d: %s", cpu, strerror(err));
+        ret = MRAA_ERROR_INVALID_PARAMETER;
+        goto out;
+    }
+    pthread_join(thread, NULL);
+
+    ret = prog.result;
+    if (stats != NULL) {
+        *stats = prog.stats;
+    }
+out:
+    free(prog.first_op);
+    free(prog.ops);
+    return ret;
+}
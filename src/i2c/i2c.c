@@ -27,6 +27,9 @@
 
 #include "i2c.h"
 #include "mraa_internal.h"
+#include "mraa_stats.h"
+#include "mraa_trace.h"
+#include "i2c/i2c_async.h"
 
 #include <stdlib.h>
 #include <unistd.h>
@@ -38,6 +41,7 @@
 #include "linux/i2c-dev.h"
 #include <errno.h>
 #include <string.h>
+#include <pthread.h>
 
 typedef union i2c_smbus_data_union {
     uint8_t byte;        ///< data byte
@@ -53,6 +57,26 @@ typedef struct i2c_smbus_ioctl_data_struct {
     i2c_smbus_data_t* data; ///< data
 } i2c_smbus_ioctl_data_t;
 
+/**
+ * A /dev/i2c-* device shared by every context on the bus. Plain i2c
+ * transfers carry the slave address in each message and need no locking,
+ * SMBus calls go to the address last set on the fd and hold lock while they
+ * select and use it.
+ */
+struct _i2c_bus {
+    /*@{*/
+    int busnum; /**< the bus number of the /dev/i2c-* device */
+    int fh; /**< the file handle to the /dev/i2c-* device */
+    unsigned long funcs; /**< /dev/i2c-* device capabilities */
+    int refs; /**< contexts using the bus */
+    int addr; /**< slave address set on fh, -1 for none */
+    pthread_mutex_t lock; /**< serialises selecting the slave and the SMBus call */
+    struct _i2c_bus* next; /**< next bus in the registry */
+    /*@}*/
+};
+
+static struct _i2c_bus* i2c_buses = NULL;
+static pthread_mutex_t i2c_buses_lock = PTHREAD_MUTEX_INITIALIZER;
 
 // static mraa_adv_func_t* func_table;
 
@@ -69,6 +93,114 @@ mraa_i2c_smbus_access(int fh, uint8_t read_write, uint8_t command, int size, i2c
     return ioctl(fh, I2C_SMBUS, &args);
 }
 
+static struct _i2c_bus*
+mraa_i2c_bus_get(unsigned int busnum)
+{
+    struct _i2c_bus* bus;
+
+    pthread_mutex_lock(&i2c_buses_lock);
+    for (bus = i2c_buses; bus != NULL; bus = bus->next) {
+        if (bus->busnum == (int) busnum) {
+            bus->refs++;
+            pthread_mutex_unlock(&i2c_buses_lock);
+            return bus;
+        }
+    }
+
+    bus = (struct _i2c_bus*) calloc(1, sizeof(struct _i2c_bus));
+    if (bus == NULL) {
+        syslog(LOG_CRIT, "i2c%i_init: Failed to allocate memory for bus", busnum);
+        pthread_mutex_unlock(&i2c_buses_lock);
+        return NULL;
+    }
+    char filepath[MRAA_FS_PATH_MAX];
+    mraa_fs_path(filepath, sizeof(filepath), "/dev/i2c-%u", busnum);
+    if ((bus->fh = open(filepath, O_RDWR | O_CLOEXEC)) < 1) {
+        syslog(LOG_ERR, "i2c%i_init: Failed to open requested i2c port %s: %s", busnum, filepath, strerror(errno));
+        free(bus);
+        pthread_mutex_unlock(&i2c_buses_lock);
+        return NULL;
+    }
+    if (ioctl(bus->fh, I2C_FUNCS, &bus->funcs) < 0) {
+        syslog(LOG_CRIT, "i2c%i_init: Failed to get I2C_FUNC map from device: %s", busnum, strerror(errno));
+        bus->funcs = 0;
+    }
+    bus->busnum = busnum;
+    bus->refs = 1;
+    bus->addr = -1;
+    pthread_mutex_init(&bus->lock, NULL);
+    bus->next = i2c_buses;
+    i2c_buses = bus;
+    pthread_mutex_unlock(&i2c_buses_lock);
+    return bus;
+}
+
+static void
+mraa_i2c_bus_put(struct _i2c_bus* bus)
+{
+    struct _i2c_bus** link;
+
+    pthread_mutex_lock(&i2c_buses_lock);
+    if (--bus->refs == 0) {
+        for (link = &i2c_buses; *link != NULL; link = &(*link)->next) {
+            if (*link == bus) {
+                *link = bus->next;
+                break;
+            }
+        }
+        close(bus->fh);
+        pthread_mutex_destroy(&bus->lock);
+        free(bus);
+    }
+    pthread_mutex_unlock(&i2c_buses_lock);
+}
+
+/* one plain i2c transfer, every message names its slave */
+static int
+mraa_i2c_rdwr(mraa_i2c_context dev, struct i2c_msg* msgs, int nmsgs)
+{
+    struct i2c_rdwr_ioctl_data d;
+
+    d.msgs = msgs;
+    d.nmsgs = nmsgs;
+    return ioctl(dev->fh, I2C_RDWR, &d);
+}
+
+/* takes the bus and points its fd at the slave of the context */
+static int
+mraa_i2c_bus_acquire(mraa_i2c_context dev)
+{
+    struct _i2c_bus* bus = dev->bus;
+
+    pthread_mutex_lock(&bus->lock);
+    if (bus->addr != dev->addr) {
+        if (ioctl(bus->fh, I2C_SLAVE_FORCE, dev->addr) < 0) {
+            pthread_mutex_unlock(&bus->lock);
+            return -1;
+        }
+        bus->addr = dev->addr;
+    }
+    return 0;
+}
+
+static void
+mraa_i2c_bus_release(mraa_i2c_context dev)
+{
+    pthread_mutex_unlock(&dev->bus->lock);
+}
+
+/* one SMBus call to the slave of the context, on a bus others may share */
+static int
+mraa_i2c_smbus(mraa_i2c_context dev, uint8_t read_write, uint8_t command, int size, i2c_smbus_data_t* data)
+{
+    if (mraa_i2c_bus_acquire(dev) < 0) {
+        return -1;
+    }
+    int ret = mraa_i2c_smbus_access(dev->fh, read_write, command, size, data);
+    mraa_i2c_bus_release(dev);
+    return ret;
+}
+
 static mraa_i2c_context
 mraa_i2c_init_internal(mraa_adv_func_t* advance_func, unsigned int bus)
 {
@@ -85,6 +217,8 @@ mraa_i2c_init_internal(mraa_adv_func_t* advance_func, unsigned int bus)
 
     dev->advance_func = advance_func;
     dev->busnum = bus;
+    dev->scl_pin = -1;
+    dev->sda_pin = -1;
 
     if (IS_FUNC_DEFINED(dev, i2c_init_pre)) {
         status = advance_func->i2c_init_pre(bus);
@@ -97,18 +231,13 @@ mraa_i2c_init_internal(mraa_adv_func_t* advance_func, unsigned int bus)
         if (status != MRAA_SUCCESS)
             goto init_internal_cleanup;
     } else {
-        char filepath[32];
-        snprintf(filepath, 32, "/dev/i2c-%u", bus);
-        if ((dev->fh = open(filepath, O_RDWR)) < 1) {
-            syslog(LOG_ERR, "i2c%i_init: Failed to open requested i2c port %s: %s", bus, filepath, strerror(errno));
+        dev->bus = mraa_i2c_bus_get(bus);
+        if (dev->bus == NULL) {
             status = MRAA_ERROR_INVALID_RESOURCE;
             goto init_internal_cleanup;
         }
-
-        if (ioctl(dev->fh, I2C_FUNCS, &dev->funcs) < 0) {
-            syslog(LOG_CRIT, "i2c%i_init: Failed to get I2C_FUNC map from device: %s", bus, strerror(errno));
-            dev->funcs = 0;
-        }
+        dev->fh = dev->bus->fh;
+        dev->funcs = dev->bus->funcs;
     }
 
     if (IS_FUNC_DEFINED(dev, i2c_init_post)) {
@@ -122,8 +251,9 @@ init_internal_cleanup:
     if (status == MRAA_SUCCESS) {
         return dev;
     } else {
-        if (dev != NULL)
-            free(dev);
+        if (dev->bus != NULL)
+            mraa_i2c_bus_put(dev->bus);
+        free(dev);
         return NULL;
    }
 }
@@ -180,7 +310,13 @@ mraa_i2c_init(int bus)
         }
     }
 
-    return mraa_i2c_init_internal(board->adv_func, (unsigned int) board->i2c_bus[bus].bus_id);
+    mraa_i2c_context dev = mraa_i2c_init_internal(board->adv_func, (unsigned int) board->i2c_bus[bus].bus_id);
+    if (dev != NULL && board == plat) {
+        // sub platform pins are not gpios of this board
+        dev->scl_pin = board->i2c_bus[bus].scl;
+        dev->sda_pin = board->i2c_bus[bus].sda;
+    }
+    return dev;
 }
 
 
@@ -200,15 +336,78 @@ mraa_i2c_frequency(mraa_i2c_context dev, mraa_i2c_mode_t mode)
     return MRAA_ERROR_FEATURE_NOT_SUPPORTED;
 }
 
-int
-mraa_i2c_read(mraa_i2c_context dev, uint8_t* data, int length)
+static int
+mraa_i2c_retry_error(int err)
+{
+    switch (err) {
+        case EAGAIN:
+            return MRAA_I2C_RETRY_EAGAIN;
+        case EREMOTEIO:
+            return MRAA_I2C_RETRY_EREMOTEIO;
+        case ENXIO:
+            return MRAA_I2C_RETRY_ENXIO;
+        case ETIMEDOUT:
+            return MRAA_I2C_RETRY_ETIMEDOUT;
+        case EIO:
+            return MRAA_I2C_RETRY_EIO;
+        default:
+            // not a transfer error, trying again would fail the same way
+            return 0;
+    }
+}
+
+/*
+ * Called right after a failed attempt, with its result and the errno it
+ * left. Sleeps the backoff, recovering the bus first when the policy asks,
+ * and tells whether to try again. Calls rejected before reaching the bus
+ * are never retried.
+ */
+static mraa_boolean_t
+mraa_i2c_retry(mraa_i2c_context dev, mraa_result_t result, unsigned int attempt)
+{
+    int err = mraa_i2c_retry_error(errno);
+
+    if (dev == NULL || dev->retry.retries == 0) {
+        return 0;
+    }
+    if (result == MRAA_ERROR_INVALID_PARAMETER || result == MRAA_ERROR_FEATURE_NOT_SUPPORTED ||
+        result == MRAA_ERROR_INVALID_HANDLE || !(dev->retry.retry_on & err)) {
+        return 0;
+    }
+    if (attempt >= dev->retry.retries) {
+        __atomic_fetch_add(&dev->retry_stats.exhausted, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    if (dev->retry.recover_on & err) {
+        __atomic_fetch_add(&dev->retry_stats.recoveries, 1, __ATOMIC_RELAXED);
+        mraa_i2c_recover(dev);
+    }
+    uint64_t delay = (uint64_t) dev->retry.backoff_us << (attempt < 32 ? attempt : 32);
+    if (dev->retry.max_backoff_us != 0 && delay > dev->retry.max_backoff_us) {
+        delay = dev->retry.max_backoff_us;
+    }
+    if (delay > 0) {
+        usleep(delay > 1000000 ? 1000000 : (useconds_t) delay);
+    }
+    __atomic_fetch_add(&dev->retry_stats.retries, 1, __ATOMIC_RELAXED);
+    return 1;
+}
+
+static int
+mraa_i2c_read_internal(mraa_i2c_context dev, uint8_t* data, int length)
 {
     int bytes_read = 0;
     if (IS_FUNC_DEFINED(dev, i2c_read_replace)) {
         bytes_read = dev->advance_func->i2c_read_replace(dev, data, length);
     }
-    else {
+    else if (dev->funcs & I2C_FUNC_I2C) {
+        struct i2c_msg m = { dev->addr, I2C_M_RD, length, (char*) data };
+        bytes_read = mraa_i2c_rdwr(dev, &m, 1) < 0 ? -1 : length;
+    }
+    else if (mraa_i2c_bus_acquire(dev) == 0) {
+        // read() goes to the slave set on the fd, like SMBus calls
         bytes_read = read(dev->fh, data, length);
+        mraa_i2c_bus_release(dev);
     }
     if (bytes_read == length) {
         return length;
@@ -218,50 +417,126 @@ mraa_i2c_read(mraa_i2c_context dev, uint8_t* data, int length)
 }
 
 int
-mraa_i2c_read_byte(mraa_i2c_context dev)
+mraa_i2c_read(mraa_i2c_context dev, uint8_t* data, int length)
+{
+    MRAA_STATS_START(start);
+    int ret;
+    unsigned int attempt = 0;
+    do {
+        errno = 0;
+        ret = mraa_i2c_read_internal(dev, data, length);
+    } while (ret != length && mraa_i2c_retry(dev, MRAA_ERROR_UNSPECIFIED, attempt++));
+    MRAA_STATS_RECORD(dev, start, length, ret != length);
+    return ret;
+}
+
+static int
+mraa_i2c_read_byte_internal(mraa_i2c_context dev)
 {
     if (IS_FUNC_DEFINED(dev, i2c_read_byte_replace))
         return dev->advance_func->i2c_read_byte_replace(dev);
     i2c_smbus_data_t d;
-    if (mraa_i2c_smbus_access(dev->fh, I2C_SMBUS_READ, I2C_NOCMD, I2C_SMBUS_BYTE, &d) < 0) {
-        syslog(LOG_ERR, "i2c%i: read_byte: Access error: %s", dev->busnum, strerror(errno));
+    if (dev->funcs & I2C_FUNC_I2C) {
+        struct i2c_msg m = { dev->addr, I2C_M_RD, 1, (char*) &d.byte };
+        if (mraa_i2c_rdwr(dev, &m, 1) < 0) {
+            mraa_trace(LOG_ERR, MRAA_TRACE_I2C_READ_BYTE, dev->busnum, errno);
+            return -1;
+        }
+    } else if (mraa_i2c_smbus(dev, I2C_SMBUS_READ, I2C_NOCMD, I2C_SMBUS_BYTE, &d) < 0) {
+        mraa_trace(LOG_ERR, MRAA_TRACE_I2C_READ_BYTE, dev->busnum, errno);
         return -1;
     }
     return 0x0FF & d.byte;
 }
 
 int
-mraa_i2c_read_byte_data(mraa_i2c_context dev, uint8_t command)
+mraa_i2c_read_byte(mraa_i2c_context dev)
+{
+    MRAA_STATS_START(start);
+    int ret;
+    unsigned int attempt = 0;
+    do {
+        errno = 0;
+        ret = mraa_i2c_read_byte_internal(dev);
+    } while (ret == -1 && mraa_i2c_retry(dev, MRAA_ERROR_UNSPECIFIED, attempt++));
+    MRAA_STATS_RECORD(dev, start, 1, ret == -1);
+    return ret;
+}
+
+static int
+mraa_i2c_read_byte_data_internal(mraa_i2c_context dev, uint8_t command)
 {
     if (IS_FUNC_DEFINED(dev, i2c_read_byte_data_replace))
         return dev->advance_func->i2c_read_byte_data_replace(dev, command);
     i2c_smbus_data_t d;
-    if (mraa_i2c_smbus_access(dev->fh, I2C_SMBUS_READ, command, I2C_SMBUS_BYTE_DATA, &d) < 0) {
-       syslog(LOG_ERR, "i2c%i: read_byte_data: Access error: %s", dev->busnum, strerror(errno));
+    if (dev->funcs & I2C_FUNC_I2C) {
+        struct i2c_msg m[2] = { { dev->addr, 0, 1, (char*) &command }, { dev->addr, I2C_M_RD, 1, (char*) &d.byte } };
+        if (mraa_i2c_rdwr(dev, m, 2) < 0) {
+            mraa_trace(LOG_ERR, MRAA_TRACE_I2C_READ_BYTE_DATA, dev->busnum, errno);
+            return -1;
+        }
+    } else if (mraa_i2c_smbus(dev, I2C_SMBUS_READ, command, I2C_SMBUS_BYTE_DATA, &d) < 0) {
+       mraa_trace(LOG_ERR, MRAA_TRACE_I2C_READ_BYTE_DATA, dev->busnum, errno);
        return -1;
     }
     return 0x0FF & d.byte;
 }
 
 int
-mraa_i2c_read_word_data(mraa_i2c_context dev, uint8_t command)
+mraa_i2c_read_byte_data(mraa_i2c_context dev, uint8_t command)
+{
+    MRAA_STATS_START(start);
+    int ret;
+    unsigned int attempt = 0;
+    do {
+        errno = 0;
+        ret = mraa_i2c_read_byte_data_internal(dev, command);
+    } while (ret == -1 && mraa_i2c_retry(dev, MRAA_ERROR_UNSPECIFIED, attempt++));
+    MRAA_STATS_RECORD(dev, start, 1, ret == -1);
+    return ret;
+}
+
+static int
+mraa_i2c_read_word_data_internal(mraa_i2c_context dev, uint8_t command)
 {
     if (IS_FUNC_DEFINED(dev, i2c_read_word_data_replace))
         return dev->advance_func->i2c_read_word_data_replace(dev, command);
     i2c_smbus_data_t d;
-    if (mraa_i2c_smbus_access(dev->fh, I2C_SMBUS_READ, command, I2C_SMBUS_WORD_DATA, &d) < 0) {
-        syslog(LOG_ERR, "i2c%i: read_word_data: Access error: %s", dev->busnum, strerror(errno));
+    if (dev->funcs & I2C_FUNC_I2C) {
+        // SMBus words go low byte first
+        struct i2c_msg m[2] = { { dev->addr, 0, 1, (char*) &command }, { dev->addr, I2C_M_RD, 2, (char*) d.block } };
+        if (mraa_i2c_rdwr(dev, m, 2) < 0) {
+            mraa_trace(LOG_ERR, MRAA_TRACE_I2C_READ_WORD_DATA, dev->busnum, errno);
+            return -1;
+        }
+        return d.block[0] | (d.block[1] << 8);
+    }
+    if (mraa_i2c_smbus(dev, I2C_SMBUS_READ, command, I2C_SMBUS_WORD_DATA, &d) < 0) {
+        mraa_trace(LOG_ERR, MRAA_TRACE_I2C_READ_WORD_DATA, dev->busnum, errno);
         return -1;
     }
     return 0xFFFF & d.word;
 }
 
 int
-mraa_i2c_read_bytes_data(mraa_i2c_context dev, uint8_t command, uint8_t* data, int length)
+mraa_i2c_read_word_data(mraa_i2c_context dev, uint8_t command)
+{
+    MRAA_STATS_START(start);
+    int ret;
+    unsigned int attempt = 0;
+    do {
+        errno = 0;
+        ret = mraa_i2c_read_word_data_internal(dev, command);
+    } while (ret == -1 && mraa_i2c_retry(dev, MRAA_ERROR_UNSPECIFIED, attempt++));
+    MRAA_STATS_RECORD(dev, start, 2, ret == -1);
+    return ret;
+}
+
+static int
+mraa_i2c_read_bytes_data_internal(mraa_i2c_context dev, uint8_t command, uint8_t* data, int length)
 {
     if (IS_FUNC_DEFINED(dev, i2c_read_bytes_data_replace))
         return dev->advance_func->i2c_read_bytes_data_replace(dev, command, data, length);
-    struct i2c_rdwr_ioctl_data d;
     struct i2c_msg m[2];
 
     m[0].addr = dev->addr;
@@ -273,54 +548,135 @@ mraa_i2c_read_bytes_data(mraa_i2c_context dev, uint8_t command, uint8_t* data, i
     m[1].len = length;
     m[1].buf = (char*) data;
 
-    d.msgs = m;
-    d.nmsgs = 2;
-
-    int ret = ioctl(dev->fh, I2C_RDWR, &d);
+    int ret = mraa_i2c_rdwr(dev, m, 2);
 
     if (ret < 0)
     {
-        syslog(LOG_ERR, "i2c%i: read_bytes_data: Access error: %s", dev->busnum, strerror(errno));
+        mraa_trace(LOG_ERR, MRAA_TRACE_I2C_READ_BYTES_DATA, dev->busnum, errno);
         return -1;
     }
     return length;
 }
 
-mraa_result_t
-mraa_i2c_write(mraa_i2c_context dev, const uint8_t* data, int length)
+int
+mraa_i2c_read_bytes_data(mraa_i2c_context dev, uint8_t command, uint8_t* data, int length)
+{
+    MRAA_STATS_START(start);
+    int ret;
+    unsigned int attempt = 0;
+    do {
+        errno = 0;
+        ret = mraa_i2c_read_bytes_data_internal(dev, command, data, length);
+    } while (ret != length && mraa_i2c_retry(dev, MRAA_ERROR_UNSPECIFIED, attempt++));
+    MRAA_STATS_RECORD(dev, start, length, ret != length);
+    return ret;
+}
+
+/*
+ * Sends the caller's buffer as is. Messages longer than i2c-dev accepts are
+ * split and glued back together with I2C_M_NOSTART, so the slave still sees
+ * a single write.
+ */
+static mraa_result_t
+mraa_i2c_write_rdwr(mraa_i2c_context dev, const uint8_t* data, int length)
+{
+    struct i2c_msg m[MRAA_I2C_TRANSACTION_MAX_MSGS];
+    int n = 0, offset = 0;
+
+    if (length > MRAA_I2C_TRANSACTION_MAX_LENGTH && !(dev->funcs & I2C_FUNC_NOSTART)) {
+        syslog(LOG_ERR, "i2c%i: write: %d bytes is more than the adapter takes at once", dev->busnum, length);
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    if (length > MRAA_I2C_TRANSACTION_MAX_MSGS * MRAA_I2C_TRANSACTION_MAX_LENGTH) {
+        syslog(LOG_ERR, "i2c%i: write: %d bytes is more than one transfer holds", dev->busnum, length);
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+
+    do {
+        int chunk = length - offset;
+        if (chunk > MRAA_I2C_TRANSACTION_MAX_LENGTH) {
+            chunk = MRAA_I2C_TRANSACTION_MAX_LENGTH;
+        }
+        m[n].addr = dev->addr;
+        m[n].flags = n == 0 ? 0 : I2C_M_NOSTART;
+        m[n].len = chunk;
+        m[n].buf = (char*) data + offset;
+        offset += chunk;
+        n++;
+    } while (offset < length);
+
+    if (IS_FUNC_DEFINED(dev, i2c_transfer_replace)) {
+        return dev->advance_func->i2c_transfer_replace(dev, m, n);
+    }
+    if (mraa_i2c_rdwr(dev, m, n) < 0) {
+        mraa_trace(LOG_ERR, MRAA_TRACE_I2C_WRITE, dev->busnum, errno);
+        return MRAA_ERROR_UNSPECIFIED;
+    }
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mraa_i2c_write_internal(mraa_i2c_context dev, const uint8_t* data, int length)
 {
+    if (data == NULL || length < 1) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
     if (IS_FUNC_DEFINED(dev, i2c_write_replace))
         return dev->advance_func->i2c_write_replace(dev, data, length);
+    if (dev->funcs & I2C_FUNC_I2C) {
+        return mraa_i2c_write_rdwr(dev, data, length);
+    }
+
+    // SMBus only adapters, the first byte goes out as the command
     i2c_smbus_data_t d;
-    int i;
     uint8_t command = data[0];
 
     data = &data[1];
     length = length - 1;
     if (length > I2C_SMBUS_I2C_BLOCK_MAX) {
+        syslog(LOG_WARNING, "i2c%i: write: SMBus only adapter, sending %d of %d bytes", dev->busnum,
+               I2C_SMBUS_I2C_BLOCK_MAX + 1, length + 1);
         length = I2C_SMBUS_I2C_BLOCK_MAX;
     }
-
-    for (i = 1; i <= length; i++) {
-        d.block[i] = data[i - 1];
-    }
+    memcpy(&d.block[1], data, length);
     d.block[0] = length;
 
-    if (mraa_i2c_smbus_access(dev->fh, I2C_SMBUS_WRITE, command, I2C_SMBUS_I2C_BLOCK_DATA, &d) < 0) {
-        syslog(LOG_ERR, "i2c%i: write: Access error: %s", dev->busnum, strerror(errno));
+    if (mraa_i2c_smbus(dev, I2C_SMBUS_WRITE, command, I2C_SMBUS_I2C_BLOCK_DATA, &d) < 0) {
+        mraa_trace(LOG_ERR, MRAA_TRACE_I2C_WRITE, dev->busnum, errno);
         return MRAA_ERROR_UNSPECIFIED;
     }
     return MRAA_SUCCESS;
 }
 
 mraa_result_t
-mraa_i2c_write_byte(mraa_i2c_context dev, const uint8_t data)
+mraa_i2c_write(mraa_i2c_context dev, const uint8_t* data, int length)
+{
+    MRAA_STATS_START(start);
+    mraa_result_t ret;
+    unsigned int attempt = 0;
+    do {
+        errno = 0;
+        ret = mraa_i2c_write_internal(dev, data, length);
+    } while (ret != MRAA_SUCCESS && mraa_i2c_retry(dev, ret, attempt++));
+    MRAA_STATS_RECORD(dev, start, length, ret != MRAA_SUCCESS);
+    return ret;
+}
+
+static mraa_result_t
+mraa_i2c_write_byte_internal(mraa_i2c_context dev, const uint8_t data)
 {
     if (IS_FUNC_DEFINED(dev, i2c_write_byte_replace)) {
         return dev->advance_func->i2c_write_byte_replace(dev, data);
     } else {
-        if (mraa_i2c_smbus_access(dev->fh, I2C_SMBUS_WRITE, data, I2C_SMBUS_BYTE, NULL) < 0) {
-            syslog(LOG_ERR, "i2c%i: write_byte: Access error: %s", dev->busnum, strerror(errno));
+        int ret;
+        if (dev->funcs & I2C_FUNC_I2C) {
+            struct i2c_msg m = { dev->addr, 0, 1, (char*) &data };
+            ret = mraa_i2c_rdwr(dev, &m, 1);
+        } else {
+            ret = mraa_i2c_smbus(dev, I2C_SMBUS_WRITE, data, I2C_SMBUS_BYTE, NULL);
+        }
+        if (ret < 0) {
+            mraa_trace(LOG_ERR, MRAA_TRACE_I2C_WRITE_BYTE, dev->busnum, errno);
             return MRAA_ERROR_UNSPECIFIED;
         }
         return MRAA_SUCCESS;
@@ -328,33 +684,91 @@ mraa_i2c_write_byte(mraa_i2c_context dev, const uint8_t data)
 }
 
 mraa_result_t
-mraa_i2c_write_byte_data(mraa_i2c_context dev, const uint8_t data, const uint8_t command)
+mraa_i2c_write_byte(mraa_i2c_context dev, const uint8_t data)
+{
+    MRAA_STATS_START(start);
+    mraa_result_t ret;
+    unsigned int attempt = 0;
+    do {
+        errno = 0;
+        ret = mraa_i2c_write_byte_internal(dev, data);
+    } while (ret != MRAA_SUCCESS && mraa_i2c_retry(dev, ret, attempt++));
+    MRAA_STATS_RECORD(dev, start, 1, ret != MRAA_SUCCESS);
+    return ret;
+}
+
+static mraa_result_t
+mraa_i2c_write_byte_data_internal(mraa_i2c_context dev, const uint8_t data, const uint8_t command)
 {
     if (IS_FUNC_DEFINED(dev, i2c_write_byte_data_replace))
         return dev->advance_func->i2c_write_byte_data_replace(dev, data, command);
     i2c_smbus_data_t d;
-    d.byte = data;
-    if (mraa_i2c_smbus_access(dev->fh, I2C_SMBUS_WRITE, command, I2C_SMBUS_BYTE_DATA, &d) < 0) {
-        syslog(LOG_ERR, "i2c%i: write_byte_data: Access error: %s", dev->busnum, strerror(errno));
+    int ret;
+    if (dev->funcs & I2C_FUNC_I2C) {
+        uint8_t buf[2] = { command, data };
+        struct i2c_msg m = { dev->addr, 0, 2, (char*) buf };
+        ret = mraa_i2c_rdwr(dev, &m, 1);
+    } else {
+        d.byte = data;
+        ret = mraa_i2c_smbus(dev, I2C_SMBUS_WRITE, command, I2C_SMBUS_BYTE_DATA, &d);
+    }
+    if (ret < 0) {
+        mraa_trace(LOG_ERR, MRAA_TRACE_I2C_WRITE_BYTE_DATA, dev->busnum, errno);
         return MRAA_ERROR_UNSPECIFIED;
     }
     return MRAA_SUCCESS;
 }
 
 mraa_result_t
-mraa_i2c_write_word_data(mraa_i2c_context dev, const uint16_t data, const uint8_t command)
+mraa_i2c_write_byte_data(mraa_i2c_context dev, const uint8_t data, const uint8_t command)
+{
+    MRAA_STATS_START(start);
+    mraa_result_t ret;
+    unsigned int attempt = 0;
+    do {
+        errno = 0;
+        ret = mraa_i2c_write_byte_data_internal(dev, data, command);
+    } while (ret != MRAA_SUCCESS && mraa_i2c_retry(dev, ret, attempt++));
+    MRAA_STATS_RECORD(dev, start, 1, ret != MRAA_SUCCESS);
+    return ret;
+}
+
+static mraa_result_t
+mraa_i2c_write_word_data_internal(mraa_i2c_context dev, const uint16_t data, const uint8_t command)
 {
     if (IS_FUNC_DEFINED(dev, i2c_write_word_data_replace))
         return dev->advance_func->i2c_write_word_data_replace(dev, data, command);
     i2c_smbus_data_t d;
-    d.word = data;
-    if (mraa_i2c_smbus_access(dev->fh, I2C_SMBUS_WRITE, command, I2C_SMBUS_WORD_DATA, &d) < 0) {
-        syslog(LOG_ERR, "i2c%i: write_word_data: Access error: %s", dev->busnum, strerror(errno));
+    int ret;
+    if (dev->funcs & I2C_FUNC_I2C) {
+        uint8_t buf[3] = { command, data & 0xff, data >> 8 };
+        struct i2c_msg m = { dev->addr, 0, 3, (char*) buf };
+        ret = mraa_i2c_rdwr(dev, &m, 1);
+    } else {
+        d.word = data;
+        ret = mraa_i2c_smbus(dev, I2C_SMBUS_WRITE, command, I2C_SMBUS_WORD_DATA, &d);
+    }
+    if (ret < 0) {
+        mraa_trace(LOG_ERR, MRAA_TRACE_I2C_WRITE_WORD_DATA, dev->busnum, errno);
         return MRAA_ERROR_UNSPECIFIED;
     }
     return MRAA_SUCCESS;
 }
 
+mraa_result_t
+mraa_i2c_write_word_data(mraa_i2c_context dev, const uint16_t data, const uint8_t command)
+{
+    MRAA_STATS_START(start);
+    mraa_result_t ret;
+    unsigned int attempt = 0;
+    do {
+        errno = 0;
+        ret = mraa_i2c_write_word_data_internal(dev, data, command);
+    } while (ret != MRAA_SUCCESS && mraa_i2c_retry(dev, ret, attempt++));
+    MRAA_STATS_RECORD(dev, start, 2, ret != MRAA_SUCCESS);
+    return ret;
+}
+
 mraa_result_t
 mraa_i2c_address(mraa_i2c_context dev, uint8_t addr)
 {
@@ -362,23 +776,373 @@ mraa_i2c_address(mraa_i2c_context dev, uint8_t addr)
         return MRAA_ERROR_INVALID_HANDLE;
     }
 
+    if (addr > 0x7f) {
+        syslog(LOG_ERR, "i2c%i: address: Invalid 7-bit slave address %d", dev->busnum, addr);
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
     dev->addr = (int) addr;
     if (IS_FUNC_DEFINED(dev, i2c_address_replace)) {
         return dev->advance_func->i2c_address_replace(dev, addr);
+    }
+    // transfers carry the address, SMBus calls select it on the shared fd
+    return MRAA_SUCCESS;
+}
+
+mraa_boolean_t
+mraa_i2c_probe(mraa_i2c_context dev, uint8_t address)
+{
+    if (dev == NULL || address > 0x7f) {
+        return 0;
+    }
+    // eeproms latch the address of a quick write, and so do some sensors
+    mraa_boolean_t use_read = (address >= 0x30 && address <= 0x37) || (address >= 0x50 && address <= 0x5f);
+
+    if (IS_FUNC_DEFINED(dev, i2c_read_byte_replace)) {
+        int old = dev->addr;
+        mraa_boolean_t found = 0;
+        if (mraa_i2c_address(dev, address) == MRAA_SUCCESS) {
+            found = dev->advance_func->i2c_read_byte_replace(dev) != -1;
+        }
+        mraa_i2c_address(dev, (uint8_t) old);
+        return found;
+    }
+    if (dev->bus == NULL) {
+        return 0;
+    }
+
+    if (!(dev->funcs & I2C_FUNC_SMBUS_QUICK)) {
+        use_read = 1;
+    } else if (!(dev->funcs & (I2C_FUNC_I2C | I2C_FUNC_SMBUS_READ_BYTE))) {
+        use_read = 0;
+    }
+
+    struct _i2c_bus* bus = dev->bus;
+    i2c_smbus_data_t d;
+    int ret = -1;
+    pthread_mutex_lock(&bus->lock);
+    // like i2cdetect, never touch a slave a kernel driver has claimed
+    if (ioctl(bus->fh, I2C_SLAVE, address) < 0) {
+        ret = errno == EBUSY ? 0 : -1;
     } else {
-        if (ioctl(dev->fh, I2C_SLAVE_FORCE, addr) < 0) {
-            syslog(LOG_ERR, "i2c%i: address: Failed to set slave address %d: %s", dev->busnum, addr, strerror(errno));
-            return MRAA_ERROR_UNSPECIFIED;
+        bus->addr = address;
+        if (use_read && (dev->funcs & I2C_FUNC_I2C)) {
+            uint8_t byte;
+            struct i2c_msg m = { address, I2C_M_RD, 1, (char*) &byte };
+            ret = mraa_i2c_rdwr(dev, &m, 1);
+        } else if (use_read) {
+            ret = mraa_i2c_smbus_access(bus->fh, I2C_SMBUS_READ, I2C_NOCMD, I2C_SMBUS_BYTE, &d);
+        } else {
+            ret = mraa_i2c_smbus_access(bus->fh, I2C_SMBUS_WRITE, I2C_NOCMD, I2C_SMBUS_QUICK, NULL);
         }
+    }
+    pthread_mutex_unlock(&bus->lock);
+    return ret >= 0;
+}
+
+mraa_result_t
+mraa_i2c_set_retry_policy(mraa_i2c_context dev, const mraa_i2c_retry_policy_t* policy)
+{
+    if (dev == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (policy == NULL) {
+        memset(&dev->retry, 0, sizeof(dev->retry));
+    } else {
+        dev->retry = *policy;
+    }
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_i2c_retry_stats(mraa_i2c_context dev, mraa_i2c_retry_stats_t* stats, mraa_boolean_t reset)
+{
+    if (dev == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (stats == NULL) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    if (reset) {
+        stats->retries = __atomic_exchange_n(&dev->retry_stats.retries, 0, __ATOMIC_RELAXED);
+        stats->recoveries = __atomic_exchange_n(&dev->retry_stats.recoveries, 0, __ATOMIC_RELAXED);
+        stats->exhausted = __atomic_exchange_n(&dev->retry_stats.exhausted, 0, __ATOMIC_RELAXED);
+    } else {
+        stats->retries = __atomic_load_n(&dev->retry_stats.retries, __ATOMIC_RELAXED);
+        stats->recoveries = __atomic_load_n(&dev->retry_stats.recoveries, __ATOMIC_RELAXED);
+        stats->exhausted = __atomic_load_n(&dev->retry_stats.exhausted, __ATOMIC_RELAXED);
+    }
+    return MRAA_SUCCESS;
+}
+
+/* restores the i2c function of a pin taken over as a gpio */
+static mraa_result_t
+mraa_i2c_recover_mux(int pin)
+{
+    if (plat->no_bus_mux || plat->pins[pin].i2c.mux_total == 0) {
         return MRAA_SUCCESS;
     }
+    return mraa_setup_mux_mapped(plat->pins[pin].i2c);
+}
+
+mraa_result_t
+mraa_i2c_recover(mraa_i2c_context dev)
+{
+    mraa_result_t ret = MRAA_SUCCESS;
+    int i;
+
+    if (dev == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (plat == NULL || dev->scl_pin < 0 || dev->sda_pin < 0) {
+        syslog(LOG_ERR, "i2c%i: recover: SCL and SDA pins are unknown", dev->busnum);
+        return MRAA_ERROR_FEATURE_NOT_SUPPORTED;
+    }
+    mraa_gpio_context scl = mraa_gpio_init(dev->scl_pin);
+    mraa_gpio_context sda = mraa_gpio_init(dev->sda_pin);
+    if (scl == NULL || sda == NULL) {
+        syslog(LOG_ERR, "i2c%i: recover: SCL and SDA cannot be used as gpios", dev->busnum);
+        ret = MRAA_ERROR_FEATURE_NOT_SUPPORTED;
+        goto recover_exit;
+    }
+    if (dev->bus != NULL) {
+        // SMBus users wait, plain transfers fail and may retry themselves
+        pthread_mutex_lock(&dev->bus->lock);
+    }
+
+    // open drain: a line is released as an input and pulled low as an output
+    mraa_gpio_dir(sda, MRAA_GPIO_IN);
+    mraa_gpio_dir(scl, MRAA_GPIO_IN);
+    for (i = 0; i < 9 && mraa_gpio_read(sda) == 0; i++) {
+        mraa_gpio_dir(scl, MRAA_GPIO_OUT_LOW);
+        usleep(5);
+        mraa_gpio_dir(scl, MRAA_GPIO_IN);
+        usleep(5);
+    }
+    // STOP: SDA rises while SCL is high
+    mraa_gpio_dir(sda, MRAA_GPIO_OUT_LOW);
+    usleep(5);
+    mraa_gpio_dir(sda, MRAA_GPIO_IN);
+    usleep(5);
+    if (mraa_gpio_read(sda) != 1) {
+        syslog(LOG_ERR, "i2c%i: recover: SDA is still held low", dev->busnum);
+        ret = MRAA_ERROR_UNSPECIFIED;
+    }
+
+    if (dev->bus != NULL) {
+        pthread_mutex_unlock(&dev->bus->lock);
+    }
+
+recover_exit:
+    if (scl != NULL) {
+        mraa_gpio_close(scl);
+    }
+    if (sda != NULL) {
+        mraa_gpio_close(sda);
+    }
+    if (mraa_i2c_recover_mux(dev->scl_pin) != MRAA_SUCCESS || mraa_i2c_recover_mux(dev->sda_pin) != MRAA_SUCCESS) {
+        syslog(LOG_ERR, "i2c%i: recover: Failed to mux SCL and SDA back to i2c", dev->busnum);
+        ret = MRAA_ERROR_UNSPECIFIED;
+    }
+    return ret;
 }
 
 
 mraa_result_t
 mraa_i2c_stop(mraa_i2c_context dev)
 {
+    // the bus worker may still hold jobs for this context
+    if (dev != NULL) {
+        mraa_i2c_async_release(dev);
+    }
+    if (IS_FUNC_DEFINED(dev, i2c_stop_replace)) {
+        mraa_result_t ret = dev->advance_func->i2c_stop_replace(dev);
+        free(dev);
+        return ret;
+    }
+    if (dev == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (dev->bus != NULL) {
+        mraa_i2c_bus_put(dev->bus);
+    }
     free(dev);
     return MRAA_SUCCESS;
 }
 
+
+#if MRAA_I2C_TRANSACTION_MAX_MSGS > I2C_RDRW_IOCTL_MAX_MSGS
+#error "MRAA_I2C_TRANSACTION_MAX_MSGS is beyond what I2C_RDWR accepts"
+#endif
+
+struct _i2c_transaction {
+    /*@{*/
+    mraa_i2c_context dev; /**< the bus the messages go to */
+    struct i2c_msg msgs[MRAA_I2C_TRANSACTION_MAX_MSGS]; /**< the queued messages */
+    size_t offsets[MRAA_I2C_TRANSACTION_MAX_MSGS]; /**< where the data of each write starts in wbuf */
+    int nmsgs; /**< messages queued */
+    int bytes; /**< bytes moved by the queued messages */
+    uint8_t* wbuf; /**< copies of the data to write, may move while queueing */
+    size_t wlen; /**< bytes used in wbuf */
+    size_t wsize; /**< bytes allocated for wbuf */
+    /*@}*/
+};
+
+mraa_i2c_transaction
+mraa_i2c_transaction_init(mraa_i2c_context dev)
+{
+    if (dev == NULL) {
+        syslog(LOG_ERR, "i2c: transaction_init: context is invalid");
+        return NULL;
+    }
+    mraa_i2c_transaction trans = (mraa_i2c_transaction) calloc(1, sizeof(struct _i2c_transaction));
+    if (trans == NULL) {
+        syslog(LOG_CRIT, "i2c%i: transaction_init: Failed to allocate memory for transaction", dev->busnum);
+        return NULL;
+    }
+    trans->dev = dev;
+    return trans;
+}
+
+static mraa_result_t
+mraa_i2c_transaction_queue(mraa_i2c_transaction trans, uint8_t address, uint16_t flags, uint8_t* data, int length)
+{
+    if (trans == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (data == NULL || length < 1 || length > MRAA_I2C_TRANSACTION_MAX_LENGTH) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    if (trans->nmsgs == MRAA_I2C_TRANSACTION_MAX_MSGS) {
+        syslog(LOG_ERR, "i2c%i: transaction: more than %d messages", trans->dev->busnum, MRAA_I2C_TRANSACTION_MAX_MSGS);
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+
+    struct i2c_msg* msg = &trans->msgs[trans->nmsgs];
+    msg->addr = address;
+    msg->flags = flags;
+    msg->len = length;
+    msg->buf = (char*) data;
+    trans->nmsgs++;
+    trans->bytes += length;
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_i2c_transaction_write(mraa_i2c_transaction trans, uint8_t address, const uint8_t* data, int length)
+{
+    // buf is pointed into wbuf on submit, once wbuf can no longer move
+    mraa_result_t ret = mraa_i2c_transaction_queue(trans, address, 0, (uint8_t*) data, length);
+    if (ret != MRAA_SUCCESS) {
+        return ret;
+    }
+    if (trans->wlen + length > trans->wsize) {
+        size_t size = trans->wsize == 0 ? 64 : trans->wsize;
+        while (size < trans->wlen + length) {
+            size *= 2;
+        }
+        uint8_t* wbuf = (uint8_t*) realloc(trans->wbuf, size);
+        if (wbuf == NULL) {
+            syslog(LOG_CRIT, "i2c%i: transaction_write: Failed to allocate memory for data", trans->dev->busnum);
+            trans->nmsgs--;
+            trans->bytes -= length;
+            return MRAA_ERROR_NO_RESOURCES;
+        }
+        trans->wbuf = wbuf;
+        trans->wsize = size;
+    }
+    memcpy(trans->wbuf + trans->wlen, data, length);
+    trans->offsets[trans->nmsgs - 1] = trans->wlen;
+    trans->wlen += length;
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_i2c_transaction_read(mraa_i2c_transaction trans, uint8_t address, uint8_t* data, int length)
+{
+    return mraa_i2c_transaction_queue(trans, address, I2C_M_RD, data, length);
+}
+
+static mraa_result_t
+mraa_i2c_transaction_submit_internal(mraa_i2c_transaction trans)
+{
+    mraa_i2c_context dev = trans->dev;
+    int i;
+
+    if (trans->nmsgs == 0) {
+        return MRAA_SUCCESS;
+    }
+    for (i = 0; i < trans->nmsgs; i++) {
+        if (!(trans->msgs[i].flags & I2C_M_RD)) {
+            trans->msgs[i].buf = (char*) trans->wbuf + trans->offsets[i];
+        }
+    }
+
+    if (IS_FUNC_DEFINED(dev, i2c_transfer_replace)) {
+        return dev->advance_func->i2c_transfer_replace(dev, trans->msgs, trans->nmsgs);
+    }
+    if (!(dev->funcs & I2C_FUNC_I2C)) {
+        syslog(LOG_ERR, "i2c%i: transaction_submit: bus does not support plain i2c transfers", dev->busnum);
+        return MRAA_ERROR_FEATURE_NOT_SUPPORTED;
+    }
+
+    if (mraa_i2c_rdwr(dev, trans->msgs, trans->nmsgs) < 0) {
+        mraa_trace(LOG_ERR, MRAA_TRACE_I2C_TRANSFER, dev->busnum, errno);
+        return MRAA_ERROR_UNSPECIFIED;
+    }
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_i2c_transaction_submit(mraa_i2c_transaction trans)
+{
+    if (trans == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    MRAA_STATS_START(start);
+    mraa_result_t ret;
+    unsigned int attempt = 0;
+    do {
+        errno = 0;
+        ret = mraa_i2c_transaction_submit_internal(trans);
+    } while (ret != MRAA_SUCCESS && mraa_i2c_retry(trans->dev, ret, attempt++));
+    MRAA_STATS_RECORD(trans->dev, start, trans->bytes, ret != MRAA_SUCCESS);
+    return ret;
+}
+
+mraa_i2c_context
+mraa_i2c_transaction_context(mraa_i2c_transaction trans)
+{
+    return trans == NULL ? NULL : trans->dev;
+}
+
+int
+mraa_i2c_transaction_count(mraa_i2c_transaction trans)
+{
+    if (trans == NULL) {
+        return -1;
+    }
+    return trans->nmsgs;
+}
+
+mraa_result_t
+mraa_i2c_transaction_clear(mraa_i2c_transaction trans)
+{
+    if (trans == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    trans->nmsgs = 0;
+    trans->bytes = 0;
+    trans->wlen = 0;
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_i2c_transaction_stop(mraa_i2c_transaction trans)
+{
+    if (trans == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    free(trans->wbuf);
+    free(trans);
+    return MRAA_SUCCESS;
+}
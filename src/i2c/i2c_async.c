@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "i2c.h"
+#include "i2c/i2c_async.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+typedef enum {
+    I2C_JOB_READ_BYTES_DATA,
+    I2C_JOB_WRITE,
+    I2C_JOB_TRANSACTION
+} i2c_job_kind_t;
+
+/**
+ * A request waiting for the worker of its bus. Data to write is copied
+ * right behind the job.
+ */
+struct _i2c_job {
+    /*@{*/
+    i2c_job_kind_t kind; /**< what to run */
+    mraa_i2c_context dev; /**< the context it was queued on */
+    mraa_i2c_transaction trans; /**< transaction to submit, I2C_JOB_TRANSACTION only */
+    uint8_t command; /**< register to read from */
+    uint8_t* data; /**< buffer to read into or the copy to write */
+    int length; /**< bytes to read or write */
+    mraa_i2c_async_cb cb; /**< called once done, may be NULL */
+    void* args; /**< passed to cb */
+    struct _i2c_job* next; /**< next job of the same priority */
+    /*@}*/
+};
+
+/**
+ * Worker of one bus. Platforms number their buses independently so the
+ * function table is part of the key.
+ */
+struct _i2c_queue {
+    /*@{*/
+    int busnum; /**< the bus number of the contexts served */
+    mraa_adv_func_t* advance_func; /**< the function table of the contexts served */
+    pthread_t thread; /**< the worker */
+    mraa_i2c_context running; /**< context of the job being run, under async_lock */
+    mraa_boolean_t running_stopped; /**< running was stopped from its own callback */
+    pthread_cond_t work_cond; /**< signalled when a job is queued or the worker must stop */
+    struct _i2c_job* head[MRAA_I2C_PRIORITY_LOW + 1]; /**< next job to run, per priority */
+    struct _i2c_job* tail[MRAA_I2C_PRIORITY_LOW + 1]; /**< last job queued, per priority */
+    struct _i2c_queue* next; /**< next bus */
+    /*@}*/
+};
+
+static pthread_mutex_t async_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t async_done_cond = PTHREAD_COND_INITIALIZER;
+static struct _i2c_queue* async_queues = NULL;
+static mraa_boolean_t async_stopping = 0;
+
+// must be called with async_lock held
+static struct _i2c_job*
+mraa_i2c_async_pop(struct _i2c_queue* q)
+{
+    int prio;
+
+    for (prio = MRAA_I2C_PRIORITY_HIGH; prio <= MRAA_I2C_PRIORITY_LOW; prio++) {
+        struct _i2c_job* job = q->head[prio];
+        if (job != NULL) {
+            q->head[prio] = job->next;
+            if (q->head[prio] == NULL) {
+                q->tail[prio] = NULL;
+            }
+            return job;
+        }
+    }
+    return NULL;
+}
+
+static void*
+mraa_i2c_async_worker(void* arg)
+{
+    struct _i2c_queue* q = (struct _i2c_queue*) arg;
+    struct _i2c_job* job;
+    mraa_result_t ret;
+
+    pthread_mutex_lock(&async_lock);
+    for (;;) {
+        job = mraa_i2c_async_pop(q);
+        if (job == NULL) {
+            if (async_stopping) {
+                break;
+            }
+            pthread_cond_wait(&q->work_cond, &async_lock);
+            continue;
+        }
+        q->running = job->dev;
+        q->running_stopped = 0;
+        pthread_mutex_unlock(&async_lock);
+
+        switch (job->kind) {
+            case I2C_JOB_READ_BYTES_DATA:
+                ret = mraa_i2c_read_bytes_data(job->dev, job->command, job->data, job->length) == job->length
+                      ? MRAA_SUCCESS
+                      : MRAA_ERROR_UNSPECIFIED;
+                break;
+            case I2C_JOB_WRITE:
+                ret = mraa_i2c_write(job->dev, job->data, job->length);
+                break;
+            default:
+                ret = mraa_i2c_transaction_submit(job->trans);
+                break;
+        }
+        if (job->cb != NULL) {
+            job->cb(job->dev, ret, job->args);
+        }
+
+        pthread_mutex_lock(&async_lock);
+        // a callback closing its context leaves nothing to account for
+        if (!q->running_stopped) {
+            job->dev->async_pending--;
+        }
+        q->running = NULL;
+        pthread_cond_broadcast(&async_done_cond);
+        free(job);
+    }
+    pthread_mutex_unlock(&async_lock);
+    return NULL;
+}
+
+// must be called with async_lock held
+static struct _i2c_queue*
+mraa_i2c_async_queue(mraa_i2c_context dev)
+{
+    struct _i2c_queue* q;
+
+    for (q = async_queues; q != NULL; q = q->next) {
+        if (q->busnum == dev->busnum && q->advance_func == dev->advance_func) {
+            return q;
+        }
+    }
+    q = (struct _i2c_queue*) calloc(1, sizeof(struct _i2c_queue));
+    if (q == NULL) {
+        syslog(LOG_CRIT, "i2c%i: async: Failed to allocate memory for queue", dev->busnum);
+        return NULL;
+    }
+    q->busnum = dev->busnum;
+    q->advance_func = dev->advance_func;
+    pthread_cond_init(&q->work_cond, NULL);
+    if (mraa_thread_create(&q->thread, NULL, mraa_i2c_async_worker, q) != 0) {
+        syslog(LOG_ERR, "i2c%i: async: Failed to create bus worker", dev->busnum);
+        pthread_cond_destroy(&q->work_cond);
+        free(q);
+        return NULL;
+    }
+    q->next = async_queues;
+    async_queues = q;
+    return q;
+}
+
+static mraa_result_t
+mraa_i2c_async_submit(struct _i2c_job* job, mraa_i2c_priority_t priority)
+{
+    struct _i2c_queue* q;
+
+    if (priority < MRAA_I2C_PRIORITY_HIGH || priority > MRAA_I2C_PRIORITY_LOW) {
+        free(job);
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    pthread_mutex_lock(&async_lock);
+    if (async_stopping || (q = mraa_i2c_async_queue(job->dev)) == NULL) {
+        pthread_mutex_unlock(&async_lock);
+        free(job);
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    if (q->tail[priority] != NULL) {
+        q->tail[priority]->next = job;
+    } else {
+        q->head[priority] = job;
+    }
+    q->tail[priority] = job;
+    job->dev->async_pending++;
+    pthread_cond_signal(&q->work_cond);
+    pthread_mutex_unlock(&async_lock);
+    return MRAA_SUCCESS;
+}
+
+static struct _i2c_job*
+mraa_i2c_async_job(mraa_i2c_context dev, i2c_job_kind_t kind, size_t extra, mraa_i2c_async_cb cb, void* args)
+{
+    struct _i2c_job* job = (struct _i2c_job*) calloc(1, sizeof(struct _i2c_job) + extra);
+    if (job == NULL) {
+        syslog(LOG_CRIT, "i2c%i: async: Failed to allocate memory for job", dev->busnum);
+        return NULL;
+    }
+    job->kind = kind;
+    job->dev = dev;
+    job->cb = cb;
+    job->args = args;
+    return job;
+}
+
+mraa_result_t
+mraa_i2c_async_read_bytes_data(mraa_i2c_context dev,
+                               uint8_t command,
+                               uint8_t* data,
+                               int length,
+                               mraa_i2c_priority_t priority,
+                               mraa_i2c_async_cb cb,
+                               void* args)
+{
+    if (dev == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (data == NULL || length < 1) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    struct _i2c_job* job = mraa_i2c_async_job(dev, I2C_JOB_READ_BYTES_DATA, 0, cb, args);
+    if (job == NULL) {
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    job->command = command;
+    job->data = data;
+    job->length = length;
+    return mraa_i2c_async_submit(job, priority);
+}
+
+mraa_result_t
+mraa_i2c_async_write(mraa_i2c_context dev,
+                     const uint8_t* data,
+                     int length,
+                     mraa_i2c_priority_t priority,
+                     mraa_i2c_async_cb cb,
+                     void* args)
+{
+    if (dev == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (data == NULL || length < 1) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    struct _i2c_job* job = mraa_i2c_async_job(dev, I2C_JOB_WRITE, length, cb, args);
+    if (job == NULL) {
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    job->data = (uint8_t*) (job + 1);
+    job->length = length;
+    memcpy(job->data, data, length);
+    return mraa_i2c_async_submit(job, priority);
+}
+
+mraa_result_t
+mraa_i2c_async_transaction(mraa_i2c_transaction trans, mraa_i2c_priority_t priority, mraa_i2c_async_cb cb, void* args)
+{
+    mraa_i2c_context dev = mraa_i2c_transaction_context(trans);
+    if (dev == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    struct _i2c_job* job = mraa_i2c_async_job(dev, I2C_JOB_TRANSACTION, 0, cb, args);
+    if (job == NULL) {
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    job->trans = trans;
+    return mraa_i2c_async_submit(job, priority);
+}
+
+// must be called with async_lock held, the queue of dev if this is its worker
+static struct _i2c_queue*
+mraa_i2c_async_self(mraa_i2c_context dev)
+{
+    struct _i2c_queue* q;
+
+    for (q = async_queues; q != NULL; q = q->next) {
+        if (q->busnum == dev->busnum && q->advance_func == dev->advance_func) {
+            return pthread_equal(q->thread, pthread_self()) ? q : NULL;
+        }
+    }
+    return NULL;
+}
+
+mraa_result_t
+mraa_i2c_async_wait(mraa_i2c_context dev)
+{
+    if (dev == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    pthread_mutex_lock(&async_lock);
+    struct _i2c_queue* q = mraa_i2c_async_self(dev);
+    if (q != NULL) {
+        // jobs behind the running one only start once this callback returns
+        int pending = dev->async_pending - (q->running == dev);
+        pthread_mutex_unlock(&async_lock);
+        if (pending > 0) {
+            syslog(LOG_ERR, "i2c%i: async_wait: called from a callback on the bus worker", dev->busnum);
+            return MRAA_ERROR_INVALID_RESOURCE;
+        }
+        return MRAA_SUCCESS;
+    }
+    while (dev->async_pending > 0) {
+        pthread_cond_wait(&async_done_cond, &async_lock);
+    }
+    pthread_mutex_unlock(&async_lock);
+    return MRAA_SUCCESS;
+}
+
+void
+mraa_i2c_async_release(mraa_i2c_context dev)
+{
+    struct _i2c_job** link;
+    struct _i2c_job* job;
+    int prio;
+
+    pthread_mutex_lock(&async_lock);
+    struct _i2c_queue* q = mraa_i2c_async_self(dev);
+    if (q == NULL) {
+        while (dev->async_pending > 0) {
+            pthread_cond_wait(&async_done_cond, &async_lock);
+        }
+        pthread_mutex_unlock(&async_lock);
+        return;
+    }
+
+    // stopped from a callback: what is still queued would never run in time
+    for (prio = MRAA_I2C_PRIORITY_HIGH; prio <= MRAA_I2C_PRIORITY_LOW; prio++) {
+        q->tail[prio] = NULL;
+        link = &q->head[prio];
+        while ((job = *link) != NULL) {
+            if (job->dev == dev) {
+                *link = job->next;
+                dev->async_pending--;
+                free(job);
+            } else {
+                q->tail[prio] = job;
+                link = &job->next;
+            }
+        }
+    }
+    if (q->running == dev) {
+        q->running_stopped = 1;
+    }
+    pthread_mutex_unlock(&async_lock);
+}
+
+void
+mraa_i2c_async_shutdown()
+{
+    struct _i2c_queue* q;
+
+    pthread_mutex_lock(&async_lock);
+    async_stopping = 1;
+    for (q = async_queues; q != NULL; q = q->next) {
+        pthread_cond_signal(&q->work_cond);
+    }
+    pthread_mutex_unlock(&async_lock);
+
+    // queues are only added while not stopping, the list is stable now
+    while (async_queues != NULL) {
+        q = async_queues;
+        pthread_join(q->thread, NULL);
+        async_queues = q->next;
+        pthread_cond_destroy(&q->work_cond);
+        free(q);
+    }
+
+    pthread_mutex_lock(&async_lock);
+    async_stopping = 0;
+    pthread_mutex_unlock(&async_lock);
+}
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "i2c.h"
+#include "mraa_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define REGMAP_REGS 256
+#define REGMAP_WORDS (REGMAP_REGS / 32)
+
+/**
+ * Register cache of one slave. Registers are cacheable unless marked
+ * volatile, a cached register is read from the device once and then served
+ * from values until the cache is invalidated.
+ */
+struct _i2c_regmap {
+    /*@{*/
+    mraa_i2c_context dev; /**< the bus the slave is on */
+    uint8_t addr; /**< the address of the slave */
+    mraa_boolean_t writeback; /**< hold writes in the cache until synced */
+    uint8_t values[REGMAP_REGS]; /**< last value read from or written to each register */
+    uint32_t valid[REGMAP_WORDS]; /**< registers whose value is cached */
+    uint32_t dirty[REGMAP_WORDS]; /**< registers written to the cache only */
+    uint32_t volatile_regs[REGMAP_WORDS]; /**< registers always read from the device */
+    /*@}*/
+};
+
+static inline mraa_boolean_t
+regmap_test(const uint32_t* bits, uint8_t reg)
+{
+    return (bits[reg >> 5] >> (reg & 31)) & 1;
+}
+
+static inline void
+regmap_set(uint32_t* bits, uint8_t reg, mraa_boolean_t on)
+{
+    if (on) {
+        bits[reg >> 5] |= 1U << (reg & 31);
+    } else {
+        bits[reg >> 5] &= ~(1U << (reg & 31));
+    }
+}
+
+static mraa_result_t
+regmap_select(mraa_i2c_regmap map)
+{
+    // the context may be shared with drivers of other slaves on the bus
+    if (map->dev->addr == map->addr) {
+        return MRAA_SUCCESS;
+    }
+    return mraa_i2c_address(map->dev, map->addr);
+}
+
+static mraa_result_t
+regmap_write_reg(mraa_i2c_regmap map, uint8_t reg, uint8_t value)
+{
+    mraa_result_t ret = regmap_select(map);
+    if (ret != MRAA_SUCCESS) {
+        return ret;
+    }
+    ret = mraa_i2c_write_byte_data(map->dev, value, reg);
+    if (ret != MRAA_SUCCESS) {
+        return ret;
+    }
+    regmap_set(map->dirty, reg, 0);
+    if (!regmap_test(map->volatile_regs, reg)) {
+        map->values[reg] = value;
+        regmap_set(map->valid, reg, 1);
+    }
+    return MRAA_SUCCESS;
+}
+
+mraa_i2c_regmap
+mraa_i2c_regmap_init(mraa_i2c_context dev, uint8_t address)
+{
+    if (dev == NULL) {
+        syslog(LOG_ERR, "i2c: regmap_init: context is invalid");
+        return NULL;
+    }
+    mraa_i2c_regmap map = (mraa_i2c_regmap) calloc(1, sizeof(struct _i2c_regmap));
+    if (map == NULL) {
+        syslog(LOG_CRIT, "i2c%i: regmap_init: Failed to allocate memory for register map", dev->busnum);
+        return NULL;
+    }
+    map->dev = dev;
+    map->addr = address;
+    return map;
+}
+
+mraa_result_t
+mraa_i2c_regmap_set_volatile(mraa_i2c_regmap map, uint8_t reg, mraa_boolean_t is_volatile)
+{
+    if (map == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (is_volatile && regmap_test(map->dirty, reg)) {
+        // the device would never see the held value otherwise
+        mraa_result_t ret = regmap_write_reg(map, reg, map->values[reg]);
+        if (ret != MRAA_SUCCESS) {
+            return ret;
+        }
+    }
+    regmap_set(map->volatile_regs, reg, is_volatile);
+    regmap_set(map->valid, reg, 0);
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_i2c_regmap_set_writeback(mraa_i2c_regmap map, mraa_boolean_t enable)
+{
+    if (map == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (map->writeback && !enable) {
+        mraa_result_t ret = mraa_i2c_regmap_sync(map);
+        if (ret != MRAA_SUCCESS) {
+            return ret;
+        }
+    }
+    map->writeback = enable;
+    return MRAA_SUCCESS;
+}
+
+int
+mraa_i2c_regmap_read(mraa_i2c_regmap map, uint8_t reg)
+{
+    if (map == NULL) {
+        return -1;
+    }
+    if (regmap_test(map->valid, reg)) {
+        return map->values[reg];
+    }
+    if (regmap_select(map) != MRAA_SUCCESS) {
+        return -1;
+    }
+    int value = mraa_i2c_read_byte_data(map->dev, reg);
+    if (value != -1 && !regmap_test(map->volatile_regs, reg)) {
+        map->values[reg] = (uint8_t) value;
+        regmap_set(map->valid, reg, 1);
+    }
+    return value;
+}
+
+mraa_result_t
+mraa_i2c_regmap_write(mraa_i2c_regmap map, uint8_t reg, uint8_t value)
+{
+    if (map == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (map->writeback && !regmap_test(map->volatile_regs, reg)) {
+        // repeated writes coalesce, only the last value reaches the device
+        map->values[reg] = value;
+        regmap_set(map->valid, reg, 1);
+        regmap_set(map->dirty, reg, 1);
+        return MRAA_SUCCESS;
+    }
+    return regmap_write_reg(map, reg, value);
+}
+
+mraa_result_t
+mraa_i2c_regmap_update_bits(mraa_i2c_regmap map, uint8_t reg, uint8_t mask, uint8_t value)
+{
+    int old = mraa_i2c_regmap_read(map, reg);
+    if (old == -1) {
+        return map == NULL ? MRAA_ERROR_INVALID_HANDLE : MRAA_ERROR_UNSPECIFIED;
+    }
+    uint8_t new_value = (uint8_t) ((old & ~mask) | (value & mask));
+    if (new_value == old && !regmap_test(map->volatile_regs, reg)) {
+        return MRAA_SUCCESS;
+    }
+    return mraa_i2c_regmap_write(map, reg, new_value);
+}
+
+mraa_result_t
+mraa_i2c_regmap_sync(mraa_i2c_regmap map)
+{
+    int word, bit;
+
+    if (map == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    for (word = 0; word < REGMAP_WORDS; word++) {
+        while (map->dirty[word] != 0) {
+            bit = __builtin_ctz(map->dirty[word]);
+            uint8_t reg = (uint8_t) (word * 32 + bit);
+            // a failed register stays dirty for the next sync
+            mraa_result_t ret = regmap_write_reg(map, reg, map->values[reg]);
+            if (ret != MRAA_SUCCESS) {
+                return ret;
+            }
+        }
+    }
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_i2c_regmap_invalidate(mraa_i2c_regmap map)
+{
+    if (map == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    memset(map->valid, 0, sizeof(map->valid));
+    memset(map->dirty, 0, sizeof(map->dirty));
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_i2c_regmap_stop(mraa_i2c_regmap map)
+{
+    if (map == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    mraa_result_t ret = mraa_i2c_regmap_sync(map);
+    free(map);
+    return ret;
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "i2c.h"
+#include "mraa_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define SCAN_FIRST 0x08
+#define SCAN_LAST 0x77
+
+/**
+ * Slaves found by the last scan of a bus
+ */
+struct _i2c_scan {
+    /*@{*/
+    int bus; /**< the bus, as passed to mraa_i2c_init() */
+    uint32_t present[4]; /**< bit addr & 31 of word addr >> 5 is set when addr answered */
+    struct _i2c_scan* next; /**< next cached bus */
+    /*@}*/
+};
+
+/**
+ * One bus of mraa_i2c_scan_buses()
+ */
+struct _i2c_scan_job {
+    /*@{*/
+    int bus; /**< the bus to scan */
+    pthread_t thread; /**< the thread scanning it */
+    mraa_boolean_t started; /**< thread was created */
+    mraa_result_t result; /**< outcome of the scan */
+    /*@}*/
+};
+
+static pthread_mutex_t scan_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct _i2c_scan* scans = NULL;
+
+// must be called with scan_lock held
+static struct _i2c_scan*
+mraa_i2c_scan_find(int bus)
+{
+    struct _i2c_scan* scan;
+
+    for (scan = scans; scan != NULL; scan = scan->next) {
+        if (scan->bus == bus) {
+            return scan;
+        }
+    }
+    return NULL;
+}
+
+/* probes the bus and caches the result, unless it already is */
+static mraa_result_t
+mraa_i2c_scan_fill(int bus)
+{
+    struct _i2c_scan* scan;
+    uint32_t present[4] = { 0 };
+    int addr;
+
+    pthread_mutex_lock(&scan_lock);
+    scan = mraa_i2c_scan_find(bus);
+    pthread_mutex_unlock(&scan_lock);
+    if (scan != NULL) {
+        return MRAA_SUCCESS;
+    }
+
+    mraa_i2c_context dev = mraa_i2c_init(bus);
+    if (dev == NULL) {
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    for (addr = SCAN_FIRST; addr <= SCAN_LAST; addr++) {
+        if (mraa_i2c_probe(dev, (uint8_t) addr)) {
+            present[addr >> 5] |= 1U << (addr & 31);
+        }
+    }
+    mraa_i2c_stop(dev);
+
+    pthread_mutex_lock(&scan_lock);
+    // a concurrent scan of the same bus may have won, both saw the same bus
+    scan = mraa_i2c_scan_find(bus);
+    if (scan == NULL) {
+        scan = (struct _i2c_scan*) calloc(1, sizeof(struct _i2c_scan));
+        if (scan == NULL) {
+            pthread_mutex_unlock(&scan_lock);
+            syslog(LOG_CRIT, "i2c%i: scan: Failed to allocate memory for result", bus);
+            return MRAA_ERROR_NO_RESOURCES;
+        }
+        scan->bus = bus;
+        scan->next = scans;
+        scans = scan;
+    }
+    memcpy(scan->present, present, sizeof(present));
+    pthread_mutex_unlock(&scan_lock);
+    return MRAA_SUCCESS;
+}
+
+int
+mraa_i2c_scan(int bus, uint8_t* addresses, int max_addresses)
+{
+    struct _i2c_scan* scan;
+    int addr, n = 0;
+
+    if (addresses == NULL && max_addresses > 0) {
+        return -1;
+    }
+    if (mraa_i2c_scan_fill(bus) != MRAA_SUCCESS) {
+        return -1;
+    }
+    pthread_mutex_lock(&scan_lock);
+    scan = mraa_i2c_scan_find(bus);
+    for (addr = SCAN_FIRST; scan != NULL && addr <= SCAN_LAST && n < max_addresses; addr++) {
+        if ((scan->present[addr >> 5] >> (addr & 31)) & 1) {
+            addresses[n++] = (uint8_t) addr;
+        }
+    }
+    pthread_mutex_unlock(&scan_lock);
+    return n;
+}
+
+static void*
+mraa_i2c_scan_thread(void* arg)
+{
+    struct _i2c_scan_job* job = (struct _i2c_scan_job*) arg;
+    job->result = mraa_i2c_scan_fill(job->bus);
+    return NULL;
+}
+
+mraa_result_t
+mraa_i2c_scan_buses(const int* buses, int nbuses)
+{
+    mraa_result_t ret = MRAA_SUCCESS;
+    int i;
+
+    if (buses == NULL || nbuses < 0) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    struct _i2c_scan_job* jobs = (struct _i2c_scan_job*) calloc(nbuses > 0 ? nbuses : 1, sizeof(struct _i2c_scan_job));
+    if (jobs == NULL) {
+        syslog(LOG_CRIT, "i2c: scan: Failed to allocate memory for %d buses", nbuses);
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    for (i = 0; i < nbuses; i++) {
+        jobs[i].bus = buses[i];
+        jobs[i].started = mraa_thread_create(&jobs[i].thread, NULL, mraa_i2c_scan_thread, &jobs[i]) == 0;
+        if (!jobs[i].started) {
+            // scan it from here rather than not at all
+            jobs[i].result = mraa_i2c_scan_fill(buses[i]);
+        }
+    }
+    for (i = 0; i < nbuses; i++) {
+        if (jobs[i].started) {
+            pthread_join(jobs[i].thread, NULL);
+        }
+        if (jobs[i].result != MRAA_SUCCESS) {
+            syslog(LOG_ERR, "i2c%i: scan: Failed to scan bus", jobs[i].bus);
+            if (ret == MRAA_SUCCESS) {
+                ret = jobs[i].result;
+            }
+        }
+    }
+    free(jobs);
+    return ret;
+}
+
+void
+mraa_i2c_scan_invalidate(int bus)
+{
+    struct _i2c_scan** link = &scans;
+    struct _i2c_scan* scan;
+
+    pthread_mutex_lock(&scan_lock);
+    while ((scan = *link) != NULL) {
+        if (bus == -1 || scan->bus == bus) {
+            *link = scan->next;
+            free(scan);
+        } else {
+            link = &scan->next;
+        }
+    }
+    pthread_mutex_unlock(&scan_lock);
+}
@@ -76,7 +76,7 @@ mraa_iio_get_channel_data(mraa_iio_context dev)
     const struct dirent* ent;
     DIR* dir;
     int chan_num = 0;
-    char buf[MAX_SIZE];
+    char buf[MRAA_FS_PATH_MAX];
     char readbuf[32];
     int fd;
     int ret = 0;
@@ -87,8 +87,8 @@ mraa_iio_get_channel_data(mraa_iio_context dev)
 
     dev->datasize = 0;
 
-    memset(buf, 0, MAX_SIZE);
-    snprintf(buf, MAX_SIZE, IIO_SYSFS_DEVICE "%d/" IIO_SCAN_ELEM, dev->num);
+    memset(buf, 0, sizeof(buf));
+    mraa_fs_path(buf, sizeof(buf), IIO_SYSFS_DEVICE "%d/" IIO_SCAN_ELEM, dev->num);
     dir = opendir(buf);
     if (dir != NULL) {
         while ((ent = readdir(dir)) != NULL) {
@@ -108,7 +108,7 @@ mraa_iio_get_channel_data(mraa_iio_context dev)
     seekdir(dir, 0);
     while ((ent = readdir(dir)) != NULL) {
         if (strcmp(ent->d_name + strlen(ent->d_name) - strlen("_index"), "_index") == 0) {
-            snprintf(buf, MAX_SIZE, IIO_SYSFS_DEVICE "%d/" IIO_SCAN_ELEM "/%s", dev->num, ent->d_name);
+            mraa_fs_path(buf, sizeof(buf), IIO_SYSFS_DEVICE "%d/" IIO_SCAN_ELEM "/%s", dev->num, ent->d_name);
             fd = open(buf, O_RDONLY);
             if (fd != -1) {
                 if (read(fd, readbuf, 2 * sizeof(char)) != 2) {
@@ -123,7 +123,7 @@ mraa_iio_get_channel_data(mraa_iio_context dev)
                 buf[(strlen(buf) - 5)] = '\0';
                 char* str = strdup(buf);
                 // grab the type of the buffer
-                snprintf(buf, MAX_SIZE, "%stype", str);
+                snprintf(buf, sizeof(buf), "%stype", str);
                 fd = open(buf, O_RDONLY);
                 if (fd != -1) {
                     read(fd, readbuf, 31 * sizeof(char));
@@ -147,7 +147,7 @@ mraa_iio_get_channel_data(mraa_iio_context dev)
                     close(fd);
                 }
                 // grab the enable flag of channel
-                snprintf(buf, MAX_SIZE, "%sen", str);
+                snprintf(buf, sizeof(buf), "%sen", str);
                 fd = open(buf, O_RDONLY);
                 if (fd != -1) {
                     if (read(fd, readbuf, 2 * sizeof(char)) != 2) {
@@ -246,9 +246,9 @@ mraa_iio_read_int(mraa_iio_context dev, const char* attr_name, int* data)
 mraa_result_t
 mraa_iio_read_string(mraa_iio_context dev, const char* attr_name, char* data, int max_len)
 {
-    char buf[MAX_SIZE];
+    char buf[MRAA_FS_PATH_MAX];
     mraa_result_t result = MRAA_ERROR_UNSPECIFIED;
-    snprintf(buf, MAX_SIZE, IIO_SYSFS_DEVICE "%d/%s", dev->num, attr_name);
+    mraa_fs_path(buf, sizeof(buf), IIO_SYSFS_DEVICE "%d/%s", dev->num, attr_name);
     int fd = open(buf, O_RDONLY);
     if (fd != -1) {
         ssize_t len = read(fd, data, max_len);
@@ -279,9 +279,9 @@ mraa_iio_write_int(mraa_iio_context dev, const char* attr_name, const int data)
 mraa_result_t
 mraa_iio_write_string(mraa_iio_context dev, const char* attr_name, const char* data)
 {
-    char buf[MAX_SIZE];
+    char buf[MRAA_FS_PATH_MAX];
     mraa_result_t result = MRAA_ERROR_UNSPECIFIED;
-    snprintf(buf, MAX_SIZE, IIO_SYSFS_DEVICE "%d/%s", dev->num, attr_name);
+    mraa_fs_path(buf, sizeof(buf), IIO_SYSFS_DEVICE "%d/%s", dev->num, attr_name);
     int fd = open(buf, O_WRONLY);
     if (fd != -1) {
         int len = strlen(data);
@@ -348,19 +348,22 @@ mraa_iio_trigger_handler(void* arg)
 mraa_result_t
 mraa_iio_trigger_buffer(mraa_iio_context dev, void (*fptr)(char* data), void* args)
 {
-    char bu[MAX_SIZE];
+    char bu[MRAA_FS_PATH_MAX];
     if (dev->thread_id != 0) {
         return MRAA_ERROR_NO_RESOURCES;
     }
 
-    sprintf(bu, IIO_SLASH_DEV "%d", dev->num);
+    mraa_fs_path(bu, sizeof(bu), IIO_SLASH_DEV "%d", dev->num);
     dev->fp = open(bu, O_RDONLY | O_NONBLOCK);
     if (dev->fp == -1) {
         return MRAA_ERROR_INVALID_RESOURCE;
     }
 
     dev->isr = fptr;
-    pthread_create(&dev->thread_id, NULL, mraa_iio_trigger_handler, (void*) dev);
+    if (mraa_thread_create(&dev->thread_id, dev->thread_attr, mraa_iio_trigger_handler, (void*) dev) != 0) {
+        dev->thread_id = 0;
+        return MRAA_ERROR_NO_RESOURCES;
+    }
 
     return MRAA_SUCCESS;
 }
@@ -371,16 +374,16 @@ mraa_iio_get_event_data(mraa_iio_context dev)
     const struct dirent* ent;
     DIR* dir;
     int event_num = 0;
-    char buf[MAX_SIZE];
+    char buf[MRAA_FS_PATH_MAX];
     char readbuf[32];
     int fd;
     int ret = 0;
     int padint = 0;
     int curr_bytes = 0;
     char shortbuf, signchar;
-    memset(buf, 0, MAX_SIZE);
+    memset(buf, 0, sizeof(buf));
     memset(readbuf, 0, 32);
-    snprintf(buf, MAX_SIZE, IIO_SYSFS_DEVICE "%d/" IIO_EVENTS, dev->num);
+    mraa_fs_path(buf, sizeof(buf), IIO_SYSFS_DEVICE "%d/" IIO_EVENTS, dev->num);
     dir = opendir(buf);
     if (dir != NULL) {
         while ((ent = readdir(dir)) != NULL) {
@@ -406,7 +409,7 @@ mraa_iio_get_event_data(mraa_iio_context dev)
             if (strcmp(ent->d_name + strlen(ent->d_name) - strlen("_en"), "_en") == 0) {
                 event = &dev->events[event_num];
                 event->name = strdup(ent->d_name);
-                snprintf(buf, MAX_SIZE, IIO_SYSFS_DEVICE "%d/" IIO_EVENTS "/%s", dev->num, ent->d_name);
+                mraa_fs_path(buf, sizeof(buf), IIO_SYSFS_DEVICE "%d/" IIO_EVENTS "/%s", dev->num, ent->d_name);
                 fd = open(buf, O_RDONLY);
                 if (fd != -1) {
                     if (read(fd, readbuf, 2 * sizeof(char)) != 2) {
@@ -449,12 +452,12 @@ mraa_iio_event_poll_nonblock(int fd, struct iio_event_data* data)
 mraa_result_t
 mraa_iio_event_poll(mraa_iio_context dev, struct iio_event_data* data)
 {
-    char bu[MAX_SIZE];
+    char bu[MRAA_FS_PATH_MAX];
     int ret;
     int event_fd;
     int fd;
 
-    snprintf(bu, MAX_SIZE, IIO_SLASH_DEV "%d", dev->num);
+    mraa_fs_path(bu, sizeof(bu), IIO_SLASH_DEV "%d", dev->num);
     fd = open(bu, 0);
     if (fd != -1) {
         ret = ioctl(fd, IIO_GET_EVENT_FD_IOCTL, &event_fd);
@@ -501,12 +504,12 @@ mraa_result_t
 mraa_iio_event_setup_callback(mraa_iio_context dev, void (*fptr)(struct iio_event_data* data, void* args), void* args)
 {
     int ret;
-    char bu[MAX_SIZE];
+    char bu[MRAA_FS_PATH_MAX];
     if (dev->thread_id != 0) {
         return MRAA_ERROR_NO_RESOURCES;
     }
 
-    sprintf(bu, IIO_SLASH_DEV "%d", dev->num);
+    mraa_fs_path(bu, sizeof(bu), IIO_SLASH_DEV "%d", dev->num);
     dev->fp = open(bu, O_RDONLY | O_NONBLOCK);
     if (dev->fp == -1) {
         return MRAA_ERROR_INVALID_RESOURCE;
@@ -520,7 +523,10 @@ mraa_iio_event_setup_callback(mraa_iio_context dev, void (*fptr)(struct iio_even
 
     dev->isr_event = fptr;
     dev->isr_args = args;
-    pthread_create(&dev->thread_id, NULL, mraa_iio_event_handler, (void*) dev);
+    if (mraa_thread_create(&dev->thread_id, dev->thread_attr, mraa_iio_event_handler, (void*) dev) != 0) {
+        dev->thread_id = 0;
+        return MRAA_ERROR_NO_RESOURCES;
+    }
 
     return MRAA_SUCCESS;
 }
@@ -548,12 +554,12 @@ mraa_iio_event_extract_event(struct iio_event_data* event,
 mraa_result_t
 mraa_iio_get_mounting_matrix(mraa_iio_context dev, float mm[9])
 {
-    char buf[MAX_SIZE];
+    char buf[MRAA_FS_PATH_MAX];
     FILE* fp;
     int ret;
 
-    memset(buf, 0, MAX_SIZE);
-    snprintf(buf, MAX_SIZE, IIO_SYSFS_DEVICE "%d/" IIO_MOUNTING_MATRIX, dev->num);
+    memset(buf, 0, sizeof(buf));
+    mraa_fs_path(buf, sizeof(buf), IIO_SYSFS_DEVICE "%d/" IIO_MOUNTING_MATRIX, dev->num);
     fp = fopen(buf, "r");
     if (fp != NULL) {
         ret = fscanf(fp, "%f %f %f\n%f %f %f\n%f %f %f\n", &mm[0], &mm[1], &mm[2], &mm[3], &mm[4], &mm[5],
@@ -572,12 +578,12 @@ mraa_iio_create_trigger(mraa_iio_context dev, const char* trigger)
 {
     struct stat configfs_status;
     struct stat trigger_status;
-    char buf[MAX_SIZE];
+    char buf[MRAA_FS_PATH_MAX];
     int ret;
 
     if (stat(IIO_CONFIGFS_TRIGGER, &configfs_status) == 0) {
-        memset(buf, 0, MAX_SIZE);
-        snprintf(buf, MAX_SIZE, IIO_CONFIGFS_TRIGGER "%s", trigger);
+        memset(buf, 0, sizeof(buf));
+        mraa_fs_path(buf, sizeof(buf), IIO_CONFIGFS_TRIGGER "%s", trigger);
         // we actually don't care if this doesn't succeed, as it just means
         // it's already been initialised
         mkdir(buf, configfs_status.st_mode);
@@ -592,19 +598,19 @@ mraa_iio_update_channels(mraa_iio_context dev)
     const struct dirent* ent;
     DIR* dir;
     int chan_num = 0;
-    char buf[MAX_SIZE];
+    char buf[MRAA_FS_PATH_MAX];
     char readbuf[32];
     int fd;
     mraa_iio_channel* chan;
 
     dev->datasize = 0;
-    memset(buf, 0, MAX_SIZE);
-    snprintf(buf, MAX_SIZE, IIO_SYSFS_DEVICE "%d/" IIO_SCAN_ELEM, dev->num);
+    memset(buf, 0, sizeof(buf));
+    mraa_fs_path(buf, sizeof(buf), IIO_SYSFS_DEVICE "%d/" IIO_SCAN_ELEM, dev->num);
     dir = opendir(buf);
     if (dir != NULL) {
         while ((ent = readdir(dir)) != NULL) {
             if (strcmp(ent->d_name + strlen(ent->d_name) - strlen("_index"), "_index") == 0) {
-                snprintf(buf, MAX_SIZE, IIO_SYSFS_DEVICE "%d/" IIO_SCAN_ELEM "/%s", dev->num, ent->d_name);
+                mraa_fs_path(buf, sizeof(buf), IIO_SYSFS_DEVICE "%d/" IIO_SCAN_ELEM "/%s", dev->num, ent->d_name);
                 fd = open(buf, O_RDONLY);
                 if (fd != -1) {
                     if (read(fd, readbuf, 2 * sizeof(char)) != 2) {
@@ -620,7 +626,7 @@ mraa_iio_update_channels(mraa_iio_context dev)
                         buf[(strlen(buf) - 5)] = '\0';
                         char* str = strdup(buf);
                         // grab the enable flag of channel
-                        snprintf(buf, MAX_SIZE, "%sen", str);
+                        snprintf(buf, sizeof(buf), "%sen", str);
                         fd = open(buf, O_RDONLY);
                         if (fd != -1) {
                             if (read(fd, readbuf, 2 * sizeof(char)) != 2) {
@@ -653,9 +659,32 @@ mraa_iio_update_channels(mraa_iio_context dev)
     return MRAA_ERROR_INVALID_HANDLE;
 }
 
+mraa_result_t
+mraa_iio_thread_attr(mraa_iio_context dev, const mraa_thread_attr_t* attr)
+{
+    if (dev == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (attr == NULL) {
+        free(dev->thread_attr);
+        dev->thread_attr = NULL;
+        return MRAA_SUCCESS;
+    }
+    if (dev->thread_attr == NULL) {
+        dev->thread_attr = (mraa_thread_attr_t*) malloc(sizeof(mraa_thread_attr_t));
+        if (dev->thread_attr == NULL) {
+            return MRAA_ERROR_NO_RESOURCES;
+        }
+    }
+    *dev->thread_attr = *attr;
+    return MRAA_SUCCESS;
+}
+
 mraa_result_t
 mraa_iio_close(mraa_iio_context dev)
 {
+    free(dev->thread_attr);
+    dev->thread_attr = NULL;
     free(dev->channels);
     return MRAA_SUCCESS;
 }
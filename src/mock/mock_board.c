@@ -0,0 +1,747 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <ftw.h>
+#include <pthread.h>
+#include <termios.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+
+#include "mock/mock_board.h"
+#include "gpio.h"
+#include "linux/i2c-dev.h"
+
+#define PLATFORM_NAME "MRAA mock platform"
+#define MAX_LENGTH 32
+#define UART_POLL_MS 100
+
+/**
+ * What backs the fake board. GPIO, PWM and AIO live as plain files in a
+ * fake sysfs tree, so the regular sysfs code paths run against them. Edges
+ * are raised by writes to a pin, as if every pin was wired to itself. I2C
+ * and SPI have no file to talk to and are served by the replace hooks, the
+ * UART is a pty whose far end echoes everything back.
+ */
+static struct {
+    mraa_boolean_t own_root; /**< the fake tree is in a directory we created */
+    int edge_fd[MRAA_MOCK_GPIOCOUNT]; /**< eventfd raised on edges of each gpio */
+    mraa_gpio_edge_t edge[MRAA_MOCK_GPIOCOUNT]; /**< edges each gpio reports */
+    int level[MRAA_MOCK_GPIOCOUNT]; /**< last level written to each gpio */
+    pthread_mutex_t i2c_lock; /**< serialises access to the register file */
+    uint8_t i2c_regs[MRAA_MOCK_I2C_REGS]; /**< the i2c device */
+    uint8_t i2c_ptr; /**< register the next plain read or write starts at */
+    int pty_master; /**< loopback side of the uart */
+    int pty_slave; /**< keeps the slave raw while no context has it open */
+    char pty_path[64]; /**< the uart as opened by mraa_uart_init */
+    pthread_t uart_thread; /**< echoes the uart */
+    mraa_boolean_t uart_running; /**< uart_thread was started */
+    volatile int uart_stop; /**< asks uart_thread to return */
+} mock = { .pty_master = -1, .pty_slave = -1 };
+
+static mraa_result_t
+mock_mkdir(const char* fmt, int n)
+{
+    char path[MRAA_FS_PATH_MAX];
+    char* p;
+
+    if (mraa_fs_path(path, sizeof(path), fmt, n) == -1) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    // create every missing component, like mkdir -p
+    for (p = path + strlen(mraa_get_fs_root()) + 1; (p = strchr(p, '/')) != NULL; p++) {
+        *p = '\0';
+        if (mkdir(path, 0755) == -1 && errno != EEXIST) {
+            return MRAA_ERROR_INVALID_RESOURCE;
+        }
+        *p = '/';
+    }
+    if (mkdir(path, 0755) == -1 && errno != EEXIST) {
+        syslog(LOG_ERR, "mock: unable to create %s: %s", path, strerror(errno));
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mock_file(const char* dir_fmt, int n, const char* name, const char* content)
+{
+    char path[MRAA_FS_PATH_MAX];
+    char file[MRAA_FS_PATH_MAX + MAX_LENGTH * 2];
+
+    if (mraa_fs_path(path, sizeof(path), dir_fmt, n) == -1) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    snprintf(file, sizeof(file), "%s/%s", path, name);
+    int fd = open(file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        syslog(LOG_ERR, "mock: unable to create %s: %s", file, strerror(errno));
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    int len = strlen(content);
+    int ret = write(fd, content, len);
+    close(fd);
+    return ret == len ? MRAA_SUCCESS : MRAA_ERROR_INVALID_RESOURCE;
+}
+
+static mraa_result_t
+mock_create_tree()
+{
+    char bu[MAX_LENGTH * 2];
+    int i;
+
+    if (mock_mkdir("/sys/class/gpio", 0) != MRAA_SUCCESS ||
+        mock_file("/sys/class/gpio", 0, "export", "") != MRAA_SUCCESS ||
+        mock_file("/sys/class/gpio", 0, "unexport", "") != MRAA_SUCCESS) {
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    // exported up front, so no context owns and unexports them
+    for (i = 0; i < MRAA_MOCK_GPIOCOUNT; i++) {
+        if (mock_mkdir("/sys/class/gpio/gpio%d", i) != MRAA_SUCCESS ||
+            mock_file("/sys/class/gpio/gpio%d", i, "value", "0\n") != MRAA_SUCCESS ||
+            mock_file("/sys/class/gpio/gpio%d", i, "direction", "in\n") != MRAA_SUCCESS ||
+            mock_file("/sys/class/gpio/gpio%d", i, "edge", "none\n") != MRAA_SUCCESS ||
+            mock_file("/sys/class/gpio/gpio%d", i, "active_low", "0\n") != MRAA_SUCCESS) {
+            return MRAA_ERROR_INVALID_RESOURCE;
+        }
+    }
+
+    snprintf(bu, sizeof(bu), "%d\n", MRAA_MOCK_PWMCOUNT);
+    if (mock_mkdir("/sys/class/pwm/pwmchip%d", 0) != MRAA_SUCCESS ||
+        mock_file("/sys/class/pwm/pwmchip%d", 0, "export", "") != MRAA_SUCCESS ||
+        mock_file("/sys/class/pwm/pwmchip%d", 0, "unexport", "") != MRAA_SUCCESS ||
+        mock_file("/sys/class/pwm/pwmchip%d", 0, "npwm", bu) != MRAA_SUCCESS) {
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    for (i = 0; i < MRAA_MOCK_PWMCOUNT; i++) {
+        if (mock_mkdir("/sys/class/pwm/pwmchip0/pwm%d", i) != MRAA_SUCCESS ||
+            mock_file("/sys/class/pwm/pwmchip0/pwm%d", i, "period", "0\n") != MRAA_SUCCESS ||
+            mock_file("/sys/class/pwm/pwmchip0/pwm%d", i, "duty_cycle", "0\n") != MRAA_SUCCESS ||
+            mock_file("/sys/class/pwm/pwmchip0/pwm%d", i, "enable", "0\n") != MRAA_SUCCESS) {
+            return MRAA_ERROR_INVALID_RESOURCE;
+        }
+    }
+
+    if (mock_mkdir("/sys/bus/iio/devices/iio:device%d", 0) != MRAA_SUCCESS ||
+        mock_file("/sys/bus/iio/devices/iio:device%d", 0, "name", "mraa-mock-adc\n") != MRAA_SUCCESS) {
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    snprintf(bu, sizeof(bu), "%d\n", MRAA_MOCK_ADC_VALUE);
+    for (i = 0; i < MRAA_MOCK_AIOCOUNT; i++) {
+        char name[MAX_LENGTH * 2];
+        snprintf(name, sizeof(name), "in_voltage%d_raw", i);
+        if (mock_file("/sys/bus/iio/devices/iio:device%d", 0, name, bu) != MRAA_SUCCESS) {
+            return MRAA_ERROR_INVALID_RESOURCE;
+        }
+    }
+    // buffered channels, so the scan layout can be decoded like a real adc
+    if (mock_mkdir("/sys/bus/iio/devices/iio:device%d/scan_elements", 0) != MRAA_SUCCESS) {
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    snprintf(bu, sizeof(bu), "le:u%d/16>>0\n", MRAA_MOCK_ADC_BITS);
+    for (i = 0; i < MRAA_MOCK_AIOCOUNT; i++) {
+        char name[MAX_LENGTH * 2];
+        char index[8];
+        snprintf(index, sizeof(index), "%d\n", i);
+        snprintf(name, sizeof(name), "in_voltage%d_index", i);
+        if (mock_file("/sys/bus/iio/devices/iio:device%d/scan_elements", 0, name, index) != MRAA_SUCCESS) {
+            return MRAA_ERROR_INVALID_RESOURCE;
+        }
+        snprintf(name, sizeof(name), "in_voltage%d_type", i);
+        if (mock_file("/sys/bus/iio/devices/iio:device%d/scan_elements", 0, name, bu) != MRAA_SUCCESS) {
+            return MRAA_ERROR_INVALID_RESOURCE;
+        }
+        snprintf(name, sizeof(name), "in_voltage%d_en", i);
+        if (mock_file("/sys/bus/iio/devices/iio:device%d/scan_elements", 0, name, "1\n") != MRAA_SUCCESS) {
+            return MRAA_ERROR_INVALID_RESOURCE;
+        }
+    }
+    return MRAA_SUCCESS;
+}
+
+static int
+mock_remove_entry(const char* path, const struct stat* sb, int flag, struct FTW* ftwb)
+{
+    return remove(path);
+}
+
+/* gpio, edges come from writes */
+
+static mraa_result_t
+mock_gpio_check(mraa_gpio_context dev)
+{
+    if (dev->pin < 0 || dev->pin >= MRAA_MOCK_GPIOCOUNT) {
+        syslog(LOG_ERR, "mock: gpio%i is not on the mock board", dev->pin);
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mock_gpio_edge_mode_replace(mraa_gpio_context dev, mraa_gpio_edge_t mode)
+{
+    uint64_t ticks;
+
+    if (mock_gpio_check(dev) != MRAA_SUCCESS) {
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    mock.edge[dev->pin] = mode;
+    // edges from before the isr was set are not reported, drained here as
+    // the isr thread may only start once the caller raised the next edge
+    read(mock.edge_fd[dev->pin], &ticks, sizeof(ticks));
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mock_gpio_write_post(mraa_gpio_context dev, int value)
+{
+    uint64_t one = 1;
+
+    if (mock_gpio_check(dev) != MRAA_SUCCESS) {
+        return MRAA_SUCCESS;
+    }
+    int level = value != 0;
+    if (level == __atomic_exchange_n(&mock.level[dev->pin], level, __ATOMIC_RELAXED)) {
+        return MRAA_SUCCESS;
+    }
+    mraa_gpio_edge_t edge = level ? MRAA_GPIO_EDGE_RISING : MRAA_GPIO_EDGE_FALLING;
+    if (mock.edge[dev->pin] == MRAA_GPIO_EDGE_BOTH || mock.edge[dev->pin] == edge) {
+        write(mock.edge_fd[dev->pin], &one, sizeof(one));
+    }
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mock_gpio_interrupt_handler_init_replace(mraa_gpio_context dev)
+{
+    return mock_gpio_check(dev);
+}
+
+static mraa_result_t
+mock_gpio_wait_interrupt_replace(mraa_gpio_context dev)
+{
+    struct pollfd pfd = { mock.edge_fd[dev->pin], POLLIN, 0 };
+    uint64_t ticks;
+
+    while (!dev->isr_thread_terminating) {
+        if (poll(&pfd, 1, -1) == -1 && errno != EINTR) {
+            return MRAA_ERROR_UNSPECIFIED;
+        }
+        if (read(mock.edge_fd[dev->pin], &ticks, sizeof(ticks)) == sizeof(ticks)) {
+            return MRAA_SUCCESS;
+        }
+    }
+    return MRAA_ERROR_UNSPECIFIED;
+}
+
+static mraa_boolean_t
+mock_gpio_interrupt_pending_replace(mraa_gpio_context dev)
+{
+    uint64_t ticks;
+    return read(mock.edge_fd[dev->pin], &ticks, sizeof(ticks)) == sizeof(ticks);
+}
+
+static mraa_result_t
+mock_gpio_interrupt_handler_exit_replace(mraa_gpio_context dev)
+{
+    return MRAA_SUCCESS;
+}
+
+/* i2c, a register file at MRAA_MOCK_I2C_ADDR on bus 0 */
+
+static mraa_result_t
+mock_i2c_init_bus_replace(mraa_i2c_context dev)
+{
+    if (dev->busnum != 0) {
+        syslog(LOG_ERR, "mock: i2c%i is not on the mock board", dev->busnum);
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    dev->fh = -1;
+    dev->funcs = I2C_FUNC_I2C | I2C_FUNC_NOSTART;
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mock_i2c_address_replace(mraa_i2c_context dev, uint8_t addr)
+{
+    // like the kernel, nobody answers until the first transfer
+    return MRAA_SUCCESS;
+}
+
+static mraa_boolean_t
+mock_i2c_acked(mraa_i2c_context dev, int addr)
+{
+    if (addr != MRAA_MOCK_I2C_ADDR) {
+        syslog(LOG_DEBUG, "mock: i2c%i: no device at 0x%02x", dev->busnum, addr);
+        // what most adapters report for an address nobody acknowledged
+        errno = ENXIO;
+        return 0;
+    }
+    return 1;
+}
+
+static int
+mock_i2c_read_regs(mraa_i2c_context dev, int reg, uint8_t* data, int length)
+{
+    int i;
+
+    if (!mock_i2c_acked(dev, dev->addr)) {
+        return -1;
+    }
+    pthread_mutex_lock(&mock.i2c_lock);
+    if (reg >= 0) {
+        mock.i2c_ptr = reg;
+    }
+    for (i = 0; i < length; i++) {
+        data[i] = mock.i2c_regs[mock.i2c_ptr++];
+    }
+    pthread_mutex_unlock(&mock.i2c_lock);
+    return length;
+}
+
+static mraa_result_t
+mock_i2c_write_regs(mraa_i2c_context dev, int reg, const uint8_t* data, int length)
+{
+    int i;
+
+    if (!mock_i2c_acked(dev, dev->addr)) {
+        return MRAA_ERROR_UNSPECIFIED;
+    }
+    pthread_mutex_lock(&mock.i2c_lock);
+    mock.i2c_ptr = reg;
+    for (i = 0; i < length; i++) {
+        mock.i2c_regs[mock.i2c_ptr++] = data[i];
+    }
+    pthread_mutex_unlock(&mock.i2c_lock);
+    return MRAA_SUCCESS;
+}
+
+static int
+mock_i2c_read_replace(mraa_i2c_context dev, uint8_t* data, int length)
+{
+    return mock_i2c_read_regs(dev, -1, data, length);
+}
+
+static int
+mock_i2c_read_byte_replace(mraa_i2c_context dev)
+{
+    uint8_t data;
+    return mock_i2c_read_regs(dev, -1, &data, 1) == 1 ? data : -1;
+}
+
+static int
+mock_i2c_read_byte_data_replace(mraa_i2c_context dev, const uint8_t command)
+{
+    uint8_t data;
+    return mock_i2c_read_regs(dev, command, &data, 1) == 1 ? data : -1;
+}
+
+static int
+mock_i2c_read_word_data_replace(mraa_i2c_context dev, const uint8_t command)
+{
+    uint8_t data[2];
+    // smbus words go low byte first
+    return mock_i2c_read_regs(dev, command, data, 2) == 2 ? data[0] | (data[1] << 8) : -1;
+}
+
+static int
+mock_i2c_read_bytes_data_replace(mraa_i2c_context dev, uint8_t command, uint8_t* data, int length)
+{
+    return mock_i2c_read_regs(dev, command, data, length);
+}
+
+static mraa_result_t
+mock_i2c_write_byte_replace(mraa_i2c_context dev, uint8_t data)
+{
+    return mock_i2c_write_regs(dev, data, NULL, 0);
+}
+
+static mraa_result_t
+mock_i2c_write_byte_data_replace(mraa_i2c_context dev, const uint8_t data, const uint8_t command)
+{
+    return mock_i2c_write_regs(dev, command, &data, 1);
+}
+
+static mraa_result_t
+mock_i2c_write_word_data_replace(mraa_i2c_context dev, const uint16_t data, const uint8_t command)
+{
+    uint8_t bytes[2] = { data & 0xff, data >> 8 };
+    return mock_i2c_write_regs(dev, command, bytes, 2);
+}
+
+static mraa_result_t
+mock_i2c_transfer_replace(mraa_i2c_context dev, struct i2c_msg* msgs, int nmsgs)
+{
+    int i, j;
+
+    // the whole transfer holds the bus, nothing else gets in between
+    pthread_mutex_lock(&mock.i2c_lock);
+    for (i = 0; i < nmsgs; i++) {
+        uint8_t* buf = (uint8_t*) msgs[i].buf;
+        if (!mock_i2c_acked(dev, msgs[i].addr)) {
+            pthread_mutex_unlock(&mock.i2c_lock);
+            return MRAA_ERROR_UNSPECIFIED;
+        }
+        if (msgs[i].flags & I2C_M_RD) {
+            for (j = 0; j < msgs[i].len; j++) {
+                buf[j] = mock.i2c_regs[mock.i2c_ptr++];
+            }
+        } else {
+            // a continued message carries on where the previous one stopped
+            j = 0;
+            if (!(msgs[i].flags & I2C_M_NOSTART)) {
+                mock.i2c_ptr = buf[j++];
+            }
+            for (; j < msgs[i].len; j++) {
+                mock.i2c_regs[mock.i2c_ptr++] = buf[j];
+            }
+        }
+    }
+    pthread_mutex_unlock(&mock.i2c_lock);
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mock_i2c_stop_replace(mraa_i2c_context dev)
+{
+    return MRAA_SUCCESS;
+}
+
+/* spi, mosi wired to miso */
+
+static mraa_result_t
+mock_spi_init_raw_replace(mraa_spi_context dev, unsigned int bus, unsigned int cs)
+{
+    if (bus != 0 || cs != 0) {
+        syslog(LOG_ERR, "mock: spidev%u.%u is not on the mock board", bus, cs);
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+    dev->devfd = -1;
+    dev->clock = 4000000;
+    dev->mode = 0;
+    dev->lsb = 0;
+    dev->bpw = 8;
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mock_spi_mode_replace(mraa_spi_context dev, mraa_spi_mode_t mode)
+{
+    dev->mode = mode;
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mock_spi_frequency_replace(mraa_spi_context dev, int hz)
+{
+    dev->clock = hz;
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mock_spi_lsbmode_replace(mraa_spi_context dev, mraa_boolean_t lsb)
+{
+    dev->lsb = lsb;
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mock_spi_bit_per_word_replace(mraa_spi_context dev, unsigned int bits)
+{
+    dev->bpw = bits;
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mock_spi_transfer_buf_replace(mraa_spi_context dev, uint8_t* data, uint8_t* rxbuf, int length)
+{
+    if (rxbuf != NULL) {
+        memmove(rxbuf, data, length);
+    }
+    return MRAA_SUCCESS;
+}
+
+static mraa_result_t
+mock_spi_transfer_buf_word_replace(mraa_spi_context dev, uint16_t* data, uint16_t* rxbuf, int length)
+{
+    return mock_spi_transfer_buf_replace(dev, (uint8_t*) data, (uint8_t*) rxbuf, length);
+}
+
+static mraa_result_t
+mock_spi_stop_replace(mraa_spi_context dev)
+{
+    return MRAA_SUCCESS;
+}
+
+/* uart, a pty with rx wired to tx */
+
+static void*
+mock_uart_loopback(void* arg)
+{
+    struct pollfd pfd = { mock.pty_master, POLLIN, 0 };
+    char bu[256];
+
+    while (!mock.uart_stop) {
+        if (poll(&pfd, 1, UART_POLL_MS) <= 0) {
+            continue;
+        }
+        ssize_t n = read(mock.pty_master, bu, sizeof(bu));
+        if (n > 0) {
+            write(mock.pty_master, bu, n);
+        }
+    }
+    return NULL;
+}
+
+static mraa_result_t
+mock_uart_setup()
+{
+    struct termios tio;
+
+    mock.pty_master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (mock.pty_master == -1 || grantpt(mock.pty_master) != 0 || unlockpt(mock.pty_master) != 0 ||
+        ptsname_r(mock.pty_master, mock.pty_path, sizeof(mock.pty_path)) != 0) {
+        syslog(LOG_ERR, "mock: unable to create uart pty: %s", strerror(errno));
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    // an echoing line discipline would bounce the loopback forever
+    mock.pty_slave = open(mock.pty_path, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (mock.pty_slave == -1 || tcgetattr(mock.pty_slave, &tio) != 0) {
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    cfmakeraw(&tio);
+    if (tcsetattr(mock.pty_slave, TCSANOW, &tio) != 0) {
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    mock.uart_stop = 0;
+    if (mraa_thread_create(&mock.uart_thread, NULL, mock_uart_loopback, NULL) != 0) {
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    mock.uart_running = 1;
+    return MRAA_SUCCESS;
+}
+
+static void
+mock_set_pininfo(mraa_board_t* b, int index, const char* name, mraa_pincapabilities_t caps)
+{
+    mraa_pininfo_t* pin = &b->pins[index];
+
+    strncpy(pin->name, name, MRAA_PIN_NAME_SIZE - 1);
+    pin->capabilites = caps;
+    if (caps.gpio) {
+        pin->gpio.pinmap = index;
+    }
+}
+
+mraa_board_t*
+mraa_mock_board()
+{
+    mraa_board_t* b = (mraa_board_t*) calloc(1, sizeof(mraa_board_t));
+    if (b == NULL) {
+        return NULL;
+    }
+
+    b->platform_name = PLATFORM_NAME;
+    b->phy_pin_count = MRAA_MOCK_PINCOUNT;
+    b->gpio_count = MRAA_MOCK_GPIOCOUNT;
+    b->aio_count = MRAA_MOCK_AIOCOUNT;
+    b->adc_raw = MRAA_MOCK_ADC_BITS;
+    b->adc_supported = MRAA_MOCK_ADC_BITS;
+    b->no_bus_mux = 1;
+    b->pwm_default_period = 500;
+    b->pwm_max_period = 2147483;
+    b->pwm_min_period = 1;
+
+    b->pins = (mraa_pininfo_t*) calloc(MRAA_MOCK_PINCOUNT, sizeof(mraa_pininfo_t));
+    if (b->pins == NULL) {
+        goto error;
+    }
+    b->adv_func = (mraa_adv_func_t*) calloc(1, sizeof(mraa_adv_func_t));
+    if (b->adv_func == NULL) {
+        goto error;
+    }
+
+    mock_set_pininfo(b, 0, "GPIO0", (mraa_pincapabilities_t){ 1, 1, 0, 0, 0, 0, 0, 0 });
+    mock_set_pininfo(b, 1, "GPIO1", (mraa_pincapabilities_t){ 1, 1, 0, 0, 0, 0, 0, 0 });
+    mock_set_pininfo(b, 2, "GPIO2", (mraa_pincapabilities_t){ 1, 1, 0, 0, 0, 0, 0, 0 });
+    mock_set_pininfo(b, 3, "PWM0", (mraa_pincapabilities_t){ 1, 1, 1, 0, 0, 0, 0, 0 });
+    mock_set_pininfo(b, 4, "GPIO4", (mraa_pincapabilities_t){ 1, 1, 0, 0, 0, 0, 0, 0 });
+    mock_set_pininfo(b, 5, "PWM1", (mraa_pincapabilities_t){ 1, 1, 1, 0, 0, 0, 0, 0 });
+    mock_set_pininfo(b, 6, "GPIO6", (mraa_pincapabilities_t){ 1, 1, 0, 0, 0, 0, 0, 0 });
+    mock_set_pininfo(b, 7, "GPIO7", (mraa_pincapabilities_t){ 1, 1, 0, 0, 0, 0, 0, 0 });
+    mock_set_pininfo(b, 8, "GPIO8", (mraa_pincapabilities_t){ 1, 1, 0, 0, 0, 0, 0, 0 });
+    mock_set_pininfo(b, 9, "GPIO9", (mraa_pincapabilities_t){ 1, 1, 0, 0, 0, 0, 0, 0 });
+    mock_set_pininfo(b, 10, "AIO0", (mraa_pincapabilities_t){ 1, 0, 0, 0, 0, 0, 1, 0 });
+    mock_set_pininfo(b, 11, "AIO1", (mraa_pincapabilities_t){ 1, 0, 0, 0, 0, 0, 1, 0 });
+    mock_set_pininfo(b, 12, "I2C_SDA", (mraa_pincapabilities_t){ 1, 0, 0, 0, 0, 1, 0, 0 });
+    mock_set_pininfo(b, 13, "I2C_SCL", (mraa_pincapabilities_t){ 1, 0, 0, 0, 0, 1, 0, 0 });
+    mock_set_pininfo(b, 14, "SPI_CS", (mraa_pincapabilities_t){ 1, 0, 0, 0, 1, 0, 0, 0 });
+    mock_set_pininfo(b, 15, "SPI_MOSI", (mraa_pincapabilities_t){ 1, 0, 0, 0, 1, 0, 0, 0 });
+    mock_set_pininfo(b, 16, "SPI_MISO", (mraa_pincapabilities_t){ 1, 0, 0, 0, 1, 0, 0, 0 });
+    mock_set_pininfo(b, 17, "SPI_SCLK", (mraa_pincapabilities_t){ 1, 0, 0, 0, 1, 0, 0, 0 });
+    mock_set_pininfo(b, 18, "UART_RX", (mraa_pincapabilities_t){ 1, 0, 0, 0, 0, 0, 0, 1 });
+    mock_set_pininfo(b, 19, "UART_TX", (mraa_pincapabilities_t){ 1, 0, 0, 0, 0, 0, 0, 1 });
+    b->pins[3].pwm.pinmap = 0;
+    b->pins[5].pwm.pinmap = 1;
+    b->pins[10].aio.pinmap = 0;
+    b->pins[11].aio.pinmap = 1;
+
+    b->i2c_bus_count = 1;
+    b->def_i2c_bus = 0;
+    b->i2c_bus[0].bus_id = 0;
+    b->i2c_bus[0].sda = 12;
+    b->i2c_bus[0].scl = 13;
+
+    b->spi_bus_count = 1;
+    b->def_spi_bus = 0;
+    b->spi_bus[0].bus_id = 0;
+    b->spi_bus[0].slave_s = 0;
+    b->spi_bus[0].cs = 14;
+    b->spi_bus[0].mosi = 15;
+    b->spi_bus[0].miso = 16;
+    b->spi_bus[0].sclk = 17;
+
+    b->uart_dev_count = 1;
+    b->def_uart_dev = 0;
+    b->uart_dev[0].index = 0;
+    b->uart_dev[0].rx = 18;
+    b->uart_dev[0].tx = 19;
+    b->uart_dev[0].device_path = mock.pty_path;
+
+    b->adv_func->gpio_edge_mode_replace = &mock_gpio_edge_mode_replace;
+    b->adv_func->gpio_write_post = &mock_gpio_write_post;
+    b->adv_func->gpio_interrupt_handler_init_replace = &mock_gpio_interrupt_handler_init_replace;
+    b->adv_func->gpio_wait_interrupt_replace = &mock_gpio_wait_interrupt_replace;
+    b->adv_func->gpio_interrupt_pending_replace = &mock_gpio_interrupt_pending_replace;
+    b->adv_func->gpio_interrupt_handler_exit_replace = &mock_gpio_interrupt_handler_exit_replace;
+
+    b->adv_func->i2c_init_bus_replace = &mock_i2c_init_bus_replace;
+    b->adv_func->i2c_address_replace = &mock_i2c_address_replace;
+    b->adv_func->i2c_read_replace = &mock_i2c_read_replace;
+    b->adv_func->i2c_read_byte_replace = &mock_i2c_read_byte_replace;
+    b->adv_func->i2c_read_byte_data_replace = &mock_i2c_read_byte_data_replace;
+    b->adv_func->i2c_read_word_data_replace = &mock_i2c_read_word_data_replace;
+    b->adv_func->i2c_read_bytes_data_replace = &mock_i2c_read_bytes_data_replace;
+    b->adv_func->i2c_write_byte_replace = &mock_i2c_write_byte_replace;
+    b->adv_func->i2c_write_byte_data_replace = &mock_i2c_write_byte_data_replace;
+    b->adv_func->i2c_write_word_data_replace = &mock_i2c_write_word_data_replace;
+    b->adv_func->i2c_transfer_replace = &mock_i2c_transfer_replace;
+    b->adv_func->i2c_stop_replace = &mock_i2c_stop_replace;
+
+    b->adv_func->spi_init_raw_replace = &mock_spi_init_raw_replace;
+    b->adv_func->spi_mode_replace = &mock_spi_mode_replace;
+    b->adv_func->spi_frequency_replace = &mock_spi_frequency_replace;
+    b->adv_func->spi_lsbmode_replace = &mock_spi_lsbmode_replace;
+    b->adv_func->spi_bit_per_word_replace = &mock_spi_bit_per_word_replace;
+    b->adv_func->spi_transfer_buf_replace = &mock_spi_transfer_buf_replace;
+    b->adv_func->spi_transfer_buf_word_replace = &mock_spi_transfer_buf_word_replace;
+    b->adv_func->spi_stop_replace = &mock_spi_stop_replace;
+
+    return b;
+
+error:
+    syslog(LOG_CRIT, "mock: Platform failed to initialise");
+    free(b->pins);
+    free(b);
+    return NULL;
+}
+
+mraa_platform_t
+mraa_mock_platform()
+{
+    int i;
+
+    // without a root of its own the board builds its tree in a temporary one
+    if (mraa_get_fs_root()[0] == '\0') {
+        char dir[] = "/tmp/mraa-mock-XXXXXX";
+        if (mkdtemp(dir) == NULL || mraa_set_fs_root(dir) != MRAA_SUCCESS) {
+            syslog(LOG_ERR, "mock: unable to create a filesystem root: %s", strerror(errno));
+            return MRAA_UNKNOWN_PLATFORM;
+        }
+        mock.own_root = 1;
+    }
+    if (mock_create_tree() != MRAA_SUCCESS) {
+        mraa_mock_platform_deinit();
+        return MRAA_UNKNOWN_PLATFORM;
+    }
+
+    pthread_mutex_init(&mock.i2c_lock, NULL);
+    memset(mock.i2c_regs, 0, sizeof(mock.i2c_regs));
+    mock.i2c_ptr = 0;
+    for (i = 0; i < MRAA_MOCK_GPIOCOUNT; i++) {
+        mock.edge_fd[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        mock.edge[i] = MRAA_GPIO_EDGE_NONE;
+        mock.level[i] = 0;
+    }
+    if (mock_uart_setup() != MRAA_SUCCESS) {
+        syslog(LOG_WARNING, "mock: running without a uart");
+    }
+
+    plat = mraa_mock_board();
+    if (plat == NULL) {
+        mraa_mock_platform_deinit();
+        return MRAA_UNKNOWN_PLATFORM;
+    }
+    if (!mock.uart_running) {
+        plat->uart_dev_count = 0;
+    }
+    syslog(LOG_NOTICE, "mock: fake filesystem under %s", mraa_get_fs_root());
+    return MRAA_MOCK_PLATFORM;
+}
+
+void
+mraa_mock_platform_deinit()
+{
+    int i;
+
+    if (mock.uart_running) {
+        mock.uart_stop = 1;
+        pthread_join(mock.uart_thread, NULL);
+        mock.uart_running = 0;
+    }
+    if (mock.pty_master != -1) {
+        close(mock.pty_master);
+        mock.pty_master = -1;
+    }
+    if (mock.pty_slave != -1) {
+        close(mock.pty_slave);
+        mock.pty_slave = -1;
+    }
+    for (i = 0; i < MRAA_MOCK_GPIOCOUNT; i++) {
+        if (mock.edge_fd[i] > 0) {
+            close(mock.edge_fd[i]);
+        }
+        mock.edge_fd[i] = -1;
+    }
+    if (mock.own_root) {
+        nftw(mraa_get_fs_root(), &mock_remove_entry, 20, FTW_DEPTH | FTW_PHYS);
+        mraa_set_fs_root(NULL);
+        mock.own_root = 0;
+    }
+}
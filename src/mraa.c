@@ -44,6 +44,7 @@
 #include <errno.h>
 #include <ctype.h>
 #include <limits.h>
+#include <stdarg.h>
 
 #if defined(IMRAA)
 #include <json-c/json.h>
@@ -60,6 +61,8 @@
 #include "aio.h"
 #include "spi.h"
 #include "uart.h"
+#include "mraa_trace.h"
+#include "i2c/i2c_async.h"
 
 
 #define IIO_DEVICE_WILDCARD "iio:device*"
@@ -72,6 +75,12 @@ static char* platform_long_name = NULL;
 
 static int num_i2c_devices = 0;
 static int num_iio_devices = 0;
+// attributes of library threads, set through mraa_set_thread_attr()
+static mraa_thread_attr_t thread_attr;
+static mraa_boolean_t thread_attr_set = 0;
+// prefix of sysfs, devfs and procfs paths, set through mraa_set_fs_root()
+static char fs_root[MRAA_FS_ROOT_MAX] = "";
+static mraa_boolean_t fs_root_set = 0;
 
 const char*
 mraa_get_version()
@@ -84,6 +93,7 @@ mraa_set_log_level(int level)
 {
     if (level <= 7 && level >= 0) {
         setlogmask(LOG_UPTO(level));
+        mraa_trace_set_mask(LOG_UPTO(level));
         syslog(LOG_DEBUG, "Loglevel %d is set", level);
         return MRAA_SUCCESS;
     }
@@ -107,24 +117,36 @@ imraa_init()
 
 #ifdef DEBUG
     setlogmask(LOG_UPTO(LOG_DEBUG));
+    mraa_trace_set_mask(LOG_UPTO(LOG_DEBUG));
 #else
     setlogmask(LOG_UPTO(LOG_NOTICE));
+    mraa_trace_set_mask(LOG_UPTO(LOG_NOTICE));
 #endif
 
     openlog("libmraa", LOG_CONS | LOG_PID | LOG_NDELAY, LOG_LOCAL1);
     syslog(LOG_NOTICE, "libmraa version %s initialised by user '%s' with EUID %d",
            mraa_get_version(), (proc_user != NULL) ? proc_user->pw_name : "<unknown>", proc_euid);
 
+    const char* env_root = getenv("MRAA_FS_ROOT");
+    if (!fs_root_set && env_root != NULL && mraa_set_fs_root(env_root) != MRAA_SUCCESS) {
+        syslog(LOG_ERR, "MRAA_FS_ROOT '%s' ignored", env_root);
+    }
+
     mraa_platform_t platform_type;
+    if (getenv("MRAA_MOCK_PLATFORM") != NULL) {
+        // fake board on a fake filesystem, for tests and benchmarks
+        platform_type = mraa_mock_platform();
+    } else {
 #if defined(X86PLAT)
-    // Use runtime x86 platform detection
-    platform_type = mraa_x86_platform();
+        // Use runtime x86 platform detection
+        platform_type = mraa_x86_platform();
 #elif defined(ARMPLAT)
-    // Use runtime ARM platform detection
-    platform_type = mraa_arm_platform();
+        // Use runtime ARM platform detection
+        platform_type = mraa_arm_platform();
 #else
 #error mraa_ARCH NOTHING
 #endif
+    }
 
     if (plat != NULL) {
         plat->platform_type = platform_type;
@@ -179,9 +201,12 @@ imraa_init()
         }
     }
 
-    lang_func = (mraa_lang_func_t*) calloc(1, sizeof(mraa_lang_func_t));
+    // the bindings install their hooks once, they outlive mraa_deinit()
     if (lang_func == NULL) {
-        return MRAA_ERROR_NO_RESOURCES;
+        lang_func = (mraa_lang_func_t*) calloc(1, sizeof(mraa_lang_func_t));
+        if (lang_func == NULL) {
+            return MRAA_ERROR_NO_RESOURCES;
+        }
     }
 
     syslog(LOG_NOTICE, "libmraa initialised for platform '%s' of type %d", mraa_get_platform_name(), mraa_get_platform_type());
@@ -205,6 +230,13 @@ mraa_init()
 void
 mraa_deinit()
 {
+    mraa_sampler_shutdown();
+    mraa_gpio_isr_dispatcher_stop();
+    mraa_i2c_async_shutdown();
+    mraa_i2c_scan_invalidate(-1);
+    if (plat != NULL && plat->platform_type == MRAA_MOCK_PLATFORM) {
+        mraa_mock_platform_deinit();
+    }
     if (plat != NULL) {
         if (plat->pins != NULL) {
             free(plat->pins);
@@ -217,11 +249,18 @@ mraa_deinit()
             free(sub_plat);
         }
         free(plat);
-
+        plat = NULL;
     }
     if (plat_iio != NULL) {
         free(plat_iio);
+        plat_iio = NULL;
     }
+    // a following mraa_init() detects again, possibly under another root
+    num_iio_devices = 0;
+    num_i2c_devices = 0;
+    free(platform_name);
+    platform_name = NULL;
+    mraa_trace_stop();
     closelog();
 }
 
@@ -240,6 +279,160 @@ mraa_set_priority(const int priority)
     return sched_setscheduler(0, SCHED_RR, &sched_s);
 }
 
+mraa_result_t
+mraa_set_thread_attr(const mraa_thread_attr_t* attr)
+{
+    if (attr == NULL) {
+        thread_attr_set = 0;
+        return MRAA_SUCCESS;
+    }
+    if (attr->policy < MRAA_THREAD_SCHED_INHERIT || attr->policy > MRAA_THREAD_SCHED_RR) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    thread_attr = *attr;
+    thread_attr_set = 1;
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_set_fs_root(const char* root)
+{
+    size_t len = root == NULL ? 0 : strlen(root);
+
+    // a trailing slash would double up with the absolute paths appended
+    while (len > 0 && root[len - 1] == '/') {
+        len--;
+    }
+    if (len >= sizeof(fs_root)) {
+        syslog(LOG_ERR, "fs_root: '%s' longer than %d characters", root, MRAA_FS_ROOT_MAX - 1);
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    if (len > 0) {
+        memcpy(fs_root, root, len);
+    }
+    fs_root[len] = '\0';
+    fs_root_set = 1;
+    return MRAA_SUCCESS;
+}
+
+const char*
+mraa_get_fs_root()
+{
+    return fs_root;
+}
+
+int
+mraa_fs_path(char* buf, size_t size, const char* fmt, ...)
+{
+    va_list args;
+    size_t root_len = strlen(fs_root);
+
+    if (root_len >= size) {
+        return -1;
+    }
+    memcpy(buf, fs_root, root_len);
+    va_start(args, fmt);
+    int len = vsnprintf(buf + root_len, size - root_len, fmt, args);
+    va_end(args);
+    if (len < 0 || (size_t) len >= size - root_len) {
+        syslog(LOG_ERR, "fs_root: path under '%s' too long", fs_root);
+        return -1;
+    }
+    return (int) root_len + len;
+}
+
+int
+mraa_fs_open(const char* path, int flags)
+{
+    char bu[MRAA_FS_PATH_MAX];
+
+    if (fs_root[0] == '\0') {
+        return open(path, flags);
+    }
+    if (mraa_fs_path(bu, sizeof(bu), "%s", path) == -1) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    return open(bu, flags);
+}
+
+FILE*
+mraa_fs_fopen(const char* path, const char* mode)
+{
+    char bu[MRAA_FS_PATH_MAX];
+
+    if (mraa_fs_path(bu, sizeof(bu), "%s", path) == -1) {
+        errno = ENAMETOOLONG;
+        return NULL;
+    }
+    return fopen(bu, mode);
+}
+
+static void
+mraa_thread_attr_apply(pthread_attr_t* pattr, const mraa_thread_attr_t* attr, mraa_boolean_t sched)
+{
+    if (attr->stack_size != 0) {
+        pthread_attr_setstacksize(pattr, attr->stack_size < PTHREAD_STACK_MIN ? PTHREAD_STACK_MIN : attr->stack_size);
+    }
+    if (attr->cpu_mask != 0) {
+        cpu_set_t cpus;
+        int i;
+        CPU_ZERO(&cpus);
+        for (i = 0; i < 64; i++) {
+            if ((attr->cpu_mask >> i) & 1) {
+                CPU_SET(i, &cpus);
+            }
+        }
+        pthread_attr_setaffinity_np(pattr, sizeof(cpus), &cpus);
+    }
+    if (sched && attr->policy != MRAA_THREAD_SCHED_INHERIT) {
+        struct sched_param param;
+        int policy = attr->policy == MRAA_THREAD_SCHED_FIFO ? SCHED_FIFO :
+                     attr->policy == MRAA_THREAD_SCHED_RR ? SCHED_RR : SCHED_OTHER;
+
+        memset(&param, 0, sizeof(param));
+        if (policy != SCHED_OTHER) {
+            param.sched_priority = attr->priority;
+            if (param.sched_priority > sched_get_priority_max(policy)) {
+                param.sched_priority = sched_get_priority_max(policy);
+            } else if (param.sched_priority < sched_get_priority_min(policy)) {
+                param.sched_priority = sched_get_priority_min(policy);
+            }
+        }
+        pthread_attr_setinheritsched(pattr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(pattr, policy);
+        pthread_attr_setschedparam(pattr, &param);
+    }
+}
+
+int
+mraa_thread_create(pthread_t* thread, const mraa_thread_attr_t* attr, void* (*start)(void*), void* arg)
+{
+    pthread_attr_t pattr;
+    int ret;
+
+    if (attr == NULL && thread_attr_set) {
+        attr = &thread_attr;
+    }
+    if (attr == NULL) {
+        return pthread_create(thread, NULL, start, arg);
+    }
+
+    pthread_attr_init(&pattr);
+    mraa_thread_attr_apply(&pattr, attr, 1);
+    ret = pthread_create(thread, &pattr, start, arg);
+    pthread_attr_destroy(&pattr);
+    if (ret == EPERM) {
+        // realtime policies need privileges, a thread at normal priority beats none
+        syslog(LOG_WARNING, "mraa: not allowed to set thread scheduling, using the default policy");
+        pthread_attr_init(&pattr);
+        mraa_thread_attr_apply(&pattr, attr, 0);
+        ret = pthread_create(thread, &pattr, start, arg);
+        pthread_attr_destroy(&pattr);
+    }
+    return ret;
+}
+
 static int
 mraa_count_iio_devices(const char* path, const struct stat* sb, int flag, struct FTW* ftwb)
 {
@@ -258,11 +451,13 @@ mraa_iio_detect()
     // Now detect IIO devices, linux only
     // find how many iio devices we have if we haven't already
     if (num_iio_devices == 0) {
-        if (nftw("/sys/bus/iio/devices", &mraa_count_iio_devices, 20, FTW_PHYS) == -1) {
+        char dirpath[MRAA_FS_PATH_MAX];
+        if (mraa_fs_path(dirpath, sizeof(dirpath), "/sys/bus/iio/devices") == -1 ||
+            nftw(dirpath, &mraa_count_iio_devices, 20, FTW_PHYS) == -1) {
             return MRAA_ERROR_UNSPECIFIED;
         }
     }
-    char name[64], filepath[64];
+    char name[64], filepath[MRAA_FS_PATH_MAX];
     int fd, len, i;
     plat_iio->iio_device_count = num_iio_devices;
     plat_iio->iio_devices = calloc(num_iio_devices, sizeof(struct _iio));
@@ -270,7 +465,7 @@ mraa_iio_detect()
     for (i=0; i < num_iio_devices; i++) {
         device = &plat_iio->iio_devices[i];
         device->num = i;
-        snprintf(filepath, 64, "/sys/bus/iio/devices/iio:device%d/name", i);
+        mraa_fs_path(filepath, sizeof(filepath), "/sys/bus/iio/devices/iio:device%d/name", i);
         fd = open(filepath, O_RDONLY);
         if (fd != -1) {
             len = read(fd, &name, 64);
@@ -761,8 +956,12 @@ mraa_boolean_t
 mraa_file_exist(const char* filename)
 {
     glob_t results;
+    char path[MRAA_FS_PATH_MAX];
     results.gl_pathc = 0;
-    glob(filename, 0, NULL, &results);
+    if (mraa_fs_path(path, sizeof(path), "%s", filename) == -1) {
+        return 0;
+    }
+    glob(path, 0, NULL, &results);
     int file_found = results.gl_pathc == 1;
     globfree(&results);
     return file_found;
@@ -842,9 +1041,13 @@ char*
 mraa_file_unglob(const char* filename)
 {
     glob_t results;
+    char path[MRAA_FS_PATH_MAX];
     char* res = NULL;
     results.gl_pathc = 0;
-    glob(filename, 0, NULL, &results);
+    if (mraa_fs_path(path, sizeof(path), "%s", filename) == -1) {
+        return NULL;
+    }
+    glob(path, 0, NULL, &results);
     if (results.gl_pathc == 1)
         res = strdup(results.gl_pathv[0]);
     globfree(&results);
@@ -857,11 +1060,15 @@ mraa_link_targets(const char* filename, const char* targetname)
     int size = 100;
     int nchars = 0;
     char* buffer = NULL;
+    char path[MRAA_FS_PATH_MAX];
+    if (mraa_fs_path(path, sizeof(path), "%s", filename) == -1) {
+        return 0;
+    }
     while (nchars == 0) {
         buffer = (char*) realloc(buffer, size);
         if (buffer == NULL)
             return 0;
-        nchars = readlink(filename, buffer, size);
+        nchars = readlink(path, buffer, size);
         if (nchars < 0) {
             free(buffer);
             return 0;
@@ -896,7 +1103,7 @@ mraa_count_i2c_files(const char* path, const struct stat* sb, int flag, struct F
 int
 mraa_find_i2c_bus(const char* devname, int startfrom)
 {
-    char path[64];
+    char path[MRAA_FS_PATH_MAX];
     int fd;
     int i = startfrom;
     int ret = -1;
@@ -909,7 +1116,8 @@ mraa_find_i2c_bus(const char* devname, int startfrom)
 
     // find how many i2c buses we have if we haven't already
     if (num_i2c_devices == 0) {
-        if (nftw("/sys/class/i2c-dev/", &mraa_count_i2c_files, 20, FTW_PHYS) == -1) {
+        if (mraa_fs_path(path, sizeof(path), "/sys/class/i2c-dev/") == -1 ||
+            nftw(path, &mraa_count_i2c_files, 20, FTW_PHYS) == -1) {
             return -1;
         }
     }
@@ -919,7 +1127,7 @@ mraa_find_i2c_bus(const char* devname, int startfrom)
     if (mraa_file_exist("/sys/class/i2c-dev/i2c-0")) {
         for (i; i < num_i2c_devices; i++) {
             off_t size, err;
-            snprintf(path, 64, "/sys/class/i2c-dev/i2c-%u/name", i);
+            mraa_fs_path(path, sizeof(path), "/sys/class/i2c-dev/i2c-%u/name", i);
             fd = open(path, O_RDONLY);
             if (fd < 0) {
                 break;
@@ -962,6 +1170,89 @@ mraa_find_i2c_bus(const char* devname, int startfrom)
     return ret;
 }
 
+int
+mraa_find_gpiochip_base(const char* label, int* ngpio)
+{
+    glob_t results;
+    char path[MRAA_FS_PATH_MAX];
+    char buf[64];
+    int ret = -1;
+    size_t i;
+
+    if (label == NULL) {
+        return -1;
+    }
+    results.gl_pathc = 0;
+    if (mraa_fs_path(path, sizeof(path), "/sys/class/gpio/gpiochip*/label") == -1 ||
+        glob(path, 0, NULL, &results) != 0) {
+        globfree(&results);
+        return -1;
+    }
+    for (i = 0; i < results.gl_pathc && ret == -1; i++) {
+        FILE* fh = fopen(results.gl_pathv[i], "r");
+        if (fh == NULL) {
+            continue;
+        }
+        if (fgets(buf, sizeof(buf), fh) != NULL) {
+            buf[strcspn(buf, "\n")] = '\0';
+            if (strcmp(buf, label) == 0) {
+                int base, count = 0;
+                // path is <root>/sys/class/gpio/gpiochipN/label, base is the N
+                if (sscanf(results.gl_pathv[i] + strlen(fs_root), "/sys/class/gpio/gpiochip%d", &base) == 1) {
+                    mraa_fs_path(path, sizeof(path), "/sys/class/gpio/gpiochip%d/ngpio", base);
+                    FILE* nfh = fopen(path, "r");
+                    if (nfh != NULL) {
+                        if (fscanf(nfh, "%d", &count) != 1) {
+                            count = 0;
+                        }
+                        fclose(nfh);
+                    }
+                    if (ngpio != NULL) {
+                        *ngpio = count;
+                    }
+                    ret = base;
+                }
+            }
+        }
+        fclose(fh);
+    }
+    globfree(&results);
+    return ret;
+}
+
+mraa_result_t
+mraa_find_iomem_resource(const char* name, uint64_t* start, uint64_t* size)
+{
+    char line[256];
+    mraa_result_t ret = MRAA_ERROR_NO_RESOURCES;
+
+    FILE* fh = mraa_fs_fopen("/proc/iomem", "r");
+    if (fh == NULL) {
+        syslog(LOG_WARNING, "mraa: unable to read /proc/iomem");
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    while (fgets(line, sizeof(line), fh) != NULL) {
+        unsigned long long first, last;
+        if (strstr(line, name) == NULL) {
+            continue;
+        }
+        if (sscanf(line, " %llx-%llx", &first, &last) != 2) {
+            continue;
+        }
+        // unprivileged readers are shown zeroed ranges
+        if (first == 0 || last <= first) {
+            syslog(LOG_WARNING, "mraa: %s region hidden in /proc/iomem, root required", name);
+            break;
+        }
+        *start = first;
+        *size = last - first + 1;
+        ret = MRAA_SUCCESS;
+        break;
+    }
+    fclose(fh);
+    return ret;
+}
+
 mraa_boolean_t
 mraa_is_sub_platform_id(int pin_or_bus)
 {
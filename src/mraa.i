@@ -2,6 +2,7 @@
 
 %include stdint.i
 %include std_string.i
+%include std_vector.i
 %include exception.i
 
 #ifdef DOXYGEN
@@ -40,6 +41,8 @@
 
 %include "types.hpp"
 
+%template (IntVector) std::vector<int>;
+
 %include "common.hpp"
 %template (gpioFromDesc) mraa::initIo<mraa::Gpio>;
 %template (aioFromDesc) mraa::initIo<mraa::Aio>;
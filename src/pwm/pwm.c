@@ -32,6 +32,8 @@
 
 #include "pwm.h"
 #include "mraa_internal.h"
+#include "mraa_stats.h"
+#include "mraa_trace.h"
 
 #define MAX_SIZE 64
 #define SYSFS_PWM "/sys/class/pwm"
@@ -39,8 +41,8 @@
 static int
 mraa_pwm_setup_duty_fp(mraa_pwm_context dev)
 {
-    char bu[MAX_SIZE];
-    snprintf(bu, MAX_SIZE, "/sys/class/pwm/pwmchip%d/pwm%d/duty_cycle", dev->chipid, dev->pin);
+    char bu[MRAA_FS_PATH_MAX];
+    mraa_fs_path(bu, sizeof(bu), SYSFS_PWM "/pwmchip%d/pwm%d/duty_cycle", dev->chipid, dev->pin);
 
     dev->duty_fp = open(bu, O_RDWR);
     if (dev->duty_fp == -1) {
@@ -64,10 +66,11 @@ mraa_pwm_write_period(mraa_pwm_context dev, int period)
         }
         return result;
     }
-    char bu[MAX_SIZE];
-    snprintf(bu, MAX_SIZE, "/sys/class/pwm/pwmchip%d/pwm%d/period", dev->chipid, dev->pin);
+    char bu[MRAA_FS_PATH_MAX];
+    mraa_fs_path(bu, sizeof(bu), SYSFS_PWM "/pwmchip%d/pwm%d/period", dev->chipid, dev->pin);
 
     int period_f = open(bu, O_RDWR);
+    MRAA_STATS_REOPEN(dev);
     if (period_f == -1) {
         syslog(LOG_ERR, "pwm%i write_period: Failed to open period for writing: %s", dev->pin, strerror(errno));
         return MRAA_ERROR_INVALID_RESOURCE;
@@ -97,8 +100,9 @@ mraa_pwm_write_duty(mraa_pwm_context dev, int duty)
         return dev->advance_func->pwm_write_replace(dev, duty);
     }
     if (dev->duty_fp == -1) {
+        MRAA_STATS_REOPEN(dev);
         if (mraa_pwm_setup_duty_fp(dev) == 1) {
-            syslog(LOG_ERR, "pwm%i write_duty: Failed to open duty_cycle for writing: %s", dev->pin, strerror(errno));
+            mraa_trace(LOG_ERR, MRAA_TRACE_PWM_OPEN_DUTY, dev->pin, errno);
             return MRAA_ERROR_INVALID_RESOURCE;
         }
     }
@@ -106,7 +110,7 @@ mraa_pwm_write_duty(mraa_pwm_context dev, int duty)
     int length = sprintf(bu, "%d", duty);
     if (write(dev->duty_fp, bu, length * sizeof(char)) == -1)
     {
-        syslog(LOG_ERR, "pwm%i write_duty: Failed to write to duty_cycle: %s", dev->pin, strerror(errno));
+        mraa_trace(LOG_ERR, MRAA_TRACE_PWM_WRITE_DUTY, dev->pin, errno);
         return MRAA_ERROR_INVALID_RESOURCE;
     }
     return MRAA_SUCCESS;
@@ -124,11 +128,12 @@ mraa_pwm_read_period(mraa_pwm_context dev)
         return dev->period;
     }
 
-    char bu[MAX_SIZE];
+    char bu[MRAA_FS_PATH_MAX];
     char output[MAX_SIZE];
-    snprintf(bu, MAX_SIZE, "/sys/class/pwm/pwmchip%d/pwm%d/period", dev->chipid, dev->pin);
+    mraa_fs_path(bu, sizeof(bu), SYSFS_PWM "/pwmchip%d/pwm%d/period", dev->chipid, dev->pin);
 
     int period_f = open(bu, O_RDWR);
+    MRAA_STATS_REOPEN(dev);
     if (period_f == -1) {
         syslog(LOG_ERR, "pwm%i read_period: Failed to open period for reading: %s", dev->pin, strerror(errno));
         return 0;
@@ -168,9 +173,9 @@ mraa_pwm_read_duty(mraa_pwm_context dev)
     }
 
     if (dev->duty_fp == -1) {
+        MRAA_STATS_REOPEN(dev);
         if (mraa_pwm_setup_duty_fp(dev) == 1) {
-            syslog(LOG_ERR, "pwm%i read_duty: Failed to open duty_cycle for reading: %s",
-                    dev->pin, strerror(errno));
+            mraa_trace(LOG_ERR, MRAA_TRACE_PWM_OPEN_DUTY, dev->pin, errno);
             return -1;
         }
     } else {
@@ -180,14 +185,14 @@ mraa_pwm_read_duty(mraa_pwm_context dev)
     char output[MAX_SIZE];
     ssize_t rb = read(dev->duty_fp, output, MAX_SIZE);
     if (rb < 0) {
-        syslog(LOG_ERR, "pwm%i read_duty: Failed to read duty_cycle: %s", dev->pin, strerror(errno));
+        mraa_trace(LOG_ERR, MRAA_TRACE_PWM_READ_DUTY, dev->pin, errno);
         return -1;
     }
 
     char* endptr;
     long int ret = strtol(output, &endptr, 10);
     if ('\0' != *endptr && '\n' != *endptr) {
-        syslog(LOG_ERR, "pwm%i read_duty: Error in string conversion", dev->pin);
+        mraa_trace(LOG_ERR, MRAA_TRACE_PWM_PARSE_DUTY, dev->pin, 0);
         return -1;
     } else if (ret > INT_MAX || ret < INT_MIN) {
         syslog(LOG_ERR, "pwm%i read_duty: Number is invalid", dev->pin);
@@ -300,15 +305,15 @@ mraa_pwm_init_raw(int chipin, int pin)
     if (dev == NULL)
         return NULL;
 
-    char directory[MAX_SIZE];
-    snprintf(directory, MAX_SIZE, SYSFS_PWM "/pwmchip%d/pwm%d", dev->chipid, dev->pin);
+    char directory[MRAA_FS_PATH_MAX];
+    mraa_fs_path(directory, sizeof(directory), SYSFS_PWM "/pwmchip%d/pwm%d", dev->chipid, dev->pin);
     struct stat dir;
     if (stat(directory, &dir) == 0 && S_ISDIR(dir.st_mode)) {
         syslog(LOG_NOTICE, "pwm_init: pwm%i already exported, continuing", pin);
         dev->owner = 0; // Not Owner
     } else {
-        char buffer[MAX_SIZE];
-        snprintf(buffer, MAX_SIZE, "/sys/class/pwm/pwmchip%d/export", dev->chipid);
+        char buffer[MRAA_FS_PATH_MAX];
+        mraa_fs_path(buffer, sizeof(buffer), SYSFS_PWM "/pwmchip%d/export", dev->chipid);
         int export_f = open(buffer, O_WRONLY);
         if (export_f == -1) {
             syslog(LOG_ERR, "pwm_init: pwm%i. Failed to open export for writing: %s", pin, strerror(errno));
@@ -332,8 +337,8 @@ mraa_pwm_init_raw(int chipin, int pin)
     return dev;
 }
 
-mraa_result_t
-mraa_pwm_write(mraa_pwm_context dev, float percentage)
+static mraa_result_t
+mraa_pwm_write_internal(mraa_pwm_context dev, float percentage)
 {
     if (!dev) {
         syslog(LOG_ERR, "pwm: write: context is NULL");
@@ -359,8 +364,17 @@ mraa_pwm_write(mraa_pwm_context dev, float percentage)
     return mraa_pwm_write_duty(dev, percentage * dev->period);
 }
 
-float
-mraa_pwm_read(mraa_pwm_context dev)
+mraa_result_t
+mraa_pwm_write(mraa_pwm_context dev, float percentage)
+{
+    MRAA_STATS_START(start);
+    mraa_result_t ret = mraa_pwm_write_internal(dev, percentage);
+    MRAA_STATS_RECORD(dev, start, 0, ret != MRAA_SUCCESS);
+    return ret;
+}
+
+static float
+mraa_pwm_read_internal(mraa_pwm_context dev)
 {
     if (!dev) {
         syslog(LOG_ERR, "pwm: read: context is NULL");
@@ -374,6 +388,15 @@ mraa_pwm_read(mraa_pwm_context dev)
     return 0.0f;
 }
 
+float
+mraa_pwm_read(mraa_pwm_context dev)
+{
+    MRAA_STATS_START(start);
+    float ret = mraa_pwm_read_internal(dev);
+    MRAA_STATS_RECORD(dev, start, 0, ret < 0);
+    return ret;
+}
+
 mraa_result_t
 mraa_pwm_period(mraa_pwm_context dev, float seconds)
 {
@@ -386,8 +409,8 @@ mraa_pwm_period_ms(mraa_pwm_context dev, int ms)
     return mraa_pwm_period_us(dev, ms * 1000);
 }
 
-mraa_result_t
-mraa_pwm_period_us(mraa_pwm_context dev, int us)
+static mraa_result_t
+mraa_pwm_period_us_internal(mraa_pwm_context dev, int us)
 {
     int min, max;
 
@@ -410,6 +433,15 @@ mraa_pwm_period_us(mraa_pwm_context dev, int us)
     return mraa_pwm_write_period(dev, us * 1000);
 }
 
+mraa_result_t
+mraa_pwm_period_us(mraa_pwm_context dev, int us)
+{
+    MRAA_STATS_START(start);
+    mraa_result_t ret = mraa_pwm_period_us_internal(dev, us);
+    MRAA_STATS_RECORD(dev, start, 0, ret != MRAA_SUCCESS);
+    return ret;
+}
+
 mraa_result_t
 mraa_pwm_pulsewidth(mraa_pwm_context dev, float seconds)
 {
@@ -422,14 +454,23 @@ mraa_pwm_pulsewidth_ms(mraa_pwm_context dev, int ms)
     return mraa_pwm_pulsewidth_us(dev, ms * 1000);
 }
 
-mraa_result_t
-mraa_pwm_pulsewidth_us(mraa_pwm_context dev, int us)
+static mraa_result_t
+mraa_pwm_pulsewidth_us_internal(mraa_pwm_context dev, int us)
 {
     return mraa_pwm_write_duty(dev, us * 1000);
 }
 
 mraa_result_t
-mraa_pwm_enable(mraa_pwm_context dev, int enable)
+mraa_pwm_pulsewidth_us(mraa_pwm_context dev, int us)
+{
+    MRAA_STATS_START(start);
+    mraa_result_t ret = mraa_pwm_pulsewidth_us_internal(dev, us);
+    MRAA_STATS_RECORD(dev, start, 0, ret != MRAA_SUCCESS);
+    return ret;
+}
+
+static mraa_result_t
+mraa_pwm_enable_internal(mraa_pwm_context dev, int enable)
 {
     if (!dev) {
         syslog(LOG_ERR, "pwm: enable: context is NULL");
@@ -447,10 +488,11 @@ mraa_pwm_enable(mraa_pwm_context dev, int enable)
         }
     }
 
-    char bu[MAX_SIZE];
-    snprintf(bu, MAX_SIZE, "/sys/class/pwm/pwmchip%d/pwm%d/enable", dev->chipid, dev->pin);
+    char bu[MRAA_FS_PATH_MAX];
+    mraa_fs_path(bu, sizeof(bu), SYSFS_PWM "/pwmchip%d/pwm%d/enable", dev->chipid, dev->pin);
 
     int enable_f = open(bu, O_RDWR);
+    MRAA_STATS_REOPEN(dev);
 
     if (enable_f == -1) {
         syslog(LOG_ERR, "pwm_enable: pwm%i: Failed to open enable for writing: %s", dev->pin, strerror(errno));
@@ -467,11 +509,20 @@ mraa_pwm_enable(mraa_pwm_context dev, int enable)
     return MRAA_SUCCESS;
 }
 
+mraa_result_t
+mraa_pwm_enable(mraa_pwm_context dev, int enable)
+{
+    MRAA_STATS_START(start);
+    mraa_result_t ret = mraa_pwm_enable_internal(dev, enable);
+    MRAA_STATS_RECORD(dev, start, 0, ret != MRAA_SUCCESS);
+    return ret;
+}
+
 mraa_result_t
 mraa_pwm_unexport_force(mraa_pwm_context dev)
 {
-    char filepath[MAX_SIZE];
-    snprintf(filepath, MAX_SIZE, "/sys/class/pwm/pwmchip%d/unexport", dev->chipid);
+    char filepath[MRAA_FS_PATH_MAX];
+    mraa_fs_path(filepath, sizeof(filepath), SYSFS_PWM "/pwmchip%d/unexport", dev->chipid);
 
     int unexport_f = open(filepath, O_WRONLY);
     if (unexport_f == -1) {
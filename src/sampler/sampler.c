@@ -0,0 +1,489 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "sampler.h"
+#include "mraa_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/timerfd.h>
+
+// jobs due this close to a tick are served by it
+#define SAMPLER_SLACK_NS 100000
+// a batch reads with two messages per job
+#define SAMPLER_BATCH_JOBS (MRAA_I2C_TRANSACTION_MAX_MSGS / 2)
+
+/**
+ * One periodic read. The sampler thread is the only writer of the timing
+ * fields, under the lock of its sampler, and of the ring, under lock.
+ */
+struct _sampler_job {
+    /*@{*/
+    struct _sampler* sampler; /**< thread running the job, NULL once shut down */
+    mraa_i2c_context i2c; /**< context used to reach the bus, NULL for spi jobs */
+    mraa_spi_context spi; /**< context to transfer with, NULL for i2c jobs */
+    uint8_t address; /**< i2c slave */
+    uint8_t reg; /**< first i2c register */
+    uint8_t* tx; /**< spi bytes to send */
+    uint8_t* scratch; /**< lands the transfer before it is stored */
+    int length; /**< bytes per sample */
+    uint64_t period_ns; /**< sampling period */
+    uint64_t next_ns; /**< next deadline */
+    pthread_mutex_t lock; /**< protects the ring and the counters */
+    uint8_t* data; /**< ring of samples, length bytes each */
+    uint64_t* timestamps; /**< time of each sample in the ring */
+    unsigned int depth; /**< samples the ring holds */
+    unsigned int head; /**< oldest sample */
+    unsigned int count; /**< samples in the ring */
+    mraa_sampler_status_t status; /**< counters */
+    struct _sampler_job* next; /**< next job of the sampler */
+    /*@}*/
+};
+
+/**
+ * Thread serving every job of one i2c bus, or of one spi context
+ */
+struct _sampler {
+    /*@{*/
+    int busnum; /**< i2c bus, -1 for a spi sampler */
+    mraa_adv_func_t* advance_func; /**< function table of the i2c bus */
+    mraa_spi_context spi; /**< spi context, NULL for an i2c sampler */
+    int timer_fd; /**< armed for the earliest deadline */
+    pthread_t thread; /**< the sampler thread */
+    pthread_mutex_t lock; /**< protects jobs and the deadlines, held while sampling */
+    mraa_boolean_t stopping; /**< the thread must exit */
+    struct _sampler_job* jobs; /**< jobs served */
+    struct _sampler* next; /**< next sampler */
+    /*@}*/
+};
+
+static pthread_mutex_t samplers_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct _sampler* samplers = NULL;
+
+static uint64_t
+mraa_sampler_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// must be called with the sampler lock held
+static void
+mraa_sampler_arm(struct _sampler* s)
+{
+    struct itimerspec spec;
+    struct _sampler_job* job;
+    uint64_t due = 0;
+
+    for (job = s->jobs; job != NULL; job = job->next) {
+        if (due == 0 || job->next_ns < due) {
+            due = job->next_ns;
+        }
+    }
+    if (s->stopping || due == 0) {
+        // expires at once, the thread wakes to exit
+        due = 1;
+    }
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = due / 1000000000ULL;
+    spec.it_value.tv_nsec = due % 1000000000ULL;
+    timerfd_settime(s->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+}
+
+static void
+mraa_sampler_store(struct _sampler_job* job, mraa_boolean_t ok, uint64_t timestamp)
+{
+    pthread_mutex_lock(&job->lock);
+    if (!ok) {
+        job->status.errors++;
+    } else {
+        unsigned int slot;
+        if (job->count == job->depth) {
+            // keep the newest, the reader wants to know how much it lost
+            job->head = (job->head + 1) % job->depth;
+            job->count--;
+            job->status.overruns++;
+        }
+        slot = (job->head + job->count) % job->depth;
+        memcpy(job->data + (size_t) slot * job->length, job->scratch, job->length);
+        job->timestamps[slot] = timestamp;
+        job->count++;
+        job->status.samples++;
+    }
+    pthread_mutex_unlock(&job->lock);
+}
+
+static mraa_boolean_t
+mraa_sampler_queue_read(mraa_i2c_transaction trans, struct _sampler_job* job)
+{
+    return mraa_i2c_transaction_write(trans, job->address, &job->reg, 1) == MRAA_SUCCESS &&
+           mraa_i2c_transaction_read(trans, job->address, job->scratch, job->length) == MRAA_SUCCESS;
+}
+
+/* reads every due i2c job, batched into as few transfers as possible */
+static void
+mraa_sampler_run_i2c(struct _sampler_job** due, int ndue)
+{
+    mraa_i2c_transaction trans = mraa_i2c_transaction_init(due[0]->i2c);
+    uint64_t timestamp;
+    int i, first;
+
+    if (trans == NULL) {
+        for (i = 0; i < ndue; i++) {
+            mraa_sampler_store(due[i], 0, 0);
+        }
+        return;
+    }
+    for (first = 0; first < ndue; first += SAMPLER_BATCH_JOBS) {
+        int last = first + SAMPLER_BATCH_JOBS < ndue ? first + SAMPLER_BATCH_JOBS : ndue;
+        mraa_boolean_t ok = 1;
+
+        mraa_i2c_transaction_clear(trans);
+        for (i = first; i < last && ok; i++) {
+            ok = mraa_sampler_queue_read(trans, due[i]);
+        }
+        timestamp = mraa_sampler_now();
+        if (ok && mraa_i2c_transaction_submit(trans) == MRAA_SUCCESS) {
+            for (i = first; i < last; i++) {
+                mraa_sampler_store(due[i], 1, timestamp);
+            }
+            continue;
+        }
+        // one slave not answering fails the batch, find out which
+        for (i = first; i < last; i++) {
+            mraa_i2c_transaction_clear(trans);
+            timestamp = mraa_sampler_now();
+            ok = mraa_sampler_queue_read(trans, due[i]) && mraa_i2c_transaction_submit(trans) == MRAA_SUCCESS;
+            mraa_sampler_store(due[i], ok, timestamp);
+        }
+    }
+    mraa_i2c_transaction_stop(trans);
+}
+
+static void*
+mraa_sampler_thread(void* arg)
+{
+    struct _sampler* s = (struct _sampler*) arg;
+    struct _sampler_job* due[SAMPLER_BATCH_JOBS * 4];
+    struct _sampler_job* job;
+    uint64_t expirations;
+    int ndue;
+
+    pthread_mutex_lock(&s->lock);
+    while (!s->stopping) {
+        mraa_sampler_arm(s);
+        pthread_mutex_unlock(&s->lock);
+        if (read(s->timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+            // EINTR, just look at the deadlines again
+        }
+        pthread_mutex_lock(&s->lock);
+        if (s->stopping) {
+            break;
+        }
+
+        uint64_t now = mraa_sampler_now();
+        ndue = 0;
+        for (job = s->jobs; job != NULL; job = job->next) {
+            if (job->next_ns > now + SAMPLER_SLACK_NS) {
+                continue;
+            }
+            uint64_t late = now > job->next_ns ? now - job->next_ns : 0;
+            pthread_mutex_lock(&job->lock);
+            if (late > job->status.max_late_ns) {
+                job->status.max_late_ns = late;
+            }
+            if (late >= job->period_ns) {
+                // deadlines stay on the grid, the ones already gone are skipped
+                job->status.missed += late / job->period_ns;
+            }
+            pthread_mutex_unlock(&job->lock);
+            job->next_ns += (late / job->period_ns + 1) * job->period_ns;
+
+            if (job->spi != NULL) {
+                uint64_t timestamp = mraa_sampler_now();
+                mraa_boolean_t ok = mraa_spi_transfer_buf(job->spi, job->tx, job->scratch, job->length) == MRAA_SUCCESS;
+                mraa_sampler_store(job, ok, timestamp);
+            } else {
+                due[ndue++] = job;
+                if (ndue == (int) (sizeof(due) / sizeof(due[0]))) {
+                    mraa_sampler_run_i2c(due, ndue);
+                    ndue = 0;
+                }
+            }
+        }
+        if (ndue > 0) {
+            mraa_sampler_run_i2c(due, ndue);
+        }
+    }
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+static void
+mraa_sampler_free_job(struct _sampler_job* job)
+{
+    pthread_mutex_destroy(&job->lock);
+    free(job->data);
+    free(job->timestamps);
+    free(job->scratch);
+    free(job->tx);
+    free(job);
+}
+
+static struct _sampler_job*
+mraa_sampler_new_job(int length, unsigned int period_us, unsigned int depth)
+{
+    if (length < 1 || length > MRAA_I2C_TRANSACTION_MAX_LENGTH || period_us == 0 || depth == 0) {
+        syslog(LOG_ERR, "sampler: invalid length, period or depth");
+        return NULL;
+    }
+    struct _sampler_job* job = (struct _sampler_job*) calloc(1, sizeof(struct _sampler_job));
+    if (job == NULL) {
+        syslog(LOG_CRIT, "sampler: Failed to allocate memory for job");
+        return NULL;
+    }
+    pthread_mutex_init(&job->lock, NULL);
+    job->length = length;
+    job->period_ns = (uint64_t) period_us * 1000;
+    job->depth = depth;
+    job->scratch = (uint8_t*) malloc(length);
+    job->data = (uint8_t*) malloc((size_t) depth * length);
+    job->timestamps = (uint64_t*) malloc(depth * sizeof(uint64_t));
+    if (job->scratch == NULL || job->data == NULL || job->timestamps == NULL) {
+        syslog(LOG_CRIT, "sampler: Failed to allocate memory for %u samples", depth);
+        mraa_sampler_free_job(job);
+        return NULL;
+    }
+    return job;
+}
+
+/* hands the job to the sampler of its bus, starting one if needed */
+static mraa_sampler_job
+mraa_sampler_attach(struct _sampler_job* job, int busnum, mraa_adv_func_t* advance_func)
+{
+    struct _sampler* s;
+
+    pthread_mutex_lock(&samplers_lock);
+    for (s = samplers; s != NULL; s = s->next) {
+        if (job->spi != NULL ? s->spi == job->spi :
+                               s->spi == NULL && s->busnum == busnum && s->advance_func == advance_func) {
+            break;
+        }
+    }
+    if (s == NULL) {
+        s = (struct _sampler*) calloc(1, sizeof(struct _sampler));
+        if (s == NULL) {
+            syslog(LOG_CRIT, "sampler: Failed to allocate memory for sampler");
+            goto attach_fail;
+        }
+        s->busnum = job->spi != NULL ? -1 : busnum;
+        s->advance_func = advance_func;
+        s->spi = job->spi;
+        s->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (s->timer_fd == -1) {
+            syslog(LOG_ERR, "sampler: Failed to create timer: %s", strerror(errno));
+            free(s);
+            goto attach_fail;
+        }
+        pthread_mutex_init(&s->lock, NULL);
+        if (mraa_thread_create(&s->thread, NULL, mraa_sampler_thread, s) != 0) {
+            syslog(LOG_ERR, "sampler: Failed to create sampler thread");
+            pthread_mutex_destroy(&s->lock);
+            close(s->timer_fd);
+            free(s);
+            goto attach_fail;
+        }
+        s->next = samplers;
+        samplers = s;
+    }
+
+    pthread_mutex_lock(&s->lock);
+    // on the grid of the period, so jobs with related periods share ticks
+    job->next_ns = (mraa_sampler_now() / job->period_ns + 1) * job->period_ns;
+    job->sampler = s;
+    job->next = s->jobs;
+    s->jobs = job;
+    mraa_sampler_arm(s);
+    pthread_mutex_unlock(&s->lock);
+    pthread_mutex_unlock(&samplers_lock);
+    return job;
+
+attach_fail:
+    pthread_mutex_unlock(&samplers_lock);
+    mraa_sampler_free_job(job);
+    return NULL;
+}
+
+/* stops the thread of a sampler that is no longer listed */
+static void
+mraa_sampler_stop(struct _sampler* s)
+{
+    pthread_mutex_lock(&s->lock);
+    s->stopping = 1;
+    mraa_sampler_arm(s);
+    pthread_mutex_unlock(&s->lock);
+    pthread_join(s->thread, NULL);
+    pthread_mutex_destroy(&s->lock);
+    close(s->timer_fd);
+    free(s);
+}
+
+mraa_sampler_job
+mraa_sampler_add_i2c(mraa_i2c_context dev, uint8_t address, uint8_t reg, int length, unsigned int period_us, unsigned int depth)
+{
+    if (dev == NULL) {
+        syslog(LOG_ERR, "sampler: add_i2c: context is invalid");
+        return NULL;
+    }
+    struct _sampler_job* job = mraa_sampler_new_job(length, period_us, depth);
+    if (job == NULL) {
+        return NULL;
+    }
+    job->i2c = dev;
+    job->address = address;
+    job->reg = reg;
+    return mraa_sampler_attach(job, dev->busnum, dev->advance_func);
+}
+
+mraa_sampler_job
+mraa_sampler_add_spi(mraa_spi_context dev, const uint8_t* tx, int length, unsigned int period_us, unsigned int depth)
+{
+    if (dev == NULL || tx == NULL) {
+        syslog(LOG_ERR, "sampler: add_spi: context is invalid");
+        return NULL;
+    }
+    struct _sampler_job* job = mraa_sampler_new_job(length, period_us, depth);
+    if (job == NULL) {
+        return NULL;
+    }
+    job->spi = dev;
+    job->tx = (uint8_t*) malloc(length);
+    if (job->tx == NULL) {
+        syslog(LOG_CRIT, "sampler: Failed to allocate memory for spi data");
+        mraa_sampler_free_job(job);
+        return NULL;
+    }
+    memcpy(job->tx, tx, length);
+    return mraa_sampler_attach(job, -1, dev->advance_func);
+}
+
+int
+mraa_sampler_read(mraa_sampler_job job, uint8_t* data, uint64_t* timestamps, int max_samples)
+{
+    int n = 0;
+
+    if (job == NULL || data == NULL || max_samples < 0) {
+        return -1;
+    }
+    pthread_mutex_lock(&job->lock);
+    while (n < max_samples && job->count > 0) {
+        memcpy(data + (size_t) n * job->length, job->data + (size_t) job->head * job->length, job->length);
+        if (timestamps != NULL) {
+            timestamps[n] = job->timestamps[job->head];
+        }
+        job->head = (job->head + 1) % job->depth;
+        job->count--;
+        n++;
+    }
+    pthread_mutex_unlock(&job->lock);
+    return n;
+}
+
+mraa_result_t
+mraa_sampler_status(mraa_sampler_job job, mraa_sampler_status_t* status)
+{
+    if (job == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    if (status == NULL) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    pthread_mutex_lock(&job->lock);
+    *status = job->status;
+    pthread_mutex_unlock(&job->lock);
+    return MRAA_SUCCESS;
+}
+
+mraa_result_t
+mraa_sampler_remove(mraa_sampler_job job)
+{
+    struct _sampler** link;
+    struct _sampler_job** jlink;
+    struct _sampler* idle = NULL;
+
+    if (job == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+    pthread_mutex_lock(&samplers_lock);
+    struct _sampler* s = job->sampler;
+    if (s != NULL) {
+        // the lock is held while sampling, the job is not in use once we own it
+        pthread_mutex_lock(&s->lock);
+        for (jlink = &s->jobs; *jlink != NULL; jlink = &(*jlink)->next) {
+            if (*jlink == job) {
+                *jlink = job->next;
+                break;
+            }
+        }
+        if (s->jobs == NULL) {
+            for (link = &samplers; *link != NULL; link = &(*link)->next) {
+                if (*link == s) {
+                    *link = s->next;
+                    break;
+                }
+            }
+            idle = s;
+        }
+        pthread_mutex_unlock(&s->lock);
+    }
+    pthread_mutex_unlock(&samplers_lock);
+
+    if (idle != NULL) {
+        mraa_sampler_stop(idle);
+    }
+    mraa_sampler_free_job(job);
+    return MRAA_SUCCESS;
+}
+
+void
+mraa_sampler_shutdown()
+{
+    struct _sampler* s;
+    struct _sampler_job* job;
+
+    pthread_mutex_lock(&samplers_lock);
+    while ((s = samplers) != NULL) {
+        samplers = s->next;
+        // jobs stay valid for reading and removal
+        for (job = s->jobs; job != NULL; job = job->next) {
+            job->sampler = NULL;
+        }
+        mraa_sampler_stop(s);
+    }
+    pthread_mutex_unlock(&samplers_lock);
+}
@@ -28,11 +28,14 @@
 #include <sys/ioctl.h>
 #include <linux/spi/spidev.h>
 #include <stdio.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <unistd.h>
 
 #include "spi.h"
 #include "mraa_internal.h"
+#include "mraa_stats.h"
+#include "mraa_trace.h"
 
 #define MAX_SIZE 64
 #define SPI_MAX_LENGTH 4096
@@ -132,8 +135,16 @@ mraa_spi_init_raw(unsigned int bus, unsigned int cs)
         return NULL;
     }
 
-    char path[MAX_SIZE];
-    sprintf(path, "/dev/spidev%u.%u", bus, cs);
+    if (IS_FUNC_DEFINED(dev, spi_init_raw_replace)) {
+        if (dev->advance_func->spi_init_raw_replace(dev, bus, cs) != MRAA_SUCCESS) {
+            free(dev);
+            return NULL;
+        }
+        return dev;
+    }
+
+    char path[MRAA_FS_PATH_MAX];
+    mraa_fs_path(path, sizeof(path), "/dev/spidev%u.%u", bus, cs);
 
     dev->devfd = open(path, O_RDWR);
     if (dev->devfd < 0) {
@@ -172,6 +183,10 @@ mraa_spi_init_raw(unsigned int bus, unsigned int cs)
 mraa_result_t
 mraa_spi_mode(mraa_spi_context dev, mraa_spi_mode_t mode)
 {
+    if (IS_FUNC_DEFINED(dev, spi_mode_replace)) {
+        return dev->advance_func->spi_mode_replace(dev, mode);
+    }
+
     uint8_t spi_mode = 0;
     switch (mode) {
         case MRAA_SPI_MODE0:
@@ -203,6 +218,10 @@ mraa_spi_mode(mraa_spi_context dev, mraa_spi_mode_t mode)
 mraa_result_t
 mraa_spi_frequency(mraa_spi_context dev, int hz)
 {
+    if (IS_FUNC_DEFINED(dev, spi_frequency_replace)) {
+        return dev->advance_func->spi_frequency_replace(dev, hz);
+    }
+
     int speed = 0;
     dev->clock = hz;
     if (ioctl(dev->devfd, SPI_IOC_RD_MAX_SPEED_HZ, &speed) != -1) {
@@ -237,6 +256,10 @@ mraa_spi_lsbmode(mraa_spi_context dev, mraa_boolean_t lsb)
 mraa_result_t
 mraa_spi_bit_per_word(mraa_spi_context dev, unsigned int bits)
 {
+    if (IS_FUNC_DEFINED(dev, spi_bit_per_word_replace)) {
+        return dev->advance_func->spi_bit_per_word_replace(dev, bits);
+    }
+
     if (ioctl(dev->devfd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) {
         syslog(LOG_ERR, "spi: Failed to set bit per word");
         return MRAA_ERROR_INVALID_RESOURCE;
@@ -245,9 +268,17 @@ mraa_spi_bit_per_word(mraa_spi_context dev, unsigned int bits)
     return MRAA_SUCCESS;
 }
 
-int
-mraa_spi_write(mraa_spi_context dev, uint8_t data)
+static int
+mraa_spi_write_internal(mraa_spi_context dev, uint8_t data)
 {
+    if (IS_FUNC_DEFINED(dev, spi_transfer_buf_replace)) {
+        uint8_t recv = 0;
+        if (dev->advance_func->spi_transfer_buf_replace(dev, &data, &recv, 1) != MRAA_SUCCESS) {
+            return -1;
+        }
+        return (int) recv;
+    }
+
     struct spi_ioc_transfer msg;
     memset(&msg, 0, sizeof(msg));
 
@@ -261,15 +292,32 @@ mraa_spi_write(mraa_spi_context dev, uint8_t data)
     msg.delay_usecs = 0;
     msg.len = length;
     if (ioctl(dev->devfd, SPI_IOC_MESSAGE(1), &msg) < 0) {
-        syslog(LOG_ERR, "spi: Failed to perform dev transfer");
+        mraa_trace(LOG_ERR, MRAA_TRACE_SPI_TRANSFER, -1, errno);
         return -1;
     }
     return (int) recv;
 }
 
 int
-mraa_spi_write_word(mraa_spi_context dev, uint16_t data)
+mraa_spi_write(mraa_spi_context dev, uint8_t data)
 {
+    MRAA_STATS_START(start);
+    int ret = mraa_spi_write_internal(dev, data);
+    MRAA_STATS_RECORD(dev, start, 1, ret == -1);
+    return ret;
+}
+
+static int
+mraa_spi_write_word_internal(mraa_spi_context dev, uint16_t data)
+{
+    if (IS_FUNC_DEFINED(dev, spi_transfer_buf_word_replace)) {
+        uint16_t recv = 0;
+        if (dev->advance_func->spi_transfer_buf_word_replace(dev, &data, &recv, 2) != MRAA_SUCCESS) {
+            return -1;
+        }
+        return (int) recv;
+    }
+
     struct spi_ioc_transfer msg;
     memset(&msg, 0, sizeof(msg));
 
@@ -283,15 +331,28 @@ mraa_spi_write_word(mraa_spi_context dev, uint16_t data)
     msg.delay_usecs = 0;
     msg.len = length;
     if (ioctl(dev->devfd, SPI_IOC_MESSAGE(1), &msg) < 0) {
-        syslog(LOG_ERR, "spi: Failed to perform dev transfer");
+        mraa_trace(LOG_ERR, MRAA_TRACE_SPI_TRANSFER, -1, errno);
         return -1;
     }
     return (int) recv;
 }
 
-mraa_result_t
-mraa_spi_transfer_buf(mraa_spi_context dev, uint8_t* data, uint8_t* rxbuf, int length)
+int
+mraa_spi_write_word(mraa_spi_context dev, uint16_t data)
+{
+    MRAA_STATS_START(start);
+    int ret = mraa_spi_write_word_internal(dev, data);
+    MRAA_STATS_RECORD(dev, start, 2, ret == -1);
+    return ret;
+}
+
+static mraa_result_t
+mraa_spi_transfer_buf_internal(mraa_spi_context dev, uint8_t* data, uint8_t* rxbuf, int length)
 {
+    if (IS_FUNC_DEFINED(dev, spi_transfer_buf_replace)) {
+        return dev->advance_func->spi_transfer_buf_replace(dev, data, rxbuf, length);
+    }
+
     struct spi_ioc_transfer msg;
     memset(&msg, 0, sizeof(msg));
 
@@ -302,15 +363,28 @@ mraa_spi_transfer_buf(mraa_spi_context dev, uint8_t* data, uint8_t* rxbuf, int l
     msg.delay_usecs = 0;
     msg.len = length;
     if (ioctl(dev->devfd, SPI_IOC_MESSAGE(1), &msg) < 0) {
-        syslog(LOG_ERR, "spi: Failed to perform dev transfer");
+        mraa_trace(LOG_ERR, MRAA_TRACE_SPI_TRANSFER, -1, errno);
         return MRAA_ERROR_INVALID_RESOURCE;
     }
     return MRAA_SUCCESS;
 }
 
 mraa_result_t
-mraa_spi_transfer_buf_word(mraa_spi_context dev, uint16_t* data, uint16_t* rxbuf, int length)
+mraa_spi_transfer_buf(mraa_spi_context dev, uint8_t* data, uint8_t* rxbuf, int length)
+{
+    MRAA_STATS_START(start);
+    mraa_result_t ret = mraa_spi_transfer_buf_internal(dev, data, rxbuf, length);
+    MRAA_STATS_RECORD(dev, start, length, ret != MRAA_SUCCESS);
+    return ret;
+}
+
+static mraa_result_t
+mraa_spi_transfer_buf_word_internal(mraa_spi_context dev, uint16_t* data, uint16_t* rxbuf, int length)
 {
+    if (IS_FUNC_DEFINED(dev, spi_transfer_buf_word_replace)) {
+        return dev->advance_func->spi_transfer_buf_word_replace(dev, data, rxbuf, length);
+    }
+
     struct spi_ioc_transfer msg;
     memset(&msg, 0, sizeof(msg));
 
@@ -321,12 +395,21 @@ mraa_spi_transfer_buf_word(mraa_spi_context dev, uint16_t* data, uint16_t* rxbuf
     msg.delay_usecs = 0;
     msg.len = length;
     if (ioctl(dev->devfd, SPI_IOC_MESSAGE(1), &msg) < 0) {
-        syslog(LOG_ERR, "spi: Failed to perform dev transfer");
+        mraa_trace(LOG_ERR, MRAA_TRACE_SPI_TRANSFER, -1, errno);
         return MRAA_ERROR_INVALID_RESOURCE;
     }
     return MRAA_SUCCESS;
 }
 
+mraa_result_t
+mraa_spi_transfer_buf_word(mraa_spi_context dev, uint16_t* data, uint16_t* rxbuf, int length)
+{
+    MRAA_STATS_START(start);
+    mraa_result_t ret = mraa_spi_transfer_buf_word_internal(dev, data, rxbuf, length);
+    MRAA_STATS_RECORD(dev, start, length, ret != MRAA_SUCCESS);
+    return ret;
+}
+
 uint8_t*
 mraa_spi_write_buf(mraa_spi_context dev, uint8_t* data, int length)
 {
@@ -354,6 +437,12 @@ mraa_spi_write_buf_word(mraa_spi_context dev, uint16_t* data, int length)
 mraa_result_t
 mraa_spi_stop(mraa_spi_context dev)
 {
+    if (IS_FUNC_DEFINED(dev, spi_stop_replace)) {
+        mraa_result_t ret = dev->advance_func->spi_stop_replace(dev);
+        free(dev);
+        return ret;
+    }
+
     close(dev->devfd);
     free(dev);
     return MRAA_SUCCESS;
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "mraa_internal.h"
+#include "mraa_stats.h"
+
+#ifdef MRAA_STATS
+static uint64_t
+mraa_stats_take(uint64_t* counter, mraa_boolean_t reset)
+{
+    if (reset) {
+        return __atomic_exchange_n(counter, 0, __ATOMIC_RELAXED);
+    }
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static mraa_result_t
+mraa_stats_snapshot(mraa_stats_t* counters, mraa_stats_t* stats, mraa_boolean_t reset)
+{
+    int i;
+
+    if (stats == NULL) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    stats->ops = mraa_stats_take(&counters->ops, reset);
+    stats->bytes = mraa_stats_take(&counters->bytes, reset);
+    stats->errors = mraa_stats_take(&counters->errors, reset);
+    stats->reopens = mraa_stats_take(&counters->reopens, reset);
+    stats->total_ns = mraa_stats_take(&counters->total_ns, reset);
+    stats->max_ns = mraa_stats_take(&counters->max_ns, reset);
+    for (i = 0; i < MRAA_STATS_BUCKETS; i++) {
+        stats->histogram[i] = mraa_stats_take(&counters->histogram[i], reset);
+    }
+    return MRAA_SUCCESS;
+}
+
+#define MRAA_STATS_SNAPSHOT(dev, stats, reset)                                                            \
+    ((dev) == NULL ? MRAA_ERROR_INVALID_HANDLE : mraa_stats_snapshot(&(dev)->stats, (stats), (reset)))
+#else
+#define MRAA_STATS_SNAPSHOT(dev, stats, reset) MRAA_ERROR_FEATURE_NOT_IMPLEMENTED
+#endif
+
+mraa_boolean_t
+mraa_stats_enabled()
+{
+#ifdef MRAA_STATS
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+mraa_result_t
+mraa_stats_gpio(mraa_gpio_context dev, mraa_stats_t* stats, mraa_boolean_t reset)
+{
+    return MRAA_STATS_SNAPSHOT(dev, stats, reset);
+}
+
+mraa_result_t
+mraa_stats_i2c(mraa_i2c_context dev, mraa_stats_t* stats, mraa_boolean_t reset)
+{
+    return MRAA_STATS_SNAPSHOT(dev, stats, reset);
+}
+
+mraa_result_t
+mraa_stats_spi(mraa_spi_context dev, mraa_stats_t* stats, mraa_boolean_t reset)
+{
+    return MRAA_STATS_SNAPSHOT(dev, stats, reset);
+}
+
+mraa_result_t
+mraa_stats_uart(mraa_uart_context dev, mraa_stats_t* stats, mraa_boolean_t reset)
+{
+    return MRAA_STATS_SNAPSHOT(dev, stats, reset);
+}
+
+mraa_result_t
+mraa_stats_aio(mraa_aio_context dev, mraa_stats_t* stats, mraa_boolean_t reset)
+{
+    return MRAA_STATS_SNAPSHOT(dev, stats, reset);
+}
+
+mraa_result_t
+mraa_stats_pwm(mraa_pwm_context dev, mraa_stats_t* stats, mraa_boolean_t reset)
+{
+    return MRAA_STATS_SNAPSHOT(dev, stats, reset);
+}
+
+uint64_t
+mraa_stats_percentile(const mraa_stats_t* stats, double percentile)
+{
+    uint64_t total = 0, seen = 0;
+    int i;
+
+    if (stats == NULL) {
+        return 0;
+    }
+    for (i = 0; i < MRAA_STATS_BUCKETS; i++) {
+        total += stats->histogram[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    if (percentile < 0) {
+        percentile = 0;
+    } else if (percentile > 100) {
+        percentile = 100;
+    }
+    // rank of the call the percentile points at, counting from 1
+    uint64_t rank = (uint64_t) (percentile / 100.0 * (double) total + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+    for (i = 0; i < MRAA_STATS_BUCKETS - 1; i++) {
+        seen += stats->histogram[i];
+        if (seen >= rank) {
+            break;
+        }
+    }
+    // the last bucket is open ended, the slowest call bounds it
+    if (i == MRAA_STATS_BUCKETS - 1) {
+        return stats->max_ns;
+    }
+    uint64_t upper = (2ULL << i) - 1;
+    return upper < stats->max_ns ? upper : stats->max_ns;
+}
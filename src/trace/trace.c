@@ -0,0 +1,407 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+
+#include "mraa_internal.h"
+#include "mraa_trace.h"
+
+// records kept per thread, a power of two
+#define TRACE_RING_SIZE 256
+#define TRACE_DRAIN_MS 50
+#define TRACE_LINE_MAX 256
+
+struct _trace_record {
+    /*@{*/
+    uint64_t timestamp_ns; /**< CLOCK_REALTIME of the event */
+    int32_t tid; /**< thread that recorded it */
+    int32_t id; /**< pin, bus or channel, -1 for none */
+    int32_t err; /**< errno of the failure, 0 for none */
+    uint16_t op; /**< mraa_trace_op_t */
+    uint8_t priority; /**< syslog priority */
+    /*@}*/
+};
+
+/**
+ * Single producer, single consumer ring. The owning thread is the only one
+ * storing head and the drainer the only one storing tail. Rings are never
+ * freed, a thread that exits hands its ring to the next new thread.
+ */
+struct _trace_ring {
+    /*@{*/
+    struct _trace_record records[TRACE_RING_SIZE]; /**< indexed by sequence modulo the size */
+    uint32_t head; /**< records written */
+    uint32_t tail; /**< records forwarded */
+    uint32_t dropped; /**< records lost to a full ring since the last drain */
+    int32_t tid; /**< kernel id of the owning thread */
+    int owned; /**< 1 while a thread records into the ring */
+    struct _trace_ring* next; /**< set before the ring is published */
+    /*@}*/
+};
+
+static const struct {
+    const char* subsystem;
+    const char* call; /**< NULL when the message names the file */
+    const char* message;
+} trace_ops[MRAA_TRACE_OP_COUNT] = {
+    { "gpio", NULL, "Failed to open 'value'" },
+    { "gpio", "read", "Failed to read a sensible value from sysfs" },
+    { "gpio", "write", "Failed to write to 'value'" },
+    { "i2c", "read_byte", "Access error" },
+    { "i2c", "read_byte_data", "Access error" },
+    { "i2c", "read_word_data", "Access error" },
+    { "i2c", "read_bytes_data", "Access error" },
+    { "i2c", "write", "Access error" },
+    { "i2c", "write_byte", "Access error" },
+    { "i2c", "write_byte_data", "Access error" },
+    { "i2c", "write_word_data", "Access error" },
+    { "i2c", "transaction_submit", "Access error" },
+    { "spi", NULL, "Failed to perform dev transfer" },
+    { "aio", NULL, "Failed to get to the device" },
+    { "aio", NULL, "Failed to read a sensible value" },
+    { "aio", NULL, "Value is not a decimal number" },
+    { "pwm", NULL, "Failed to open duty_cycle" },
+    { "pwm", "write_duty", "Failed to write to duty_cycle" },
+    { "pwm", "read_duty", "Failed to read duty_cycle" },
+    { "pwm", "read_duty", "Error in string conversion" },
+};
+
+static struct _trace_ring* rings = NULL;
+static pthread_key_t ring_key;
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+static int trace_mask = LOG_UPTO(LOG_NOTICE);
+
+// drainer state and the output, never taken on the recording path
+static pthread_mutex_t drain_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t drain_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t drain_thread;
+static int drain_running = 0;
+static int drain_stop = 0;
+static int out_fd = -1;
+
+static void
+trace_ring_release(void* ring)
+{
+    __atomic_store_n(&((struct _trace_ring*) ring)->owned, 0, __ATOMIC_RELEASE);
+}
+
+static void
+trace_fork_child()
+{
+    // the drainer did not survive the fork, the next record starts one
+    pthread_mutex_init(&drain_lock, NULL);
+    drain_running = 0;
+    drain_stop = 0;
+}
+
+static void
+trace_key_create()
+{
+    pthread_key_create(&ring_key, trace_ring_release);
+    pthread_atfork(NULL, NULL, trace_fork_child);
+}
+
+static struct _trace_ring*
+trace_ring_claim()
+{
+    struct _trace_ring* ring;
+
+    for (ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+        int unowned = 0;
+        if (__atomic_compare_exchange_n(&ring->owned, &unowned, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+    if (ring == NULL) {
+        ring = (struct _trace_ring*) calloc(1, sizeof(struct _trace_ring));
+        if (ring == NULL) {
+            return NULL;
+        }
+        ring->owned = 1;
+        ring->next = __atomic_load_n(&rings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&rings, &ring->next, ring, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
+    }
+    ring->tid = (int32_t) syscall(SYS_gettid);
+    pthread_setspecific(ring_key, ring);
+    return ring;
+}
+
+static int
+trace_format(const struct _trace_record* r, char* buf, size_t size)
+{
+    char id[16] = "";
+    const char* call = trace_ops[r->op].call;
+
+    if (r->id >= 0) {
+        snprintf(id, sizeof(id), "%d", r->id);
+    }
+    return snprintf(buf, size, "%s%s: %s%s%s%s%s", trace_ops[r->op].subsystem, id, call != NULL ? call : "",
+                    call != NULL ? ": " : "", trace_ops[r->op].message, r->err != 0 ? ": " : "",
+                    r->err != 0 ? strerror(r->err) : "");
+}
+
+static void
+trace_write_line(int fd, const struct _trace_record* r, const char* message)
+{
+    char line[TRACE_LINE_MAX + 64];
+    char date[32];
+    struct tm tm;
+    time_t sec = (time_t) (r->timestamp_ns / 1000000000ULL);
+
+    localtime_r(&sec, &tm);
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &tm);
+    int len = snprintf(line, sizeof(line), "%s.%06u libmraa[%d]: %s\n", date,
+                       (unsigned int) (r->timestamp_ns % 1000000000ULL / 1000), (int) r->tid, message);
+    if (len >= (int) sizeof(line)) {
+        len = sizeof(line) - 1;
+        line[len - 1] = '\n';
+    }
+    if (write(fd, line, len) != len) {
+        // nowhere left to report it
+    }
+}
+
+/* forwards every pending record, called with drain_lock held */
+static void
+trace_drain_all()
+{
+    struct _trace_ring* ring;
+    char message[TRACE_LINE_MAX];
+
+    for (ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+        uint32_t tail = ring->tail;
+        uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+        for (; tail != head; tail++) {
+            const struct _trace_record* r = &ring->records[tail & (TRACE_RING_SIZE - 1)];
+            trace_format(r, message, sizeof(message));
+            if (out_fd == -1) {
+                syslog(r->priority, "%s", message);
+            } else {
+                trace_write_line(out_fd, r, message);
+            }
+        }
+        __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+
+        uint32_t dropped = __atomic_exchange_n(&ring->dropped, 0, __ATOMIC_RELAXED);
+        if (dropped != 0) {
+            syslog(LOG_WARNING, "trace: %u records dropped by thread %d", dropped, (int) ring->tid);
+        }
+    }
+}
+
+static void*
+trace_drain(void* arg)
+{
+    struct timespec deadline;
+
+    pthread_mutex_lock(&drain_lock);
+    while (!drain_stop) {
+        trace_drain_all();
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += TRACE_DRAIN_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&drain_cond, &drain_lock, &deadline);
+    }
+    trace_drain_all();
+    pthread_mutex_unlock(&drain_lock);
+    return NULL;
+}
+
+static void
+trace_drain_start()
+{
+    pthread_mutex_lock(&drain_lock);
+    if (!drain_running) {
+        drain_stop = 0;
+        // a plain thread, the library thread attributes are meant for the isr paths
+        if (pthread_create(&drain_thread, NULL, trace_drain, NULL) == 0) {
+            __atomic_store_n(&drain_running, 1, __ATOMIC_RELEASE);
+        } else {
+            // no thread to hand over to, forward from here rather than lose the records
+            trace_drain_all();
+        }
+    }
+    pthread_mutex_unlock(&drain_lock);
+}
+
+void
+mraa_trace(int priority, mraa_trace_op_t op, int id, int err)
+{
+    struct _trace_ring* ring;
+    struct timespec ts;
+    // callers look at errno again once the record is made
+    int saved_errno = errno;
+
+    if (!(LOG_MASK(LOG_PRI(priority)) & __atomic_load_n(&trace_mask, __ATOMIC_RELAXED))) {
+        return;
+    }
+    pthread_once(&ring_key_once, trace_key_create);
+    ring = (struct _trace_ring*) pthread_getspecific(ring_key);
+    if (ring == NULL && (ring = trace_ring_claim()) == NULL) {
+        errno = saved_errno;
+        return;
+    }
+
+    uint32_t head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= TRACE_RING_SIZE) {
+        __atomic_fetch_add(&ring->dropped, 1, __ATOMIC_RELAXED);
+    } else {
+        struct _trace_record* r = &ring->records[head & (TRACE_RING_SIZE - 1)];
+        clock_gettime(CLOCK_REALTIME, &ts);
+        r->timestamp_ns = (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+        r->tid = ring->tid;
+        r->id = id;
+        r->err = err;
+        r->op = (uint16_t) op;
+        r->priority = (uint8_t) LOG_PRI(priority);
+        __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+    }
+
+    if (!__atomic_load_n(&drain_running, __ATOMIC_ACQUIRE)) {
+        trace_drain_start();
+    }
+    errno = saved_errno;
+}
+
+void
+mraa_trace_set_mask(int mask)
+{
+    __atomic_store_n(&trace_mask, mask, __ATOMIC_RELAXED);
+}
+
+void
+mraa_trace_stop()
+{
+    pthread_mutex_lock(&drain_lock);
+    if (!drain_running) {
+        trace_drain_all();
+        pthread_mutex_unlock(&drain_lock);
+        return;
+    }
+    drain_stop = 1;
+    pthread_cond_signal(&drain_cond);
+    pthread_mutex_unlock(&drain_lock);
+
+    pthread_join(drain_thread, NULL);
+    __atomic_store_n(&drain_running, 0, __ATOMIC_RELEASE);
+}
+
+mraa_result_t
+mraa_set_trace_output(const char* path)
+{
+    int fd = -1;
+
+    if (path != NULL) {
+        fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+        if (fd == -1) {
+            syslog(LOG_ERR, "trace: Failed to open %s: %s", path, strerror(errno));
+            return MRAA_ERROR_INVALID_RESOURCE;
+        }
+    }
+
+    pthread_mutex_lock(&drain_lock);
+    // what was recorded so far goes where it was meant to
+    trace_drain_all();
+    if (out_fd != -1) {
+        close(out_fd);
+    }
+    out_fd = fd;
+    pthread_mutex_unlock(&drain_lock);
+    return MRAA_SUCCESS;
+}
+
+static int
+trace_record_cmp(const void* a, const void* b)
+{
+    uint64_t x = ((const struct _trace_record*) a)->timestamp_ns;
+    uint64_t y = ((const struct _trace_record*) b)->timestamp_ns;
+    return x < y ? -1 : x > y;
+}
+
+mraa_result_t
+mraa_trace_dump(int fd)
+{
+    struct _trace_ring* ring;
+    struct _trace_record* records;
+    char message[TRACE_LINE_MAX];
+    size_t count = 0, n = 0, i;
+
+    if (fd < 0) {
+        return MRAA_ERROR_INVALID_PARAMETER;
+    }
+    for (ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); ring != NULL; ring = ring->next) {
+        count += TRACE_RING_SIZE;
+    }
+    if (count == 0) {
+        return MRAA_SUCCESS;
+    }
+    records = (struct _trace_record*) malloc(count * sizeof(struct _trace_record));
+    if (records == NULL) {
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+
+    for (ring = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); ring != NULL && n < count; ring = ring->next) {
+        uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        uint32_t first = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+        size_t start = n;
+        uint32_t seq;
+
+        for (seq = first; seq != head; seq++) {
+            records[n++] = ring->records[seq & (TRACE_RING_SIZE - 1)];
+        }
+        // the owner may have reused the oldest slots while they were copied
+        uint32_t now = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (now - first >= TRACE_RING_SIZE) {
+            uint32_t stale = now - first - TRACE_RING_SIZE + 1;
+            if (stale > head - first) {
+                stale = head - first;
+            }
+            memmove(&records[start], &records[start + stale], (n - start - stale) * sizeof(struct _trace_record));
+            n -= stale;
+        }
+    }
+
+    qsort(records, n, sizeof(struct _trace_record), trace_record_cmp);
+    // strerror is not reentrant, share the drainer lock
+    pthread_mutex_lock(&drain_lock);
+    for (i = 0; i < n; i++) {
+        trace_format(&records[i], message, sizeof(message));
+        trace_write_line(fd, &records[i], message);
+    }
+    pthread_mutex_unlock(&drain_lock);
+    free(records);
+    return MRAA_SUCCESS;
+}
@@ -35,6 +35,7 @@
 
 #include "uart.h"
 #include "mraa_internal.h"
+#include "mraa_stats.h"
 
 #ifndef CMSPAR
 #define CMSPAR   010000000000
@@ -508,7 +509,10 @@ mraa_uart_read(mraa_uart_context dev, char* buf, size_t len)
         return MRAA_ERROR_INVALID_RESOURCE;
     }
 
-    return read(dev->fd, buf, len);
+    MRAA_STATS_START(start);
+    int ret = read(dev->fd, buf, len);
+    MRAA_STATS_RECORD(dev, start, ret > 0 ? ret : 0, ret < 0);
+    return ret;
 }
 
 int
@@ -524,7 +528,10 @@ mraa_uart_write(mraa_uart_context dev, const char* buf, size_t len)
         return MRAA_ERROR_INVALID_RESOURCE;
     }
 
-    return write(dev->fd, buf, len);
+    MRAA_STATS_START(start);
+    int ret = write(dev->fd, buf, len);
+    MRAA_STATS_RECORD(dev, start, ret > 0 ? ret : 0, ret < 0);
+    return ret;
 }
 
 mraa_boolean_t
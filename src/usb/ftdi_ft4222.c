@@ -919,7 +919,7 @@ mraa_ftdi_ft4222_gpio_monitor_add_pin(int pin)
 {
     if (gpio_monitor.num_active_pins == 0) {
         pthread_mutex_init(&gpio_monitor.mutex, NULL);
-        pthread_create(&gpio_monitor.thread, NULL, mraa_ftdi_ft4222_gpio_monitor, NULL);
+        mraa_thread_create(&gpio_monitor.thread, NULL, mraa_ftdi_ft4222_gpio_monitor, NULL);
     }
     pthread_mutex_lock(&gpio_monitor.mutex);
     gpio_monitor.num_active_pins++;
@@ -973,24 +973,41 @@ mraa_ftdi_ft4222_gpio_interrupt_handler_init_replace(mraa_gpio_context dev)
     return MRAA_SUCCESS;
 }
 
+static mraa_boolean_t
+mraa_ftdi_ft4222_gpio_interrupt_pending_replace(mraa_gpio_context dev)
+{
+    switch (mraa_ftdi_ft4222_get_gpio_type(dev->pin)) {
+        case GPIO_TYPE_BUILTIN:
+            return mraa_ftdi_ft4222_has_internal_gpio_triggered(dev->phy_pin);
+        case GPIO_TYPE_PCA9672:
+        case GPIO_TYPE_PCA9555:
+            return mraa_ftdi_ft4222_gpio_monitor_is_interrupt_detected(dev->phy_pin);
+        default:
+            return FALSE;
+    }
+}
+
+static mraa_result_t
+mraa_ftdi_ft4222_gpio_interrupt_handler_exit_replace(mraa_gpio_context dev)
+{
+    switch (mraa_ftdi_ft4222_get_gpio_type(dev->pin)) {
+        case GPIO_TYPE_PCA9672:
+        case GPIO_TYPE_PCA9555:
+            mraa_ftdi_ft4222_gpio_monitor_remove_pin(dev->phy_pin);
+            break;
+        default:;
+    }
+    return MRAA_SUCCESS;
+}
+
 static mraa_result_t
 mraa_ftdi_ft4222_gpio_wait_interrupt_replace(mraa_gpio_context dev)
 {
     int prev_level = mraa_ftdi_ft4222_gpio_read_replace(dev);
-    ft4222_gpio_type gpio_type = mraa_ftdi_ft4222_get_gpio_type(dev->pin);
     mraa_boolean_t interrupt_detected = FALSE;
 
     while (!dev->isr_thread_terminating && !interrupt_detected) {
-        switch (gpio_type) {
-            case GPIO_TYPE_BUILTIN:
-                interrupt_detected = mraa_ftdi_ft4222_has_internal_gpio_triggered(dev->phy_pin);
-                break;
-            case GPIO_TYPE_PCA9672:
-            case GPIO_TYPE_PCA9555:
-                interrupt_detected = mraa_ftdi_ft4222_gpio_monitor_is_interrupt_detected(dev->phy_pin);
-                break;
-            default:;
-        }
+        interrupt_detected = mraa_ftdi_ft4222_gpio_interrupt_pending_replace(dev);
         if (!interrupt_detected)
             mraa_ftdi_ft4222_sleep_ms(20);
     }
@@ -1028,6 +1045,8 @@ mraa_ftdi_ft4222_populate_gpio_func_table(mraa_adv_func_t* func_table)
     func_table->gpio_write_replace = &mraa_ftdi_ft4222_gpio_write_replace;
     func_table->gpio_interrupt_handler_init_replace = &mraa_ftdi_ft4222_gpio_interrupt_handler_init_replace;
     func_table->gpio_wait_interrupt_replace = &mraa_ftdi_ft4222_gpio_wait_interrupt_replace;
+    func_table->gpio_interrupt_pending_replace = &mraa_ftdi_ft4222_gpio_interrupt_pending_replace;
+    func_table->gpio_interrupt_handler_exit_replace = &mraa_ftdi_ft4222_gpio_interrupt_handler_exit_replace;
 }
 
 
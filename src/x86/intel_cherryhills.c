@@ -30,6 +30,7 @@
 
 #include "common.h"
 #include "x86/intel_cherryhills.h"
+#include "x86/intel_pad_mmap.h"
 
 #define PLATFORM_NAME "Braswell Cherry Hill"
 
@@ -47,7 +48,7 @@ mraa_intel_cherryhills()
     b->adc_raw = 0;
     b->adc_supported = 0;
 
-    b->pins = (mraa_pininfo_t*) malloc(sizeof(mraa_pininfo_t) * MRAA_INTEL_CHERRYHILLS_PINCOUNT);
+    b->pins = (mraa_pininfo_t*) calloc(MRAA_INTEL_CHERRYHILLS_PINCOUNT, sizeof(mraa_pininfo_t));
     if (b->pins == NULL) {
         goto error;
     }
@@ -91,6 +92,8 @@ mraa_intel_cherryhills()
     b->pins[pos].gpio.mux_total = 0;
     pos++;
 
+    mraa_intel_pad_mmap_init(b, MRAA_INTEL_PAD_CHERRYVIEW);
+
     return b;
 error:
     syslog(LOG_CRIT, "Cherryhills(Braswell): Platform failed to initialise");
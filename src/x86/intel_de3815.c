@@ -30,6 +30,7 @@
 
 #include "common.h"
 #include "x86/intel_de3815.h"
+#include "x86/intel_pad_mmap.h"
 
 #define PLATFORM_NAME "Intel DE3815"
 #define SYSFS_CLASS_GPIO "/sys/class/gpio"
@@ -152,6 +153,9 @@ mraa_intel_de3815()
 
     b->uart_dev_count = 0;
 
+    // no gpio on the header, raw SoC gpios can still use the pad registers
+    mraa_intel_pad_mmap_init(b, MRAA_INTEL_PAD_BAYTRAIL);
+
     return b;
 error:
     syslog(LOG_CRIT, "de3815: Platform failed to initialise");
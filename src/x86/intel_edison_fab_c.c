@@ -33,6 +33,7 @@
 
 #include "common.h"
 #include "x86/intel_edison_fab_c.h"
+#include "gpio/gpio_mmap.h"
 
 #define PLATFORM_NAME "Intel Edison"
 #define SYSFS_CLASS_GPIO "/sys/class/gpio"
@@ -70,11 +71,20 @@ static unsigned int pullup_map[] = { 216, 217, 218, 219, 220, 221, 222, 223, 224
                                      226, 227, 228, 229, 208, 209, 210, 211, 212, 213 };
 static int miniboard = 0;
 
-// MMAP
-static uint8_t* mmap_reg = NULL;
-static int mmap_fd = 0;
-static int mmap_size;
-static unsigned int mmap_count = 0;
+// MMAP, GPLR/GPSR/GPCR banks of the Merrifield gpio controller. Direction
+// stays with the kernel so the output enable buffers follow it
+static mraa_gpio_mmap_desc_t mmap_desc = {
+    .name = "edison",
+    .path = MMAP_PATH,
+    .num_banks = 6,
+    .pins_per_bank = 32,
+    .bank_stride = sizeof(uint32_t),
+    .data_in = 0x04,
+    .data_out = MRAA_GPIO_MMAP_NONE,
+    .set = 0x34,
+    .clear = 0x4c,
+    .dir = MRAA_GPIO_MMAP_NONE,
+};
 
 // PWM 0% duty workaround state array
 static int pwm_disabled[4] = { 0 };
@@ -503,13 +513,6 @@ mraa_intel_edison_spi_init_post(mraa_spi_context spi)
 mraa_result_t
 mraa_intel_edison_gpio_mode_replace(mraa_gpio_context dev, mraa_gpio_mode_t mode)
 {
-    if (dev->value_fp != -1) {
-        if (close(dev->value_fp) != 0) {
-            return MRAA_ERROR_INVALID_RESOURCE;
-        }
-        dev->value_fp = -1;
-    }
-
     mraa_gpio_context pullup_e;
     pullup_e = mraa_gpio_init_raw(pullup_map[dev->phy_pin]);
     if (pullup_e == NULL) {
@@ -555,13 +558,6 @@ mraa_intel_edison_gpio_mode_replace(mraa_gpio_context dev, mraa_gpio_mode_t mode
 mraa_result_t
 mraa_intel_edsion_mb_gpio_mode(mraa_gpio_context dev, mraa_gpio_mode_t mode)
 {
-    if (dev->value_fp != -1) {
-        if (close(dev->value_fp) != 0) {
-            return MRAA_ERROR_INVALID_RESOURCE;
-        }
-        dev->value_fp = -1;
-    }
-
     char filepath[MAX_SIZE];
 
     mraa_gpio_context mode_gpio = mraa_gpio_init_raw(dev->pin);
@@ -658,108 +654,10 @@ mraa_intel_edison_uart_init_post(mraa_uart_context uart)
     return mraa_gpio_write(tristate, 1);
 }
 
-static mraa_result_t
-mraa_intel_edsion_mmap_unsetup()
-{
-    if (mmap_reg == NULL) {
-        syslog(LOG_ERR, "edison mmap: null register cant unsetup");
-        return MRAA_ERROR_INVALID_RESOURCE;
-    }
-    munmap(mmap_reg, mmap_size);
-    mmap_reg = NULL;
-    if (close(mmap_fd) != 0) {
-        return MRAA_ERROR_INVALID_RESOURCE;
-    }
-    return MRAA_SUCCESS;
-}
-
-mraa_result_t
-mraa_intel_edison_mmap_write(mraa_gpio_context dev, int value)
-{
-    uint8_t offset = ((dev->pin / 32) * sizeof(uint32_t));
-    uint8_t valoff;
-
-    if (value) {
-        valoff = 0x34;
-    } else {
-        valoff = 0x4c;
-    }
-
-    *(volatile uint32_t*) (mmap_reg + offset + valoff) = (uint32_t)(1 << (dev->pin % 32));
-
-    return MRAA_SUCCESS;
-}
-
-int
-mraa_intel_edison_mmap_read(mraa_gpio_context dev)
-{
-    uint8_t offset = ((dev->pin / 32) * sizeof(uint32_t));
-    uint32_t value;
-
-    value = *(volatile uint32_t*) (mmap_reg + 0x04 + offset);
-    if (value & (uint32_t)(1 << (dev->pin % 32))) {
-        return 1;
-    }
-    return 0;
-}
-
 mraa_result_t
 mraa_intel_edison_mmap_setup(mraa_gpio_context dev, mraa_boolean_t en)
 {
-    if (dev == NULL) {
-        syslog(LOG_ERR, "edison mmap: context not valid");
-        return MRAA_ERROR_INVALID_HANDLE;
-    }
-
-    if (en == 0) {
-        if (dev->mmap_write == NULL && dev->mmap_read == NULL) {
-            syslog(LOG_ERR, "edison mmap: can't disable disabled mmap gpio");
-            return MRAA_ERROR_INVALID_PARAMETER;
-        }
-        dev->mmap_write = NULL;
-        dev->mmap_read = NULL;
-        mmap_count--;
-        if (mmap_count == 0) {
-            return mraa_intel_edsion_mmap_unsetup();
-        }
-        return MRAA_SUCCESS;
-    }
-
-    if (dev->mmap_write != NULL && dev->mmap_read != NULL) {
-        syslog(LOG_ERR, "edison mmap: can't enable enabled mmap gpio");
-        return MRAA_ERROR_INVALID_PARAMETER;
-    }
-
-    // Might need to make some elements of this thread safe.
-    // For example only allow one thread to enter the following block
-    // to prevent mmap'ing twice.
-    if (mmap_reg == NULL) {
-        if ((mmap_fd = open(MMAP_PATH, O_RDWR)) < 0) {
-            syslog(LOG_ERR, "edison map: unable to open resource0 file");
-            return MRAA_ERROR_INVALID_HANDLE;
-        }
-
-        struct stat fd_stat;
-        if (fstat(mmap_fd, &fd_stat) != 0) {
-            syslog(LOG_ERR, "edison map: unable to access resource0 file");
-            return MRAA_ERROR_INVALID_HANDLE;
-        }
-        mmap_size = fd_stat.st_size;
-
-        mmap_reg =
-        (uint8_t*) mmap(NULL, fd_stat.st_size, PROT_READ | PROT_WRITE, MAP_FILE | MAP_SHARED, mmap_fd, 0);
-        if (mmap_reg == MAP_FAILED) {
-            syslog(LOG_ERR, "edison mmap: failed to mmap");
-            mmap_reg = NULL;
-            close(mmap_fd);
-            return MRAA_ERROR_NO_RESOURCES;
-        }
-    }
-    dev->mmap_write = &mraa_intel_edison_mmap_write;
-    dev->mmap_read = &mraa_intel_edison_mmap_read;
-    mmap_count++;
-
-    return MRAA_SUCCESS;
+    return mraa_gpio_mmap_setup(&mmap_desc, dev, dev != NULL ? dev->pin : 0, en);
 }
 
 mraa_result_t
@@ -838,6 +736,7 @@ mraa_intel_edison_miniboard(mraa_board_t* b)
     b->adv_func->gpio_mode_replace = &mraa_intel_edsion_mb_gpio_mode;
     b->adv_func->uart_init_pre = &mraa_intel_edison_uart_init_pre;
     b->adv_func->gpio_mmap_setup = &mraa_intel_edison_mmap_setup;
+    b->adv_func->gpio_mmap_setup_multi = &mraa_gpio_mmap_setup_multi;
 
     int pos = 0;
     strncpy(b->pins[pos].name, "J17-1", 8);
@@ -1297,6 +1196,7 @@ mraa_intel_edison_fab_c()
     b->adv_func->uart_init_pre = &mraa_intel_edison_uart_init_pre;
     b->adv_func->uart_init_post = &mraa_intel_edison_uart_init_post;
     b->adv_func->gpio_mmap_setup = &mraa_intel_edison_mmap_setup;
+    b->adv_func->gpio_mmap_setup_multi = &mraa_gpio_mmap_setup_multi;
     b->adv_func->spi_lsbmode_replace = &mraa_intel_edison_spi_lsbmode_replace;
 
     b->pins = (mraa_pininfo_t*) calloc(MRAA_INTEL_EDISON_PINCOUNT, sizeof(mraa_pininfo_t));
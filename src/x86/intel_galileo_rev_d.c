@@ -30,40 +30,24 @@
 
 #include "common.h"
 #include "x86/intel_galileo_rev_d.h"
+#include "gpio/gpio_mmap.h"
 
 #define UIO_PATH "/dev/uio0"
 #define PLATFORM_NAME "Intel Galileo Gen 1"
 
-static uint8_t* mmap_reg = NULL;
-static int mmap_fd = 0;
-static int mmap_size = 0x1000;
-static unsigned int mmap_count = 0;
-
-static mraa_result_t
-mraa_intel_galileo_g1_mmap_unsetup()
-{
-    if (mmap_reg == NULL) {
-        syslog(LOG_WARNING, "galileo1: Mmap null register nothing to unsetup");
-        return MRAA_ERROR_INVALID_RESOURCE;
-    }
-    munmap(mmap_reg, mmap_size);
-    mmap_reg = NULL;
-    close(mmap_fd);
-    return MRAA_SUCCESS;
-}
-
-mraa_result_t
-mraa_intel_galileo_g1_mmap_write(mraa_gpio_context dev, int value)
-{
-    int bitpos = plat->pins[dev->phy_pin].mmap.bit_pos;
-    if (value) {
-        *((unsigned*) mmap_reg) |= (1 << bitpos);
-        return MRAA_SUCCESS;
-    }
-    *((unsigned*) mmap_reg) &= ~(1 << bitpos);
-
-    return MRAA_SUCCESS;
-}
+// a single output latch on the uio node, bit positions come from the pin table
+static mraa_gpio_mmap_desc_t mmap_desc = {
+    .name = "galileo1",
+    .path = UIO_PATH,
+    .size = 0x1000,
+    .num_banks = 1,
+    .pins_per_bank = 32,
+    .data_in = MRAA_GPIO_MMAP_NONE,
+    .data_out = 0,
+    .set = MRAA_GPIO_MMAP_NONE,
+    .clear = MRAA_GPIO_MMAP_NONE,
+    .dir = MRAA_GPIO_MMAP_NONE,
+};
 
 mraa_result_t
 mraa_intel_galileo_g1_mmap_setup(mraa_gpio_context dev, mraa_boolean_t en)
@@ -78,42 +62,18 @@ mraa_intel_galileo_g1_mmap_setup(mraa_gpio_context dev, mraa_boolean_t en)
         return MRAA_ERROR_NO_RESOURCES;
     }
     if (en == 0) {
-        if (dev->mmap_write == NULL) {
-            syslog(LOG_NOTICE, "galileo1: Can't disable disabled mmap gpio");
-            return MRAA_ERROR_INVALID_PARAMETER;
-        }
-        dev->mmap_write = NULL;
-        mmap_count--;
-        if (mmap_count == 0) {
-            return mraa_intel_galileo_g1_mmap_unsetup();
-        }
-        return MRAA_SUCCESS;
-    }
-
-    if (dev->mmap_write != NULL) {
-        syslog(LOG_ERR, "galileo1: Can't enable enabled mmap gpio");
-        return MRAA_ERROR_INVALID_PARAMETER;
+        return mraa_gpio_mmap_setup(&mmap_desc, dev, 0, 0);
     }
-    if (mmap_reg == NULL) {
-        if ((mmap_fd = open(UIO_PATH, O_RDWR)) < 0) {
-            syslog(LOG_ERR, "galileo1: Unable to open UIO device");
-            return MRAA_ERROR_INVALID_RESOURCE;
-        }
-        mmap_reg = mmap(NULL, mmap_size, PROT_READ | PROT_WRITE, MAP_SHARED, mmap_fd, 0);
 
-        if (mmap_reg == MAP_FAILED) {
-            syslog(LOG_ERR, "galileo1: Mmap failed to mmap");
-            mmap_reg = NULL;
-            close(mmap_fd);
-            return MRAA_ERROR_NO_RESOURCES;
-        }
+    mraa_result_t ret = mraa_gpio_mmap_setup(&mmap_desc, dev, plat->pins[dev->phy_pin].mmap.bit_pos, 1);
+    if (ret != MRAA_SUCCESS) {
+        return ret;
     }
     if (mraa_setup_mux_mapped(plat->pins[dev->phy_pin].mmap.gpio) != MRAA_SUCCESS) {
         syslog(LOG_ERR, "galileo1: Unable to setup required multiplexers for mmap");
+        mraa_gpio_mmap_setup(&mmap_desc, dev, 0, 0);
         return MRAA_ERROR_INVALID_RESOURCE;
     }
-    dev->mmap_write = &mraa_intel_galileo_g1_mmap_write;
-
     return MRAA_SUCCESS;
 }
 
@@ -29,6 +29,7 @@
 
 #include "common.h"
 #include "x86/intel_galileo_rev_g.h"
+#include "gpio/gpio_mmap.h"
 
 #define MAX_SIZE 64
 #define SYSFS_CLASS_GPIO "/sys/class/gpio"
@@ -36,10 +37,19 @@
 
 #define UIO_PATH "/dev/uio0"
 
-static uint8_t* mmap_reg = NULL;
-static int mmap_fd = 0;
-static int mmap_size = 0x1000;
-static unsigned int mmap_count = 0;
+// a single output latch on the uio node, bit positions come from the pin table
+static mraa_gpio_mmap_desc_t mmap_desc = {
+    .name = "galileo2",
+    .path = UIO_PATH,
+    .size = 0x1000,
+    .num_banks = 1,
+    .pins_per_bank = 32,
+    .data_in = MRAA_GPIO_MMAP_NONE,
+    .data_out = 0,
+    .set = MRAA_GPIO_MMAP_NONE,
+    .clear = MRAA_GPIO_MMAP_NONE,
+    .dir = MRAA_GPIO_MMAP_NONE,
+};
 
 static unsigned int pullup_map[] = { 33, 29, 35, 17, 37, 19, 21, 39, 41, 23,
                                      27, 25, 43, 31, 49, 51, 53, 55, 57, 59 };
@@ -115,11 +125,6 @@ mraa_intel_galileo_gen2_pwm_period_replace(mraa_pwm_context dev, int period)
 mraa_result_t
 mraa_intel_galileo_gen2_gpio_mode_replace(mraa_gpio_context dev, mraa_gpio_mode_t mode)
 {
-    if (dev->value_fp != -1) {
-        close(dev->value_fp);
-        dev->value_fp = -1;
-    }
-
     mraa_gpio_context pullup_e;
     pullup_e = mraa_gpio_init_raw(pullup_map[dev->phy_pin]);
     if (pullup_e == NULL) {
@@ -184,32 +189,6 @@ mraa_intel_galileo_gen2_gpio_mode_replace(mraa_gpio_context dev, mraa_gpio_mode_
     return MRAA_SUCCESS;
 }
 
-static mraa_result_t
-mraa_intel_galileo_g2_mmap_unsetup()
-{
-    if (mmap_reg == NULL) {
-        syslog(LOG_ERR, "mmap: null register cant unsetup");
-        return MRAA_ERROR_INVALID_RESOURCE;
-    }
-    munmap(mmap_reg, mmap_size);
-    mmap_reg = NULL;
-    close(mmap_fd);
-    return MRAA_SUCCESS;
-}
-
-mraa_result_t
-mraa_intel_galileo_g2_mmap_write(mraa_gpio_context dev, int value)
-{
-    int bitpos = plat->pins[dev->phy_pin].mmap.bit_pos;
-    if (value) {
-        *((unsigned*) mmap_reg) |= (1 << bitpos);
-        return MRAA_SUCCESS;
-    }
-    *((unsigned*) mmap_reg) &= ~(1 << bitpos);
-
-    return MRAA_SUCCESS;
-}
-
 mraa_result_t
 mraa_intel_galileo_g2_mmap_setup(mraa_gpio_context dev, mraa_boolean_t en)
 {
@@ -223,41 +202,18 @@ mraa_intel_galileo_g2_mmap_setup(mraa_gpio_context dev, mraa_boolean_t en)
         return MRAA_ERROR_NO_RESOURCES;
     }
     if (en == 0) {
-        if (dev->mmap_write == NULL) {
-            syslog(LOG_ERR, "mmap: can't disable disabled mmap gpio");
-            return MRAA_ERROR_INVALID_PARAMETER;
-        }
-        dev->mmap_write = NULL;
-        mmap_count--;
-        if (mmap_count == 0) {
-            return mraa_intel_galileo_g2_mmap_unsetup();
-        }
-        return MRAA_SUCCESS;
+        return mraa_gpio_mmap_setup(&mmap_desc, dev, 0, 0);
     }
 
-    if (dev->mmap_write != NULL) {
-        syslog(LOG_ERR, "mmap: can't enable enabled mmap gpio");
-        return MRAA_ERROR_INVALID_PARAMETER;
-    }
-    if (mmap_reg == NULL) {
-        if ((mmap_fd = open(UIO_PATH, O_RDWR)) < 0) {
-            syslog(LOG_ERR, "mmap: Unable to open UIO device");
-            return MRAA_ERROR_INVALID_RESOURCE;
-        }
-        mmap_reg = mmap(NULL, mmap_size, PROT_READ | PROT_WRITE, MAP_SHARED, mmap_fd, 0);
-
-        if (mmap_reg == MAP_FAILED) {
-            syslog(LOG_ERR, "mmap: failed to mmap");
-            mmap_reg = NULL;
-            close(mmap_fd);
-            return MRAA_ERROR_NO_RESOURCES;
-        }
+    mraa_result_t ret = mraa_gpio_mmap_setup(&mmap_desc, dev, plat->pins[dev->phy_pin].mmap.bit_pos, 1);
+    if (ret != MRAA_SUCCESS) {
+        return ret;
     }
     if (mraa_setup_mux_mapped(plat->pins[dev->phy_pin].mmap.gpio) != MRAA_SUCCESS) {
         syslog(LOG_ERR, "mmap: unable to setup required multiplexers");
+        mraa_gpio_mmap_setup(&mmap_desc, dev, 0, 0);
         return MRAA_ERROR_INVALID_RESOURCE;
     }
-    dev->mmap_write = &mraa_intel_galileo_g2_mmap_write;
     return MRAA_SUCCESS;
 }
 
@@ -30,6 +30,7 @@
 
 #include "common.h"
 #include "x86/intel_minnow_byt_compatible.h"
+#include "x86/intel_pad_mmap.h"
 
 #define PLATFORM_NAME "MinnowBoard MAX"
 #define I2C_BUS_DEFAULT 7
@@ -205,6 +206,8 @@ mraa_intel_minnowboard_byt_compatible(mraa_boolean_t turbot)
     b->uart_dev[0].tx = -1;
     b->uart_dev[0].device_path = "/dev/ttyS0";
 
+    mraa_intel_pad_mmap_init(b, MRAA_INTEL_PAD_BAYTRAIL);
+
     return b;
 error:
     syslog(LOG_CRIT, "minnowmax: Platform failed to initialise");
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <glob.h>
+
+#include "common.h"
+#include "gpio/gpio_mmap.h"
+#include "x86/intel_pad_mmap.h"
+
+#define MMAP_PATH "/dev/mem"
+#define DEBUGFS_PINCTRL "/sys/kernel/debug/pinctrl"
+
+#define PAD_MAX_COMMUNITIES 4
+#define PAD_MAX_RANGES 32
+
+// Baytrail: 16 bytes per pad, the level lives in the VAL register
+#define BYT_PAD_STRIDE 16
+#define BYT_VAL_REG 0x8
+#define BYT_LEVEL 0x1
+
+// every pad register is its own bank of the engine, one word wide
+#define PAD_REG_STRIDE sizeof(uint32_t)
+
+// Cherryview: pads grouped in families of up to 15, 8 bytes per pad
+#define CHV_PADCTRL0 0x4400
+#define CHV_FAMILY_STRIDE 0x400
+#define CHV_PAD_STRIDE 8
+#define CHV_PADS_PER_FAMILY 15
+#define CHV_RX_STATE 0x1
+#define CHV_TX_STATE 0x2
+#define CHV_GPIOCFG_MASK (0x7 << 8)
+#define CHV_GPIOCFG_TX_ONLY (0x1 << 8)
+
+// gpio line offset to pad number, same order as the kernel driver
+static const unsigned int byt_score_pads[] = {
+    85, 89, 93, 96, 99, 102, 98, 101, 34, 37, 36, 38, 39, 35, 40, 84, 62, 61, 64, 59, 54,
+    56, 60, 55, 63, 57, 51, 50, 53, 47, 52, 49, 48, 43, 46, 41, 45, 42, 58, 44, 95, 105,
+    70, 68, 67, 66, 69, 71, 65, 72, 86, 90, 88, 92, 103, 77, 79, 83, 78, 81, 80, 82, 13,
+    12, 15, 14, 17, 18, 19, 16, 2, 1, 0, 4, 6, 7, 9, 8, 33, 32, 31, 30, 29, 27, 25,
+    28, 26, 23, 21, 20, 24, 22, 5, 3, 10, 11, 106, 87, 91, 104, 97, 100,
+};
+
+static const unsigned int byt_ncore_pads[] = {
+    19, 18, 17, 20, 21, 22, 24, 25, 23, 16, 14, 15, 12, 26, 27, 1, 4, 8, 11, 0,
+    3, 6, 10, 13, 2, 5, 9, 7,
+};
+
+static const unsigned int byt_sus_pads[] = {
+    29, 33, 30, 31, 32, 34, 36, 35, 38, 37, 18, 7, 11, 20, 17, 1, 8, 10, 19, 12, 0, 2,
+    23, 39, 28, 27, 22, 21, 24, 25, 26, 51, 56, 54, 49, 55, 48, 57, 50, 58, 52, 53, 59, 40,
+};
+
+typedef struct {
+    char name[16]; /**< ACPI device name, used as gpiochip label and iomem name */
+    int gpio_base; /**< sysfs number of line 0, -1 when the gpiochip is missing */
+    int ngpio; /**< lines on the gpiochip */
+    const unsigned int* pads; /**< Baytrail line to pad map, NULL on Cherryview */
+    unsigned int num_pads; /**< entries in pads */
+    mraa_gpio_mmap_desc_t desc; /**< register window of the community */
+} pad_community_t;
+
+typedef struct {
+    int community; /**< index into communities */
+    int gpio_first; /**< first sysfs gpio of the range */
+    int gpio_last; /**< last sysfs gpio of the range */
+    int pin_first; /**< pin number of gpio_first in the community */
+} pad_range_t;
+
+typedef struct {
+    int gpio; /**< sysfs gpio number */
+    int community; /**< index into communities */
+    uint32_t offset; /**< register offset in the community window */
+} pad_entry_t;
+
+static mraa_intel_pad_soc_t pad_soc;
+static pad_community_t communities[PAD_MAX_COMMUNITIES];
+static int num_communities = 0;
+static pad_range_t ranges[PAD_MAX_RANGES];
+static int num_ranges = 0;
+static pad_entry_t* pad_table = NULL;
+static int pad_table_size = 0;
+
+static void
+mraa_intel_pad_load_ranges()
+{
+    int c;
+
+    // gpio-ranges lines look like "0: INT33FF:00 GPIOS [341 - 348] PINS [0 - 7]"
+    for (c = 0; c < num_communities; c++) {
+        char pattern[64];
+        glob_t results;
+        results.gl_pathc = 0;
+        snprintf(pattern, sizeof(pattern), DEBUGFS_PINCTRL "/%.*s*/gpio-ranges",
+                 (int) sizeof(communities[c].name) - 1, communities[c].name);
+        if (glob(pattern, 0, NULL, &results) != 0) {
+            globfree(&results);
+            continue;
+        }
+        FILE* fh = fopen(results.gl_pathv[0], "r");
+        globfree(&results);
+        if (fh == NULL) {
+            continue;
+        }
+        char line[128];
+        while (fgets(line, sizeof(line), fh) != NULL && num_ranges < PAD_MAX_RANGES) {
+            int gpio_first, gpio_last, pin_first, pin_last;
+            char* gpios = strstr(line, "GPIOS");
+            if (gpios == NULL) {
+                continue;
+            }
+            if (sscanf(gpios, "GPIOS [%d - %d] PINS [%d - %d]", &gpio_first, &gpio_last, &pin_first, &pin_last) != 4 &&
+                sscanf(gpios, "GPIOS [%d - %d] PINGRP [%d - %d]", &gpio_first, &gpio_last, &pin_first, &pin_last) != 4) {
+                continue;
+            }
+            ranges[num_ranges].community = c;
+            ranges[num_ranges].gpio_first = gpio_first;
+            ranges[num_ranges].gpio_last = gpio_last;
+            ranges[num_ranges].pin_first = pin_first;
+            num_ranges++;
+        }
+        fclose(fh);
+    }
+}
+
+static mraa_result_t
+mraa_intel_pad_resolve(int gpio, int* community, uint32_t* offset)
+{
+    int i;
+
+    if (pad_soc == MRAA_INTEL_PAD_BAYTRAIL) {
+        for (i = 0; i < num_communities; i++) {
+            pad_community_t* com = &communities[i];
+            int line = gpio - com->gpio_base;
+            if (com->gpio_base < 0 || line < 0 || line >= com->ngpio || line >= (int) com->num_pads) {
+                continue;
+            }
+            *community = i;
+            *offset = com->pads[line] * BYT_PAD_STRIDE + BYT_VAL_REG;
+            return MRAA_SUCCESS;
+        }
+        return MRAA_ERROR_INVALID_RESOURCE;
+    }
+
+    // Cherryview line offsets skip the holes between families, only the
+    // pinctrl ranges say which pad a line really is
+    for (i = 0; i < num_ranges; i++) {
+        if (gpio < ranges[i].gpio_first || gpio > ranges[i].gpio_last) {
+            continue;
+        }
+        int pin = ranges[i].pin_first + (gpio - ranges[i].gpio_first);
+        *community = ranges[i].community;
+        *offset = CHV_PADCTRL0 + CHV_FAMILY_STRIDE * (pin / CHV_PADS_PER_FAMILY) +
+                  CHV_PAD_STRIDE * (pin % CHV_PADS_PER_FAMILY);
+        return MRAA_SUCCESS;
+    }
+    return MRAA_ERROR_INVALID_RESOURCE;
+}
+
+static mraa_result_t
+mraa_intel_pad_lookup(int gpio, int* community, uint32_t* offset)
+{
+    int i;
+
+    for (i = 0; i < pad_table_size; i++) {
+        if (pad_table[i].gpio == gpio) {
+            *community = pad_table[i].community;
+            *offset = pad_table[i].offset;
+            return MRAA_SUCCESS;
+        }
+    }
+    // raw pins were not known at init, resolve them the slow way
+    return mraa_intel_pad_resolve(gpio, community, offset);
+}
+
+static int
+mraa_intel_chv_mmap_read(mraa_gpio_context dev)
+{
+    uint32_t ctrl = *dev->mmap_reg;
+    // the rx buffer is off on output only pads, report what is driven
+    if ((ctrl & CHV_GPIOCFG_MASK) == CHV_GPIOCFG_TX_ONLY) {
+        return (ctrl & CHV_TX_STATE) ? 1 : 0;
+    }
+    return (ctrl & CHV_RX_STATE) ? 1 : 0;
+}
+
+static mraa_result_t
+mraa_intel_pad_mmap_setup(mraa_gpio_context dev, mraa_boolean_t en)
+{
+    int community;
+    uint32_t offset;
+
+    if (dev == NULL) {
+        syslog(LOG_ERR, "pad mmap: context not valid");
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+
+    if (mraa_intel_pad_lookup(dev->pin, &community, &offset) != MRAA_SUCCESS) {
+        syslog(LOG_WARNING, "pad mmap: gpio%i is not a soc pad, mmap not available", dev->pin);
+        return MRAA_ERROR_FEATURE_NOT_SUPPORTED;
+    }
+
+    // the kernel owns the other bits of the pad register, writes go read-modify-write
+    mraa_result_t ret = mraa_gpio_mmap_setup(&communities[community].desc, dev, offset / PAD_REG_STRIDE, en);
+    if (ret == MRAA_SUCCESS && en && pad_soc == MRAA_INTEL_PAD_CHERRYVIEW) {
+        dev->mmap_read = &mraa_intel_chv_mmap_read;
+    }
+    return ret;
+}
+
+mraa_result_t
+mraa_intel_pad_mmap_init(mraa_board_t* board, mraa_intel_pad_soc_t soc)
+{
+    int i;
+
+    if (board == NULL || board->adv_func == NULL) {
+        return MRAA_ERROR_INVALID_HANDLE;
+    }
+
+    // a previous init may have run before mraa_deinit()
+    free(pad_table);
+    pad_table = NULL;
+    pad_table_size = 0;
+    num_ranges = 0;
+
+    pad_soc = soc;
+    num_communities = soc == MRAA_INTEL_PAD_BAYTRAIL ? 3 : 4;
+    for (i = 0; i < num_communities; i++) {
+        pad_community_t* com = &communities[i];
+        snprintf(com->name, sizeof(com->name), "%s:%02hhu",
+                 soc == MRAA_INTEL_PAD_BAYTRAIL ? "INT33FC" : "INT33FF", (unsigned char) i);
+        com->gpio_base = mraa_find_gpiochip_base(com->name, &com->ngpio);
+        com->pads = NULL;
+        com->num_pads = 0;
+        memset(&com->desc, 0, sizeof(com->desc));
+        com->desc.name = "pad";
+        com->desc.path = MMAP_PATH;
+        com->desc.iomem_name = com->name;
+        com->desc.pins_per_bank = 1;
+        com->desc.bank_stride = PAD_REG_STRIDE;
+        com->desc.data_in = 0;
+        com->desc.data_out = 0;
+        com->desc.set = MRAA_GPIO_MMAP_NONE;
+        com->desc.clear = MRAA_GPIO_MMAP_NONE;
+        com->desc.dir = MRAA_GPIO_MMAP_NONE;
+        com->desc.in_mask = soc == MRAA_INTEL_PAD_BAYTRAIL ? BYT_LEVEL : CHV_RX_STATE;
+        com->desc.out_mask = soc == MRAA_INTEL_PAD_BAYTRAIL ? BYT_LEVEL : CHV_TX_STATE;
+    }
+    if (soc == MRAA_INTEL_PAD_BAYTRAIL) {
+        communities[0].pads = byt_score_pads;
+        communities[0].num_pads = sizeof(byt_score_pads) / sizeof(byt_score_pads[0]);
+        communities[1].pads = byt_ncore_pads;
+        communities[1].num_pads = sizeof(byt_ncore_pads) / sizeof(byt_ncore_pads[0]);
+        communities[2].pads = byt_sus_pads;
+        communities[2].num_pads = sizeof(byt_sus_pads) / sizeof(byt_sus_pads[0]);
+    } else {
+        mraa_intel_pad_load_ranges();
+    }
+
+    // resolve the header once so mmap setup is a table lookup
+    pad_table = (pad_entry_t*) calloc(board->phy_pin_count, sizeof(pad_entry_t));
+    if (pad_table == NULL) {
+        syslog(LOG_ERR, "pad mmap: Failed to allocate memory for pad table");
+        return MRAA_ERROR_NO_RESOURCES;
+    }
+    for (i = 0; i < board->phy_pin_count; i++) {
+        pad_entry_t* entry = &pad_table[pad_table_size];
+        if (!board->pins[i].capabilites.gpio) {
+            continue;
+        }
+        entry->gpio = board->pins[i].gpio.pinmap;
+        if (mraa_intel_pad_resolve(entry->gpio, &entry->community, &entry->offset) == MRAA_SUCCESS) {
+            pad_table_size++;
+        }
+    }
+    syslog(LOG_DEBUG, "pad mmap: %d of %d pins resolved to soc pads", pad_table_size, board->phy_pin_count);
+
+    board->adv_func->gpio_mmap_setup = &mraa_intel_pad_mmap_setup;
+    board->adv_func->gpio_mmap_setup_multi = &mraa_gpio_mmap_setup_multi;
+    return MRAA_SUCCESS;
+}
@@ -30,6 +30,8 @@
 
 #include "common.h"
 #include "x86/up.h"
+#include "x86/intel_pad_mmap.h"
+#include "gpio/gpio_chardev.h"
 
 #define PLATFORM_NAME "UP"
 #define I2C_BUS_DEFAULT 1
@@ -106,6 +108,7 @@ mraa_up_board()
         free(b->pins);
         goto error;
     }
+    b->adv_func->gpio_chardev_lookup = &mraa_gpio_chardev_lookup_sysfs;
 
     if (uname(&running_uname) != 0) {
         free(b->pins);
@@ -206,6 +209,10 @@ mraa_up_board()
     get_pin_index(b, "UART2_TX", &(b->uart_dev[1].tx));
     b->uart_dev[1].device_path = "/dev/ttyS2";
 
+    // header lines owned by the CPLD gpiochip are not SoC pads and keep the
+    // sysfs path, SoC gpios used raw get the pad registers
+    mraa_intel_pad_mmap_init(b, MRAA_INTEL_PAD_CHERRYVIEW);
+
     return b;
 error:
     syslog(LOG_CRIT, "up: Platform failed to initialise");
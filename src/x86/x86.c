@@ -47,7 +47,7 @@ mraa_x86_platform()
     char* line = NULL;
     // let getline allocate memory for *line
     size_t len = 0;
-    FILE* fh = fopen("/sys/devices/virtual/dmi/id/board_name", "r");
+    FILE* fh = mraa_fs_fopen("/sys/devices/virtual/dmi/id/board_name", "r");
     if (fh != NULL) {
         if (getline(&line, &len, fh) != -1) {
             if (strncmp(line, "GalileoGen2", 11) == 0) {
@@ -94,7 +94,7 @@ mraa_x86_platform()
         }
         fclose(fh);
     } else {
-        fh = fopen("/proc/cmdline", "r");
+        fh = mraa_fs_fopen("/proc/cmdline", "r");
         if (fh != NULL) {
             if (getline(&line, &len, fh) != -1) {
                 if (strstr(line, "sf3gr_mrd_version=P2.0")) {
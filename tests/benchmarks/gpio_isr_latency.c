@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Edge to callback latency of the gpio interrupt path.
+ *
+ * With -o and -i an output pin wired back to an input pin is toggled and
+ * the time until mraa reports the edge is recorded, for a dedicated isr
+ * thread, the shared dispatcher and the event ring. Which backend serves
+ * the input (sysfs, gpiochip, Firmata, FT4222) depends on the pin, run once
+ * per pin of interest and tell the runs apart with -l.
+ *
+ * Without pins the run needs the mock platform, where every gpio raises
+ * interrupts on itself through an eventfd standing in for the value file,
+ * and MOCK_PIN is both the output and the input. The edges then go through
+ * the same isr thread, dispatcher and event ring code as on a board, which
+ * keeps them measured when no hardware is around. Mock pins have no pollable
+ * fd, so the dispatcher polls them and its latency is the poll interval.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <semaphore.h>
+
+#include "mraa/gpio.h"
+
+#define DEFAULT_SAMPLES 1000
+#define EDGE_TIMEOUT_S 1
+#define MOCK_PIN 0
+
+typedef struct {
+    uint64_t* samples; /**< latencies in ns */
+    int count; /**< samples recorded */
+    int size; /**< capacity of samples */
+    volatile uint64_t start_ns; /**< time the current edge was caused */
+    sem_t done; /**< posted by the receiving side */
+} latency_t;
+
+static uint64_t
+now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void
+record(latency_t* lat, uint64_t end_ns)
+{
+    if (lat->count < lat->size) {
+        lat->samples[lat->count++] = end_ns - lat->start_ns;
+    }
+}
+
+static int
+wait_done(latency_t* lat)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += EDGE_TIMEOUT_S;
+    while (sem_timedwait(&lat->done, &ts) != 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int
+compare_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+    return x < y ? -1 : x > y;
+}
+
+static void
+report(const char* label, const char* mode, latency_t* lat)
+{
+    if (lat->count == 0) {
+        printf("%-12s %-14s %8d %10s %10s %10s\n", label, mode, 0, "-", "-", "-");
+        return;
+    }
+    qsort(lat->samples, lat->count, sizeof(uint64_t), compare_u64);
+    printf("%-12s %-14s %8d %10.1f %10.1f %10.1f\n", label, mode, lat->count,
+           lat->samples[lat->count / 2] / 1000.0, lat->samples[(lat->count * 99) / 100] / 1000.0,
+           lat->samples[lat->count - 1] / 1000.0);
+}
+
+static void
+reset(latency_t* lat)
+{
+    lat->count = 0;
+    while (sem_trywait(&lat->done) == 0)
+        ;
+}
+
+/* wired back pins */
+
+static void
+isr_callback(void* args)
+{
+    latency_t* lat = (latency_t*) args;
+    record(lat, now_ns());
+    sem_post(&lat->done);
+}
+
+static int
+run_isr(const char* label, const char* mode, mraa_gpio_context out, mraa_gpio_context in, latency_t* lat, int samples)
+{
+    int i, level = 0;
+
+    reset(lat);
+    if (mraa_gpio_isr(in, MRAA_GPIO_EDGE_BOTH, isr_callback, lat) != MRAA_SUCCESS) {
+        fprintf(stderr, "%s: unable to set isr\n", mode);
+        return -1;
+    }
+    // let the isr thread reach its wait before the first edge
+    usleep(100000);
+    for (i = 0; i < samples; i++) {
+        level ^= 1;
+        lat->start_ns = now_ns();
+        mraa_gpio_write(out, level);
+        if (wait_done(lat) != 0) {
+            fprintf(stderr, "%s: edge %d timed out, is the output wired to the input?\n", mode, i);
+            break;
+        }
+    }
+    mraa_gpio_isr_exit(in);
+    report(label, mode, lat);
+    return lat->count == samples ? 0 : -1;
+}
+
+static int
+run_events(const char* label, mraa_gpio_context out, mraa_gpio_context in, latency_t* lat, int samples)
+{
+    latency_t stamped;
+    mraa_gpio_event_t ev;
+    int i, level = 0;
+
+    stamped.samples = (uint64_t*) calloc(samples, sizeof(uint64_t));
+    stamped.size = samples;
+    stamped.count = 0;
+    reset(lat);
+    if (stamped.samples == NULL || mraa_gpio_events_enable(in, MRAA_GPIO_EDGE_BOTH, 0) != MRAA_SUCCESS) {
+        fprintf(stderr, "events: unable to enable events\n");
+        free(stamped.samples);
+        return -1;
+    }
+    usleep(100000);
+    mraa_gpio_events_read(in, &ev, 1, 0);
+    for (i = 0; i < samples; i++) {
+        level ^= 1;
+        lat->start_ns = stamped.start_ns = now_ns();
+        mraa_gpio_write(out, level);
+        if (mraa_gpio_events_read(in, &ev, 1, EDGE_TIMEOUT_S * 1000) != 1) {
+            fprintf(stderr, "events: edge %d timed out, is the output wired to the input?\n", i);
+            break;
+        }
+        record(lat, now_ns());
+        record(&stamped, ev.timestamp_ns);
+    }
+    mraa_gpio_events_disable(in);
+    report(label, "events-read", lat);
+    report(label, "events-stamp", &stamped);
+    free(stamped.samples);
+    return lat->count == samples ? 0 : -1;
+}
+
+int
+main(int argc, char** argv)
+{
+    int samples = DEFAULT_SAMPLES;
+    int out_pin = -1, in_pin = -1, raw = 0, opt, ret = EXIT_SUCCESS;
+    const char* label = "gpio";
+    latency_t lat;
+
+    while ((opt = getopt(argc, argv, "n:o:i:l:r")) != -1) {
+        switch (opt) {
+            case 'n':
+                samples = atoi(optarg);
+                break;
+            case 'o':
+                out_pin = atoi(optarg);
+                break;
+            case 'i':
+                in_pin = atoi(optarg);
+                break;
+            case 'l':
+                label = optarg;
+                break;
+            case 'r':
+                raw = 1;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n samples] [-o output pin -i input pin [-r] [-l label]]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (samples <= 0 || (out_pin < 0) != (in_pin < 0)) {
+        fprintf(stderr, "%s: -o and -i go together, -n must be positive\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    memset(&lat, 0, sizeof(lat));
+    lat.samples = (uint64_t*) calloc(samples, sizeof(uint64_t));
+    lat.size = samples;
+    if (lat.samples == NULL || sem_init(&lat.done, 0, 0) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    if (out_pin < 0) {
+        if (mraa_get_platform_type() != MRAA_MOCK_PLATFORM) {
+            fprintf(stderr, "%s: give -o and -i, or set MRAA_MOCK_PLATFORM to run on the mock board\n", argv[0]);
+            free(lat.samples);
+            return EXIT_FAILURE;
+        }
+        out_pin = in_pin = MOCK_PIN;
+        label = "mock";
+    }
+
+    printf("%-12s %-14s %8s %10s %10s %10s\n", "source", "mode", "samples", "p50 us", "p99 us", "max us");
+    mraa_gpio_context out = raw ? mraa_gpio_init_raw(out_pin) : mraa_gpio_init(out_pin);
+    // a mock pin interrupts itself, a single context is both ends
+    mraa_gpio_context in = in_pin == out_pin ? out : raw ? mraa_gpio_init_raw(in_pin) : mraa_gpio_init(in_pin);
+    if (out == NULL || in == NULL || mraa_gpio_dir(out, MRAA_GPIO_OUT_LOW) != MRAA_SUCCESS ||
+        (in != out && mraa_gpio_dir(in, MRAA_GPIO_IN) != MRAA_SUCCESS)) {
+        fprintf(stderr, "unable to set up pins %d and %d\n", out_pin, in_pin);
+        ret = EXIT_FAILURE;
+    } else {
+        if (run_isr(label, "thread", out, in, &lat, samples) != 0) {
+            ret = EXIT_FAILURE;
+        }
+        if (mraa_gpio_isr_dispatcher_start(1) == MRAA_SUCCESS) {
+            if (run_isr(label, "dispatcher", out, in, &lat, samples) != 0) {
+                ret = EXIT_FAILURE;
+            }
+            mraa_gpio_isr_dispatcher_stop();
+        }
+        if (run_events(label, out, in, &lat, samples) != 0) {
+            ret = EXIT_FAILURE;
+        }
+    }
+    if (in != NULL && in != out) {
+        mraa_gpio_close(in);
+    }
+    if (out != NULL) {
+        mraa_gpio_close(out);
+    }
+
+    sem_destroy(&lat.done);
+    free(lat.samples);
+    return ret;
+}
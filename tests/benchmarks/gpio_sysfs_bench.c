@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Compares the sysfs value access of mraa before and after the switch to
+ * pread/pwrite. The old path is reproduced here, the new path is what
+ * mraa_gpio_read/write do today. Runs against any value file, a temporary
+ * file by default so it works without hardware, or a real gpio with -p.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "mraa/gpio.h"
+
+#define DEFAULT_ITERATIONS 100000
+
+typedef struct {
+    const char* name; /**< printed in the report */
+    int syscalls; /**< syscalls made by one call */
+    int (*op)(int fd, int i);
+} bench_t;
+
+static uint64_t
+now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int
+legacy_read(int fd, int i)
+{
+    char bu[2];
+    lseek(fd, 0, SEEK_SET);
+    if (read(fd, bu, 2) != 2) {
+        return -1;
+    }
+    lseek(fd, 0, SEEK_SET);
+    return (int) strtol(bu, NULL, 10);
+}
+
+static int
+legacy_write(int fd, int i)
+{
+    char bu[64];
+    if (lseek(fd, 0, SEEK_SET) == -1) {
+        return -1;
+    }
+    int length = snprintf(bu, sizeof(bu), "%d", i & 1);
+    return write(fd, bu, length) == -1 ? -1 : 0;
+}
+
+static int
+positioned_read(int fd, int i)
+{
+    char bu[2];
+    if (pread(fd, bu, 2, 0) != 2 || (bu[0] | 1) != '1') {
+        return -1;
+    }
+    return bu[0] & 1;
+}
+
+static int
+positioned_write(int fd, int i)
+{
+    static const char levels[2] = { '0', '1' };
+    return pwrite(fd, &levels[i & 1], 1, 0) == -1 ? -1 : 0;
+}
+
+static mraa_gpio_context gpio = NULL;
+
+static int
+mraa_read(int fd, int i)
+{
+    return mraa_gpio_read(gpio);
+}
+
+static int
+mraa_write(int fd, int i)
+{
+    return mraa_gpio_write(gpio, i & 1) == MRAA_SUCCESS ? 0 : -1;
+}
+
+static int
+run(const bench_t* b, int fd, int iterations)
+{
+    int i;
+
+    // warm the page cache and the fd position before timing
+    for (i = 0; i < 16; i++) {
+        b->op(fd, i);
+    }
+    uint64_t start = now_ns();
+    for (i = 0; i < iterations; i++) {
+        if (b->op(fd, i) < 0) {
+            fprintf(stderr, "%s: failed at iteration %d\n", b->name, i);
+            return -1;
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    printf("%-16s %10d %12.1f %12.0f", b->name, iterations, (double) elapsed / iterations,
+           iterations * 1e9 / (double) elapsed);
+    if (b->syscalls > 0) {
+        printf(" %10d\n", b->syscalls);
+    } else {
+        printf(" %10s\n", "-");
+    }
+    return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+    int iterations = DEFAULT_ITERATIONS;
+    int pin = -1;
+    const char* path = NULL;
+    char tmp_path[] = "/tmp/mraa-gpio-benchXXXXXX";
+    int opt, fd, ret = EXIT_SUCCESS;
+
+    while ((opt = getopt(argc, argv, "n:p:")) != -1) {
+        switch (opt) {
+            case 'n':
+                iterations = atoi(optarg);
+                break;
+            case 'p':
+                pin = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n iterations] [-p raw gpio] [value file]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind < argc) {
+        path = argv[optind];
+    }
+
+    if (pin >= 0) {
+        gpio = mraa_gpio_init_raw(pin);
+        if (gpio == NULL) {
+            fprintf(stderr, "unable to open gpio%d\n", pin);
+            return EXIT_FAILURE;
+        }
+        mraa_gpio_dir(gpio, MRAA_GPIO_OUT);
+    }
+
+    if (path != NULL) {
+        fd = open(path, O_RDWR);
+    } else {
+        fd = mkstemp(tmp_path);
+        if (fd != -1 && write(fd, "0\n", 2) != 2) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    if (fd == -1) {
+        perror("open");
+        return EXIT_FAILURE;
+    }
+
+    const bench_t benches[] = {
+        { "legacy read", 3, legacy_read },
+        { "pread", 1, positioned_read },
+        { "legacy write", 2, legacy_write },
+        { "pwrite", 1, positioned_write },
+    };
+    const bench_t mraa_benches[] = {
+        { "mraa_gpio_read", 0, mraa_read },
+        { "mraa_gpio_write", 0, mraa_write },
+    };
+
+    printf("%-16s %10s %12s %12s %10s\n", "path", "calls", "ns/call", "calls/s", "syscalls");
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        if (run(&benches[i], fd, iterations) != 0) {
+            ret = EXIT_FAILURE;
+        }
+    }
+    if (gpio != NULL) {
+        for (size_t i = 0; i < sizeof(mraa_benches) / sizeof(mraa_benches[0]); i++) {
+            if (run(&mraa_benches[i], fd, iterations) != 0) {
+                ret = EXIT_FAILURE;
+            }
+        }
+        mraa_gpio_close(gpio);
+    }
+
+    close(fd);
+    if (path == NULL) {
+        unlink(tmp_path);
+    }
+    return ret;
+}
@@ -0,0 +1,647 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Measures throughput and per-call latency of the hot paths of the public C
+ * API and prints the results as JSON, one object per run, so they can be
+ * stored and compared across releases and platforms.
+ *
+ * Every subsystem is benchmarked on the resource given on the command line
+ * and skipped when none is given. On the mock platform (MRAA_MOCK_PLATFORM
+ * set in the environment) the mock board resources are used by default, so
+ * the whole suite runs without hardware. Writes go to the devices as is, only
+ * point the i2c, spi and uart benchmarks at buses where that is harmless. The
+ * uart benchmark expects TX wired to RX.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "mraa.h"
+#include "mraa/iio.h"
+
+#define DEFAULT_ITERATIONS 10000
+#define WARMUP_ITERATIONS 16
+#define UART_TIMEOUT_MS 1000
+
+typedef struct {
+    int gpio; /**< gpio pin */
+    int i2c_bus; /**< i2c bus */
+    int i2c_addr; /**< i2c slave address */
+    int i2c_reg; /**< register read and written on the slave */
+    int spi_bus; /**< spi bus */
+    int uart; /**< uart index, TX wired to RX */
+    int aio; /**< aio channel */
+    int pwm; /**< pwm pin */
+    int iio; /**< iio device */
+} bench_resources_t;
+
+typedef struct {
+    void* dev; /**< context of the subsystem under test */
+    uint8_t* tx; /**< transfer buffer */
+    uint8_t* rx; /**< receive buffer */
+    int size; /**< bytes moved by one call */
+    int reg; /**< i2c register */
+    mraa_iio_channel* channels; /**< iio scan layout */
+    int channel_count; /**< entries in channels */
+} bench_ctx_t;
+
+typedef int (*bench_op_t)(bench_ctx_t* ctx, int i);
+
+static const char* filter = NULL;
+static FILE* out = NULL;
+static int iterations = DEFAULT_ITERATIONS;
+static int results = 0;
+static int failures = 0;
+static uint64_t* samples = NULL;
+static volatile int64_t decode_sink;
+
+static uint64_t
+now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int
+cmp_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*) a;
+    uint64_t y = *(const uint64_t*) b;
+    return x < y ? -1 : x > y;
+}
+
+static mraa_boolean_t
+selected(const char* name)
+{
+    return filter == NULL || strstr(name, filter) != NULL;
+}
+
+static void
+result_begin(const char* group, const char* name)
+{
+    fprintf(out, "%s\n    { \"group\": \"%s\", \"name\": \"%s\"", results++ ? "," : "", group, name);
+}
+
+static void
+skip(const char* group, const char* name, const char* reason)
+{
+    if (!selected(name)) {
+        return;
+    }
+    result_begin(group, name);
+    fprintf(out, ", \"skipped\": \"%s\" }", reason);
+}
+
+/*
+ * Runs op n times, timing every call on its own. n is divided by scale for
+ * the slow paths so a run stays in the same ballpark across subsystems.
+ */
+static void
+run(const char* group, const char* name, bench_op_t op, bench_ctx_t* ctx, int scale)
+{
+    int n = iterations / scale > 0 ? iterations / scale : 1;
+    int i;
+
+    if (!selected(name)) {
+        return;
+    }
+    result_begin(group, name);
+
+    for (i = 0; i < WARMUP_ITERATIONS && i < n; i++) {
+        op(ctx, i);
+    }
+    uint64_t start = now_ns();
+    for (i = 0; i < n; i++) {
+        uint64_t t = now_ns();
+        if (op(ctx, i) < 0) {
+            fprintf(out, ", \"failed\": \"iteration %d\" }", i);
+            failures++;
+            return;
+        }
+        samples[i] = now_ns() - t;
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    qsort(samples, n, sizeof(uint64_t), cmp_u64);
+    fprintf(out, ", \"iterations\": %d, \"ns_per_op\": %.1f, \"ops_per_s\": %.0f", n,
+            (double) elapsed / n, n * 1e9 / (double) elapsed);
+    fprintf(out, ", \"min_ns\": %llu, \"p50_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu",
+            (unsigned long long) samples[0], (unsigned long long) samples[n / 2],
+            (unsigned long long) samples[(int) (n * 0.99)], (unsigned long long) samples[n - 1]);
+    if (ctx->size > 0) {
+        fprintf(out, ", \"bytes_per_op\": %d, \"bytes_per_s\": %.0f", ctx->size,
+                (double) ctx->size * n * 1e9 / (double) elapsed);
+    }
+    fprintf(out, " }");
+}
+
+/* gpio */
+
+static int
+gpio_read_op(bench_ctx_t* ctx, int i)
+{
+    return mraa_gpio_read((mraa_gpio_context) ctx->dev);
+}
+
+static int
+gpio_write_op(bench_ctx_t* ctx, int i)
+{
+    return mraa_gpio_write((mraa_gpio_context) ctx->dev, i & 1) == MRAA_SUCCESS ? 0 : -1;
+}
+
+static void
+bench_gpio(int pin)
+{
+    bench_ctx_t ctx = { 0 };
+
+    if (pin < 0) {
+        skip("gpio", "gpio_read_sysfs", "no gpio");
+        skip("gpio", "gpio_write_sysfs", "no gpio");
+        skip("gpio", "gpio_read_mmap", "no gpio");
+        skip("gpio", "gpio_write_mmap", "no gpio");
+        return;
+    }
+    mraa_gpio_context gpio = mraa_gpio_init(pin);
+    if (gpio == NULL || mraa_gpio_dir(gpio, MRAA_GPIO_OUT) != MRAA_SUCCESS) {
+        skip("gpio", "gpio_read_sysfs", "gpio init failed");
+        skip("gpio", "gpio_write_sysfs", "gpio init failed");
+        skip("gpio", "gpio_read_mmap", "gpio init failed");
+        skip("gpio", "gpio_write_mmap", "gpio init failed");
+        if (gpio != NULL) {
+            mraa_gpio_close(gpio);
+        }
+        return;
+    }
+    ctx.dev = gpio;
+
+    run("gpio", "gpio_read_sysfs", gpio_read_op, &ctx, 1);
+    run("gpio", "gpio_write_sysfs", gpio_write_op, &ctx, 1);
+    if (mraa_gpio_use_mmaped(gpio, 1) == MRAA_SUCCESS) {
+        run("gpio", "gpio_read_mmap", gpio_read_op, &ctx, 1);
+        run("gpio", "gpio_write_mmap", gpio_write_op, &ctx, 1);
+        mraa_gpio_use_mmaped(gpio, 0);
+    } else {
+        skip("gpio", "gpio_read_mmap", "mmap not supported");
+        skip("gpio", "gpio_write_mmap", "mmap not supported");
+    }
+    mraa_gpio_close(gpio);
+}
+
+/* i2c */
+
+static int
+i2c_read_byte_op(bench_ctx_t* ctx, int i)
+{
+    return mraa_i2c_read_byte((mraa_i2c_context) ctx->dev);
+}
+
+static int
+i2c_write_byte_op(bench_ctx_t* ctx, int i)
+{
+    return mraa_i2c_write_byte((mraa_i2c_context) ctx->dev, (uint8_t) ctx->reg) == MRAA_SUCCESS ? 0 : -1;
+}
+
+static int
+i2c_read_byte_data_op(bench_ctx_t* ctx, int i)
+{
+    return mraa_i2c_read_byte_data((mraa_i2c_context) ctx->dev, (uint8_t) ctx->reg);
+}
+
+static int
+i2c_write_byte_data_op(bench_ctx_t* ctx, int i)
+{
+    return mraa_i2c_write_byte_data((mraa_i2c_context) ctx->dev, (uint8_t) i, (uint8_t) ctx->reg) == MRAA_SUCCESS ? 0 : -1;
+}
+
+static int
+i2c_read_word_data_op(bench_ctx_t* ctx, int i)
+{
+    return mraa_i2c_read_word_data((mraa_i2c_context) ctx->dev, (uint8_t) ctx->reg);
+}
+
+static int
+i2c_write_word_data_op(bench_ctx_t* ctx, int i)
+{
+    return mraa_i2c_write_word_data((mraa_i2c_context) ctx->dev, (uint16_t) i, (uint8_t) ctx->reg) == MRAA_SUCCESS ? 0 : -1;
+}
+
+static int
+i2c_read_block_op(bench_ctx_t* ctx, int i)
+{
+    return mraa_i2c_read_bytes_data((mraa_i2c_context) ctx->dev, (uint8_t) ctx->reg, ctx->rx, ctx->size) ==
+           ctx->size ? 0 : -1;
+}
+
+static int
+i2c_write_block_op(bench_ctx_t* ctx, int i)
+{
+    // register address first, as a block write to the slave
+    ctx->tx[0] = (uint8_t) ctx->reg;
+    return mraa_i2c_write((mraa_i2c_context) ctx->dev, ctx->tx, ctx->size + 1) == MRAA_SUCCESS ? 0 : -1;
+}
+
+static void
+bench_i2c(int bus, int addr, int reg)
+{
+    static const char* names[] = { "i2c_read_byte", "i2c_write_byte", "i2c_read_byte_data",
+                                   "i2c_write_byte_data", "i2c_read_word_data", "i2c_write_word_data",
+                                   "i2c_read_block_32", "i2c_write_block_32" };
+    static const bench_op_t ops[] = { i2c_read_byte_op, i2c_write_byte_op, i2c_read_byte_data_op,
+                                      i2c_write_byte_data_op, i2c_read_word_data_op, i2c_write_word_data_op,
+                                      i2c_read_block_op, i2c_write_block_op };
+    uint8_t tx[33] = { 0 };
+    uint8_t rx[32];
+    bench_ctx_t ctx = { 0 };
+    size_t i;
+
+    mraa_i2c_context i2c = NULL;
+    if (bus >= 0 && addr >= 0) {
+        i2c = mraa_i2c_init(bus);
+        if (i2c != NULL && mraa_i2c_address(i2c, (uint8_t) addr) != MRAA_SUCCESS) {
+            mraa_i2c_stop(i2c);
+            i2c = NULL;
+        }
+    }
+    for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (i2c == NULL) {
+            skip("i2c", names[i], bus < 0 || addr < 0 ? "no i2c slave" : "i2c init failed");
+            continue;
+        }
+        ctx.dev = i2c;
+        ctx.reg = reg;
+        ctx.tx = tx;
+        ctx.rx = rx;
+        // byte and word ops are counted as calls, block ops also as bytes
+        ctx.size = ops[i] == i2c_read_block_op || ops[i] == i2c_write_block_op ? (int) sizeof(rx) : 0;
+        run("i2c", names[i], ops[i], &ctx, 1);
+    }
+    if (i2c != NULL) {
+        mraa_i2c_stop(i2c);
+    }
+}
+
+/* spi */
+
+static int
+spi_transfer_op(bench_ctx_t* ctx, int i)
+{
+    return mraa_spi_transfer_buf((mraa_spi_context) ctx->dev, ctx->tx, ctx->rx, ctx->size) == MRAA_SUCCESS ? 0 : -1;
+}
+
+static void
+bench_spi(int bus)
+{
+    static const int sizes[] = { 1, 4, 16, 64, 256, 1024, 4096 };
+    char name[64];
+    bench_ctx_t ctx = { 0 };
+    size_t i;
+
+    mraa_spi_context spi = bus >= 0 ? mraa_spi_init(bus) : NULL;
+    uint8_t* tx = calloc(1, 4096);
+    uint8_t* rx = calloc(1, 4096);
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        snprintf(name, sizeof(name), "spi_transfer_%d", sizes[i]);
+        if (spi == NULL || tx == NULL || rx == NULL) {
+            skip("spi", name, bus < 0 ? "no spi bus" : "spi init failed");
+            continue;
+        }
+        ctx.dev = spi;
+        ctx.tx = tx;
+        ctx.rx = rx;
+        ctx.size = sizes[i];
+        // the largest transfers take long on real buses
+        run("spi", name, spi_transfer_op, &ctx, sizes[i] >= 1024 ? 10 : 1);
+    }
+    if (spi != NULL) {
+        mraa_spi_stop(spi);
+    }
+    free(tx);
+    free(rx);
+}
+
+/* uart */
+
+static int
+uart_loopback_op(bench_ctx_t* ctx, int i)
+{
+    mraa_uart_context uart = (mraa_uart_context) ctx->dev;
+    int received = 0;
+
+    if (mraa_uart_write(uart, (const char*) ctx->tx, ctx->size) != ctx->size) {
+        return -1;
+    }
+    while (received < ctx->size) {
+        if (!mraa_uart_data_available(uart, UART_TIMEOUT_MS)) {
+            return -1;
+        }
+        int ret = mraa_uart_read(uart, (char*) ctx->rx + received, ctx->size - received);
+        if (ret <= 0) {
+            return -1;
+        }
+        received += ret;
+    }
+    return 0;
+}
+
+static void
+bench_uart(int index)
+{
+    static const int sizes[] = { 1, 64, 1024 };
+    char name[64];
+    uint8_t tx[1024];
+    uint8_t rx[1024];
+    bench_ctx_t ctx = { 0 };
+    size_t i;
+
+    mraa_uart_context uart = index >= 0 ? mraa_uart_init(index) : NULL;
+    if (uart != NULL) {
+        mraa_uart_set_baudrate(uart, 115200);
+        mraa_uart_set_mode(uart, 8, MRAA_UART_PARITY_NONE, 1);
+        mraa_uart_flush(uart);
+    }
+    for (i = 0; i < sizeof(tx); i++) {
+        tx[i] = (uint8_t) i;
+    }
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        snprintf(name, sizeof(name), "uart_loopback_%d", sizes[i]);
+        if (uart == NULL) {
+            skip("uart", name, index < 0 ? "no uart" : "uart init failed");
+            continue;
+        }
+        ctx.dev = uart;
+        ctx.tx = tx;
+        ctx.rx = rx;
+        ctx.size = sizes[i];
+        run("uart", name, uart_loopback_op, &ctx, sizes[i] >= 64 ? 100 : 10);
+    }
+    if (uart != NULL) {
+        mraa_uart_stop(uart);
+    }
+}
+
+/* aio */
+
+static int
+aio_read_op(bench_ctx_t* ctx, int i)
+{
+    return mraa_aio_read((mraa_aio_context) ctx->dev);
+}
+
+static int
+aio_read_float_op(bench_ctx_t* ctx, int i)
+{
+    return mraa_aio_read_float((mraa_aio_context) ctx->dev) < 0 ? -1 : 0;
+}
+
+static void
+bench_aio(int channel)
+{
+    bench_ctx_t ctx = { 0 };
+
+    mraa_aio_context aio = channel >= 0 ? mraa_aio_init(channel) : NULL;
+    if (aio == NULL) {
+        skip("aio", "aio_read", channel < 0 ? "no aio" : "aio init failed");
+        skip("aio", "aio_read_float", channel < 0 ? "no aio" : "aio init failed");
+        return;
+    }
+    ctx.dev = aio;
+    run("aio", "aio_read", aio_read_op, &ctx, 1);
+    run("aio", "aio_read_float", aio_read_float_op, &ctx, 1);
+    mraa_aio_close(aio);
+}
+
+/* pwm */
+
+static int
+pwm_write_op(bench_ctx_t* ctx, int i)
+{
+    return mraa_pwm_write((mraa_pwm_context) ctx->dev, (i & 1) ? 0.75f : 0.25f) == MRAA_SUCCESS ? 0 : -1;
+}
+
+static int
+pwm_pulsewidth_op(bench_ctx_t* ctx, int i)
+{
+    return mraa_pwm_pulsewidth_us((mraa_pwm_context) ctx->dev, (i & 1) ? 750 : 250) == MRAA_SUCCESS ? 0 : -1;
+}
+
+static void
+bench_pwm(int pin)
+{
+    bench_ctx_t ctx = { 0 };
+
+    mraa_pwm_context pwm = pin >= 0 ? mraa_pwm_init(pin) : NULL;
+    if (pwm == NULL || mraa_pwm_period_us(pwm, 1000) != MRAA_SUCCESS) {
+        skip("pwm", "pwm_write", pin < 0 ? "no pwm" : "pwm init failed");
+        skip("pwm", "pwm_pulsewidth_us", pin < 0 ? "no pwm" : "pwm init failed");
+        if (pwm != NULL) {
+            mraa_pwm_close(pwm);
+        }
+        return;
+    }
+    ctx.dev = pwm;
+    run("pwm", "pwm_write", pwm_write_op, &ctx, 1);
+    run("pwm", "pwm_pulsewidth_us", pwm_pulsewidth_op, &ctx, 1);
+    mraa_pwm_close(pwm);
+}
+
+/* iio */
+
+static int
+iio_read_attr_op(bench_ctx_t* ctx, int i)
+{
+    int value;
+    return mraa_iio_read_int((mraa_iio_context) ctx->dev, "in_voltage0_raw", &value) == MRAA_SUCCESS ? 0 : -1;
+}
+
+/*
+ * Decodes one scan of the trigger buffer the way a consumer of
+ * mraa_iio_trigger_buffer does, with the layout from mraa_iio_get_channels.
+ */
+static int
+iio_decode_op(bench_ctx_t* ctx, int i)
+{
+    int64_t sum = 0;
+    int c;
+
+    for (c = 0; c < ctx->channel_count; c++) {
+        const mraa_iio_channel* chan = &ctx->channels[c];
+        const uint8_t* p = ctx->tx + chan->location;
+        uint64_t raw = 0;
+        int b;
+
+        if (!chan->enabled) {
+            continue;
+        }
+        for (b = 0; b < chan->bytes; b++) {
+            int shift = chan->lendian ? b * 8 : (chan->bytes - 1 - b) * 8;
+            raw |= (uint64_t) p[b] << shift;
+        }
+        raw = (raw >> chan->shift) & (uint64_t) (unsigned int) chan->mask;
+        if (chan->signedd && chan->bits_used < 64 && (raw & (1ULL << (chan->bits_used - 1)))) {
+            sum += (int64_t) (raw | ~((1ULL << chan->bits_used) - 1));
+        } else {
+            sum += (int64_t) raw;
+        }
+    }
+    // keep the decode from being optimised away
+    decode_sink = sum;
+    return 0;
+}
+
+static void
+bench_iio(int device)
+{
+    uint8_t scan[256];
+    bench_ctx_t ctx = { 0 };
+    size_t i;
+
+    mraa_iio_context iio = device >= 0 ? mraa_iio_init(device) : NULL;
+    if (iio == NULL) {
+        skip("iio", "iio_read_attr", device < 0 ? "no iio device" : "iio init failed");
+        skip("iio", "iio_buffer_decode", device < 0 ? "no iio device" : "iio init failed");
+        return;
+    }
+    ctx.dev = iio;
+    run("iio", "iio_read_attr", iio_read_attr_op, &ctx, 1);
+
+    ctx.channels = mraa_iio_get_channels(iio);
+    ctx.channel_count = mraa_iio_get_channel_count(iio);
+    ctx.size = mraa_iio_read_size(iio);
+    if (ctx.channels == NULL || ctx.channel_count <= 0 || ctx.size <= 0 || ctx.size > (int) sizeof(scan)) {
+        skip("iio", "iio_buffer_decode", "no buffered channels");
+        return;
+    }
+    for (i = 0; i < sizeof(scan); i++) {
+        scan[i] = (uint8_t) (i * 37);
+    }
+    ctx.tx = scan;
+    run("iio", "iio_buffer_decode", iio_decode_op, &ctx, 1);
+}
+
+static void
+usage(const char* prog)
+{
+    fprintf(stderr, "usage: %s [-n iterations] [-f filter] [-o file] [-g gpio] [-i i2c bus] [-a i2c address]\n"
+                    "       [-r i2c register] [-s spi bus] [-u uart] [-A aio] [-p pwm] [-d iio device]\n",
+            prog);
+}
+
+int
+main(int argc, char** argv)
+{
+    bench_resources_t res = { -1, -1, -1, 0, -1, -1, -1, -1, -1 };
+    const char* path = NULL;
+    int opt;
+
+    if (mraa_get_platform_type() == MRAA_MOCK_PLATFORM) {
+        res.gpio = 1;
+        res.i2c_bus = 0;
+        res.i2c_addr = 0x33;
+        res.spi_bus = 0;
+        res.uart = 0;
+        res.aio = 0;
+        res.pwm = 3;
+        res.iio = 0;
+    }
+
+    while ((opt = getopt(argc, argv, "n:f:o:g:i:a:r:s:u:A:p:d:")) != -1) {
+        switch (opt) {
+            case 'n':
+                iterations = atoi(optarg);
+                break;
+            case 'f':
+                filter = optarg;
+                break;
+            case 'o':
+                path = optarg;
+                break;
+            case 'g':
+                res.gpio = atoi(optarg);
+                break;
+            case 'i':
+                res.i2c_bus = atoi(optarg);
+                break;
+            case 'a':
+                res.i2c_addr = (int) strtol(optarg, NULL, 0);
+                break;
+            case 'r':
+                res.i2c_reg = (int) strtol(optarg, NULL, 0);
+                break;
+            case 's':
+                res.spi_bus = atoi(optarg);
+                break;
+            case 'u':
+                res.uart = atoi(optarg);
+                break;
+            case 'A':
+                res.aio = atoi(optarg);
+                break;
+            case 'p':
+                res.pwm = atoi(optarg);
+                break;
+            case 'd':
+                res.iio = atoi(optarg);
+                break;
+            default:
+                usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (iterations <= 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    out = path != NULL ? fopen(path, "w") : stdout;
+    samples = malloc(sizeof(uint64_t) * iterations);
+    if (out == NULL || samples == NULL) {
+        perror(path != NULL ? path : "malloc");
+        return EXIT_FAILURE;
+    }
+
+    fprintf(out, "{\n  \"version\": \"%s\",\n  \"platform\": \"%s\",\n  \"platform_type\": %d,\n",
+            mraa_get_version(), mraa_get_platform_name() != NULL ? mraa_get_platform_name() : "",
+            (int) mraa_get_platform_type());
+    fprintf(out, "  \"timestamp\": %lld,\n  \"iterations\": %d,\n  \"results\": [", (long long) time(NULL), iterations);
+
+    bench_gpio(res.gpio);
+    bench_i2c(res.i2c_bus, res.i2c_addr, res.i2c_reg);
+    bench_spi(res.spi_bus);
+    bench_uart(res.uart);
+    bench_aio(res.aio);
+    bench_pwm(res.pwm);
+    bench_iio(res.iio);
+
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+    free(samples);
+    mraa_deinit();
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Gpio edge counter on the mock platform. Every mock pin is wired to
+ * itself, writing a new level raises an edge on the same pin. The mock
+ * cannot tell rising from falling, so no pulse width is ever known.
+ */
+
+#include "mock_checks.h"
+
+#define EDGE_PIN 0
+
+static void
+ignore_isr(void* args)
+{
+}
+
+static uint64_t
+counter_count(mraa_gpio_context dev)
+{
+    mraa_gpio_counter_t counter;
+    return mraa_gpio_counter_read(dev, &counter, 0) == MRAA_SUCCESS ? counter.count : 0;
+}
+
+static mraa_gpio_context
+edge_pin()
+{
+    mraa_gpio_context dev = mraa_gpio_init(EDGE_PIN);
+    if (dev != NULL && mraa_gpio_dir(dev, MRAA_GPIO_OUT) != MRAA_SUCCESS) {
+        mraa_gpio_close(dev);
+        return NULL;
+    }
+    return dev;
+}
+
+static int
+check_count()
+{
+    mraa_gpio_counter_t counter;
+    uint64_t period_ns;
+    int i;
+
+    mraa_gpio_context dev = edge_pin();
+    CHECK(dev != NULL);
+    CHECK(mraa_gpio_counter_enable(dev, MRAA_GPIO_EDGE_NONE) == MRAA_ERROR_INVALID_PARAMETER);
+    CHECK(mraa_gpio_counter_enable(dev, MRAA_GPIO_EDGE_BOTH) == MRAA_SUCCESS);
+    CHECK(mraa_gpio_counter_enable(dev, MRAA_GPIO_EDGE_BOTH) == MRAA_ERROR_NO_RESOURCES);
+    CHECK(mraa_gpio_events_enable(dev, MRAA_GPIO_EDGE_BOTH, 0) == MRAA_ERROR_NO_RESOURCES);
+    CHECK(mraa_gpio_isr(dev, MRAA_GPIO_EDGE_BOTH, ignore_isr, NULL) != MRAA_SUCCESS);
+    CHECK(mraa_gpio_measure_period(dev, &period_ns) == MRAA_ERROR_UNSPECIFIED);
+
+    for (i = 1; i <= 6; i++) {
+        CHECK(mraa_gpio_write(dev, i & 1) == MRAA_SUCCESS);
+        CHECK_WAIT(counter_count(dev) == (uint64_t) i);
+    }
+    CHECK(mraa_gpio_counter_read(dev, &counter, 0) == MRAA_SUCCESS);
+    CHECK(counter.count == 6);
+    CHECK(counter.timestamp_ns != 0);
+    CHECK(counter.period_ns != 0);
+    CHECK(counter.mean_period_ns != 0);
+    CHECK(mraa_gpio_measure_period(dev, &period_ns) == MRAA_SUCCESS);
+    CHECK(period_ns == counter.mean_period_ns);
+    // the mock does not report the direction of an edge, no pulse is complete
+    CHECK(mraa_gpio_measure_pulsewidth(dev, NULL, NULL) == MRAA_ERROR_UNSPECIFIED);
+
+    // after a reset counting and averaging start over from the last edge
+    CHECK(mraa_gpio_counter_read(dev, &counter, 1) == MRAA_SUCCESS);
+    CHECK(counter.count == 6);
+    CHECK(mraa_gpio_counter_read(dev, &counter, 0) == MRAA_SUCCESS);
+    CHECK(counter.count == 0);
+    CHECK(counter.mean_period_ns == 0);
+    CHECK(mraa_gpio_write(dev, 1) == MRAA_SUCCESS);
+    CHECK_WAIT(counter_count(dev) == 1);
+    CHECK(mraa_gpio_measure_period(dev, &period_ns) == MRAA_SUCCESS);
+
+    CHECK(mraa_gpio_counter_disable(dev) == MRAA_SUCCESS);
+    CHECK(mraa_gpio_counter_read(dev, &counter, 0) == MRAA_ERROR_INVALID_HANDLE);
+    CHECK(mraa_gpio_close(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static const check_t checks[] = {
+    { "count", check_count },
+};
+
+int
+main(int argc, char** argv)
+{
+    return checks_main(checks, sizeof(checks) / sizeof(checks[0]), argc, argv);
+}
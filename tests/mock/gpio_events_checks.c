@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Gpio event ring on the mock platform. Every mock pin is wired to itself,
+ * writing a new level raises an edge on the same pin. The mock cannot tell
+ * rising from falling, events come as MRAA_GPIO_EDGE_BOTH.
+ */
+
+#include "mock_checks.h"
+
+#define EDGE_PIN 0
+#define SMALL_RING 4
+
+static void
+ignore_isr(void* args)
+{
+}
+
+static mraa_gpio_context
+edge_pin()
+{
+    mraa_gpio_context dev = mraa_gpio_init(EDGE_PIN);
+    if (dev != NULL && mraa_gpio_dir(dev, MRAA_GPIO_OUT) != MRAA_SUCCESS) {
+        mraa_gpio_close(dev);
+        return NULL;
+    }
+    return dev;
+}
+
+static int
+check_order()
+{
+    mraa_gpio_event_t ev[SMALL_RING];
+    uint64_t last_ns = 0;
+    int i;
+
+    mraa_gpio_context dev = edge_pin();
+    CHECK(dev != NULL);
+    CHECK(mraa_gpio_events_enable(dev, MRAA_GPIO_EDGE_BOTH, 0) == MRAA_SUCCESS);
+    // the isr of the context is taken
+    CHECK(mraa_gpio_events_enable(dev, MRAA_GPIO_EDGE_BOTH, 0) == MRAA_ERROR_NO_RESOURCES);
+    CHECK(mraa_gpio_isr(dev, MRAA_GPIO_EDGE_BOTH, ignore_isr, NULL) != MRAA_SUCCESS);
+    // nothing to store into, returns at once instead of waiting
+    CHECK(mraa_gpio_events_read(dev, ev, 0, -1) == 0);
+    CHECK(mraa_gpio_events_read(dev, ev, SMALL_RING, 0) == 0);
+
+    for (i = 0; i < 8; i++) {
+        CHECK(mraa_gpio_write(dev, !(i & 1)) == MRAA_SUCCESS);
+        CHECK(mraa_gpio_events_read(dev, ev, SMALL_RING, CHECK_WAIT_MS) == 1);
+        CHECK(ev[0].seqno == (unsigned int) i + 1);
+        CHECK(ev[0].edge == MRAA_GPIO_EDGE_BOTH);
+        CHECK(ev[0].timestamp_ns >= last_ns);
+        last_ns = ev[0].timestamp_ns;
+    }
+    CHECK(mraa_gpio_events_dropped(dev) == 0);
+
+    CHECK(mraa_gpio_events_disable(dev) == MRAA_SUCCESS);
+    CHECK(mraa_gpio_events_read(dev, ev, SMALL_RING, 0) == -1);
+    CHECK(mraa_gpio_events_disable(dev) == MRAA_ERROR_INVALID_PARAMETER);
+    CHECK(mraa_gpio_close(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static int
+check_overflow()
+{
+    mraa_gpio_event_t ev[SMALL_RING * 4];
+    int i, n;
+
+    mraa_gpio_context dev = edge_pin();
+    CHECK(dev != NULL);
+    // rounded up to SMALL_RING
+    CHECK(mraa_gpio_events_enable(dev, MRAA_GPIO_EDGE_BOTH, SMALL_RING - 1) == MRAA_SUCCESS);
+
+    // nobody drains, keep raising edges until the ring overflows
+    for (i = 0; i < CHECK_WAIT_MS && mraa_gpio_events_dropped(dev) == 0; i++) {
+        CHECK(mraa_gpio_write(dev, !(i & 1)) == MRAA_SUCCESS);
+        usleep(1000);
+    }
+    CHECK(mraa_gpio_events_dropped(dev) > 0);
+
+    // the oldest events were kept, the overflowing ones dropped
+    n = mraa_gpio_events_read(dev, ev, SMALL_RING * 4, 0);
+    CHECK(n == SMALL_RING);
+    for (i = 0; i < n; i++) {
+        CHECK(ev[i].seqno == (unsigned int) i + 1);
+    }
+
+    // the next event follows the dropped ones, the gap is their count
+    CHECK(mraa_gpio_write(dev, mraa_gpio_read(dev) == 0) == MRAA_SUCCESS);
+    n = mraa_gpio_events_read(dev, ev, SMALL_RING * 4, CHECK_WAIT_MS);
+    CHECK(n >= 1);
+    CHECK(ev[0].seqno == SMALL_RING + mraa_gpio_events_dropped(dev) + 1);
+
+    CHECK(mraa_gpio_events_disable(dev) == MRAA_SUCCESS);
+    CHECK(mraa_gpio_close(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static const check_t checks[] = {
+    { "order", check_order },
+    { "overflow", check_overflow },
+};
+
+int
+main(int argc, char** argv)
+{
+    return checks_main(checks, sizeof(checks) / sizeof(checks[0]), argc, argv);
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Gpio groups on the mock platform, values written through a group must
+ * read back through it and through the pins themselves.
+ */
+
+#include "mock_checks.h"
+
+static int
+check_read_write()
+{
+    int pins[] = { 0, 1, 2 };
+    int high[] = { 1, 0, 1 };
+    int low[] = { 0, 1, 0 };
+    int values[3];
+
+    mraa_gpio_group_context group = mraa_gpio_init_multi(pins, 3);
+    CHECK(group != NULL);
+    CHECK(mraa_gpio_dir_multi(group, MRAA_GPIO_OUT) == MRAA_SUCCESS);
+
+    CHECK(mraa_gpio_write_multi(group, high) == MRAA_SUCCESS);
+    CHECK(mraa_gpio_read_multi(group, values) == MRAA_SUCCESS);
+    CHECK(memcmp(values, high, sizeof(values)) == 0);
+
+    CHECK(mraa_gpio_write_multi(group, low) == MRAA_SUCCESS);
+    CHECK(mraa_gpio_read_multi(group, values) == MRAA_SUCCESS);
+    CHECK(memcmp(values, low, sizeof(values)) == 0);
+
+    // the pins themselves were written, not only the group
+    mraa_gpio_context dev = mraa_gpio_init(pins[1]);
+    CHECK(dev != NULL);
+    CHECK(mraa_gpio_read(dev) == low[1]);
+    CHECK(mraa_gpio_close(dev) == MRAA_SUCCESS);
+
+    CHECK(mraa_gpio_read_multi(group, NULL) != MRAA_SUCCESS);
+    CHECK(mraa_gpio_close_multi(group) == MRAA_SUCCESS);
+    return 0;
+}
+
+static int
+check_bad_pin()
+{
+    // the i2c pins of the mock are not gpios
+    int pins[] = { 0, 12 };
+
+    CHECK(mraa_gpio_init_multi(pins, 2) == NULL);
+    CHECK(mraa_gpio_init_multi(pins, 0) == NULL);
+    CHECK(mraa_gpio_init_multi(NULL, 2) == NULL);
+
+    // a failed group leaves the pins it took usable
+    mraa_gpio_group_context group = mraa_gpio_init_multi(pins, 1);
+    CHECK(group != NULL);
+    CHECK(mraa_gpio_close_multi(group) == MRAA_SUCCESS);
+    return 0;
+}
+
+static const check_t checks[] = {
+    { "read_write", check_read_write },
+    { "bad_pin", check_bad_pin },
+};
+
+int
+main(int argc, char** argv)
+{
+    return checks_main(checks, sizeof(checks) / sizeof(checks[0]), argc, argv);
+}
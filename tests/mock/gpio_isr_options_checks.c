@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Gpio interrupt filtering on the mock platform. Every mock pin is wired to
+ * itself, writing a new level raises an edge on the same pin. The mock
+ * replaces the interrupt wait, so debouncing there is a hold off.
+ */
+
+#include "mock_checks.h"
+
+#define EDGE_PIN 0
+
+static int isr_calls = 0;
+
+static void
+count_isr(void* args)
+{
+    __atomic_add_fetch(&isr_calls, 1, __ATOMIC_RELAXED);
+}
+
+static int
+isr_count()
+{
+    return __atomic_load_n(&isr_calls, __ATOMIC_RELAXED);
+}
+
+static mraa_gpio_context
+edge_pin()
+{
+    mraa_gpio_context dev = mraa_gpio_init(EDGE_PIN);
+    if (dev != NULL && mraa_gpio_dir(dev, MRAA_GPIO_OUT) != MRAA_SUCCESS) {
+        mraa_gpio_close(dev);
+        return NULL;
+    }
+    return dev;
+}
+
+static int
+check_debounce()
+{
+    mraa_gpio_isr_options_t options = { 300000, 0 };
+    int i;
+
+    mraa_gpio_context dev = edge_pin();
+    CHECK(dev != NULL);
+    CHECK(mraa_gpio_isr_options(dev, &options) == MRAA_SUCCESS);
+    CHECK(mraa_gpio_isr(dev, MRAA_GPIO_EDGE_BOTH, count_isr, NULL) == MRAA_SUCCESS);
+
+    // a bouncing contact, well inside the debounce time
+    for (i = 0; i < 8; i++) {
+        CHECK(mraa_gpio_write(dev, !(i & 1)) == MRAA_SUCCESS);
+        usleep(5000);
+    }
+    CHECK_WAIT(isr_count() >= 1);
+    // the mock only holds off, edges during the first hold off give at most one more call
+    usleep(2 * options.debounce_us);
+    CHECK(isr_count() <= 2);
+
+    CHECK(mraa_gpio_isr_exit(dev) == MRAA_SUCCESS);
+    CHECK(mraa_gpio_close(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static int
+check_rate_limit()
+{
+    mraa_gpio_isr_options_t options = { 0, 10000000 };
+    int i;
+
+    mraa_gpio_context dev = edge_pin();
+    CHECK(dev != NULL);
+    CHECK(mraa_gpio_isr(dev, MRAA_GPIO_EDGE_BOTH, count_isr, NULL) == MRAA_SUCCESS);
+    CHECK(mraa_gpio_isr_options(dev, &options) == MRAA_SUCCESS);
+
+    CHECK(mraa_gpio_write(dev, 1) == MRAA_SUCCESS);
+    CHECK_WAIT(isr_count() == 1);
+    // inside the minimum interval, every one of these is dropped
+    for (i = 0; i < 4; i++) {
+        CHECK(mraa_gpio_write(dev, i & 1) == MRAA_SUCCESS);
+        usleep(20000);
+    }
+    CHECK(isr_count() == 1);
+
+    // without filtering the next edge is delivered
+    CHECK(mraa_gpio_isr_options(dev, NULL) == MRAA_SUCCESS);
+    CHECK(mraa_gpio_write(dev, mraa_gpio_read(dev) == 0) == MRAA_SUCCESS);
+    CHECK_WAIT(isr_count() >= 2);
+
+    CHECK(mraa_gpio_isr_exit(dev) == MRAA_SUCCESS);
+    CHECK(mraa_gpio_close(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static const check_t checks[] = {
+    { "debounce", check_debounce },
+    { "rate_limit", check_rate_limit },
+};
+
+int
+main(int argc, char** argv)
+{
+    return checks_main(checks, sizeof(checks) / sizeof(checks[0]), argc, argv);
+}
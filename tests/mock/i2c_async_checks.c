@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Queued i2c jobs on the mock platform. Bus 0 holds a register file at
+ * SLAVE. Callbacks run one at a time on the worker of the bus, so a
+ * callback that blocks holds every other job back, which lets the checks
+ * queue jobs behind it in a known state.
+ */
+
+#include <semaphore.h>
+
+#include "mock_checks.h"
+
+#define BUS 0
+#define SLAVE 0x33
+#define JOBS 5
+
+static sem_t entered;
+static sem_t release;
+static int order[JOBS * 2];
+static int done = 0;
+static mraa_result_t wait_result[JOBS];
+
+static mraa_i2c_context
+slave()
+{
+    mraa_i2c_context dev = mraa_i2c_init(BUS);
+    if (dev != NULL && mraa_i2c_address(dev, SLAVE) != MRAA_SUCCESS) {
+        mraa_i2c_stop(dev);
+        return NULL;
+    }
+    return dev;
+}
+
+// callbacks are serialised by the worker, no locking needed
+static void
+record(mraa_i2c_context dev, mraa_result_t result, void* args)
+{
+    order[done++] = result == MRAA_SUCCESS ? (int) (intptr_t) args : -1;
+}
+
+static void
+block(mraa_i2c_context dev, mraa_result_t result, void* args)
+{
+    sem_post(&entered);
+    sem_wait(&release);
+}
+
+// queues a job whose callback blocks the worker until release_worker()
+static mraa_result_t
+hold_worker(mraa_i2c_context dev)
+{
+    static uint8_t data[2];
+
+    if (sem_init(&entered, 0, 0) != 0 || sem_init(&release, 0, 0) != 0 ||
+        mraa_i2c_async_read_bytes_data(dev, 0, data, 2, MRAA_I2C_PRIORITY_HIGH, block, NULL) != MRAA_SUCCESS) {
+        return MRAA_ERROR_UNSPECIFIED;
+    }
+    sem_wait(&entered);
+    return MRAA_SUCCESS;
+}
+
+static void
+release_worker()
+{
+    sem_post(&release);
+}
+
+static void
+wait_from_callback(mraa_i2c_context dev, mraa_result_t result, void* args)
+{
+    wait_result[done++] = mraa_i2c_async_wait(dev);
+}
+
+static void
+stop_from_callback(mraa_i2c_context dev, mraa_result_t result, void* args)
+{
+    done++;
+    mraa_i2c_stop(dev);
+}
+
+static int
+check_priority()
+{
+    const mraa_i2c_priority_t prio[JOBS] = { MRAA_I2C_PRIORITY_LOW, MRAA_I2C_PRIORITY_NORMAL, MRAA_I2C_PRIORITY_LOW,
+                                             MRAA_I2C_PRIORITY_HIGH, MRAA_I2C_PRIORITY_HIGH };
+    const int expected[JOBS] = { 3, 4, 1, 0, 2 };
+    uint8_t data[JOBS][2];
+    int i;
+
+    mraa_i2c_context dev = slave();
+    CHECK(dev != NULL);
+
+    CHECK(hold_worker(dev) == MRAA_SUCCESS);
+    for (i = 0; i < JOBS; i++) {
+        CHECK(mraa_i2c_async_read_bytes_data(dev, 0, data[i], 2, prio[i], record, (void*) (intptr_t) i) == MRAA_SUCCESS);
+    }
+    release_worker();
+
+    // by priority, in queueing order within a priority
+    CHECK(mraa_i2c_async_wait(dev) == MRAA_SUCCESS);
+    CHECK(done == JOBS);
+    CHECK(memcmp(order, expected, sizeof(expected)) == 0);
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static int
+check_wait()
+{
+    uint8_t regs[] = { 0x70, 0x01, 0x02, 0x03, 0x04 };
+    uint8_t data[JOBS][4];
+    int i;
+
+    mraa_i2c_context dev = slave();
+    CHECK(dev != NULL);
+    CHECK(mraa_i2c_async_write(dev, regs, sizeof(regs), MRAA_I2C_PRIORITY_NORMAL, record, (void*) 0) == MRAA_SUCCESS);
+    for (i = 1; i < JOBS; i++) {
+        CHECK(mraa_i2c_async_read_bytes_data(dev, regs[0], data[i], 4, MRAA_I2C_PRIORITY_NORMAL, record,
+                                             (void*) (intptr_t) i) == MRAA_SUCCESS);
+    }
+
+    // every job ran and every callback returned
+    CHECK(mraa_i2c_async_wait(dev) == MRAA_SUCCESS);
+    CHECK(done == JOBS);
+    for (i = 0; i < JOBS; i++) {
+        CHECK(order[i] == i);
+        CHECK(i == 0 || memcmp(data[i], regs + 1, 4) == 0);
+    }
+    // nothing queued, nothing to wait for
+    CHECK(mraa_i2c_async_wait(dev) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static int
+check_wait_in_callback()
+{
+    uint8_t data[2][2];
+
+    mraa_i2c_context dev = slave();
+    CHECK(dev != NULL);
+
+    // refused while a job of the context is queued behind, fine after the last
+    CHECK(hold_worker(dev) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_async_read_bytes_data(dev, 0, data[0], 2, MRAA_I2C_PRIORITY_NORMAL, wait_from_callback, NULL) ==
+          MRAA_SUCCESS);
+    CHECK(mraa_i2c_async_read_bytes_data(dev, 0, data[1], 2, MRAA_I2C_PRIORITY_NORMAL, wait_from_callback, NULL) ==
+          MRAA_SUCCESS);
+    release_worker();
+    CHECK(mraa_i2c_async_wait(dev) == MRAA_SUCCESS);
+    CHECK(done == 2);
+    CHECK(wait_result[0] == MRAA_ERROR_INVALID_RESOURCE);
+    CHECK(wait_result[1] == MRAA_SUCCESS);
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static int
+check_stop_in_callback()
+{
+    uint8_t data[3][2];
+
+    mraa_i2c_context dev = slave();
+    mraa_i2c_context other = slave();
+    CHECK(dev != NULL && other != NULL);
+
+    // the job queued behind the stop is dropped without its callback
+    CHECK(hold_worker(other) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_async_read_bytes_data(dev, 0, data[0], 2, MRAA_I2C_PRIORITY_NORMAL, stop_from_callback, NULL) ==
+          MRAA_SUCCESS);
+    CHECK(mraa_i2c_async_read_bytes_data(dev, 0, data[1], 2, MRAA_I2C_PRIORITY_NORMAL, stop_from_callback, NULL) ==
+          MRAA_SUCCESS);
+    // the worker keeps serving the other contexts of the bus
+    CHECK(mraa_i2c_async_read_bytes_data(other, 0, data[2], 2, MRAA_I2C_PRIORITY_LOW, record, (void*) 7) ==
+          MRAA_SUCCESS);
+    release_worker();
+    CHECK(mraa_i2c_async_wait(other) == MRAA_SUCCESS);
+    CHECK(done == 2);
+    CHECK(order[1] == 7);
+    CHECK(mraa_i2c_stop(other) == MRAA_SUCCESS);
+    return 0;
+}
+
+static const check_t checks[] = {
+    { "priority", check_priority },
+    { "wait", check_wait },
+    { "wait_in_callback", check_wait_in_callback },
+    { "stop_in_callback", check_stop_in_callback },
+};
+
+int
+main(int argc, char** argv)
+{
+    return checks_main(checks, sizeof(checks) / sizeof(checks[0]), argc, argv);
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * I2c register map cache on the mock platform. Bus 0 holds a register file
+ * at SLAVE. The checks change registers behind the back of the map with a
+ * plain context to see whether the map went to the device or the cache.
+ */
+
+#include "mock_checks.h"
+
+#define BUS 0
+#define SLAVE 0x33
+
+static mraa_i2c_context
+slave()
+{
+    mraa_i2c_context dev = mraa_i2c_init(BUS);
+    if (dev != NULL && mraa_i2c_address(dev, SLAVE) != MRAA_SUCCESS) {
+        mraa_i2c_stop(dev);
+        return NULL;
+    }
+    return dev;
+}
+
+static int
+check_cache()
+{
+    mraa_i2c_context dev = slave();
+    CHECK(dev != NULL);
+    mraa_i2c_regmap map = mraa_i2c_regmap_init(dev, SLAVE);
+    CHECK(map != NULL);
+
+    // write through
+    CHECK(mraa_i2c_regmap_write(map, 0x40, 0xf0) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x40) == 0xf0);
+    CHECK(mraa_i2c_regmap_update_bits(map, 0x40, 0x3c, 0x14) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x40) == 0xd4);
+
+    // the old value comes from the cache, an unchanged value is not written
+    CHECK(mraa_i2c_write_byte_data(dev, 0x00, 0x40) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_regmap_read(map, 0x40) == 0xd4);
+    CHECK(mraa_i2c_regmap_update_bits(map, 0x40, 0x0f, 0x04) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x40) == 0x00);
+
+    // a volatile register always goes to the device
+    CHECK(mraa_i2c_regmap_set_volatile(map, 0x40, 1) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_regmap_read(map, 0x40) == 0x00);
+    CHECK(mraa_i2c_regmap_set_volatile(map, 0x40, 0) == MRAA_SUCCESS);
+
+    CHECK(mraa_i2c_regmap_stop(map) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static int
+check_writeback()
+{
+    mraa_i2c_context dev = slave();
+    CHECK(dev != NULL);
+    mraa_i2c_regmap map = mraa_i2c_regmap_init(dev, SLAVE);
+    CHECK(map != NULL);
+
+    // writeback holds writes until sync, the last value of a register wins
+    CHECK(mraa_i2c_regmap_set_writeback(map, 1) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_regmap_write(map, 0x41, 0x01) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_regmap_write(map, 0x41, 0x02) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_regmap_update_bits(map, 0x41, 0x80, 0x80) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_regmap_write(map, 0x42, 0x03) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_regmap_read(map, 0x41) == 0x82);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x41) != 0x82);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x42) != 0x03);
+    CHECK(mraa_i2c_regmap_sync(map) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x41) == 0x82);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x42) == 0x03);
+
+    // turning writeback off syncs, invalidate drops what is held
+    CHECK(mraa_i2c_regmap_write(map, 0x42, 0x04) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_regmap_set_writeback(map, 0) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x42) == 0x04);
+    CHECK(mraa_i2c_regmap_set_writeback(map, 1) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_regmap_write(map, 0x42, 0x05) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_regmap_invalidate(map) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_regmap_read(map, 0x42) == 0x04);
+
+    // stopping the map sends what it still holds
+    CHECK(mraa_i2c_regmap_write(map, 0x43, 0x06) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x43) != 0x06);
+    CHECK(mraa_i2c_regmap_stop(map) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x43) == 0x06);
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static const check_t checks[] = {
+    { "cache", check_cache },
+    { "writeback", check_writeback },
+};
+
+int
+main(int argc, char** argv)
+{
+    return checks_main(checks, sizeof(checks) / sizeof(checks[0]), argc, argv);
+}
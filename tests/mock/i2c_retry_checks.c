@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Retry policies on the mock platform. Bus 0 holds a register file at SLAVE,
+ * transfers to ABSENT are nacked with ENXIO.
+ */
+
+#include "mock_checks.h"
+
+#define BUS 0
+#define SLAVE 0x33
+#define ABSENT 0x34
+
+static int
+check_nack()
+{
+    mraa_i2c_retry_policy_t policy = { 3, 100, 1000, MRAA_I2C_RETRY_ENXIO, 0 };
+    mraa_i2c_retry_stats_t stats;
+
+    mraa_i2c_context dev = mraa_i2c_init(BUS);
+    CHECK(dev != NULL);
+    CHECK(mraa_i2c_address(dev, ABSENT) == MRAA_SUCCESS);
+
+    // a new context does not retry
+    CHECK(mraa_i2c_read_byte_data(dev, 0x00) == -1);
+    CHECK(mraa_i2c_retry_stats(dev, &stats, 0) == MRAA_SUCCESS);
+    CHECK(stats.retries == 0 && stats.exhausted == 0);
+
+    // the mock nacks with ENXIO, every retry is used up
+    CHECK(mraa_i2c_set_retry_policy(dev, &policy) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x00) == -1);
+    CHECK(mraa_i2c_write_byte_data(dev, 0x00, 0x00) != MRAA_SUCCESS);
+    CHECK(mraa_i2c_retry_stats(dev, &stats, 1) == MRAA_SUCCESS);
+    CHECK(stats.retries == 2 * policy.retries);
+    CHECK(stats.exhausted == 2);
+    CHECK(stats.recoveries == 0);
+    CHECK(mraa_i2c_retry_stats(dev, &stats, 0) == MRAA_SUCCESS);
+    CHECK(stats.retries == 0 && stats.exhausted == 0);
+
+    // calls rejected before reaching the bus are never retried
+    CHECK(mraa_i2c_write(dev, NULL, 1) == MRAA_ERROR_INVALID_PARAMETER);
+    CHECK(mraa_i2c_retry_stats(dev, &stats, 0) == MRAA_SUCCESS);
+    CHECK(stats.retries == 0 && stats.exhausted == 0);
+
+    // errors outside retry_on fail at once
+    policy.retry_on = MRAA_I2C_RETRY_EAGAIN | MRAA_I2C_RETRY_EIO;
+    CHECK(mraa_i2c_set_retry_policy(dev, &policy) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x00) == -1);
+    CHECK(mraa_i2c_retry_stats(dev, &stats, 0) == MRAA_SUCCESS);
+    CHECK(stats.retries == 0 && stats.exhausted == 0);
+
+    // a call that succeeds costs nothing
+    policy.retry_on = MRAA_I2C_RETRY_ENXIO;
+    CHECK(mraa_i2c_set_retry_policy(dev, &policy) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_address(dev, SLAVE) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x00) != -1);
+    CHECK(mraa_i2c_retry_stats(dev, &stats, 0) == MRAA_SUCCESS);
+    CHECK(stats.retries == 0 && stats.exhausted == 0);
+
+    CHECK(mraa_i2c_set_retry_policy(dev, NULL) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static const check_t checks[] = {
+    { "nack", check_nack },
+};
+
+int
+main(int argc, char** argv)
+{
+    return checks_main(checks, sizeof(checks) / sizeof(checks[0]), argc, argv);
+}
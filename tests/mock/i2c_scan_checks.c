@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Bus scans on the mock platform. Bus 0 holds a register file at SLAVE and
+ * nothing at ABSENT. A plain read of the register file returns the register
+ * after the last one accessed, which shows whether a scan touched the bus.
+ */
+
+#include "mock_checks.h"
+
+#define BUS 0
+#define SLAVE 0x33
+#define ABSENT 0x34
+
+static mraa_i2c_context
+slave()
+{
+    mraa_i2c_context dev = mraa_i2c_init(BUS);
+    if (dev != NULL && mraa_i2c_address(dev, SLAVE) != MRAA_SUCCESS) {
+        mraa_i2c_stop(dev);
+        return NULL;
+    }
+    return dev;
+}
+
+static int
+check_probe()
+{
+    mraa_i2c_context dev = slave();
+    CHECK(dev != NULL);
+    CHECK(mraa_i2c_probe(dev, SLAVE) == 1);
+    CHECK(mraa_i2c_probe(dev, ABSENT) == 0);
+    CHECK(mraa_i2c_probe(dev, 0x80) == 0);
+    // the address of the context is left as it was
+    CHECK(mraa_i2c_write_byte_data(dev, 0x5a, 0x20) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x20) == 0x5a);
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static int
+check_cache()
+{
+    uint8_t found[MRAA_I2C_SCAN_MAX_ADDRESSES];
+    int bus = BUS;
+
+    mraa_i2c_context dev = slave();
+    CHECK(dev != NULL);
+    CHECK(mraa_i2c_write_byte_data(dev, 0xa0, 0x10) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_write_byte_data(dev, 0xa1, 0x11) == MRAA_SUCCESS);
+    mraa_i2c_scan_invalidate(-1);
+
+    // probing the slave reads a byte, moving its register pointer on
+    CHECK(mraa_i2c_write_byte(dev, 0x10) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_scan(BUS, found, MRAA_I2C_SCAN_MAX_ADDRESSES) == 1);
+    CHECK(found[0] == SLAVE);
+    CHECK(mraa_i2c_read_byte(dev) == 0xa1);
+
+    // a cached scan leaves the bus alone
+    CHECK(mraa_i2c_write_byte(dev, 0x10) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_scan(BUS, found, MRAA_I2C_SCAN_MAX_ADDRESSES) == 1);
+    CHECK(found[0] == SLAVE);
+    CHECK(mraa_i2c_scan_buses(&bus, 1) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_byte(dev) == 0xa0);
+
+    // until it is invalidated
+    mraa_i2c_scan_invalidate(BUS);
+    CHECK(mraa_i2c_write_byte(dev, 0x10) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_scan_buses(&bus, 1) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_byte(dev) == 0xa1);
+    CHECK(mraa_i2c_scan(BUS, found, MRAA_I2C_SCAN_MAX_ADDRESSES) == 1);
+
+    // the mock has a single bus
+    CHECK(mraa_i2c_scan(BUS + 1, found, MRAA_I2C_SCAN_MAX_ADDRESSES) == -1);
+
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static const check_t checks[] = {
+    { "probe", check_probe },
+    { "cache", check_cache },
+};
+
+int
+main(int argc, char** argv)
+{
+    return checks_main(checks, sizeof(checks) / sizeof(checks[0]), argc, argv);
+}
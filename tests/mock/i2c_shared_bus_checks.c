@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Several i2c contexts on one bus on the mock platform. Bus 0 holds a
+ * register file at SLAVE and nothing at ABSENT. Every call must go to the
+ * address of its own context, whatever the other contexts on the bus do at
+ * the same time.
+ */
+
+#include <pthread.h>
+
+#include "mock_checks.h"
+
+#define BUS 0
+#define SLAVE 0x33
+#define ABSENT 0x34
+#define ROUNDS 1000
+
+typedef struct {
+    mraa_i2c_context dev; /**< context of the thread */
+    int errors; /**< calls that did not behave as their address implies */
+} worker_t;
+
+static void*
+present_worker(void* arg)
+{
+    worker_t* w = (worker_t*) arg;
+    int i;
+
+    for (i = 0; i < ROUNDS; i++) {
+        if (mraa_i2c_write_byte_data(w->dev, (uint8_t) i, 0x50) != MRAA_SUCCESS ||
+            mraa_i2c_read_byte_data(w->dev, 0x50) != (i & 0xff)) {
+            w->errors++;
+        }
+    }
+    return NULL;
+}
+
+static void*
+absent_worker(void* arg)
+{
+    worker_t* w = (worker_t*) arg;
+    int i;
+
+    for (i = 0; i < ROUNDS; i++) {
+        if (mraa_i2c_read_byte_data(w->dev, 0x50) != -1) {
+            w->errors++;
+        }
+    }
+    return NULL;
+}
+
+static int
+check_threads()
+{
+    worker_t present = { mraa_i2c_init(BUS), 0 };
+    worker_t absent = { mraa_i2c_init(BUS), 0 };
+    pthread_t a, b;
+
+    CHECK(present.dev != NULL && absent.dev != NULL);
+    CHECK(mraa_i2c_address(present.dev, SLAVE) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_address(absent.dev, ABSENT) == MRAA_SUCCESS);
+
+    CHECK(pthread_create(&a, NULL, present_worker, &present) == 0);
+    CHECK(pthread_create(&b, NULL, absent_worker, &absent) == 0);
+    pthread_join(a, NULL);
+    pthread_join(b, NULL);
+    CHECK(present.errors == 0);
+    CHECK(absent.errors == 0);
+
+    CHECK(mraa_i2c_stop(absent.dev) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_stop(present.dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static int
+check_stop_one()
+{
+    mraa_i2c_context first = mraa_i2c_init(BUS);
+    mraa_i2c_context second = mraa_i2c_init(BUS);
+
+    CHECK(first != NULL && second != NULL);
+    CHECK(mraa_i2c_address(first, SLAVE) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_address(second, SLAVE) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_write_byte_data(first, 0x5a, 0x51) == MRAA_SUCCESS);
+
+    // the bus stays open for the context left on it
+    CHECK(mraa_i2c_stop(first) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_byte_data(second, 0x51) == 0x5a);
+    CHECK(mraa_i2c_stop(second) == MRAA_SUCCESS);
+    return 0;
+}
+
+static int
+check_bad_address()
+{
+    mraa_i2c_context dev = mraa_i2c_init(BUS);
+
+    CHECK(dev != NULL);
+    CHECK(mraa_i2c_address(dev, SLAVE) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_write_byte_data(dev, 0x5a, 0x52) == MRAA_SUCCESS);
+
+    // a rejected address leaves the context talking to its slave
+    CHECK(mraa_i2c_address(dev, 0x80) == MRAA_ERROR_INVALID_PARAMETER);
+    CHECK(mraa_i2c_read_byte_data(dev, 0x52) == 0x5a);
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static const check_t checks[] = {
+    { "threads", check_threads },
+    { "stop_one", check_stop_one },
+    { "bad_address", check_bad_address },
+};
+
+int
+main(int argc, char** argv)
+{
+    return checks_main(checks, sizeof(checks) / sizeof(checks[0]), argc, argv);
+}
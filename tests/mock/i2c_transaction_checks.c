@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Batched i2c transactions on the mock platform. Bus 0 holds a register
+ * file at SLAVE, every other address is left unacknowledged.
+ */
+
+#include "mock_checks.h"
+
+#define BUS 0
+#define SLAVE 0x33
+#define ABSENT 0x34
+
+static mraa_i2c_context
+slave()
+{
+    mraa_i2c_context dev = mraa_i2c_init(BUS);
+    if (dev != NULL && mraa_i2c_address(dev, SLAVE) != MRAA_SUCCESS) {
+        mraa_i2c_stop(dev);
+        return NULL;
+    }
+    return dev;
+}
+
+static int
+check_submit()
+{
+    uint8_t regs[] = { 0x20, 0x11, 0x22, 0x33 };
+    uint8_t rx[3] = { 0 };
+
+    mraa_i2c_context dev = slave();
+    CHECK(dev != NULL);
+    mraa_i2c_transaction trans = mraa_i2c_transaction_init(dev);
+    CHECK(trans != NULL);
+
+    // write three registers then read them back, all in one transfer
+    CHECK(mraa_i2c_transaction_write(trans, SLAVE, regs, sizeof(regs)) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_transaction_write(trans, SLAVE, regs, 1) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_transaction_read(trans, SLAVE, rx, sizeof(rx)) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_transaction_count(trans) == 3);
+    CHECK(mraa_i2c_transaction_submit(trans) == MRAA_SUCCESS);
+    CHECK(memcmp(rx, regs + 1, sizeof(rx)) == 0);
+    CHECK(mraa_i2c_read_byte_data(dev, regs[0] + 1) == regs[2]);
+
+    // a transaction stays queued after submit, clear empties it
+    CHECK(mraa_i2c_transaction_count(trans) == 3);
+    CHECK(mraa_i2c_transaction_clear(trans) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_transaction_count(trans) == 0);
+
+    CHECK(mraa_i2c_transaction_stop(trans) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static int
+check_limits()
+{
+    uint8_t rx[1];
+    int i;
+
+    mraa_i2c_context dev = slave();
+    CHECK(dev != NULL);
+    mraa_i2c_transaction trans = mraa_i2c_transaction_init(dev);
+    CHECK(trans != NULL);
+
+    // one message nobody acknowledges fails the whole transfer
+    CHECK(mraa_i2c_transaction_read(trans, ABSENT, rx, 1) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_transaction_submit(trans) != MRAA_SUCCESS);
+    CHECK(mraa_i2c_transaction_clear(trans) == MRAA_SUCCESS);
+
+    CHECK(mraa_i2c_transaction_read(trans, SLAVE, NULL, 1) == MRAA_ERROR_INVALID_PARAMETER);
+    CHECK(mraa_i2c_transaction_read(trans, SLAVE, rx, 0) == MRAA_ERROR_INVALID_PARAMETER);
+    CHECK(mraa_i2c_transaction_count(trans) == 0);
+
+    for (i = 0; i < MRAA_I2C_TRANSACTION_MAX_MSGS; i++) {
+        CHECK(mraa_i2c_transaction_read(trans, SLAVE, rx, 1) == MRAA_SUCCESS);
+    }
+    CHECK(mraa_i2c_transaction_read(trans, SLAVE, rx, 1) != MRAA_SUCCESS);
+    CHECK(mraa_i2c_transaction_count(trans) == MRAA_I2C_TRANSACTION_MAX_MSGS);
+
+    CHECK(mraa_i2c_transaction_stop(trans) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static const check_t checks[] = {
+    { "submit", check_submit },
+    { "limits", check_limits },
+};
+
+int
+main(int argc, char** argv)
+{
+    return checks_main(checks, sizeof(checks) / sizeof(checks[0]), argc, argv);
+}
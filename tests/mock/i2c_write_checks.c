@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Plain i2c writes longer than an SMBus block on the mock platform. Bus 0
+ * holds a 256 register file at SLAVE, the first byte of a write selects the
+ * register the rest goes to, wrapping around at the end.
+ */
+
+#include <stdlib.h>
+
+#include "mock_checks.h"
+
+#define BUS 0
+#define SLAVE 0x33
+#define REGS 256
+
+static mraa_i2c_context
+slave()
+{
+    mraa_i2c_context dev = mraa_i2c_init(BUS);
+    if (dev != NULL && mraa_i2c_address(dev, SLAVE) != MRAA_SUCCESS) {
+        mraa_i2c_stop(dev);
+        return NULL;
+    }
+    return dev;
+}
+
+// payload byte i, whatever wraps over a register leaves the same value
+static uint8_t
+pattern(int i)
+{
+    return (uint8_t)(i * 7 + 3);
+}
+
+static int
+check_long()
+{
+    uint8_t data[1 + 100];
+    uint8_t regs[100];
+    int i;
+
+    mraa_i2c_context dev = slave();
+    CHECK(dev != NULL);
+    data[0] = 0x80;
+    for (i = 1; i < (int) sizeof(data); i++) {
+        data[i] = pattern(i - 1);
+    }
+    CHECK(mraa_i2c_write(dev, data, sizeof(data)) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_bytes_data(dev, data[0], regs, sizeof(regs)) == (int) sizeof(regs));
+    CHECK(memcmp(regs, data + 1, sizeof(regs)) == 0);
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static int
+check_split()
+{
+    int length = 1 + MRAA_I2C_TRANSACTION_MAX_LENGTH + 300;
+    uint8_t regs[REGS];
+    int i;
+
+    mraa_i2c_context dev = slave();
+    CHECK(dev != NULL);
+    uint8_t* data = (uint8_t*) malloc(length);
+    CHECK(data != NULL);
+    data[0] = 0x10;
+    for (i = 1; i < length; i++) {
+        data[i] = pattern(i - 1);
+    }
+
+    // more than one message holds, the rest continues without a new start
+    CHECK(mraa_i2c_write(dev, data, length) == MRAA_SUCCESS);
+    CHECK(mraa_i2c_read_bytes_data(dev, data[0], regs, REGS) == REGS);
+    for (i = 0; i < REGS; i++) {
+        CHECK(regs[i] == pattern(i));
+    }
+    free(data);
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static int
+check_too_long()
+{
+    int length = MRAA_I2C_TRANSACTION_MAX_MSGS * MRAA_I2C_TRANSACTION_MAX_LENGTH + 1;
+    uint8_t regs[4];
+
+    mraa_i2c_context dev = slave();
+    CHECK(dev != NULL);
+    uint8_t* data = (uint8_t*) calloc(length, 1);
+    CHECK(data != NULL);
+    CHECK(mraa_i2c_write_byte_data(dev, 0xaa, 0x20) == MRAA_SUCCESS);
+    data[0] = 0x20;
+
+    // refused as a whole rather than cut short
+    CHECK(mraa_i2c_write(dev, data, length) == MRAA_ERROR_INVALID_PARAMETER);
+    CHECK(mraa_i2c_read_bytes_data(dev, 0x20, regs, 1) == 1);
+    CHECK(regs[0] == 0xaa);
+    free(data);
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static const check_t checks[] = {
+    { "long", check_long },
+    { "split", check_split },
+    { "too_long", check_too_long },
+};
+
+int
+main(int argc, char** argv)
+{
+    return checks_main(checks, sizeof(checks) / sizeof(checks[0]), argc, argv);
+}
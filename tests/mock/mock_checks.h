@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Minimal harness for the mock platform checks. Every check is a function
+ * returning 0 on success, a program holds a table of them and runs the one
+ * named on the command line, so ctest reports each on its own line.
+ * Checks assert on results only: where the interrupt path runs in its own
+ * thread they wait, with a generous bound, for the result to show up
+ * instead of relying on how long it takes.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mraa.h"
+
+#define CHECK_WAIT_MS 5000
+
+#define CHECK(cond)                                                                           \
+    do {                                                                                      \
+        if (!(cond)) {                                                                        \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);          \
+            return 1;                                                                         \
+        }                                                                                     \
+    } while (0)
+
+// polls cond every millisecond until it holds, for at most CHECK_WAIT_MS
+#define CHECK_WAIT(cond)                                                                      \
+    do {                                                                                      \
+        int waited_ms_;                                                                       \
+        for (waited_ms_ = 0; !(cond) && waited_ms_ < CHECK_WAIT_MS; waited_ms_++) {           \
+            usleep(1000);                                                                     \
+        }                                                                                     \
+        CHECK(cond);                                                                          \
+    } while (0)
+
+typedef struct {
+    const char* name; /**< name given on the command line */
+    int (*run)(); /**< the check, 0 on success */
+} check_t;
+
+static int
+checks_main(const check_t* checks, int count, int argc, char** argv)
+{
+    int i;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s check\n", argv[0]);
+        return 1;
+    }
+    if (mraa_get_platform_type() != MRAA_MOCK_PLATFORM) {
+        fprintf(stderr, "%s: needs the mock platform, set MRAA_MOCK_PLATFORM\n", argv[0]);
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        if (strcmp(checks[i].name, argv[1]) == 0) {
+            int ret = checks[i].run();
+            mraa_deinit();
+            return ret;
+        }
+    }
+    fprintf(stderr, "%s: no check named %s\n", argv[0], argv[1]);
+    return 1;
+}
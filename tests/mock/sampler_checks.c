@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2016 Intel Corporation.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Periodic sampling on the mock platform. Bus 0 holds a register file at
+ * SLAVE and nothing at ABSENT, spi bus 0 has MOSI wired to MISO.
+ */
+
+#include "mock_checks.h"
+#include "mraa/sampler.h"
+
+#define BUS 0
+#define SLAVE 0x33
+#define ABSENT 0x34
+#define SAMPLER_DEPTH 4
+
+static mraa_i2c_context
+slave()
+{
+    mraa_i2c_context dev = mraa_i2c_init(BUS);
+    if (dev != NULL && mraa_i2c_address(dev, SLAVE) != MRAA_SUCCESS) {
+        mraa_i2c_stop(dev);
+        return NULL;
+    }
+    return dev;
+}
+
+static int
+check_overrun()
+{
+    uint8_t data[SAMPLER_DEPTH * 2 * 2];
+    uint64_t timestamps[SAMPLER_DEPTH * 2];
+    mraa_sampler_status_t status;
+    int i, n;
+
+    mraa_i2c_context dev = slave();
+    CHECK(dev != NULL);
+    CHECK(mraa_i2c_write_word_data(dev, 0xa55a, 0x60) == MRAA_SUCCESS);
+
+    mraa_sampler_job job = mraa_sampler_add_i2c(dev, SLAVE, 0x60, 2, 1000, SAMPLER_DEPTH);
+    CHECK(job != NULL);
+    mraa_sampler_job absent = mraa_sampler_add_i2c(dev, ABSENT, 0x60, 2, 1000, SAMPLER_DEPTH);
+    CHECK(absent != NULL);
+
+    // nobody reads, the ring overruns and keeps the newest samples
+    CHECK_WAIT(mraa_sampler_status(job, &status) == MRAA_SUCCESS && status.overruns > 0);
+    n = mraa_sampler_read(job, data, timestamps, SAMPLER_DEPTH * 2);
+    CHECK(n == SAMPLER_DEPTH);
+    for (i = 0; i < n; i++) {
+        CHECK(data[2 * i] == 0x5a && data[2 * i + 1] == 0xa5);
+        CHECK(i == 0 || timestamps[i] > timestamps[i - 1]);
+    }
+    CHECK(mraa_sampler_status(job, &status) == MRAA_SUCCESS);
+    CHECK(status.samples >= status.overruns + SAMPLER_DEPTH);
+    CHECK(status.errors == 0);
+
+    // failed transfers are counted, never stored
+    CHECK_WAIT(mraa_sampler_status(absent, &status) == MRAA_SUCCESS && status.errors > 0);
+    CHECK(status.samples == 0);
+    CHECK(mraa_sampler_read(absent, data, NULL, SAMPLER_DEPTH) == 0);
+
+    CHECK(mraa_sampler_remove(absent) == MRAA_SUCCESS);
+    CHECK(mraa_sampler_remove(job) == MRAA_SUCCESS);
+    CHECK(mraa_sampler_read(NULL, data, NULL, SAMPLER_DEPTH) == -1);
+    CHECK(mraa_i2c_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static int
+check_spi()
+{
+    uint8_t tx[] = { 0xde, 0xad, 0xbe, 0xef };
+    uint8_t data[sizeof(tx) * SAMPLER_DEPTH];
+    mraa_sampler_status_t status;
+    int i, n;
+
+    mraa_spi_context dev = mraa_spi_init(0);
+    CHECK(dev != NULL);
+    mraa_sampler_job job = mraa_sampler_add_spi(dev, tx, sizeof(tx), 1000, SAMPLER_DEPTH);
+    CHECK(job != NULL);
+    // the bytes to send were copied
+    memset(tx, 0, sizeof(tx));
+
+    CHECK_WAIT(mraa_sampler_status(job, &status) == MRAA_SUCCESS && status.samples >= 2);
+    n = mraa_sampler_read(job, data, NULL, SAMPLER_DEPTH);
+    CHECK(n >= 2);
+    for (i = 0; i < n; i++) {
+        CHECK(data[i * sizeof(tx)] == 0xde && data[i * sizeof(tx) + 3] == 0xef);
+    }
+    CHECK(mraa_sampler_remove(job) == MRAA_SUCCESS);
+    CHECK(mraa_spi_stop(dev) == MRAA_SUCCESS);
+    return 0;
+}
+
+static const check_t checks[] = {
+    { "overrun", check_overrun },
+    { "spi", check_spi },
+};
+
+int
+main(int argc, char** argv)
+{
+    return checks_main(checks, sizeof(checks) / sizeof(checks[0]), argc, argv);
+}